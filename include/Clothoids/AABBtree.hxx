@@ -26,11 +26,18 @@
  * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #pragma once
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <utility>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
 
 #include "Types.hxx"
+#include "Triangle2D.hxx"
 
 namespace G2lib {
 
@@ -40,7 +47,99 @@ namespace G2lib {
   using std::make_shared;
   using std::shared_ptr;
 
-  class AABBtree;
+  template <typename T>
+  class AABBtreeT;
+  template <typename T>
+  class DynamicAABBtreeT;
+  template <typename T>
+  class TriangleCoverT;
+
+  //!
+  //! Algorithm used to split the nodes when building an `AABBtree`
+  //!
+  typedef enum {
+    G2LIB_AABB_MIDPOINT = 0,  //!< split at the middle of the longest side (original builder)
+    G2LIB_AABB_BINNED_SAH     //!< binned Surface Area Heuristic (perimeter of the boxes in 2D)
+  } AABBbuildType;
+
+  extern AABBbuildType aabb_build_type;         //!< builder used by default by the new trees
+  extern int_type      aabb_max_leaf_size;      //!< maximum number of boxes in a leaf used by default
+  extern int_type      aabb_build_threads;      //!< threads used by default to build a tree (0 = all the cores)
+  extern int_type      aabb_intersect_threads;  //!< threads used to intersect curve lists (0 = all the cores)
+  extern bool          aabb_wide_nodes;         //!< build the 4-wide nodes used by the queries of the new trees
+  extern bool          aabb_clip_triangles;     //!< clip the triangles covering the pieces of the clothoids
+
+  //!
+  //! Build the AABB trees with the midpoint split, one box per leaf (initial setting)
+  //!
+  static inline void midpointAABBtree() {
+    aabb_build_type    = G2LIB_AABB_MIDPOINT;
+    aabb_max_leaf_size = 1;
+  }
+
+  //!
+  //! Build the AABB trees with the binned SAH
+  //!
+  //! \param[in] max_leaf_size maximum number of boxes in a leaf
+  //!
+  static inline void sahAABBtree(int_type max_leaf_size = 4) {
+    aabb_build_type    = G2LIB_AABB_BINNED_SAH;
+    aabb_max_leaf_size = max_leaf_size;
+  }
+
+  //!
+  //! Number of threads used to build the AABB trees (1 = serial, initial
+  //! setting, 0 = `std::thread::hardware_concurrency()`). The trees are
+  //! the same whatever the number of threads.
+  //!
+  static inline void threadsAABBtree(int_type nthreads) { aabb_build_threads = nthreads; }
+
+  //!
+  //! Number of threads used to intersect two curve lists (1 = serial,
+  //! initial setting, 0 = `std::thread::hardware_concurrency()`). The
+  //! intersections are sorted by abscissa, so the result does not depend
+  //! on the number of threads.
+  //!
+  static inline void threadsIntersectAABBtree(int_type nthreads) { aabb_intersect_threads = nthreads; }
+
+  //!
+  //! Use the 4-wide nodes for the queries of the AABB trees built from now
+  //! on (initial setting: binary nodes only). Each node test is done on four
+  //! boxes at once (AVX when the library is compiled for it). This is the
+  //! backing structure of the spatial queries of `ClothoidCurve`,
+  //! `ClothoidList`, `BiarcList` and `PolyLine`, whose trees are rebuilt
+  //! when they are next needed.
+  //!
+  static inline void wideAABBtree(bool wide = true) { aabb_wide_nodes = wide; }
+
+  //!
+  //! Clip the triangles covering the pieces of the clothoids (initial
+  //! setting: not clipped). The triangle of a piece is made by its chord and
+  //! the tangents at its ends; clipped with the line parallel to the chord
+  //! at the height of the piece it is about 3/4 of the area, so fewer pairs
+  //! of pieces pass the overlap test and go to the refinement of the
+  //! intersections. The covers of `ClothoidCurve` and `ClothoidList` are
+  //! rebuilt when they are next needed.
+  //!
+  static inline void clipAABBtriangles(bool clip = true) { aabb_clip_triangles = clip; }
+
+  //!
+  //! Pairs of triangles met by `TriangleCover::intersect_visit`: `tested`
+  //! pairs of triangles of overlapping leaves of the AABB trees and
+  //! `refined` pairs of overlapping triangles passed to the refinement of
+  //! the intersection, so the triangle tests avoid `tested - refined`
+  //! refinements. The counts are added to the current values.
+  //!
+  struct AABBintersectCounters {
+    std::uint64_t tested{0};   //!< pairs of triangles tested
+    std::uint64_t refined{0};  //!< pairs of overlapping triangles
+
+    //! Reset the counters.
+    void reset() {
+      tested  = 0;
+      refined = 0;
+    }
+  };
 
   /*\
    |   ____  ____
@@ -50,21 +149,24 @@ namespace G2lib {
    |  |____/|____/ \___/_/\_\
   \*/
   //!
-  //! Class to manipulate bounding box
+  //! Class to manipulate bounding box, templated on the scalar type. The
+  //! library provides the `float` and `double` instantiations, `BBox` is
+  //! the `real_type` one.
   //!
-  class BBox {
+  template <typename T>
+  class BBoxT {
    public:
-    typedef shared_ptr<BBox const> PtrBBox;
+    typedef shared_ptr<BBoxT const> PtrBBox;
 
    private:
-    real_type m_bbox[4]{0.0, 0.0, 0.0, 0.0}; //!< bounds of the box: [xmin, ymin, xmax, ymax]
-    int_type  m_id;    //!< id of the bbox
-    int_type  m_ipos;  //!< rank of the bounding box used in external algorithms
+    T        m_bbox[4]{0, 0, 0, 0};  //!< bounds of the box: [xmin, ymin, xmax, ymax]
+    int_type m_id;                   //!< id of the bbox
+    int_type m_ipos;                 //!< rank of the bounding box used in external algorithms
 
-    BBox();
+    BBoxT();
 
-    BBox(BBox const &) = default;
-    BBox(BBox &&)      = default;
+    BBoxT(BBoxT const &) = default;
+    BBoxT(BBoxT &&)      = default;
 
    public:
     //!
@@ -77,7 +179,7 @@ namespace G2lib {
     //! \param[in] id   identifier of the box
     //! \param[in] ipos ranking position of the box
     //!
-    BBox(real_type xmin, real_type ymin, real_type xmax, real_type ymax, int_type id, int_type ipos) {
+    BBoxT(T xmin, T ymin, T xmax, T ymax, int_type id, int_type ipos) {
       x_min() = xmin;
       y_min() = ymin;
       x_max() = xmax;
@@ -93,7 +195,7 @@ namespace G2lib {
     //! \param[in] id     identifier of the box
     //! \param[in] ipos   ranking position of the box
     //!
-    BBox(vector<PtrBBox> const & bboxes, int_type id, int_type ipos) {
+    BBoxT(vector<PtrBBox> const & bboxes, int_type id, int_type ipos) {
       m_id   = id;
       m_ipos = ipos;
       this->join(bboxes);
@@ -101,31 +203,31 @@ namespace G2lib {
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    real_type const * bbox() { return m_bbox; }
-    real_type const * bbox_min() { return m_bbox; }
-    real_type const * bbox_max() { return m_bbox + 2; }
+    T const * bbox() { return m_bbox; }
+    T const * bbox_min() { return m_bbox; }
+    T const * bbox_max() { return m_bbox + 2; }
 
     // Deprecated: retrocompatibility
-    real_type Xmin() const { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
-    real_type Ymin() const { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
-    real_type Xmax() const { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
-    real_type Ymax() const { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
+    T Xmin() const { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
+    T Ymin() const { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
+    T Xmax() const { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
+    T Ymax() const { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
 
     // Deprecated: retrocompatibility
-    real_type & Xmin() { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
-    real_type & Ymin() { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
-    real_type & Xmax() { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
-    real_type & Ymax() { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
+    T & Xmin() { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
+    T & Ymin() { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
+    T & Xmax() { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
+    T & Ymax() { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
 
-    real_type x_min() const { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
-    real_type y_min() const { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
-    real_type x_max() const { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
-    real_type y_max() const { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
+    T x_min() const { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
+    T y_min() const { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
+    T x_max() const { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
+    T y_max() const { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
 
-    real_type & x_min() { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
-    real_type & y_min() { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
-    real_type & x_max() { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
-    real_type & y_max() { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
+    T & x_min() { return m_bbox[0]; }  //!< x-minimum coordinate of the bbox
+    T & y_min() { return m_bbox[1]; }  //!< y-minimum coordinate of the bbox
+    T & x_max() { return m_bbox[2]; }  //!< x-maximum coordinate of the bbox
+    T & y_max() { return m_bbox[3]; }  //!< y-maximum coordinate of the bbox
 
     int_type const & Id() const { return m_id; }      //!< return BBOX id
     int_type const & Ipos() const { return m_ipos; }  //!< return BBOX position
@@ -133,12 +235,12 @@ namespace G2lib {
     //!
     //! copy a bbox
     //!
-    BBox const & operator=(BBox const & rhs);
+    BBoxT const & operator=(BBoxT const & rhs);
 
     //!
     //! detect if two bbox collide
     //!
-    bool collision(BBox const & box) const;
+    bool collision(BBoxT const & box) const;
 
     //!
     //! Build bbox for a list of bbox
@@ -148,25 +250,26 @@ namespace G2lib {
     //!
     //! distance of the point `(x,y)` to the bbox
     //!
-    real_type distance(real_type x, real_type y) const;
+    T distance(T x, T y) const;
 
     //!
     //! Maximum distance of the point `(x,y)` to the point of bbox
     //!
-    real_type maxDistance(real_type x, real_type y) const;
+    T maxDistance(T x, T y) const;
 
     //!
     //! Pretty print a bbox
     //!
     void print(ostream_type & stream) const;
 
-    friend class AABBtree;
+    friend class AABBtreeT<T>;
   };
 
   //!
   //! Pretty print a bbox
   //!
-  inline ostream_type & operator<<(ostream_type & stream, BBox const & bb) {
+  template <typename T>
+  inline ostream_type & operator<<(ostream_type & stream, BBoxT<T> const & bb) {
     bb.print(stream);
     return stream;
   }
@@ -187,34 +290,426 @@ namespace G2lib {
   //! efficient spatial queries, reducing the complexity of intersection tests
   //! between collections of objects.
   //!
+  //! The tree is stored flat: an array of nodes (bounds and indices) and
+  //! the array of the bounding boxes, permuted so that every leaf refers
+  //! to a contiguous range of it. The root is the node 0.
   //!
-  class AABBtree {
+  //! The tree is templated on the scalar type of the bounds, as `BBoxT`:
+  //! the library provides the `float` and `double` instantiations,
+  //! `AABBtree` is the `real_type` one.
+  //!
+  template <typename T>
+  class AABBtreeT {
    public:
-    using PtrBBox = shared_ptr<BBox const>;
-    using PtrAABB = shared_ptr<AABBtree>;
+    using PtrBBox = shared_ptr<BBoxT<T> const>;
+    using PtrAABB = shared_ptr<AABBtreeT>;
     using PairPtrBBox = pair<PtrBBox, PtrBBox>;
     using VecPtrBBox = vector<PtrBBox>;
     using VecPairPtrBBox = vector<PairPtrBBox>;
+    using DistPtrBBox = pair<T, PtrBBox>;
+    using VecDistPtrBBox = vector<DistPtrBBox>;
+
+    template <typename U>
+    friend class DynamicAABBtreeT;
+    template <typename U>
+    friend class TriangleCoverT;
 
    private:
-    // bbox of the tree
-    PtrBBox         pBBox;
-    vector<PtrAABB> children;
+    //
+    // Node of the tree. An internal node (`num == 0`) has the two
+    // children stored at `first` and `first+1`, a leaf covers the
+    // boxes `first`, ..., `first+num-1`.
+    //
+    struct Node {
+      T        bbox[4];  // [xmin, ymin, xmax, ymax]
+      int_type first;
+      int_type num;
+
+      bool is_leaf() const { return num > 0; }
+    };
+
+    //
+    // Node of the 4-wide tree obtained collapsing the binary one: the
+    // bounds of up to 4 children stored by coordinate, so that a box or a
+    // point is tested against all of them at once. The child `c < size` is
+    // the wide node `child[c]` if `num[c] == 0`, otherwise a leaf covering
+    // the boxes `child[c]`, ..., `child[c]+num[c]-1`. The unused lanes
+    // have empty bounds.
+    //
+    struct alignas(32) WideNode {
+      T        xmin[4];
+      T        ymin[4];
+      T        xmax[4];
+      T        ymax[4];
+      int_type child[4];
+      int_type num[4];
+      int_type size;
+    };
+
+    vector<Node>     m_nodes;       // nodes of the tree, m_nodes[0] is the root
+    vector<PtrBBox>  m_bboxes;      // bounding boxes, permuted by leaf
+    vector<T>        m_prim_bbox;   // bounds of m_bboxes, 4 values per box (contiguous copy)
+    vector<WideNode> m_wide_nodes;  // 4-wide nodes, m_wide_nodes[0] is the root (empty if not used)
+
+    AABBbuildType m_build_type;
+    int_type      m_max_leaf_size;
+    int_type      m_build_threads;
+    bool          m_wide;
+
+    // smallest range of boxes built by a parallel task
+    static int_type const PARALLEL_GRAIN = 4096;
+
+    AABBtreeT(AABBtreeT const & tree);
+
+    static bool overlap(T const * a, T const * b) {
+      return !((b[0] > a[2]) || (b[2] < a[0]) || (b[1] > a[3]) || (b[3] < a[1]));
+    }
+
+    // ray `(x0,y0) + t (dx,dy)` with the inverse of the direction
+    struct Ray {
+      T x0, y0, dx, dy, idx, idy;
+    };
+
+    // slab test: parameter `t_enter` where the ray enters the box `bb` if it
+    // is hit for `t` in `[0,tmax]`
+    static bool ray_enter(T const * bb, Ray const & R, T tmax, T & t_enter) {
+      T t0 = 0;
+      T t1 = tmax;
+      if (R.dx == 0) {
+        if (R.x0 < bb[0] || R.x0 > bb[2])
+          return false;
+      } else {
+        T ta = (bb[0] - R.x0) * R.idx;
+        T tb = (bb[2] - R.x0) * R.idx;
+        t0   = std::max(t0, std::min(ta, tb));
+        t1   = std::min(t1, std::max(ta, tb));
+      }
+      if (R.dy == 0) {
+        if (R.y0 < bb[1] || R.y0 > bb[3])
+          return false;
+      } else {
+        T ta = (bb[1] - R.y0) * R.idy;
+        T tb = (bb[3] - R.y0) * R.idy;
+        t0   = std::max(t0, std::min(ta, tb));
+        t1   = std::min(t1, std::max(ta, tb));
+      }
+      t_enter = t0;
+      return t0 <= t1;
+    }
+
+    // distance of the point `(x,y)` from the box `bb` (0 if inside)
+    static T point_distance(T const * bb, T x, T y) {
+      T dx = x < bb[0] ? bb[0] - x : (x > bb[2] ? x - bb[2] : 0);
+      T dy = y < bb[1] ? bb[1] - y : (y > bb[3] ? y - bb[3] : 0);
+      return std::hypot(dx, dy);
+    }
+
+    //
+    // Tests of all the children of a wide node at once. They are compiled
+    // in AABBtree.cc for the instruction sets selected at run time, so the
+    // library uses the vector units of the running CPU whatever the flags
+    // of the code including this header.
+    //
+
+    // mask of the children of `W` overlapping the box `bb`
+    static int_type overlap4(T const * bb, WideNode const & W);
+
+    // `mask[a]`: mask of the children of `B` overlapping the child `a` of `A`
+    static void overlap4x4(WideNode const & A, WideNode const & B, int_type mask[4]);
+
+    // distances of the point `(x,y)` from the children of `W` (0 if inside)
+    static void distance4(WideNode const & W, T x, T y, T d[4]);
+
+    // order of the `n` children of a wide node by increasing `key`
+    static void sort4(T const * key, int_type n, int_type * order) {
+      for (int_type c = 0; c < n; ++c) {
+        int_type k = c;
+        for (; k > 0 && key[order[k - 1]] > key[c]; --k)
+          order[k] = order[k - 1];
+        order[k] = c;
+      }
+    }
+
+    // reference to the child `c` of the wide node `w`: the node itself or,
+    // for a leaf, `-1-(4*w+c)`
+    static int_type wide_ref(WideNode const & W, int_type w, int_type c) {
+      return W.num[c] == 0 ? W.child[c] : -1 - (4 * w + c);
+    }
+
+    void set_node_bbox(Node & N, int_type ibegin, int_type iend, vector<int_type> const & perm) const;
+    bool split_node(Node & N, int_type ibegin, int_type iend, vector<int_type> & perm, int_type & imid) const;
+    bool split_midpoint(Node const & N, int_type ibegin, int_type iend, vector<int_type> & perm, int_type & imid) const;
+    bool split_sah(Node const & N, int_type ibegin, int_type iend, vector<int_type> & perm, int_type & imid) const;
+    void build_subtree(
+        vector<Node> & nodes, int_type inode, int_type ibegin, int_type iend, vector<int_type> & perm) const;
+    void build_parallel(int_type nthreads, vector<int_type> & perm);
+    void refit_nodes();
+    void build_wide();
+    void build_wide_node(int_type iwide, int_type inode);
+
+    // depth of the explicit stack of the dual tree traversal
+    static int_type const PAIR_STACK_SIZE = 128;
+
+    //
+    // Dual tree traversal from the pair of nodes `(i,j)` (`i` of this tree,
+    // `j` of `tree`, with overlapping bounds): calls `ifun(k0,nk,l0,nl)` for
+    // every pair of overlapping leaves, the boxes `m_bboxes[k0,k0+nk)` and
+    // `tree.m_bboxes[l0,l0+nl)`, and stops when it returns true. Only pairs
+    // of overlapping nodes are pushed on a fixed stack; a pair that does not
+    // fit (degenerate trees only) is visited by a recursive call.
+    //
+    template <typename LEAF_fun>
+    bool traverse_pairs(int_type i, AABBtreeT const & tree, int_type j, LEAF_fun & ifun) const {
+      int_type stack[2 * PAIR_STACK_SIZE];
+      int_type top  = 0;
+      auto     push = [&](int_type ii, int_type jj) -> bool {
+        if (!overlap(m_nodes[size_t(ii)].bbox, tree.m_nodes[size_t(jj)].bbox))
+          return false;
+        if (top == 2 * PAIR_STACK_SIZE)
+          return traverse_pairs(ii, tree, jj, ifun);
+        stack[top++] = ii;
+        stack[top++] = jj;
+        return false;
+      };
+      stack[top++] = i;
+      stack[top++] = j;
+      while (top > 0) {
+        j              = stack[--top];
+        i              = stack[--top];
+        Node const & A = m_nodes[size_t(i)];
+        Node const & B = tree.m_nodes[size_t(j)];
+        if (A.is_leaf()) {
+          if (B.is_leaf()) {
+            if (ifun(A.first, A.num, B.first, B.num))
+              return true;
+          } else if (push(i, B.first + 1) || push(i, B.first)) {
+            return true;
+          }
+        } else if (B.is_leaf()) {
+          if (push(A.first + 1, j) || push(A.first, j))
+            return true;
+        } else {
+          // pushed in reverse order, so that the pairs are visited as (A0,B0), (A0,B1), ...
+          for (int_type c1 = A.first + 1; c1 >= A.first; --c1)
+            for (int_type c2 = B.first + 1; c2 >= B.first; --c2)
+              if (push(c1, c2))
+                return true;
+        }
+      }
+      return false;
+    }
 
-    AABBtree(AABBtree const & tree);
+    //
+    // Same as `traverse_pairs` on the wide nodes: `i` and `j` are wide
+    // references (see `wide_ref`), every child of one node is tested at once
+    // against the children of the other one.
+    //
+    template <typename LEAF_fun>
+    bool traverse_pairs_wide(int_type i, AABBtreeT const & tree, int_type j, LEAF_fun & ifun) const {
+      int_type stack[2 * PAIR_STACK_SIZE];
+      int_type top = 0;
+      // the pairs of leaves are visited at once, the other pairs are pushed
+      auto pair_ref = [&](int_type ii, int_type jj) -> bool {
+        if (ii < 0 && jj < 0) {
+          int_type         la = -1 - ii;
+          int_type         lb = -1 - jj;
+          WideNode const & A  = m_wide_nodes[size_t(la / 4)];
+          WideNode const & B  = tree.m_wide_nodes[size_t(lb / 4)];
+          return ifun(A.child[la % 4], A.num[la % 4], B.child[lb % 4], B.num[lb % 4]);
+        }
+        if (top == 2 * PAIR_STACK_SIZE)
+          return traverse_pairs_wide(ii, tree, jj, ifun);
+        stack[top++] = ii;
+        stack[top++] = jj;
+        return false;
+      };
+      // bounds of the child referred by `ref` (a leaf)
+      auto leaf_bbox = [](vector<WideNode> const & nodes, int_type ref, T * bb) {
+        WideNode const & W = nodes[size_t((-1 - ref) / 4)];
+        int_type         c = (-1 - ref) % 4;
+        bb[0]              = W.xmin[c];
+        bb[1]              = W.ymin[c];
+        bb[2]              = W.xmax[c];
+        bb[3]              = W.ymax[c];
+      };
+      stack[top++] = i;
+      stack[top++] = j;
+      while (top > 0) {
+        j = stack[--top];
+        i = stack[--top];
+        T bb[4];
+        if (i >= 0 && j >= 0) {
+          WideNode const & A = m_wide_nodes[size_t(i)];
+          WideNode const & B = tree.m_wide_nodes[size_t(j)];
+          int_type         masks[4];
+          overlap4x4(A, B, masks);
+          for (int_type a = 0; a < A.size; ++a)
+            for (int_type mask = masks[a], b = 0; mask != 0; mask >>= 1, ++b)
+              if ((mask & 1) != 0 && pair_ref(wide_ref(A, i, a), wide_ref(B, j, b)))
+                return true;
+        } else if (i < 0) {
+          WideNode const & B = tree.m_wide_nodes[size_t(j)];
+          leaf_bbox(m_wide_nodes, i, bb);
+          for (int_type mask = overlap4(bb, B), b = 0; mask != 0; mask >>= 1, ++b)
+            if ((mask & 1) != 0 && pair_ref(i, wide_ref(B, j, b)))
+              return true;
+        } else {
+          WideNode const & A = m_wide_nodes[size_t(i)];
+          leaf_bbox(tree.m_wide_nodes, j, bb);
+          for (int_type mask = overlap4(bb, A), a = 0; mask != 0; mask >>= 1, ++a)
+            if ((mask & 1) != 0 && pair_ref(wide_ref(A, i, a), j))
+              return true;
+        }
+      }
+      return false;
+    }
+
+    // dual traversal on the wide nodes when both trees have them
+    template <typename LEAF_fun>
+    bool traverse_root_pairs(AABBtreeT const & tree, LEAF_fun & ifun) const {
+      if (!overlap(m_nodes.front().bbox, tree.m_nodes.front().bbox))
+        return false;
+      if (!m_wide_nodes.empty() && !tree.m_wide_nodes.empty())
+        return this->traverse_pairs_wide(0, tree, 0, ifun);
+      return this->traverse_pairs(0, tree, 0, ifun);
+    }
+
+    // leaf function of the dual traversal calling `ifun(k,l)` on the overlapping boxes of two leaves
+    template <typename PAIR_fun>
+    auto box_pairs(AABBtreeT const & tree, PAIR_fun & ifun) const {
+      return [this, &tree, &ifun](int_type k0, int_type nk, int_type l0, int_type nl) -> bool {
+        for (int_type k = k0; k < k0 + nk; ++k)
+          for (int_type l = l0; l < l0 + nl; ++l)
+            if (overlap(&m_prim_bbox[4 * size_t(k)], &tree.m_prim_bbox[4 * size_t(l)]) && ifun(k, l))
+              return true;
+        return false;
+      };
+    }
+
+    void query_box_node(int_type inode, T const * bb, VecPtrBBox & out) const;
+    void query_box_wide(int_type iwide, T const * bb, VecPtrBBox & out) const;
+
+    template <typename RAY_fun>
+    void raycast_node(int_type inode, Ray const & R, T & best, RAY_fun & ifun) const {
+      Node const & N  = m_nodes[size_t(inode)];
+      T            t0 = 0, t1 = 0;
+      if (N.is_leaf()) {
+        for (int_type k = N.first; k < N.first + N.num; ++k) {
+          if (ray_enter(&m_prim_bbox[4 * size_t(k)], R, best, t0)) {
+            T t = ifun(m_bboxes[size_t(k)], best);
+            if (t < best)
+              best = t;
+          }
+        }
+        return;
+      }
+      // the child entered first is visited first, so that `best` shrinks early
+      int_type c0  = N.first;
+      int_type c1  = N.first + 1;
+      bool     ok0 = ray_enter(m_nodes[size_t(c0)].bbox, R, best, t0);
+      bool     ok1 = ray_enter(m_nodes[size_t(c1)].bbox, R, best, t1);
+      if (ok0 && ok1 && t1 < t0) {
+        std::swap(c0, c1);
+        std::swap(t0, t1);
+      }
+      if (ok0)
+        raycast_node(c0, R, best, ifun);
+      if (ok1 && t1 <= best)
+        raycast_node(c1, R, best, ifun);
+    }
+
+    template <typename RAY_fun>
+    void raycast_wide(int_type iwide, Ray const & R, T & best, RAY_fun & ifun) const {
+      WideNode const & W = m_wide_nodes[size_t(iwide)];
+      T                t[4];
+      int_type         order[4];
+      int_type         n = 0;
+      for (int_type c = 0; c < W.size; ++c) {
+        T bb[4] = {W.xmin[c], W.ymin[c], W.xmax[c], W.ymax[c]};
+        if (!ray_enter(bb, R, best, t[c]))
+          t[c] = std::numeric_limits<T>::infinity();
+        else
+          ++n;
+      }
+      // the children entered first are visited first, so that `best` shrinks early
+      sort4(t, W.size, order);
+      for (int_type k = 0; k < n && t[order[k]] <= best; ++k) {
+        int_type c = order[k];
+        if (W.num[c] == 0) {
+          raycast_wide(W.child[c], R, best, ifun);
+          continue;
+        }
+        for (int_type l = W.child[c]; l < W.child[c] + W.num[c]; ++l) {
+          T t0;
+          if (ray_enter(&m_prim_bbox[4 * size_t(l)], R, best, t0)) {
+            T tt = ifun(m_bboxes[size_t(l)], best);
+            if (tt < best)
+              best = tt;
+          }
+        }
+      }
+    }
+
+    template <typename VISIT_fun>
+    void visit_near_node(int_type inode, T x, T y, T & r, VISIT_fun & ifun) const {
+      Node const & N = m_nodes[size_t(inode)];
+      if (N.is_leaf()) {
+        for (int_type k = N.first; k < N.first + N.num; ++k) {
+          T d = point_distance(&m_prim_bbox[4 * size_t(k)], x, y);
+          if (d <= r)
+            r = ifun(m_bboxes[size_t(k)], d);
+        }
+        return;
+      }
+      // nearer child first, so that `r` shrinks early
+      int_type c0 = N.first;
+      int_type c1 = N.first + 1;
+      T        d0 = point_distance(m_nodes[size_t(c0)].bbox, x, y);
+      T        d1 = point_distance(m_nodes[size_t(c1)].bbox, x, y);
+      if (d1 < d0) {
+        std::swap(c0, c1);
+        std::swap(d0, d1);
+      }
+      if (d0 <= r)
+        visit_near_node(c0, x, y, r, ifun);
+      if (d1 <= r)
+        visit_near_node(c1, x, y, r, ifun);
+    }
+
+    template <typename VISIT_fun>
+    void visit_near_wide(int_type iwide, T x, T y, T & r, VISIT_fun & ifun) const {
+      WideNode const & W = m_wide_nodes[size_t(iwide)];
+      T                d[4];
+      int_type         order[4];
+      distance4(W, x, y, d);
+      // nearer children first, so that `r` shrinks early
+      sort4(d, W.size, order);
+      for (int_type k = 0; k < W.size && d[order[k]] <= r; ++k) {
+        int_type c = order[k];
+        if (W.num[c] == 0) {
+          visit_near_wide(W.child[c], x, y, r, ifun);
+          continue;
+        }
+        for (int_type l = W.child[c]; l < W.child[c] + W.num[c]; ++l) {
+          T dl = point_distance(&m_prim_bbox[4 * size_t(l)], x, y);
+          if (dl <= r)
+            r = ifun(m_bboxes[size_t(l)], dl);
+        }
+      }
+    }
 
     //!
     //! Compute the minimum of the maximum distance
-    //! between a point and the bbox contained in the `AABBtree`
+    //! between a point and the bbox contained in the subtree `inode`
     //!
     //! \param[in] x      x-coordinate of the point
     //! \param[in] y      y-coordinate of the point
-    //! \param[in] tree   `AABBtree` with the bboxes
+    //! \param[in] inode  root of the subtree with the bboxes
     //! \param[in] mmDist initial value of the minimum of the maximum distance
     //!                   used in the recursive call.
     //!
     //!
-    static real_type min_maxdist(real_type x, real_type y, AABBtree const & tree, real_type mmDist);
+    T min_maxdist(T x, T y, int_type inode, T mmDist) const;
 
     //!
     //! Select the candidate bboxes which have distance less than mmDist
@@ -222,19 +717,18 @@ namespace G2lib {
     //! \param[in]  x      x-coordinate of the point
     //! \param[in]  y      y-coordinate of the point
     //! \param[in]  mmDist minimum distance used  for the selection of bboxes
-    //! \param[in]  tree   `AABBtree` with the bbox's
+    //! \param[in]  inode  root of the subtree with the bbox's
     //! \param[out] candidateList  list of bbox which have minim distance less than `mmDist`
     //!
     //!
-    static void min_maxdist_select(
-        real_type x, real_type y, real_type mmDist, AABBtree const & tree, VecPtrBBox & candidateList);
+    void min_maxdist_select(T x, T y, T mmDist, int_type inode, VecPtrBBox & candidateList) const;
 
    public:
     //! Create an empty AABB tree.
-    AABBtree();
+    AABBtreeT();
 
     //! destroy the stored AABB tree.
-    ~AABBtree();
+    ~AABBtreeT();
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -244,6 +738,66 @@ namespace G2lib {
     //! Check if AABB tree is empty.
     bool empty() const;
 
+    //! Number of nodes of the tree.
+    size_t num_nodes() const { return m_nodes.size(); }
+
+    //! Number of bounding boxes stored in the tree.
+    size_t num_bboxes() const { return m_bboxes.size(); }
+
+    //! Bounding box `k` in leaf order (the boxes of a leaf are consecutive).
+    PtrBBox const & leaf_bbox(int_type k) const { return m_bboxes[size_t(k)]; }
+
+    //!
+    //! Select the algorithm used by `build` (the defaults are
+    //! `aabb_build_type` and `aabb_max_leaf_size`)
+    //!
+    //! \param[in] type          splitting algorithm
+    //! \param[in] max_leaf_size maximum number of boxes in a leaf
+    //!
+    void set_build(AABBbuildType type, int_type max_leaf_size = 1) {
+      m_build_type    = type;
+      m_max_leaf_size = max_leaf_size > 0 ? max_leaf_size : 1;
+    }
+
+    //!
+    //! Number of threads used by `build` (the default is `aabb_build_threads`),
+    //! 0 uses all the cores. The tree does not depend on the number of threads.
+    //!
+    void set_build_threads(int_type nthreads) { m_build_threads = nthreads > 0 ? nthreads : 0; }
+
+    //!
+    //! Use the 4-wide nodes in the queries (the default is `aabb_wide_nodes`).
+    //! The wide nodes of a built tree are made or dropped immediately and
+    //! kept by the following `build` and `refit`.
+    //!
+    void set_wide(bool wide) {
+      m_wide = wide;
+      build_wide();
+    }
+
+    //!
+    //! Check if the queries use the 4-wide nodes
+    //!
+    bool wide() const { return m_wide; }
+
+    //!
+    //! Quality metrics of a built tree
+    //!
+    struct Stats {
+      int_type  num_nodes;       //!< total number of nodes
+      int_type  num_leaves;      //!< number of leaves
+      int_type  max_depth;       //!< depth of the deepest leaf (the root has depth 0)
+      real_type avg_leaf_depth;  //!< average depth of the leaves
+      real_type avg_leaf_size;   //!< average number of boxes in a leaf
+      real_type sah_cost;        //!< expected cost of a query (perimeter heuristic, box tests)
+      real_type overlap;         //!< sum of the overlap areas of sibling nodes over the root area
+    };
+
+    //!
+    //! Compute the quality metrics of the tree
+    //!
+    void stats(Stats & S) const;
+
     //!
     //! Get the Bounding Box of the whole AABB tree
     //!
@@ -252,11 +806,12 @@ namespace G2lib {
     //! \param[in] xmax x-maximum box coordinate
     //! \param[in] ymax y-maximum box coordinate
     //!
-    void bbox(real_type & xmin, real_type & ymin, real_type & xmax, real_type & ymax) const {
-      xmin = pBBox->x_min();
-      ymin = pBBox->y_min();
-      xmax = pBBox->x_max();
-      ymax = pBBox->y_max();
+    void bbox(T & xmin, T & ymin, T & xmax, T & ymax) const {
+      T const * bb = m_nodes.front().bbox;
+      xmin         = bb[0];
+      ymin         = bb[1];
+      xmax         = bb[2];
+      ymax         = bb[3];
     }
 
     //!
@@ -264,6 +819,54 @@ namespace G2lib {
     //!
     void build(vector<PtrBBox> const & bboxes);
 
+    //!
+    //! Copy the topology of `tree` (possibly this tree) replacing every box
+    //! `bb` with `ifun(bb)`, then recompute the bounds of the nodes bottom
+    //! up in O(n). Meant for boxes moved by a rigid motion: no partition is
+    //! done, so the tree stays valid but may be less tight than a rebuilt one.
+    //!
+    //! \param[in] tree the tree to copy
+    //! \param[in] ifun function returning the moved box, `PtrBBox(PtrBBox const &)`
+    //!
+    template <typename REFIT_fun>
+    void refit(AABBtreeT const & tree, REFIT_fun ifun) {
+      if (this != &tree) {
+        m_nodes         = tree.m_nodes;
+        m_build_type    = tree.m_build_type;
+        m_max_leaf_size = tree.m_max_leaf_size;
+        m_build_threads = tree.m_build_threads;
+        m_wide          = tree.m_wide;
+        m_bboxes.resize(tree.m_bboxes.size());
+        m_prim_bbox.resize(tree.m_prim_bbox.size());
+      }
+      for (size_t k = 0; k < m_bboxes.size(); ++k) {
+        m_bboxes[k]         = ifun(tree.m_bboxes[k]);
+        BBoxT<T> const & bb = *m_bboxes[k];
+        m_prim_bbox[4 * k]     = bb.x_min();
+        m_prim_bbox[4 * k + 1] = bb.y_min();
+        m_prim_bbox[4 * k + 2] = bb.x_max();
+        m_prim_bbox[4 * k + 3] = bb.y_max();
+      }
+      this->refit_nodes();
+    }
+
+    //!
+    //! Append to `buffer` a binary image of the tree (nodes, bounds, id and
+    //! position of the boxes), to be read back by `unpack` with the same
+    //! build of the library.
+    //!
+    void pack(vector<char> & buffer) const;
+
+    //!
+    //! Read a tree written by `pack`. The sizes and the indices of the
+    //! nodes are checked: on failure the tree is left empty.
+    //!
+    //! \param[in,out] data start of the image, moved past it
+    //! \param[in]     end  end of the available data
+    //! \return true if a valid tree was read
+    //!
+    bool unpack(char const *& data, char const * end);
+
     //!
     //! Pretty print the AABB tree
     //!
@@ -278,54 +881,111 @@ namespace G2lib {
     //! \return true if the two tree collides
     //!
     template<typename COLLISION_fun>
-    bool collision(AABBtree const & tree, COLLISION_fun ifun, bool swap_tree = false) const {
-      // check bbox with
-      if (!tree.pBBox->collision(*pBBox))
+    bool collision(AABBtreeT const & tree, COLLISION_fun ifun, bool swap_tree = false) const {
+      if (this->empty() || tree.empty())
         return false;
-
-      int icase = (children.empty() ? 0 : 1) + (tree.children.empty() ? 0 : 2);
-
-      switch (icase) {
-        case 0:  // both leaf, use GeomPrimitive intersection algorithm
-          if (swap_tree)
-            return ifun(tree.pBBox, pBBox);
-          else
-            return ifun(pBBox, tree.pBBox);
-        case 1:  // first is a tree, second is a leaf
-        {
-          typename vector<PtrAABB>::const_iterator it;
-          for (it = children.begin(); it != children.end(); ++it)
-            if (tree.collision(**it, ifun, !swap_tree))
-              return true;
-        } break;
-        case 2:  // first leaf, second is a tree
-        {
-          typename vector<PtrAABB>::const_iterator it;
-          for (it = tree.children.begin(); it != tree.children.end(); ++it)
-            if (this->collision(**it, ifun, swap_tree))
-              return true;
-        } break;
-        case 3:  // first is a tree, second is a tree
-        {
-          typename vector<PtrAABB>::const_iterator c1;
-          typename vector<PtrAABB>::const_iterator c2;
-          for (c1 = children.begin(); c1 != children.end(); ++c1)
-            for (c2 = tree.children.begin(); c2 != tree.children.end(); ++c2)
-              if ((*c1)->collision(**c2, ifun, swap_tree))
-                return true;
-        } break;
-      }
-      return false;
+      auto fun = [&](int_type k, int_type l) -> bool {
+        PtrBBox const & bb1 = m_bboxes[size_t(k)];
+        PtrBBox const & bb2 = tree.m_bboxes[size_t(l)];
+        return swap_tree ? ifun(bb2, bb1) : ifun(bb1, bb2);
+      };
+      auto leaves = this->box_pairs(tree, fun);
+      return this->traverse_root_pairs(tree, leaves);
     }
 
     //!
     //! Compute all the intersection of AABB trees.
     //!
     //! \param[in]  tree             an AABB tree that is used to check collision
-    //! \param[out] intersectionList list of pair bbox that overlaps
+    //! \param[out] intersectionList list of pair bbox that overlaps (appended)
+    //! \param[in]  swap_tree        if true exchange the tree in computation
+    //!
+    void intersect(AABBtreeT const & tree, VecPairPtrBBox & intersectionList, bool swap_tree = false) const;
+
+    //!
+    //! Compute all the intersection of AABB trees on `nthreads` threads
+    //! (0 = all the cores). The top of the dual traversal is expanded into
+    //! many small tasks taken by the threads as they become idle; the
+    //! pairs are merged in task order, so the list is the same as the one
+    //! of `intersect`.
+    //!
+    //! \param[in]  tree             an AABB tree that is used to check collision
+    //! \param[in]  nthreads         number of threads
+    //! \param[out] intersectionList list of pair bbox that overlaps (appended)
     //! \param[in]  swap_tree        if true exchange the tree in computation
     //!
-    void intersect(AABBtree const & tree, VecPairPtrBBox & intersectionList, bool swap_tree = false) const;
+    void intersect_parallel(
+        AABBtreeT const & tree, int_type nthreads, VecPairPtrBBox & intersectionList, bool swap_tree = false) const;
+
+    //!
+    //! Visit all the pairs of overlapping bboxes of two AABB trees, without
+    //! collecting them.
+    //!
+    //! \param[in] tree      an AABB tree that is used to check collision
+    //! \param[in] ifun      function called as `ifun(bb1,bb2)` for every pair
+    //! \param[in] swap_tree if true exchange the tree in computation
+    //!
+    template <typename INTERSECT_fun>
+    void intersect_visit(AABBtreeT const & tree, INTERSECT_fun ifun, bool swap_tree = false) const {
+      if (this->empty() || tree.empty())
+        return;
+      auto fun = [&](int_type k, int_type l) -> bool {
+        PtrBBox const & bb1 = m_bboxes[size_t(k)];
+        PtrBBox const & bb2 = tree.m_bboxes[size_t(l)];
+        if (swap_tree)
+          ifun(bb2, bb1);
+        else
+          ifun(bb1, bb2);
+        return false;
+      };
+      auto leaves = this->box_pairs(tree, fun);
+      this->traverse_root_pairs(tree, leaves);
+    }
+
+    //!
+    //! Visit the pairs of overlapping leaves of two AABB trees: `ifun(k0,nk,l0,nl)`
+    //! is called with the boxes of a leaf of this tree, `leaf_bbox(k)` for
+    //! `k0 <= k < k0+nk`, and of a leaf of `tree`, `tree.leaf_bbox(l)` for
+    //! `l0 <= l < l0+nl`, which are not tested one against the other. The
+    //! visit stops when `ifun` returns true.
+    //!
+    //! \param[in] tree an AABB tree that is used to check collision
+    //! \param[in] ifun function called for every pair of leaves
+    //! \return true if the visit was stopped by `ifun`
+    //!
+    template <typename LEAF_fun>
+    bool intersect_leaves(AABBtreeT const & tree, LEAF_fun ifun) const {
+      if (this->empty() || tree.empty())
+        return false;
+      return this->traverse_root_pairs(tree, ifun);
+    }
+
+    //!
+    //! Split the dual traversal of two AABB trees into independent pairs of
+    //! overlapping subtrees (about `16*nthreads` of them, 0 = all the
+    //! cores), in the order of the serial traversal. The pairs of leaves of
+    //! each task are visited by `intersect_leaves(tree, task, ifun)`, so the
+    //! tasks can be taken by different threads.
+    //!
+    //! \param[in] tree     an AABB tree that is used to check collision
+    //! \param[in] nthreads number of threads
+    //! \return the pairs of nodes `(this,tree)` of the tasks
+    //!
+    vector<pair<int_type, int_type>> intersect_tasks(AABBtreeT const & tree, int_type nthreads) const;
+
+    //!
+    //! Same as `intersect_leaves` restricted to the pair of subtrees `task`
+    //! returned by `intersect_tasks`.
+    //!
+    //! \param[in] tree an AABB tree that is used to check collision
+    //! \param[in] task pair of overlapping subtrees
+    //! \param[in] ifun function called for every pair of leaves
+    //! \return true if the visit was stopped by `ifun`
+    //!
+    template <typename LEAF_fun>
+    bool intersect_leaves(AABBtreeT const & tree, pair<int_type, int_type> const & task, LEAF_fun ifun) const {
+      return this->traverse_pairs(task.first, tree, task.second, ifun);
+    }
 
     //!
     //! Select all the bboxes candidate to be at minimum distance.
@@ -334,7 +994,904 @@ namespace G2lib {
     //! \param[in]  y             y-coordinate of the point
     //! \param[out] candidateList candidate list
     //!
-    void min_distance(real_type x, real_type y, VecPtrBBox & candidateList) const;
+    void min_distance(T x, T y, VecPtrBBox & candidateList) const;
+
+    //!
+    //! Select the bboxes at distance not greater than `r` from a point.
+    //!
+    //! \param[in]  x   x-coordinate of the point
+    //! \param[in]  y   y-coordinate of the point
+    //! \param[in]  r   radius of the search
+    //! \param[out] out selected bboxes (cleared first, its capacity is reused)
+    //!
+    void query_radius(T x, T y, T r, VecPtrBBox & out) const;
+
+    //!
+    //! Select the bboxes overlapping the box `[xmin,xmax] x [ymin,ymax]`.
+    //!
+    //! \param[in]  xmin x-minimimum box coordinate
+    //! \param[in]  ymin y-minimimum box coordinate
+    //! \param[in]  xmax x-maximum box coordinate
+    //! \param[in]  ymax y-maximum box coordinate
+    //! \param[out] out  selected bboxes (cleared first, its capacity is reused)
+    //!
+    void query_box(T xmin, T ymin, T xmax, T ymax, VecPtrBBox & out) const;
+
+    //!
+    //! Select the bboxes overlapping the bbox `box`.
+    //!
+    void query_box(BBoxT<T> const & box, VecPtrBBox & out) const {
+      query_box(box.x_min(), box.y_min(), box.x_max(), box.y_max(), out);
+    }
+
+    //!
+    //! Select the `k` bboxes nearest to a point.
+    //!
+    //! \param[in]  x   x-coordinate of the point
+    //! \param[in]  y   y-coordinate of the point
+    //! \param[in]  k   number of bboxes
+    //! \param[out] out pairs (distance, bbox) sorted by increasing distance
+    //!                 (cleared first, its capacity is reused)
+    //!
+    void knn(T x, T y, int_type k, VecDistPtrBBox & out) const;
+
+    //!
+    //! Visit the bboxes at distance not greater than `r` from a point, the
+    //! nearer subtree first. `ifun(bbox, d)` is called with `d` the distance
+    //! of the bbox and returns the radius used for the rest of the search
+    //! (the same `r` for a range query, smaller to prune). Nothing is
+    //! allocated: it is the building block of the radius and k-nearest
+    //! queries of the curves.
+    //!
+    //! \param[in] x    x-coordinate of the point
+    //! \param[in] y    y-coordinate of the point
+    //! \param[in] r    radius of the search
+    //! \param[in] ifun function called for each bbox
+    //!
+    template <typename VISIT_fun>
+    void visit_near(T x, T y, T r, VISIT_fun ifun) const {
+      if (this->empty() || !(point_distance(m_nodes.front().bbox, x, y) <= r))
+        return;
+      if (m_wide_nodes.empty())
+        this->visit_near_node(0, x, y, r, ifun);
+      else
+        this->visit_near_wide(0, x, y, r, ifun);
+    }
+
+    //!
+    //! First hit of the ray `(x0,y0) + t (dx,dy)`, `0 <= t <= tmax`.
+    //!
+    //! The nodes crossed by the ray are visited in order of entry (slab
+    //! test), and every bbox crossed is passed to `ifun(bbox, best)`, which
+    //! returns the parameter `t` of the first hit of the ray with its
+    //! content (or any value not smaller than `best`, the first hit found so
+    //! far, when there is none). The subtrees entered after `best` are
+    //! skipped. Nothing is allocated.
+    //!
+    //! \param[in] x0   x-coordinate of the origin of the ray
+    //! \param[in] y0   y-coordinate of the origin of the ray
+    //! \param[in] dx   x-component of the direction of the ray
+    //! \param[in] dy   y-component of the direction of the ray
+    //! \param[in] tmax maximum value of the parameter of the ray
+    //! \param[in] ifun function computing the first hit with the content of a bbox
+    //! \return the parameter of the first hit (`tmax` if no hit is found before)
+    //!
+    template <typename RAY_fun>
+    T raycast(T x0, T y0, T dx, T dy, T tmax, RAY_fun ifun) const {
+      T   best = tmax;
+      Ray R    = {x0, y0, dx, dy, 1 / dx, 1 / dy};
+      T   t0;
+      if (this->empty() || !ray_enter(m_nodes.front().bbox, R, best, t0))
+        return best;
+      if (m_wide_nodes.empty())
+        this->raycast_node(0, R, best, ifun);
+      else
+        this->raycast_wide(0, R, best, ifun);
+      return best;
+    }
+
+    //!
+    //! Best-first search of the object at minimum distance from a point.
+    //!
+    //! The nodes and the bboxes are visited in order of increasing distance
+    //! from the point, kept in a priority queue, and every bbox reached is
+    //! passed to `ifun(bbox, best)`, which returns the exact distance of its
+    //! content (or any value not smaller than `best`, the minimum found so far,
+    //! when it can tell the content is not closer). The search stops as soon
+    //! as the distance of the next bbox is not smaller than `best`, so no
+    //! candidate list is built and only a few bboxes are refined.
+    //!
+    //! \param[in] x    x-coordinate of the point
+    //! \param[in] y    y-coordinate of the point
+    //! \param[in] ifun function computing the distance of the content of a bbox
+    //! \param[in] dmax only the objects closer than `dmax` are searched
+    //! \return the minimum distance (`dmax` if no object is closer)
+    //!
+    template <typename DISTANCE_fun>
+    T nearest(T x, T y, DISTANCE_fun ifun, T dmax = std::numeric_limits<T>::infinity()) const {
+      auto no_bound = [](int_type, int_type, T *) {};
+      auto fun      = [this, &ifun](int_type k, T, T best) -> T {
+        return ifun(m_bboxes[size_t(k)], best);
+      };
+      return this->nearest_bound(x, y, no_bound, fun, dmax);
+    }
+
+    //!
+    //! Same as `nearest` with the distances of the bboxes of a leaf raised
+    //! to better lower bounds of the distances of their contents: when a
+    //! leaf is reached `bound(k0, n, d)` receives the distances `d[i]` of the
+    //! bboxes `leaf_bbox(k0+i)`, `i < n`, and can only increase them. The
+    //! bboxes are then visited in order of bound and passed to
+    //! `ifun(k, d, best)`, with `k` the index of the bbox in leaf order and
+    //! `d` its bound.
+    //!
+    //! \param[in] x     x-coordinate of the point
+    //! \param[in] y     y-coordinate of the point
+    //! \param[in] bound function raising the distances of the bboxes of a leaf
+    //! \param[in] ifun  function computing the distance of the content of a bbox
+    //! \param[in] dmax  only the objects closer than `dmax` are searched
+    //! \return the minimum distance (`dmax` if no object is closer)
+    //!
+    template <typename BOUND_fun, typename DISTANCE_fun>
+    T nearest_bound(T x, T y, BOUND_fun bound, DISTANCE_fun ifun, T dmax = std::numeric_limits<T>::infinity()) const {
+      T best = dmax;
+      if (this->empty())
+        return best;
+      // (distance, index) with the nodes as index >= 0 and the bbox k as -1-k
+      typedef pair<T, int_type> Item;
+      auto                      farther = [](Item const & a, Item const & b) { return a.first > b.first; };
+      vector<Item>              heap;
+      vector<T>                 dleaf;
+      heap.reserve(64);
+      dleaf.reserve(size_t(m_max_leaf_size));
+      // bounds of the bboxes of a leaf at distance `dl`, the ones closer than `best` are queued
+      auto push_leaf = [&](int_type k0, int_type n, T dl) {
+        dleaf.resize(size_t(n));
+        for (int_type i = 0; i < n; ++i)
+          dleaf[size_t(i)] = n == 1 ? dl : point_distance(&m_prim_bbox[4 * size_t(k0 + i)], x, y);
+        bound(k0, n, dleaf.data());
+        for (int_type i = 0; i < n; ++i) {
+          if (dleaf[size_t(i)] < best) {
+            heap.push_back(Item(dleaf[size_t(i)], -1 - (k0 + i)));
+            std::push_heap(heap.begin(), heap.end(), farther);
+          }
+        }
+      };
+      heap.push_back(Item(point_distance(m_nodes.front().bbox, x, y), 0));
+      while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), farther);
+        Item top = heap.back();
+        heap.pop_back();
+        if (!(top.first < best))
+          break;
+        if (top.second < 0) {
+          T d = ifun(-1 - top.second, top.first, best);
+          if (d < best)
+            best = d;
+          continue;
+        }
+        if (!m_wide_nodes.empty()) {
+          WideNode const & W = m_wide_nodes[size_t(top.second)];
+          T                d[4];
+          distance4(W, x, y, d);
+          for (int_type c = 0; c < W.size; ++c) {
+            if (!(d[c] < best))
+              continue;
+            if (W.num[c] == 0) {
+              heap.push_back(Item(d[c], W.child[c]));
+              std::push_heap(heap.begin(), heap.end(), farther);
+            } else {
+              push_leaf(W.child[c], W.num[c], d[c]);
+            }
+          }
+          continue;
+        }
+        Node const & N = m_nodes[size_t(top.second)];
+        if (N.num == 1) {
+          // a single bbox has the distance of its leaf, the smallest in the
+          // queue unless `bound` raises it
+          T d = top.first;
+          bound(N.first, 1, &d);
+          if (d == top.first) {
+            d = ifun(N.first, d, best);
+            if (d < best)
+              best = d;
+          } else if (d < best) {
+            heap.push_back(Item(d, -1 - N.first));
+            std::push_heap(heap.begin(), heap.end(), farther);
+          }
+          continue;
+        }
+        if (N.is_leaf()) {
+          push_leaf(N.first, N.num, top.first);
+          continue;
+        }
+        for (int_type k = N.first; k < N.first + 2; ++k) {
+          T d = point_distance(m_nodes[size_t(k)].bbox, x, y);
+          if (d < best) {
+            heap.push_back(Item(d, k));
+            std::push_heap(heap.begin(), heap.end(), farther);
+          }
+        }
+      }
+      return best;
+    }
+  };
+
+  extern template class BBoxT<float>;
+  extern template class BBoxT<double>;
+  extern template class AABBtreeT<float>;
+  extern template class AABBtreeT<double>;
+
+  typedef BBoxT<real_type>     BBox;
+  typedef AABBtreeT<real_type> AABBtree;
+
+  /*\
+   |   ____                              _
+   |  |  _ \ _   _ _ __   __ _ _ __ ___ (_) ___
+   |  | | | | | | | '_ \ / _` | '_ ` _ \| |/ __|
+   |  | |_| | |_| | | | | (_| | | | | | | | (__
+   |  |____/ \__, |_| |_|\__,_|_| |_| |_|_|\___|
+   |         |___/
+  \*/
+  //!
+  //! AABB tree of moving boxes updated incrementally, to be used as broad
+  //! phase of objects that appear, move and disappear (e.g. obstacles).
+  //!
+  //! Every box is stored in a leaf whose bounds are enlarged by a margin,
+  //! so that small motions do not change the tree. A new leaf is placed
+  //! next to the node giving the smallest increase of perimeter, and the
+  //! tree is kept balanced by rotations on the height of the nodes, so
+  //! `insert`, `remove` and `update` are O(log n). A box is identified by
+  //! the handle returned by `insert`.
+  //!
+  //! The bounds have the scalar type of the static tree they are tested
+  //! against, `DynamicAABBtree` is the `real_type` one.
+  //!
+  template <typename T>
+  class DynamicAABBtreeT {
+   public:
+    using PtrBBox        = typename AABBtreeT<T>::PtrBBox;
+    using VecPairPtrBBox = typename AABBtreeT<T>::VecPairPtrBBox;
+
+   private:
+    //
+    // Node of the tree, a leaf has `child[0] == -1`. The free nodes are
+    // chained through `parent` and have `height == -1`.
+    //
+    struct Node {
+      T        bbox[4];   // [xmin, ymin, xmax, ymax], enlarged by the margin in a leaf
+      PtrBBox  box;       // box stored in a leaf
+      int_type parent;    // parent node, next free node if free
+      int_type child[2];  // children of an internal node
+      int_type height;    // 0 for a leaf
+
+      bool is_leaf() const { return child[0] < 0; }
+    };
+
+    vector<Node> m_nodes;
+    int_type     m_root;
+    int_type     m_free;
+    int_type     m_size;
+    T            m_margin;
+
+    int_type allocate_node();
+    void     free_node(int_type i);
+    void     insert_leaf(int_type leaf);
+    void     remove_leaf(int_type leaf);
+    int_type balance(int_type i);
+    void     fix_upwards(int_type i);
+    void     set_leaf(int_type leaf, PtrBBox const & box);
+    bool     is_box(int_type id) const;
+
+    bool overlap_root(AABBtreeT<T> const & tree) const {
+      return !this->empty() && !tree.empty() &&
+             AABBtreeT<T>::overlap(m_nodes[size_t(m_root)].bbox, tree.m_nodes.front().bbox);
+    }
+
+    //
+    // Dual traversal with a static tree, see `AABBtree::traverse_pairs`:
+    // calls `ifun(i,k)` for the leaf `i` of this tree and the box `k` of
+    // `tree` when their (not enlarged) bounds overlap.
+    //
+    template <typename PAIR_fun>
+    bool traverse_pairs(int_type i, AABBtreeT<T> const & tree, int_type j, PAIR_fun & ifun) const {
+      int_type stack[2 * AABBtreeT<T>::PAIR_STACK_SIZE];
+      int_type top  = 0;
+      auto     push = [&](int_type ii, int_type jj) -> bool {
+        if (!AABBtreeT<T>::overlap(m_nodes[size_t(ii)].bbox, tree.m_nodes[size_t(jj)].bbox))
+          return false;
+        if (top == 2 * AABBtreeT<T>::PAIR_STACK_SIZE)
+          return traverse_pairs(ii, tree, jj, ifun);
+        stack[top++] = ii;
+        stack[top++] = jj;
+        return false;
+      };
+      stack[top++] = i;
+      stack[top++] = j;
+      while (top > 0) {
+        j                                     = stack[--top];
+        i                                     = stack[--top];
+        Node const &                        A = m_nodes[size_t(i)];
+        typename AABBtreeT<T>::Node const & B = tree.m_nodes[size_t(j)];
+        if (A.is_leaf()) {
+          if (B.is_leaf()) {
+            BBoxT<T> const & bb    = *A.box;
+            T                ab[4] = {bb.x_min(), bb.y_min(), bb.x_max(), bb.y_max()};
+            for (int_type k = B.first; k < B.first + B.num; ++k)
+              if (AABBtreeT<T>::overlap(ab, &tree.m_prim_bbox[4 * size_t(k)]) && ifun(i, k))
+                return true;
+          } else if (push(i, B.first + 1) || push(i, B.first)) {
+            return true;
+          }
+        } else if (B.is_leaf()) {
+          if (push(A.child[1], j) || push(A.child[0], j))
+            return true;
+        } else {
+          for (int_type c1 = 1; c1 >= 0; --c1)
+            for (int_type c2 = B.first + 1; c2 >= B.first; --c2)
+              if (push(A.child[c1], c2))
+                return true;
+        }
+      }
+      return false;
+    }
+
+   public:
+    //!
+    //! Create an empty tree.
+    //!
+    //! \param[in] margin enlargement of the bounds of the boxes in the leaves
+    //!
+    explicit DynamicAABBtreeT(T margin = 0);
+
+    //!
+    //! Remove all the boxes
+    //!
+    void clear();
+
+    //!
+    //! Check if the tree is empty
+    //!
+    bool empty() const { return m_root < 0; }
+
+    int_type size() const { return m_size; }      //!< number of boxes
+    T        margin() const { return m_margin; }  //!< enlargement of the leaves
+
+    //!
+    //! Height of the tree (0 for a single leaf)
+    //!
+    int_type height() const { return m_root < 0 ? 0 : m_nodes[size_t(m_root)].height; }
+
+    //!
+    //! Set the enlargement of the leaves, used by the next insertions and updates
+    //!
+    void set_margin(T margin) { m_margin = margin > 0 ? margin : 0; }
+
+    //!
+    //! Insert a box.
+    //!
+    //! \param[in] box the box
+    //! \return the handle of the box
+    //!
+    int_type insert(PtrBBox const & box);
+
+    //!
+    //! Remove the box with handle `id` (the handle may be reused).
+    //!
+    void remove(int_type id);
+
+    //!
+    //! Replace the box with handle `id` with `box` (the moved box). The
+    //! tree changes only when `box` leaves the enlarged bounds of the leaf.
+    //!
+    //! \return true if the leaf was moved in the tree
+    //!
+    bool update(int_type id, PtrBBox const & box);
+
+    //!
+    //! The box with handle `id`
+    //!
+    PtrBBox const & get(int_type id) const;
+
+    //!
+    //! Bounding box of the tree (with the enlarged leaves)
+    //!
+    void bbox(T & xmin, T & ymin, T & xmax, T & ymax) const;
+
+    //!
+    //! Check if the boxes of this tree collide with the ones of a static AABB tree
+    //!
+    //! \param[in] tree      an AABB tree that is used to check collision
+    //! \param[in] ifun      function the check if the contents of two bbox (curve) collide
+    //! \param[in] swap_tree if true exchange the tree in computation
+    //! \return true if the two tree collides
+    //!
+    template <typename COLLISION_fun>
+    bool collision(AABBtreeT<T> const & tree, COLLISION_fun ifun, bool swap_tree = false) const {
+      if (!this->overlap_root(tree))
+        return false;
+      auto fun = [&](int_type i, int_type k) -> bool {
+        PtrBBox const & bb1 = m_nodes[size_t(i)].box;
+        PtrBBox const & bb2 = tree.m_bboxes[size_t(k)];
+        return swap_tree ? ifun(bb2, bb1) : ifun(bb1, bb2);
+      };
+      return this->traverse_pairs(m_root, tree, 0, fun);
+    }
+
+    //!
+    //! Visit all the pairs of overlapping bboxes of this tree and of a static
+    //! AABB tree, see `AABBtree::intersect_visit`.
+    //!
+    template <typename INTERSECT_fun>
+    void intersect_visit(AABBtreeT<T> const & tree, INTERSECT_fun ifun, bool swap_tree = false) const {
+      if (!this->overlap_root(tree))
+        return;
+      auto fun = [&](int_type i, int_type k) -> bool {
+        PtrBBox const & bb1 = m_nodes[size_t(i)].box;
+        PtrBBox const & bb2 = tree.m_bboxes[size_t(k)];
+        if (swap_tree)
+          ifun(bb2, bb1);
+        else
+          ifun(bb1, bb2);
+        return false;
+      };
+      this->traverse_pairs(m_root, tree, 0, fun);
+    }
+
+    //!
+    //! Compute all the intersection of this tree with a static AABB tree.
+    //!
+    //! \param[in]  tree             an AABB tree that is used to check collision
+    //! \param[out] intersectionList list of pair bbox that overlaps (appended)
+    //! \param[in]  swap_tree        if true exchange the tree in computation
+    //!
+    void intersect(AABBtreeT<T> const & tree, VecPairPtrBBox & intersectionList, bool swap_tree = false) const;
+  };
+
+  extern template class DynamicAABBtreeT<float>;
+  extern template class DynamicAABBtreeT<double>;
+
+  typedef DynamicAABBtreeT<real_type> DynamicAABBtree;
+
+  /*\
+   |   _____     _                   _       ____
+   |  |_   _| __(_) __ _ _ __   __ _| | ___ / ___|_____   _____ _ __
+   |    | || '__| |/ _` | '_ \ / _` | |/ _ \ |   / _ \ \ / / _ \ '__|
+   |    | || |  | | (_| | | | | (_| | |  __/ |__| (_) \ V /  __/ |
+   |    |_||_|  |_|\__,_|_| |_|\__, |_|\___|\____\___/ \_/ \___|_|
+   |                           |___/
+  \*/
+  //!
+  //! Triangles covering a curve at a given offset together with the
+  //! AABB tree of their bounding boxes (the `Ipos` of a box is the index
+  //! of its triangle in `tri`). The triangles are also stored in `soa` in
+  //! the leaf order of the tree, so that the triangles of a leaf are tested
+  //! at once by the batch kernels, clipped at `height` when `clipped`.
+  //!
+  //! Curves build it lazily and share it as an immutable snapshot:
+  //! once published it is never modified, so any number of threads can
+  //! query it, and a curve modification only replaces the pointer.
+  //!
+  //! The cover is templated on the scalar type of the triangles and of the
+  //! tree: `TriangleCover`, the `real_type` one, is the cover of the curves
+  //! and of `TriangleCoverCache`, the `float` one is built by the `float`
+  //! cores `ClothoidCurveT` and `ClothoidListT`.
+  //!
+  template <typename T>
+  class TriangleCoverT {
+   public:
+    using PtrCover = shared_ptr<TriangleCoverT const>;
+
+    T                      offs;       //!< offset of the covered curve
+    T                      max_angle;  //!< maximum angle variation used to split the curve
+    T                      max_size;   //!< maximum triangle size used to split the curve
+    vector<Triangle2DT<T>> tri;        //!< triangles covering the curve
+    AABBtreeT<T>           tree;       //!< AABB tree of the triangles bounding boxes
+    Triangle2DSoAT<T>      soa;        //!< triangles in the leaf order of `tree`
+    vector<T>              height;     //!< height of the pieces over the side P1-P3 of their triangle
+    bool                   clipped;    //!< the triangles in `soa` are clipped at `height`
+
+    mutable std::atomic<std::uint64_t> last_use{0};   //!< LRU stamp used by `TriangleCoverCache`
+    mutable std::atomic<bool>          used{false};  //!< used since the last miss of its `TriangleCoverCache`
+
+    TriangleCoverT(T _offs, T _max_angle, T _max_size)
+        : offs(_offs), max_angle(_max_angle), max_size(_max_size), clipped(false) {}
+
+    //!
+    //! Build the AABB tree on the bounding boxes of the triangles (`height`,
+    //! one per triangle, is filled before when `clipped`)
+    //!
+    //! \param[in] id identifier stored in the bounding boxes
+    //!
+    void build_tree(int_type id);
+
+    //!
+    //! Check if the cover was built with the given parameters and with the
+    //! current node layout of the trees (`aabb_wide_nodes`)
+    //!
+    bool same(T _offs, T _max_angle, T _max_size) const;
+
+    //!
+    //! Copy of the cover of the curve translated by `(tx,ty)`: the
+    //! triangles are moved and the tree refitted, not rebuilt.
+    //!
+    PtrCover translated(T tx, T ty) const;
+
+    //!
+    //! Copy of the cover of the curve rotated by `angle` around `(cx,cy)`:
+    //! the triangles are moved and the tree refitted, not rebuilt.
+    //!
+    PtrCover rotated(T angle, T cx, T cy) const;
+
+    //!
+    //! Save `covers` in binary form (a header and one block of data with
+    //! its checksum), tagged with `key`, e.g. a hash of the geometry of the
+    //! covered curve. The file is meant to be read by the same build of
+    //! the library.
+    //!
+    static void save(ostream_type & stream, vector<PtrCover> const & covers, std::uint64_t key);
+
+    //!
+    //! Read the covers saved by `save` from the memory block `[data,data+size)`
+    //! (e.g. a mapped file). The header, the checksum and the indices of the
+    //! trees are checked and nothing is returned when the block is not valid
+    //! or it was saved with another `key`.
+    //!
+    //! \return true if the covers were read
+    //!
+    static bool load(void const * data, size_t size, std::uint64_t key, vector<PtrCover> & covers);
+
+    //!
+    //! Same as the `load` above reading the header and then the whole data
+    //! block from `stream`.
+    //!
+    static bool load(istream_type & stream, std::uint64_t key, vector<PtrCover> & covers);
+
+    //! Triangle `k` of `soa` (in leaf order).
+    Triangle2DT<T> const & leaf_triangle(int_type k) const { return tri[size_t(tree.leaf_bbox(k)->Ipos())]; }
+
+    //!
+    //! Visit the pairs of overlapping triangles of two covers: the pairs of
+    //! overlapping leaves of the trees are found first, then every triangle
+    //! of one leaf is tested against all the triangles of the other one.
+    //!
+    //! \param[in]  TC       the other cover
+    //! \param[in]  ifun     function called as `ifun(T1,T2)` for every pair
+    //! \param[out] counters if not null, the pairs tested and refined are added to it
+    //!
+    template <typename INTERSECT_fun>
+    void intersect_visit(
+        TriangleCoverT const & TC, INTERSECT_fun ifun, AABBintersectCounters * counters = nullptr) const {
+      vector<int_type>      hit;
+      AABBintersectCounters C;
+      tree.intersect_leaves(TC.tree, [&](int_type k0, int_type nk, int_type l0, int_type nl) -> bool {
+        this->leaf_pairs(TC, k0, nk, l0, nl, hit, C, ifun);
+        return false;
+      });
+      if (counters != nullptr) {
+        counters->tested += C.tested;
+        counters->refined += C.refined;
+      }
+    }
+
+    //!
+    //! The pairs of overlapping triangles of two covers found on `nthreads`
+    //! threads (0 = all the cores): the dual traversal of the trees is split
+    //! into tasks (see `AABBtree::intersect_tasks`) and the pairs are merged
+    //! in task order, so the list does not depend on the number of threads.
+    //!
+    //! \param[in]  TC       the other cover
+    //! \param[in]  nthreads number of threads
+    //! \param[out] pairs    the pairs of triangles `(this,TC)` (appended)
+    //! \param[out] counters if not null, the pairs tested and refined are added to it
+    //!
+    void intersect_pairs(
+        TriangleCoverT const &                                         TC,
+        int_type                                                       nthreads,
+        vector<pair<Triangle2DT<T> const *, Triangle2DT<T> const *>> & pairs,
+        AABBintersectCounters *                                        counters = nullptr) const;
+
+    //!
+    //! Best-first search of the piece of curve at minimum distance from a
+    //! point, see `AABBtree::nearest`: the bboxes of a leaf are bounded by
+    //! the distances of their triangles and `ifun(T, d, best)` is called
+    //! with the triangle and its distance `d` from the point.
+    //!
+    //! \param[in] x    x-coordinate of the point
+    //! \param[in] y    y-coordinate of the point
+    //! \param[in] ifun function computing the distance of the piece of curve covered by a triangle
+    //! \param[in] dmax only the pieces closer than `dmax` are searched
+    //! \return the minimum distance (`dmax` if no piece is closer)
+    //!
+    template <typename DISTANCE_fun>
+    T nearest(T x, T y, DISTANCE_fun ifun, T dmax = std::numeric_limits<T>::infinity()) const {
+      // the distances of the triangles are computed by chunks of 16
+      T    dtri[16];
+      auto bound = [&](int_type k0, int_type n, T * d) {
+        for (int_type i0 = 0; i0 < n; i0 += 16) {
+          int_type m = std::min(n - i0, int_type(16));
+          soa.distMin(x, y, size_t(k0 + i0), size_t(m), dtri);
+          for (int_type i = 0; i < m; ++i)
+            d[i0 + i] = std::max(d[i0 + i], dtri[i]);
+        }
+      };
+      auto fun = [&](int_type k, T d, T best) -> T {
+        return ifun(leaf_triangle(k), d, best);
+      };
+      return tree.nearest_bound(x, y, bound, fun, dmax);
+    }
+
+   private:
+    void refit_tree(TriangleCoverT const & TC);
+    void build_soa();
+
+    // calls `ifun(T1,T2)` on the overlapping triangles of a pair of leaves, see `intersect_visit`
+    template <typename INTERSECT_fun>
+    void leaf_pairs(
+        TriangleCoverT const &  TC,
+        int_type                k0,
+        int_type                nk,
+        int_type                l0,
+        int_type                nl,
+        vector<int_type> &      hit,
+        AABBintersectCounters & counters,
+        INTERSECT_fun &         ifun) const {
+      hit.resize(size_t(nl));
+      counters.tested += std::uint64_t(nk) * std::uint64_t(nl);
+      for (int_type k = k0; k < k0 + nk; ++k) {
+        if (TC.soa.overlap(soa, size_t(k), size_t(l0), size_t(nl), hit.data()) == 0)
+          continue;
+        for (int_type l = 0; l < nl; ++l) {
+          if (hit[size_t(l)] != 0) {
+            ++counters.refined;
+            ifun(leaf_triangle(k), TC.leaf_triangle(l0 + l));
+          }
+        }
+      }
+    }
+  };
+
+  extern template class TriangleCoverT<float>;
+  extern template class TriangleCoverT<double>;
+
+  typedef TriangleCoverT<real_type> TriangleCover;
+
+  using PtrTriangleCover = shared_ptr<TriangleCover const>;
+
+  //!
+  //! Slot holding an immutable object built on demand and read by
+  //! concurrent threads.
+  //!
+  //! The current snapshot is published through an atomic pointer to its
+  //! `shared_ptr`: a reader takes no lock, it copies the `shared_ptr` and
+  //! keeps the snapshot alive as long as it holds the copy. A snapshot
+  //! replaced by a newer one (or dropped by `clear`) is freed when its
+  //! last reader drops it. The replaced holders of the `shared_ptr` are
+  //! freed at the next `publish` or `clear` that finds no reader copying
+  //! one, so at most a few of them are alive. `publish` and `clear` must
+  //! be serialized by the owner.
+  //!
+  template <typename T>
+  class SnapshotSlot {
+   public:
+    using PtrSnapshot = shared_ptr<T const>;
+
+   private:
+    std::atomic<PtrSnapshot const *>           m_current{nullptr};
+    std::unique_ptr<PtrSnapshot const>         m_holder;      // owner of `*m_current`
+    vector<std::unique_ptr<PtrSnapshot const>> m_retired;     // replaced holders, a reader may be copying one
+    mutable std::atomic<int>                   m_readers{0};  // readers copying a holder
+
+    // a reader entering after the store of `m_current` sees the new holder
+    void retire(std::unique_ptr<PtrSnapshot const> holder) {
+      PtrSnapshot const * p = holder.get();
+      if (m_holder)
+        m_retired.push_back(std::move(m_holder));
+      m_holder = std::move(holder);
+      m_current.store(p, std::memory_order_seq_cst);
+      // the readers copy a pointer, they leave soon: wait for them when too many holders are retired
+      while (m_retired.size() > 8 && m_readers.load(std::memory_order_seq_cst) != 0)
+        std::this_thread::yield();
+      if (m_readers.load(std::memory_order_seq_cst) == 0)
+        m_retired.clear();
+    }
+
+   public:
+    SnapshotSlot() = default;
+
+    //! The snapshots are not copied, the copy starts empty.
+    SnapshotSlot(SnapshotSlot const &) {}
+
+    //! The snapshots are not copied, the slot is emptied.
+    SnapshotSlot & operator=(SnapshotSlot const & s) {
+      if (this != &s)
+        this->clear();
+      return *this;
+    }
+
+    //! The current snapshot (`nullptr` if none).
+    PtrSnapshot load() const {
+      m_readers.fetch_add(1, std::memory_order_seq_cst);
+      PtrSnapshot const * p = m_current.load(std::memory_order_seq_cst);
+      PtrSnapshot         S = p != nullptr ? *p : PtrSnapshot();
+      m_readers.fetch_sub(1, std::memory_order_release);
+      return S;
+    }
+
+    //! Make `ptr` the current snapshot.
+    PtrSnapshot publish(PtrSnapshot ptr) {
+      this->retire(std::make_unique<PtrSnapshot const>(std::move(ptr)));
+      return *m_holder;
+    }
+
+    //! Drop the current snapshot.
+    void clear() { this->retire(nullptr); }
+  };
+
+  //!
+  //! Small keyed cache of immutable triangle covers, one per
+  //! `(offs, max_angle, max_size)`, with LRU eviction.
+  //!
+  //! Queries alternating between a few offsets (centerline, left and
+  //! right boundary) find all the covers here and never rebuild them.
+  //! The list of entries is a `SnapshotSlot` replaced on insertion, so a
+  //! lookup is a lock free scan of a few pointers, and only a miss takes
+  //! the mutex. A hit returns a reference counted pointer to its cover,
+  //! it marks the cover as used once between two misses and counts itself
+  //! on a per-thread line. The least recently used order is updated at the
+  //! misses, from the marks, so it is exact up to the order of the hits in
+  //! between.
+  //!
+  //! The cache holds at most `capacity` covers: an evicted or replaced
+  //! cover is freed when the last reader holding it drops it.
+  //!
+  class TriangleCoverCache {
+    using Entries = vector<PtrTriangleCover>;
+
+    // hit counters, one per cache line, shared by the threads modulo `HIT_COUNTERS`
+    struct alignas(64) HitCounter {
+      std::atomic<std::uint64_t> n{0};
+    };
+    static constexpr size_t HIT_COUNTERS = 16;
+
+    SnapshotSlot<Entries>             m_entries;
+    size_t                            m_capacity;
+    std::uint64_t                     m_clock{0};
+    std::atomic<std::uint64_t>        m_misses{0};
+    mutable std::atomic<HitCounter *> m_hits{nullptr};
+    std::mutex                        m_mutex;
+
+    void insert(PtrTriangleCover const & TC);
+
+    HitCounter * hit_counters() const;
+
+    // counter of the calling thread
+    static size_t hit_slot() {
+      static std::atomic<size_t> next{0};
+      static thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed) % HIT_COUNTERS;
+      return slot;
+    }
+
+    void count_hit() const {
+      HitCounter * H = m_hits.load(std::memory_order_acquire);
+      if (H == nullptr)
+        H = this->hit_counters();
+      H[hit_slot()].n.fetch_add(1, std::memory_order_relaxed);
+    }
+
+   public:
+    //!
+    //! Create an empty cache holding at most `capacity` covers
+    //!
+    explicit TriangleCoverCache(size_t capacity = 4) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    //! The covers are not copied, the copy starts empty with the same capacity.
+    TriangleCoverCache(TriangleCoverCache const & c) : m_capacity(c.m_capacity) {}
+
+    //! The covers are not copied, the cache is emptied and takes the capacity of `c`.
+    TriangleCoverCache & operator=(TriangleCoverCache const & c) {
+      if (this != &c) {
+        this->clear();
+        m_capacity = c.m_capacity;
+      }
+      return *this;
+    }
+
+    ~TriangleCoverCache() { delete[] m_hits.load(std::memory_order_relaxed); }
+
+    //! Drop all the covers (to be called when the curve changes).
+    void clear();
+
+    //! The covers stored, most recently used first.
+    vector<PtrTriangleCover> covers() const;
+
+    //!
+    //! Store a cover built elsewhere (e.g. loaded from a file), replacing
+    //! the one with the same parameters.
+    //!
+    void add(PtrTriangleCover const & TC);
+
+    //!
+    //! Replace every cover `TC` with `move(TC)`, to be called when the
+    //! curve moves rigidly (see `TriangleCover::translated`) so that the
+    //! covers are updated instead of dropped and rebuilt.
+    //!
+    //! \param[in] move functor `PtrTriangleCover(TriangleCover const &)`
+    //!
+    template <typename MOVE>
+    void refit(MOVE const & move) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      shared_ptr<Entries const>   E = m_entries.load();
+      if (E == nullptr || E->empty())
+        return;
+      auto N = make_shared<Entries>();
+      N->reserve(E->size());
+      for (PtrTriangleCover const & TC : *E) {
+        PtrTriangleCover TN = move(*TC);
+        TN->last_use.store(TC->last_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        TN->used.store(TC->used.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        N->push_back(TN);
+      }
+      m_entries.publish(N);
+    }
+
+    //! Set the maximum number of covers, the least recently used are dropped.
+    void set_capacity(size_t capacity);
+
+    size_t        capacity() const { return m_capacity; }  //!< maximum number of covers
+    size_t        size() const;                             //!< number of covers stored
+    std::uint64_t hits() const;                             //!< number of lookups served by the cache
+    std::uint64_t misses() const { return m_misses; }       //!< number of covers built on a miss
+
+    //! Reset hits and misses counters.
+    void reset_counters();
+
+    //!
+    //! Lock free search of a cover satisfying `match`
+    //!
+    //! \param[in] match predicate `bool(TriangleCover const &)`
+    //! \return the cover found or `nullptr`
+    //!
+    template <typename MATCH>
+    PtrTriangleCover find(MATCH const & match) const {
+      shared_ptr<Entries const> E = m_entries.load();
+      if (E == nullptr)
+        return nullptr;
+      for (PtrTriangleCover const & TC : *E) {
+        if (match(*TC)) {
+          if (!TC->used.load(std::memory_order_relaxed))
+            TC->used.store(true, std::memory_order_relaxed);
+          this->count_hit();
+          return TC;
+        }
+      }
+      return nullptr;
+    }
+
+    //!
+    //! Search a cover satisfying `match`, on a miss build it with `build`
+    //! and store it. Concurrent misses on the same cache are serialized,
+    //! so each cover is built only once.
+    //!
+    //! \param[in] match predicate `bool(TriangleCover const &)`
+    //! \param[in] build functor returning the new cover
+    //! \return the cover found or built
+    //!
+    template <typename MATCH, typename BUILD>
+    PtrTriangleCover get(MATCH const & match, BUILD const & build) {
+      PtrTriangleCover TC = this->find(match);
+      if (TC != nullptr)
+        return TC;
+      std::lock_guard<std::mutex> lock(m_mutex);
+      TC = this->find(match);
+      if (TC != nullptr)
+        return TC;
+      m_misses.fetch_add(1, std::memory_order_relaxed);
+      TC = build();
+      this->insert(TC);
+      return TC;
+    }
   };
 
 }  // namespace G2lib
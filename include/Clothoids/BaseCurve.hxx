@@ -49,6 +49,28 @@ namespace G2lib {
   using Ipair = std::pair<real_type, real_type>;
   using IntersectList = std::vector<Ipair>;
 
+  //!
+  //! Caller-owned hint for the segment lookup of piecewise curves
+  //! (`ClothoidList`, `BiarcList`, `PolyLine`). Keep one cursor per thread
+  //! and per walk: it stores the last segment found, so nearby abscissae are
+  //! found in constant time without any shared state.
+  //! A cursor can be reused on another curve, an out of range value is reset.
+  //!
+  struct SegmentCursor {
+    int_type interval{0};  //!< last segment found
+  };
+
+  //!
+  //! Exact distance of a point from a segment of a piecewise curve, as
+  //! returned by the radius and k-nearest queries of `ClothoidList`,
+  //! `BiarcList` and `PolyLine`.
+  //!
+  struct SegmentDistance {
+    int_type  segment;  //!< index of the segment
+    real_type s;        //!< curvilinear abscissa (on the whole curve) of the closest point
+    real_type dst;      //!< distance of the point from the segment
+  };
+
   /*\
    |   _       _                          _
    |  (_)_ __ | |_ ___ _ __ ___  ___  ___| |_
@@ -1009,6 +1031,71 @@ namespace G2lib {
       this->eval_ISO_DDD(s, -offs, x_DDD, y_DDD);
     }
 
+    /*\
+     |   _           _       _
+     |  | |__   __ _| |_ ___| |__
+     |  | '_ \ / _` | __/ __| '_ \
+     |  | |_) | (_| | || (__| | | |
+     |  |_.__/ \__,_|\__\___|_| |_|
+    \*/
+
+    //!
+    //! Evaluate the curve at the `n` curvilinear coordinates `s[0..n-1]`
+    //! with a single virtual dispatch. Output arrays must not overlap `s`.
+    //!
+    //! The batched versions of lines, circle arcs, polylines and of the
+    //! lists give the same values of `n` scalar calls. A clothoid curve
+    //! goes through the batched Fresnel kernels (see `GeneralizedFresnelCS`)
+    //! and agrees up to rounding: within `1e-12*(1+|s|)` on the positions
+    //! and `1e-12` on angle and curvature, see `tests/testBatch.cc`.
+    //!
+    //! \param[in]  n number of points
+    //! \param[in]  s curvilinear coordinates
+    //! \param[out] x x-coordinates
+    //! \param[out] y y-coordinates
+    //!
+    virtual void eval(int_type n, real_type const * s, real_type * x, real_type * y) const;
+
+    //!
+    //! Evaluate the curve with offset `offs` (ISO) at the `n` curvilinear
+    //! coordinates `s[0..n-1]`. Output arrays must not overlap `s`.
+    //!
+    //! \param[in]  n    number of points
+    //! \param[in]  s    curvilinear coordinates
+    //! \param[in]  offs offset of the curve
+    //! \param[out] x    x-coordinates
+    //! \param[out] y    y-coordinates
+    //!
+    virtual void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const;
+
+    //!
+    //! Evaluate the curve with offset `offs` (SAE) at the `n` curvilinear
+    //! coordinates `s[0..n-1]`. Output arrays must not overlap `s`.
+    //!
+    //! \param[in]  n    number of points
+    //! \param[in]  s    curvilinear coordinates
+    //! \param[in]  offs offset of the curve
+    //! \param[out] x    x-coordinates
+    //! \param[out] y    y-coordinates
+    //!
+    void eval_SAE(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+      this->eval_ISO(n, s, -offs, x, y);
+    }
+
+    //!
+    //! Evaluate angle, curvature and position at the `n` curvilinear
+    //! coordinates `s[0..n-1]`. Output arrays must not overlap `s`.
+    //!
+    //! \param[in]  n  number of points
+    //! \param[in]  s  curvilinear coordinates
+    //! \param[out] th angles
+    //! \param[out] k  curvatures
+    //! \param[out] x  x-coordinates
+    //! \param[out] y  y-coordinates
+    //!
+    virtual void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const;
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -96,6 +96,7 @@ using BaseCurve::Y_ISO_D;
 using BaseCurve::Y_ISO_DD;
 using BaseCurve::Y_ISO_DDD;
 
+using BaseCurve::evaluate;
 using BaseCurve::evaluate_ISO;
 using BaseCurve::evaluate_SAE;
 
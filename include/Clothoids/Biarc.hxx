@@ -426,6 +426,20 @@ namespace G2lib {
     void intersect_ISO(
         real_type offs, Biarc const & B, real_type offs_B, IntersectList & ilist, bool swap_s_vals) const;
 
+    //!
+    //! First hit of a ray with the biarc with offset (ISO),
+    //! see `LineSegment::raycast_ISO`.
+    //!
+    bool raycast_ISO(
+        real_type   x0,
+        real_type   y0,
+        real_type   dx,
+        real_type   dy,
+        real_type   offs,
+        real_type   tmax,
+        real_type & t,
+        real_type & s) const;
+
     void info(ostream_type & stream) const override { stream << "BiArc\n" << *this << '\n'; }
 
     //!
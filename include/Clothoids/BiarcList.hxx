@@ -30,7 +30,6 @@
 #include "Biarc.hxx"
 #include "PolyLine.hxx"
 #include "AABBtree.hxx"
-#include "ThreadLocalData.hxx"
 
 namespace G2lib {
 
@@ -62,30 +61,34 @@ namespace G2lib {
     vector<real_type> m_s0;
     vector<Biarc>     m_biarcList;
 
-    mutable Utils::ThreadLocalData<int_type> m_lastInterval;
 
-    mutable bool               m_aabb_done;
-    mutable AABBtree           m_aabb_tree;
-    mutable real_type          m_aabb_offs;
-    mutable real_type          m_aabb_max_angle;
-    mutable real_type          m_aabb_max_size;
-    mutable vector<Triangle2D> m_aabb_tri;
+    // immutable triangle covers + AABB trees, built on demand, one per offset
+    mutable TriangleCoverCache m_aabb;
+
+    PtrTriangleCover aabb_ISO(real_type offs) const;
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     class T2D_collision_list_ISO {
-      BiarcList const * m_pList1;
-      real_type const   m_offs1;
-      BiarcList const * m_pList2;
-      real_type const   m_offs2;
+      BiarcList const *          m_pList1;
+      real_type const            m_offs1;
+      vector<Triangle2D> const & m_tri1;
+      BiarcList const *          m_pList2;
+      real_type const            m_offs2;
+      vector<Triangle2D> const & m_tri2;
 
      public:
       T2D_collision_list_ISO(
-          BiarcList const * pList1, real_type const offs1, BiarcList const * pList2, real_type const offs2)
-          : m_pList1(pList1), m_offs1(offs1), m_pList2(pList2), m_offs2(offs2) {}
-
-      bool operator()(BBox::PtrBBox ptr1, BBox::PtrBBox ptr2) const {
-        Triangle2D const & T1 = m_pList1->m_aabb_tri[size_t(ptr1->Ipos())];
-        Triangle2D const & T2 = m_pList2->m_aabb_tri[size_t(ptr2->Ipos())];
+          BiarcList const *          pList1,
+          real_type const            offs1,
+          vector<Triangle2D> const & tri1,
+          BiarcList const *          pList2,
+          real_type const            offs2,
+          vector<Triangle2D> const & tri2)
+          : m_pList1(pList1), m_offs1(offs1), m_tri1(tri1), m_pList2(pList2), m_offs2(offs2), m_tri2(tri2) {}
+
+      bool operator()(BBox::PtrBBox const & ptr1, BBox::PtrBBox const & ptr2) const {
+        Triangle2D const & T1 = m_tri1[size_t(ptr1->Ipos())];
+        Triangle2D const & T2 = m_tri2[size_t(ptr2->Ipos())];
         Biarc const &      C1 = m_pList1->get(T1.Icurve());
         Biarc const &      C2 = m_pList2->get(T2.Icurve());
         return C1.collision_ISO(m_offs1, C2, m_offs2);
@@ -94,7 +97,6 @@ namespace G2lib {
 
 #endif
 
-    void resetLastInterval() { *(m_lastInterval.search(std::this_thread::get_id())) = 0; }
 
     int_type closest_point_internal(
         real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & dst) const;
@@ -105,21 +107,18 @@ namespace G2lib {
     //!
     //! Build an empty biarc spline.
     //!
-    BiarcList() : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) { this->resetLastInterval(); }
+    BiarcList() : BaseCurve(G2LIB_BIARC_LIST) {}
 
     ~BiarcList() override {
       m_s0.clear();
       m_biarcList.clear();
-      m_aabb_tri.clear();
+      m_aabb.clear();
     }
 
     //!
     //! Build a copy of another biarc spline.
     //!
-    BiarcList(BiarcList const & s) : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) {
-      this->resetLastInterval();
-      copy(s);
-    }
+    BiarcList(BiarcList const & s) : BaseCurve(G2LIB_BIARC_LIST) { copy(s); }
 
     //!
     //! Empty the the biarc list.
@@ -261,6 +260,21 @@ namespace G2lib {
     //!
     int_type findAtS(real_type & s) const;
 
+    //!
+    //! As `findAtS(s)` using the caller-owned `cursor` (see `SegmentCursor`)
+    //!
+    int_type findAtS(real_type & s, SegmentCursor & cursor) const;
+
+    //!
+    //! Evaluate at `s` using the caller-owned `cursor` for the segment lookup
+    //!
+    void eval(real_type s, SegmentCursor & cursor, real_type & x, real_type & y) const;
+
+    void eval_ISO(real_type s, real_type offs, SegmentCursor & cursor, real_type & x, real_type & y) const;
+
+    void evaluate(
+        real_type s, SegmentCursor & cursor, real_type & th, real_type & k, real_type & x, real_type & y) const;
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     real_type length() const override;
@@ -312,7 +326,9 @@ namespace G2lib {
     //! \param[out] max_angle maximum angle variation of the arc covered by a triangle
     //! \param[out] max_size  maximum admissible size of the covering tirnagles
     //!
-    void build_AABBtree_ISO(
+    //! \return the published triangle cover, the pointer keeps it alive after the list is modified
+    //!
+    PtrTriangleCover build_AABBtree_ISO(
         real_type offs,
         real_type max_angle = Utils::m_pi / 6,  // 30 degree
         real_type max_size  = 1e100) const;
@@ -324,14 +340,42 @@ namespace G2lib {
     //! \param[out] max_angle maximum angle variation of the arc covered by a triangle
     //! \param[out] max_size  maximum admissible size of the covering tirnagles
     //!
-    void build_AABBtree_SAE(
+    //! \return the published triangle cover, the pointer keeps it alive after the list is modified
+    //!
+    PtrTriangleCover build_AABBtree_SAE(
         real_type offs,
         real_type max_angle = Utils::m_pi / 6,  // 30 degree
         real_type max_size  = 1e100) const {
-      build_AABBtree_ISO(-offs, max_angle, max_size);
+      return build_AABBtree_ISO(-offs, max_angle, max_size);
     }
 #endif
 
+    //!
+    //! Build in advance the triangle cover and the AABB tree used by
+    //! collision, intersection and closest point queries at offset `offs`.
+    //! Concurrent callers wait for a single construction, the queries on a
+    //! prepared offset never wait.
+    //!
+    //! \param[in] offs      curve offset
+    //! \param[in] max_angle maximum angle variation of the arc covered by a triangle
+    //! \param[in] max_size  maximum admissible size of the covering triangles
+    //!
+    void prepare(real_type offs = 0, real_type max_angle = Utils::m_pi / 6, real_type max_size = 1e100) const {
+      this->build_AABBtree_ISO(offs, max_angle, max_size);
+    }
+
+    //!
+    //! Cache of the triangle covers used by the queries (one per offset,
+    //! LRU): read its size, capacity and hit/miss counters.
+    //!
+    TriangleCoverCache const & aabb_cache() const { return m_aabb; }
+
+    //! Set the maximum number of triangle covers cached, the least recently used are dropped.
+    void aabb_set_capacity(size_t capacity) { m_aabb.set_capacity(capacity); }
+
+    //! Reset the hit/miss counters of the cache of the triangle covers.
+    void aabb_reset_counters() { m_aabb.reset_counters(); }
+
     /*\
      |   _     _
      |  | |__ | |__   _____  __
@@ -489,6 +533,15 @@ namespace G2lib {
 
     void eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const override;
 
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    void eval(int_type n, real_type const * s, real_type * x, real_type * y) const override;
+
+    void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const override;
+
+    void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const override;
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -527,6 +580,45 @@ namespace G2lib {
         real_type & t,
         real_type & dst) const override;
 
+    //!
+    //! Segments at distance not greater than `r` from the point `(qx,qy)`.
+    //!
+    //! \param[in]  qx   x-coordinate of the point
+    //! \param[in]  qy   y-coordinate of the point
+    //! \param[in]  offs offset of the curve
+    //! \param[in]  r    radius of the search
+    //! \param[out] out  segment, abscissa of the closest point and exact distance,
+    //!                  sorted by increasing distance (cleared first, its capacity is reused)
+    //!
+    void query_radius_ISO(
+        real_type qx, real_type qy, real_type offs, real_type r, vector<SegmentDistance> & out) const;
+
+    //!
+    //! Segments at distance not greater than `r` from the point `(qx,qy)`.
+    //!
+    void query_radius(real_type qx, real_type qy, real_type r, vector<SegmentDistance> & out) const {
+      query_radius_ISO(qx, qy, 0, r, out);
+    }
+
+    //!
+    //! The `k` segments nearest to the point `(qx,qy)`.
+    //!
+    //! \param[in]  qx   x-coordinate of the point
+    //! \param[in]  qy   y-coordinate of the point
+    //! \param[in]  offs offset of the curve
+    //! \param[in]  k    number of segments
+    //! \param[out] out  segment, abscissa of the closest point and exact distance,
+    //!                  sorted by increasing distance (cleared first, its capacity is reused)
+    //!
+    void knn_ISO(real_type qx, real_type qy, real_type offs, int_type k, vector<SegmentDistance> & out) const;
+
+    //!
+    //! The `k` segments nearest to the point `(qx,qy)`.
+    //!
+    void knn(real_type qx, real_type qy, int_type k, vector<SegmentDistance> & out) const {
+      knn_ISO(qx, qy, 0, k, out);
+    }
+
     void info(ostream_type & stream) const override { stream << "BiarcList\n" << *this << '\n'; }
 
     //! pretty print the biarc list
@@ -127,6 +127,8 @@ namespace G2lib {
       m_x0     = x0;
       m_y0     = y0;
       m_theta0 = theta0;
+      m_c0     = cos(theta0);
+      m_s0     = sin(theta0);
       m_k      = k;
       m_L      = L;
     }
@@ -412,6 +414,15 @@ namespace G2lib {
 
     void eval_DDD(real_type, real_type & x_DDD, real_type & y_DDD) const override;
 
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    void eval(int_type n, real_type const * s, real_type * x, real_type * y) const override;
+
+    void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const override;
+
+    void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const override;
+
     /*\
      |  _____                   _   _   _
      | |_   _|   __ _ _ __   __| | | \ | |
@@ -549,6 +560,20 @@ namespace G2lib {
     void intersect_ISO(
         real_type offs, CircleArc const & C, real_type offs_obj, IntersectList & ilist, bool swap_s_vals) const;
 
+    //!
+    //! First hit of a ray with the circle arc with offset (ISO),
+    //! see `LineSegment::raycast_ISO`.
+    //!
+    bool raycast_ISO(
+        real_type   x0,
+        real_type   y0,
+        real_type   dx,
+        real_type   dy,
+        real_type   offs,
+        real_type   tmax,
+        real_type & t,
+        real_type & s) const;
+
     //!
     //! Return \f$ \sin \theta_0 \f$ where
     //! \f$ \theta_0 \f$ is the initial tangent angle.
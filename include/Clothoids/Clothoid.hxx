@@ -73,38 +73,58 @@ namespace G2lib {
         real_type s_begin, real_type s_end, real_type offs, real_type ds, real_type max_angle, vector<real_type> & s)
         const;
 
-    void bbTriangles_internal_ISO(
+    // The refinements on a piece of segment take the parameters of the
+    // segment, so that `ClothoidList` calls them on its stored segments.
+
+    static void closest_point_internal(
+        ClothoidData const & CD,
+        real_type            s_begin,
+        real_type            s_end,
+        real_type            qx,
+        real_type            qy,
         real_type            offs,
-        vector<Triangle2D> & tvec,
-        real_type            s0,
-        real_type            s1,
-        real_type            max_angle,
-        real_type            max_size,
-        int_type             icurve) const;
-
-    void closest_point_internal(
-        real_type   s_begin,
-        real_type   s_end,
-        real_type   qx,
-        real_type   qy,
-        real_type   offs,
-        real_type & x,
-        real_type & y,
-        real_type & s,
-        real_type & dst) const;
+        real_type &          x,
+        real_type &          y,
+        real_type &          s,
+        real_type &          dst);
 
     void closest_point_internal(
         real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & dst) const;
 
+    static bool raycast_internal(
+        ClothoidData const & CD,
+        real_type            s_begin,
+        real_type            s_end,
+        real_type            x0,
+        real_type            y0,
+        real_type            dx,
+        real_type            dy,
+        real_type            offs,
+        real_type            tmax,
+        real_type &          t,
+        real_type &          s);
+
+    static real_type chord_height_ISO(ClothoidData const & CD, Triangle2D const & T, real_type offs);
+
     static int_type  m_max_iter;
     static real_type m_tolerance;
 
-    mutable bool               m_aabb_done;
-    mutable AABBtree           m_aabb_tree;
-    mutable real_type          m_aabb_offs;
-    mutable real_type          m_aabb_max_angle;
-    mutable real_type          m_aabb_max_size;
-    mutable vector<Triangle2D> m_aabb_tri;
+    // immutable triangle covers + AABB trees, built on demand, one per offset
+    mutable TriangleCoverCache m_aabb;
+
+    PtrTriangleCover aabb_ISO(real_type offs) const;
+
+    static bool aabb_intersect_ISO(
+        ClothoidData const & CD1,
+        real_type            L1,
+        Triangle2D const &   T1,
+        real_type            offs1,
+        ClothoidData const & CD2,
+        real_type            L2,
+        Triangle2D const &   T2,
+        real_type            offs2,
+        real_type &          ss1,
+        real_type &          ss2);
 
     bool aabb_intersect_ISO(
         Triangle2D const &    T1,
@@ -113,37 +133,47 @@ namespace G2lib {
         Triangle2D const &    T2,
         real_type             C_offs,
         real_type &           ss1,
-        real_type &           ss2) const;
+        real_type &           ss2) const {
+      return aabb_intersect_ISO(m_CD, m_L, T1, offs, pC->m_CD, pC->m_L, T2, C_offs, ss1, ss2);
+    }
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     class T2D_approximate_collision {
-      ClothoidCurve const * pC1;
-      ClothoidCurve const * pC2;
+      vector<Triangle2D> const & m_tri1;
+      vector<Triangle2D> const & m_tri2;
 
      public:
-      T2D_approximate_collision(ClothoidCurve const * _pC1, ClothoidCurve const * _pC2) : pC1(_pC1), pC2(_pC2) {}
+      T2D_approximate_collision(vector<Triangle2D> const & _tri1, vector<Triangle2D> const & _tri2)
+          : m_tri1(_tri1), m_tri2(_tri2) {}
 
-      bool operator()(BBox::PtrBBox ptr1, BBox::PtrBBox ptr2) const {
-        Triangle2D const & T1 = pC1->m_aabb_tri[size_t(ptr1->Ipos())];
-        Triangle2D const & T2 = pC2->m_aabb_tri[size_t(ptr2->Ipos())];
+      bool operator()(BBox::PtrBBox const & ptr1, BBox::PtrBBox const & ptr2) const {
+        Triangle2D const & T1 = m_tri1[size_t(ptr1->Ipos())];
+        Triangle2D const & T2 = m_tri2[size_t(ptr2->Ipos())];
         return T1.overlap(T2);
       }
     };
 
     class T2D_collision_ISO {
-      ClothoidCurve const * pC1;
-      real_type const       m_offs1;
-      ClothoidCurve const * pC2;
-      real_type const       m_offs2;
+      ClothoidCurve const *      pC1;
+      real_type const            m_offs1;
+      vector<Triangle2D> const & m_tri1;
+      ClothoidCurve const *      pC2;
+      real_type const            m_offs2;
+      vector<Triangle2D> const & m_tri2;
 
      public:
       T2D_collision_ISO(
-          ClothoidCurve const * _pC1, real_type const _offs1, ClothoidCurve const * _pC2, real_type const _offs2)
-          : pC1(_pC1), m_offs1(_offs1), pC2(_pC2), m_offs2(_offs2) {}
-
-      bool operator()(BBox::PtrBBox ptr1, BBox::PtrBBox ptr2) const {
-        Triangle2D const & T1 = pC1->m_aabb_tri[size_t(ptr1->Ipos())];
-        Triangle2D const & T2 = pC2->m_aabb_tri[size_t(ptr2->Ipos())];
+          ClothoidCurve const *      _pC1,
+          real_type const            _offs1,
+          vector<Triangle2D> const & _tri1,
+          ClothoidCurve const *      _pC2,
+          real_type const            _offs2,
+          vector<Triangle2D> const & _tri2)
+          : pC1(_pC1), m_offs1(_offs1), m_tri1(_tri1), pC2(_pC2), m_offs2(_offs2), m_tri2(_tri2) {}
+
+      bool operator()(BBox::PtrBBox const & ptr1, BBox::PtrBBox const & ptr2) const {
+        Triangle2D const & T1 = m_tri1[size_t(ptr1->Ipos())];
+        Triangle2D const & T2 = m_tri2[size_t(ptr2->Ipos())];
         real_type          ss1, ss2;
         return pC1->aabb_intersect_ISO(T1, m_offs1, pC2, T2, m_offs2, ss1, ss2);
       }
@@ -156,7 +186,7 @@ namespace G2lib {
     //!
     //! Build an empty clothoid curve
     //!
-    ClothoidCurve() : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) {
+    ClothoidCurve() : BaseCurve(G2LIB_CLOTHOID) {
       m_CD.x0     = 0;
       m_CD.y0     = 0;
       m_CD.theta0 = 0;
@@ -168,7 +198,7 @@ namespace G2lib {
     //!
     //! Build a copy of an existing clothoid curve
     //!
-    ClothoidCurve(ClothoidCurve const & s) : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) { copy(s); }
+    ClothoidCurve(ClothoidCurve const & s) : BaseCurve(G2LIB_CLOTHOID) { copy(s); }
 
     //!
     //! Construct a clothoid with the standard parameters.
@@ -181,7 +211,7 @@ namespace G2lib {
     //! \param[in] L      length
     //!
     explicit ClothoidCurve(real_type x0, real_type y0, real_type theta0, real_type k, real_type dk, real_type L)
-        : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) {
+        : BaseCurve(G2LIB_CLOTHOID) {
       m_CD.x0     = x0;
       m_CD.y0     = y0;
       m_CD.theta0 = theta0;
@@ -208,7 +238,7 @@ namespace G2lib {
     //! \param[in] theta1 final angle \f$ \theta_1 \f$
     //!
     explicit ClothoidCurve(real_type const * P0, real_type theta0, real_type const * P1, real_type theta1)
-        : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) {
+        : BaseCurve(G2LIB_CLOTHOID) {
       build_G1(P0[0], P0[1], theta0, P1[0], P1[1], theta1);
     }
 
@@ -216,16 +246,15 @@ namespace G2lib {
     //! Build a clothoid copying an existing one.
     //!
     void copy(ClothoidCurve const & c) {
-      m_CD        = c.m_CD;
-      m_L         = c.m_L;
-      m_aabb_done = false;
-      m_aabb_tree.clear();
+      m_CD = c.m_CD;
+      m_L  = c.m_L;
+      m_aabb.clear();
     }
 
     //!
     //! Build a clothoid copying an existing line segment.
     //!
-    explicit ClothoidCurve(LineSegment const & LS) : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) {
+    explicit ClothoidCurve(LineSegment const & LS) : BaseCurve(G2LIB_CLOTHOID) {
       m_CD.x0     = LS.m_x0;
       m_CD.y0     = LS.m_y0;
       m_CD.theta0 = LS.m_theta0;
@@ -237,7 +266,7 @@ namespace G2lib {
     //!
     //! Build a clothoid copying an existing circle arc.
     //!
-    explicit ClothoidCurve(CircleArc const & C) : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) {
+    explicit ClothoidCurve(CircleArc const & C) : BaseCurve(G2LIB_CLOTHOID) {
       m_CD.x0     = C.m_x0;
       m_CD.y0     = C.m_y0;
       m_CD.theta0 = C.m_theta0;
@@ -297,8 +326,7 @@ namespace G2lib {
         real_type y1,
         real_type theta1,
         real_type tol = 1e-12) {
-      m_aabb_done = false;
-      m_aabb_tree.clear();
+      m_aabb.clear();
       return m_CD.build_G1(x0, y0, theta0, x1, y1, theta1, tol, m_L);
     }
 
@@ -328,8 +356,7 @@ namespace G2lib {
         real_type k_D[2],
         real_type dk_D[2],
         real_type tol = 1e-12) {
-      m_aabb_done = false;
-      m_aabb_tree.clear();
+      m_aabb.clear();
       return m_CD.build_G1(x0, y0, theta0, x1, y1, theta1, tol, m_L, true, L_D, k_D, dk_D);
     }
 
@@ -352,8 +379,7 @@ namespace G2lib {
         real_type x1,
         real_type y1,
         real_type tol = 1e-12) {
-      m_aabb_done = false;
-      m_aabb_tree.clear();
+      m_aabb.clear();
       return m_CD.build_forward(x0, y0, theta0, kappa0, x1, y1, tol, m_L);
     }
 
@@ -367,8 +393,7 @@ namespace G2lib {
       m_CD.kappa0 = 0;
       m_CD.dk     = 0;
       m_L         = LS.m_L;
-      m_aabb_done = false;
-      m_aabb_tree.clear();
+      m_aabb.clear();
     }
 
     //!
@@ -381,8 +406,7 @@ namespace G2lib {
       m_CD.kappa0 = C.m_k;
       m_CD.dk     = 0;
       m_L         = C.m_L;
-      m_aabb_done = false;
-      m_aabb_tree.clear();
+      m_aabb.clear();
     }
 
     //!
@@ -408,6 +432,17 @@ namespace G2lib {
     //!
     real_type dkappa() const { return m_CD.dk; }
 
+    //!
+    //! Fresnel kernel used to evaluate the clothoid.
+    //!
+    FresnelMode fresnel_mode() const { return m_CD.fresnel; }
+
+    //!
+    //! Select the Fresnel kernel used to evaluate the clothoid
+    //! (`G2LIB_FRESNEL_GLOBAL` follows the global setting).
+    //!
+    void fresnel_mode(FresnelMode mode) { m_CD.fresnel = mode; }
+
     //!
     //! Clothoid curve total variation of the angle.
     //!
@@ -633,6 +668,18 @@ namespace G2lib {
       this->bbTriangles_ISO(0, tvec, max_angle, max_size, icurve);
     }
 
+    //!
+    //! Maximum distance of the offset curve from the side P1-P3 (the chord)
+    //! of a triangle `T` of `bbTriangles_ISO`, for `T.S0() <= s <= T.S1()`.
+    //! It is the height where the triangles are clipped when
+    //! `clipAABBtriangles` is set.
+    //!
+    //! \param[in] T    triangle of `bbTriangles_ISO` with the same offset
+    //! \param[in] offs curve offset
+    //! \return the height of the curve over the chord
+    //!
+    real_type chord_height_ISO(Triangle2D const & T, real_type offs) const { return chord_height_ISO(m_CD, T, offs); }
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     void bbox(real_type & xmin, real_type & ymin, real_type & xmax, real_type & ymax) const override {
@@ -809,6 +856,20 @@ namespace G2lib {
       m_CD.eval_ISO_DDD(s, offs, x_DDD, y_DDD);
     }
 
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    // batched Fresnel kernels: equal to the scalar calls up to rounding, see `BaseCurve::eval`
+    void eval(int_type n, real_type const * s, real_type * x, real_type * y) const override { m_CD.eval(n, s, x, y); }
+
+    void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const override {
+      m_CD.eval_ISO(n, s, offs, x, y);
+    }
+
+    void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const override {
+      m_CD.evaluate(n, s, th, k, x, y);
+    }
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -817,29 +878,44 @@ namespace G2lib {
      |  \__|_|  \__,_|_| |_|___/_|  \___/|_|  |_| |_| |_|
     \*/
 
+    // a rigid motion moves the cached triangle covers and refits their
+    // trees, any other change drops them
+
     void translate(real_type tx, real_type ty) override {
       m_CD.x0 += tx;
       m_CD.y0 += ty;
+      m_aabb.refit([tx, ty](TriangleCover const & TC) { return TC.translated(tx, ty); });
     }
 
-    void rotate(real_type angle, real_type cx, real_type cy) override { m_CD.rotate(angle, cx, cy); }
+    void rotate(real_type angle, real_type cx, real_type cy) override {
+      m_CD.rotate(angle, cx, cy);
+      m_aabb.refit([angle, cx, cy](TriangleCover const & TC) { return TC.rotated(angle, cx, cy); });
+    }
 
     void scale(real_type s) override {
       m_CD.kappa0 /= s;
       m_CD.dk /= s * s;
       m_L *= s;
+      m_aabb.clear();
     }
 
-    void reverse() override { m_CD.reverse(m_L); }
+    void reverse() override {
+      m_CD.reverse(m_L);
+      m_aabb.clear();
+    }
 
     void change_origin(real_type newx0, real_type newy0) override {
-      m_CD.x0 = newx0;
-      m_CD.y0 = newy0;
+      real_type tx = newx0 - m_CD.x0;
+      real_type ty = newy0 - m_CD.y0;
+      m_CD.x0      = newx0;
+      m_CD.y0      = newy0;
+      m_aabb.refit([tx, ty](TriangleCover const & TC) { return TC.translated(tx, ty); });
     }
 
     void trim(real_type s_begin, real_type s_end) override {
       m_CD.origin_at(s_begin);
       m_L = s_end - s_begin;
+      m_aabb.clear();
     }
 
     //!
@@ -876,6 +952,22 @@ namespace G2lib {
         real_type & t,
         real_type & dst) const override;
 
+    //!
+    //! First hit of a ray with the clothoid with offset (ISO), see
+    //! `LineSegment::raycast_ISO`. The pieces crossed by the ray are found
+    //! with the AABB tree of the triangle cover, then the hit is refined
+    //! with a safeguarded Newton iteration.
+    //!
+    bool raycast_ISO(
+        real_type   x0,
+        real_type   y0,
+        real_type   dx,
+        real_type   dy,
+        real_type   offs,
+        real_type   tmax,
+        real_type & t,
+        real_type & s) const;
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
@@ -888,12 +980,38 @@ namespace G2lib {
     \*/
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-    void build_AABBtree_ISO(
+    PtrTriangleCover build_AABBtree_ISO(
         real_type offs,
         real_type max_angle = Utils::m_pi / 18,  // 10 degree
         real_type max_size  = 1e100) const;
 #endif
 
+    //!
+    //! Build in advance the triangle cover and the AABB tree used by
+    //! collision, intersection and closest point queries at offset `offs`.
+    //! The cover is built once even under concurrent calls; after that a
+    //! query finds it with an atomic load and takes no lock.
+    //!
+    //! \param[in] offs      curve offset
+    //! \param[in] max_angle maximum angle variation
+    //! \param[in] max_size  if the segment is larger then this parameter is split
+    //!
+    void prepare(real_type offs = 0, real_type max_angle = Utils::m_pi / 18, real_type max_size = 1e100) const {
+      this->build_AABBtree_ISO(offs, max_angle, max_size);
+    }
+
+    //!
+    //! Cache of the triangle covers used by the queries (one per offset,
+    //! LRU): read its size, capacity and hit/miss counters.
+    //!
+    TriangleCoverCache const & aabb_cache() const { return m_aabb; }
+
+    //! Set the maximum number of triangle covers cached, the least recently used are dropped.
+    void aabb_set_capacity(size_t capacity) { m_aabb.set_capacity(capacity); }
+
+    //! Reset the hit/miss counters of the cache of the triangle covers.
+    void aabb_reset_counters() { m_aabb.reset_counters(); }
+
     // collision detection
     bool approximate_collision_ISO(
         real_type offs, ClothoidCurve const & c, real_type c_offs, real_type max_angle, real_type max_size) const;
@@ -922,6 +1040,292 @@ namespace G2lib {
     friend ostream_type & operator<<(ostream_type & stream, ClothoidCurve const & c);
   };
 
+  /*\
+   |    ____ _       _   _           _     _ ____        _
+   |   / ___| | ___ | |_| |__   ___ (_) __| / ___|  ___ / \
+   |  | |   | |/ _ \| __| '_ \ / _ \| |/ _` \___ \ / _ \/ _ \
+   |  | |___| | (_) | |_| | | | (_) | | (_| |___) | (_) / ___ \
+   |   \____|_|\___/ \__|_| |_|\___/|_|\__,_|____/ \___/_/   \_\
+  \*/
+  //!
+  //! Clothoid segments stored by parameters (structure of arrays), the
+  //! storage of the segments of a `ClothoidList`.
+  //!
+  //! A segment takes the six parameters `x0, y0, theta0, kappa0, dk, L`
+  //! instead of a whole `ClothoidCurve` with its virtual table and its
+  //! cache of triangle covers. The Fresnel kernel is one for all the
+  //! segments, the mode of the appended curves is not kept. It is read as a
+  //! `ClothoidDataT` for the evaluations, or as a `ClothoidCurve` built on
+  //! demand: a copy, whose changes are stored back with `set`.
+  //!
+  //! The parameters are stored with the scalar type `T`, the library
+  //! provides the `float` and `double` instantiations and `ClothoidSoA`
+  //! is the `real_type` one. A `float` copy of the segments of a list,
+  //! `ClothoidSoAT<float>( list.segments() )`, samples them in single
+  //! precision.
+  //!
+  template <typename T>
+  class ClothoidSoAT {
+    vector<T>   m_x0, m_y0, m_theta0, m_kappa0, m_dk, m_L;
+    FresnelMode m_fresnel{G2LIB_FRESNEL_GLOBAL};
+
+    template <typename U>
+    friend class ClothoidSoAT;
+
+    // displacement from the origin to the end of every segment, batched over the columns
+    void displacements(vector<T> & dx, vector<T> & dy) const;
+
+   public:
+    ClothoidSoAT() = default;
+
+    //! Copy of the segments of `S` converted to the scalar type `T`.
+    template <typename U>
+    explicit ClothoidSoAT(ClothoidSoAT<U> const & S)
+        : m_x0(S.m_x0.begin(), S.m_x0.end()),
+          m_y0(S.m_y0.begin(), S.m_y0.end()),
+          m_theta0(S.m_theta0.begin(), S.m_theta0.end()),
+          m_kappa0(S.m_kappa0.begin(), S.m_kappa0.end()),
+          m_dk(S.m_dk.begin(), S.m_dk.end()),
+          m_L(S.m_L.begin(), S.m_L.end()),
+          m_fresnel(S.m_fresnel) {}
+
+    void clear();
+
+    void reserve(size_t n);
+
+    size_t size() const { return m_L.size(); }
+    bool   empty() const { return m_L.empty(); }
+
+    //! Fresnel kernel used to evaluate the segments.
+    FresnelMode fresnel_mode() const { return m_fresnel; }
+
+    //! Select the Fresnel kernel used to evaluate the segments.
+    void fresnel_mode(FresnelMode mode) { m_fresnel = mode; }
+
+    //! Append the segment `C` (its Fresnel kernel is not kept).
+    void push_back(ClothoidCurve const & C);
+
+    //! Append the segment of parameters `CD` (its Fresnel kernel is not kept) and length `L`.
+    void push_back(ClothoidDataT<T> const & CD, T L);
+
+    //! Append the segments of `S` (evaluated with the kernel of this storage).
+    void append(ClothoidSoAT const & S);
+
+    //! Replace the segment `i` with `C`.
+    void set(size_t i, ClothoidCurve const & C);
+
+    //! Reverse the order of the segments (the segments are not changed).
+    void reverse_order();
+
+    //!
+    //! \name Transformations of the segments
+    //! The columns are updated in place, no clothoid curve is built.
+    //!
+    ///@{
+
+    //! Translate all the segments by `(tx,ty)`.
+    void translate(T tx, T ty);
+
+    //! Rotate all the segments by `angle` around `(cx,cy)`.
+    void rotate(T angle, T cx, T cy);
+
+    //! Scale curvatures and lengths of all the segments by `sfactor`, the origins are not moved.
+    void scale(T sfactor);
+
+    //! Reverse the direction of every segment (the order is not changed).
+    void reverse_segments();
+
+    //! Move the first segment to `(x0,y0)` and every other segment to the end of the previous one.
+    void change_origin(T x0, T y0);
+
+    ///@}
+
+    //! Parameters of the segment `i`.
+    ClothoidDataT<T> data(size_t i) const {
+      ClothoidDataT<T> CD;
+      CD.x0      = m_x0[i];
+      CD.y0      = m_y0[i];
+      CD.theta0  = m_theta0[i];
+      CD.kappa0  = m_kappa0[i];
+      CD.dk      = m_dk[i];
+      CD.fresnel = m_fresnel;
+      return CD;
+    }
+
+    //! Length of the segment `i`.
+    T length(size_t i) const { return m_L[i]; }
+
+    //! The segment `i` as a clothoid curve (built on demand).
+    ClothoidCurve operator[](size_t i) const;
+
+    ClothoidCurve front() const { return (*this)[0]; }           //!< the first segment
+    ClothoidCurve back() const { return (*this)[size() - 1]; }  //!< the last segment
+  };
+
+  extern template class ClothoidSoAT<float>;
+  extern template class ClothoidSoAT<double>;
+
+  //!
+  //! Non-virtual core of a clothoid segment, templated on the scalar type:
+  //! the parameters, the length, the evaluations and the triangle covers.
+  //! `ClothoidCurve` runs its covers and the refinement of its collisions
+  //! and intersections on the `real_type` core, the `float` core
+  //! (`ClothoidCurveT<float>( C )`) does the same in single precision.
+  //!
+  //! The core keeps no cache: `build_AABBtree_ISO` builds a new cover at
+  //! every call, `collision_ISO` and `intersect_ISO` build the two covers
+  //! they use.
+  //!
+  template <typename T>
+  class ClothoidCurveT {
+    ClothoidDataT<T> m_CD;
+    T                m_L{0};
+
+    static void bbTriangles_internal_ISO(
+        ClothoidDataT<T> const & CD,
+        T                        L,
+        T                        offs,
+        vector<Triangle2DT<T>> & tvec,
+        T                        s_begin,
+        T                        s_end,
+        T                        max_angle,
+        T                        max_size,
+        int_type                 icurve);
+
+   public:
+    using PtrCover      = shared_ptr<TriangleCoverT<T> const>;
+    using IntersectList = vector<pair<T, T>>;
+
+    ClothoidCurveT() = default;
+
+    //! Clothoid with the standard parameters.
+    ClothoidCurveT(T x0, T y0, T theta0, T k, T dk, T L) : m_L(L) {
+      m_CD.x0     = x0;
+      m_CD.y0     = y0;
+      m_CD.theta0 = theta0;
+      m_CD.kappa0 = k;
+      m_CD.dk     = dk;
+    }
+
+    //! Clothoid of parameters `CD` and length `L`.
+    ClothoidCurveT(ClothoidDataT<T> const & CD, T L) : m_CD(CD), m_L(L) {}
+
+    //! Copy of `C` converted to the scalar type `T` (with its Fresnel kernel).
+    explicit ClothoidCurveT(ClothoidCurve const & C);
+
+    ClothoidDataT<T> const & data() const { return m_CD; }  //!< parameters of the clothoid
+
+    T length() const { return m_L; }  //!< length of the clothoid
+
+    T x_begin() const { return m_CD.x0; }            //!< initial x-coordinate
+    T y_begin() const { return m_CD.y0; }            //!< initial y-coordinate
+    T theta_begin() const { return m_CD.theta0; }    //!< initial angle
+    T kappa_begin() const { return m_CD.kappa0; }    //!< initial curvature
+    T dkappa() const { return m_CD.dk; }             //!< curvature derivative
+    T x_end() const { return m_CD.X(m_L); }          //!< final x-coordinate
+    T y_end() const { return m_CD.Y(m_L); }          //!< final y-coordinate
+    T theta_end() const { return m_CD.theta(m_L); }  //!< final angle
+    T kappa_end() const { return m_CD.kappa(m_L); }  //!< final curvature
+
+    //!
+    //! \name Evaluation
+    //! The batched versions take the abscissae `s[0..n-1]` (the output
+    //! arrays must not overlap `s`), see `ClothoidDataT`.
+    //!
+    ///@{
+    void eval(T s, T & x, T & y) const { m_CD.eval(s, x, y); }
+    void eval_ISO(T s, T offs, T & x, T & y) const { m_CD.eval_ISO(s, offs, x, y); }
+    void evaluate(T s, T & theta, T & kappa, T & x, T & y) const { m_CD.evaluate(s, theta, kappa, x, y); }
+
+    void eval(int_type n, T const * s, T * x, T * y) const { m_CD.eval(n, s, x, y); }
+    void eval_ISO(int_type n, T const * s, T offs, T * x, T * y) const { m_CD.eval_ISO(n, s, offs, x, y); }
+    void evaluate(int_type n, T const * s, T * theta, T * kappa, T * x, T * y) const {
+      m_CD.evaluate(n, s, theta, kappa, x, y);
+    }
+    ///@}
+
+    //!
+    //! Triangles covering the clothoid of parameters `CD` and length `L`
+    //! at offset `offs`, see `ClothoidCurve::bbTriangles_ISO`.
+    //!
+    static void bbTriangles_ISO(
+        ClothoidDataT<T> const & CD,
+        T                        L,
+        T                        offs,
+        vector<Triangle2DT<T>> & tvec,
+        T                        max_angle,
+        T                        max_size,
+        int_type                 icurve);
+
+    //!
+    //! Maximum distance of the offset curve from the side P1-P3 of a
+    //! triangle `Tri` of `bbTriangles_ISO`, see `ClothoidCurve::chord_height_ISO`.
+    //!
+    static T chord_height_ISO(ClothoidDataT<T> const & CD, Triangle2DT<T> const & Tri, T offs);
+
+    //!
+    //! Intersection of the pieces of two clothoids covered by the triangles
+    //! `T1` and `T2`, refined by Newton until the positions agree within
+    //! `tolerance`, in at most `max_iter` iterations.
+    //!
+    //! \return true if the refinement converged, `(ss1,ss2)` are the abscissae of the intersection
+    //!
+    static bool aabb_intersect_ISO(
+        ClothoidDataT<T> const & CD1,
+        T                        L1,
+        Triangle2DT<T> const &   T1,
+        T                        offs1,
+        ClothoidDataT<T> const & CD2,
+        T                        L2,
+        Triangle2DT<T> const &   T2,
+        T                        offs2,
+        int_type                 max_iter,
+        T                        tolerance,
+        T &                      ss1,
+        T &                      ss2);
+
+    //!
+    //! Tolerance of the refinements of the core: the one of `ClothoidCurve`
+    //! (`1e-9`) in double, a thousand times the machine precision in float.
+    //!
+    static T tolerance() { return std::max(T(1e-9), 1000 * std::numeric_limits<T>::epsilon()); }
+
+    //! Maximum number of iterations of the refinements of the core (as `ClothoidCurve`).
+    static int_type max_iter() { return 10; }
+
+    void bbTriangles_ISO(
+        T                        offs,
+        vector<Triangle2DT<T>> & tvec,
+        T                        max_angle = T(Utils::m_pi / 6),  // 30 degree
+        T                        max_size  = std::numeric_limits<T>::max(),
+        int_type                 icurve    = 0) const {
+      bbTriangles_ISO(m_CD, m_L, offs, tvec, max_angle, max_size, icurve);
+    }
+
+    //!
+    //! Build the triangle cover and its AABB tree at offset `offs`, the
+    //! triangles are clipped when `aabb_clip_triangles` is set.
+    //!
+    PtrCover build_AABBtree_ISO(
+        T offs,
+        T max_angle = T(Utils::m_pi / 18),  // 10 degree
+        T max_size  = std::numeric_limits<T>::max()) const;
+
+    //! Check if the clothoid at offset `offs` collides with `C` at offset `offs_C`.
+    bool collision_ISO(T offs, ClothoidCurveT const & C, T offs_C) const;
+
+    //!
+    //! Intersections of the clothoid at offset `offs` with `C` at offset
+    //! `offs_C`, the pairs of abscissae `(s,s_C)` are appended to `ilist`.
+    //!
+    void intersect_ISO(T offs, ClothoidCurveT const & C, T offs_C, IntersectList & ilist) const;
+  };
+
+  extern template class ClothoidCurveT<float>;
+  extern template class ClothoidCurveT<double>;
+
+  typedef ClothoidSoAT<real_type> ClothoidSoA;
+
 }  // namespace G2lib
 
 ///
@@ -28,7 +28,6 @@
 #pragma once
 #include "BaseCurve.hxx"
 #include "Clothoid.hxx"
-#include "ThreadLocalData.hxx"
 
 namespace G2lib {
 
@@ -723,71 +722,57 @@ namespace G2lib {
   //! \endrst
   //!
   class ClothoidList : public BaseCurve {
-    bool                  m_curve_is_closed;
-    vector<real_type>     m_s0;
-    vector<ClothoidCurve> m_clotoidList;
+    bool              m_curve_is_closed;
+    vector<real_type> m_s0;
+    ClothoidSoA       m_clotoidList;  // segments by parameters, see `segment`
 
-    mutable Utils::ThreadLocalData<int_type> m_lastInterval;
+    // the last segment by parameters, read by the accessors of the end point
+    ClothoidData back_data() const { return m_clotoidList.data(m_clotoidList.size() - 1); }
+    real_type    back_length() const { return m_clotoidList.length(m_clotoidList.size() - 1); }
 
-    mutable bool               m_aabb_done;
-    mutable AABBtree           m_aabb_tree;
-    mutable real_type          m_aabb_offs;
-    mutable real_type          m_aabb_max_angle;
-    mutable real_type          m_aabb_max_size;
-    mutable vector<Triangle2D> m_aabb_tri;
+    // immutable triangle covers + AABB trees, built on demand, one per offset
+    mutable TriangleCoverCache m_aabb;
 
-#ifndef DOXYGEN_SHOULD_SKIP_THIS
-    class T2D_collision_list_ISO {
-      ClothoidList const * pList1;
-      real_type const      m_offs1;
-      ClothoidList const * pList2;
-      real_type const      m_offs2;
-
-     public:
-      T2D_collision_list_ISO(
-          ClothoidList const * _pList1, real_type const _offs1, ClothoidList const * _pList2, real_type const _offs2)
-          : pList1(_pList1), m_offs1(_offs1), pList2(_pList2), m_offs2(_offs2) {}
-
-      bool operator()(BBox::PtrBBox ptr1, BBox::PtrBBox ptr2) const {
-        Triangle2D const &    T1 = pList1->m_aabb_tri[size_t(ptr1->Ipos())];
-        Triangle2D const &    T2 = pList2->m_aabb_tri[size_t(ptr2->Ipos())];
-        ClothoidCurve const & C1 = pList1->get(T1.Icurve());
-        ClothoidCurve const & C2 = pList2->get(T2.Icurve());
-        real_type             ss1, ss2;
-        return C1.aabb_intersect_ISO(T1, m_offs1, &C2, T2, m_offs2, ss1, ss2);
-      }
-    };
-#endif
+    // the segments as clothoid curves, built on demand by `get`
+    mutable SnapshotSlot<vector<ClothoidCurve>> m_curves;
+
+    PtrTriangleCover aabb_ISO(real_type offs) const;
 
-    void resetLastInterval() { *m_lastInterval.search(std::this_thread::get_id()) = 0; }
+    template <typename FUN>
+    void walk_sorted(int_type n, real_type const * s, FUN const & fun) const;
 
     int_type closest_point_internal(
         real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const;
 
+    int_type closest_point_segment(
+        TriangleCover const & TC,
+        int_type              i,
+        real_type             qx,
+        real_type             qy,
+        real_type &           x,
+        real_type &           y,
+        real_type &           s,
+        real_type &           t,
+        real_type &           DST) const;
+
    public:
 #include "BaseCurve_using.hxx"
 
     //!
     //! Build an empty clothoid list
     //!
-    ClothoidList() : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-      this->resetLastInterval();
-    }
+    ClothoidList() : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {}
 
     ~ClothoidList() override {
       m_s0.clear();
       m_clotoidList.clear();
-      m_aabb_tri.clear();
+      m_aabb.clear();
     }
 
     //!
     //! Build a copy of an existing clothoid list
     //!
-    ClothoidList(ClothoidList const & s)
-        : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-      this->resetLastInterval();
-      copy(s);
-    }
+    ClothoidList(ClothoidList const & s) : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) { copy(s); }
 
     //!
     //! Initialize the clothoid list
@@ -1083,7 +1068,10 @@ namespace G2lib {
     }
 
     //!
-    //! Get the `idx`-th clothoid of the list
+    //! Get the `idx`-th clothoid of the list. The segments are stored by
+    //! parameters: the first call builds the clothoids of all the segments,
+    //! the reference is valid until the list is modified.
+    //! Use `segment` to build only the one needed.
     //!
     ClothoidCurve const & get(int_type idx) const;
 
@@ -1092,11 +1080,43 @@ namespace G2lib {
     //!
     ClothoidCurve const & getAtS(real_type s) const;
 
+    //!
+    //! The `idx`-th clothoid of the list built from its parameters and
+    //! returned by value.
+    //!
+    ClothoidCurve segment(int_type idx) const;
+
+    //!
+    //! The clothoid of the list at parameter `s` returned by value.
+    //!
+    ClothoidCurve segmentAtS(real_type s) const { return this->segment(this->findAtS(s)); }
+
     //!
     //! Return the numbber of clothoid of the list
     //!
     int_type num_segments() const { return int_type(m_clotoidList.size()); }
 
+    //!
+    //! Fresnel kernel used to evaluate the segments of the list.
+    //!
+    FresnelMode fresnel_mode() const { return m_clotoidList.fresnel_mode(); }
+
+    //!
+    //! Select the Fresnel kernel used to evaluate all the segments of the list
+    //! (`G2LIB_FRESNEL_GLOBAL` follows the global setting). The kernel is one
+    //! for the whole list, the mode of the appended curves is not kept.
+    //!
+    void fresnel_mode(FresnelMode mode) {
+      m_clotoidList.fresnel_mode(mode);
+      m_curves.clear();
+    }
+
+    //!
+    //! The segments of the list stored by parameters, converted with
+    //! `ClothoidSoAT<float>( segments() )` to sample them in single precision.
+    //!
+    ClothoidSoA const & segments() const { return m_clotoidList; }
+
     //!
     //! The list of clothoid has total length \f$ L \f$
     //! the parameter \f$ s \f$ us recomputed as \f$ s+kL\f$ in such a way
@@ -1109,6 +1129,24 @@ namespace G2lib {
     //!
     int_type findAtS(real_type & s) const;
 
+    //!
+    //! As `findAtS(s)` but starting the search from, and updating, the
+    //! caller-owned `cursor` instead of the per-thread hint of the list.
+    //!
+    int_type findAtS(real_type & s, SegmentCursor & cursor) const;
+
+    //!
+    //! Evaluate at `s` using the caller-owned `cursor` for the segment lookup
+    //! (see `SegmentCursor`), values are the same of `eval`, `eval_ISO`
+    //! and `evaluate`.
+    //!
+    void eval(real_type s, SegmentCursor & cursor, real_type & x, real_type & y) const;
+
+    void eval_ISO(real_type s, real_type offs, SegmentCursor & cursor, real_type & x, real_type & y) const;
+
+    void evaluate(
+        real_type s, SegmentCursor & cursor, real_type & th, real_type & k, real_type & x, real_type & y) const;
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     real_type length() const override;
@@ -1160,12 +1198,68 @@ namespace G2lib {
     }
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-    void build_AABBtree_ISO(
+    PtrTriangleCover build_AABBtree_ISO(
         real_type offs,
         real_type max_angle = Utils::m_pi / 6,  // 30 degree
         real_type max_size  = 1e100) const;
 #endif
 
+    //!
+    //! Build in advance the triangle cover and the AABB tree used by
+    //! collision, intersection and closest point queries at offset `offs`,
+    //! e.g. right after loading a shared read-only track, so that the
+    //! threads querying the track only read the published cover.
+    //!
+    //! \param[in] offs      curve offset
+    //! \param[in] max_angle maximum angle variation of the arc covered by a triangle
+    //! \param[in] max_size  maximum admissible size of the covering triangles
+    //!
+    void prepare(real_type offs = 0, real_type max_angle = Utils::m_pi / 6, real_type max_size = 1e100) const {
+      this->build_AABBtree_ISO(offs, max_angle, max_size);
+    }
+
+    //!
+    //! Cache of the triangle covers used by the queries (one per offset,
+    //! LRU): read its size, capacity and hit/miss counters.
+    //!
+    TriangleCoverCache const & aabb_cache() const { return m_aabb; }
+
+    //! Set the maximum number of triangle covers cached, the least recently used are dropped.
+    void aabb_set_capacity(size_t capacity) { m_aabb.set_capacity(capacity); }
+
+    //! Reset the hit/miss counters of the cache of the triangle covers.
+    void aabb_reset_counters() { m_aabb.reset_counters(); }
+
+    //!
+    //! Hash of the segments of the list, the key of the saved covers
+    //!
+    std::uint64_t geometry_hash() const;
+
+    //!
+    //! Save in binary form the triangle covers and the AABB trees built so
+    //! far (see `prepare`), so that a later run on the same curve can load
+    //! them with `load_aabb` instead of building them again.
+    //!
+    //! \param[in] stream binary output stream
+    //!
+    void save_aabb(ostream_type & stream) const;
+
+    //!
+    //! Load the covers saved by `save_aabb` in the cache of the curve. They
+    //! are rejected (nothing changes and false is returned) when saved for
+    //! another geometry (`geometry_hash`) or when the data is corrupted.
+    //!
+    //! \param[in] stream binary input stream, the data is read with a single read
+    //! \return true if the covers were loaded
+    //!
+    bool load_aabb(istream_type & stream) const;
+
+    //!
+    //! Same as the `load_aabb` above from the memory block `[data,data+size)`,
+    //! e.g. a mapped file.
+    //!
+    bool load_aabb(void const * data, size_t size) const;
+
     /*\
      |   _     _
      |  | |__ | |__   _____  __
@@ -1190,41 +1284,41 @@ namespace G2lib {
      |              |___/
     \*/
 
-    real_type theta_begin() const override { return m_clotoidList.front().theta_begin(); }
+    real_type theta_begin() const override { return m_clotoidList.data(0).theta0; }
 
-    real_type theta_end() const override { return m_clotoidList.back().theta_end(); }
+    real_type theta_end() const override { return back_data().theta(back_length()); }
 
-    real_type x_begin() const override { return m_clotoidList.front().x_begin(); }
+    real_type x_begin() const override { return m_clotoidList.data(0).x0; }
 
-    real_type y_begin() const override { return m_clotoidList.front().y_begin(); }
+    real_type y_begin() const override { return m_clotoidList.data(0).y0; }
 
-    real_type x_end() const override { return m_clotoidList.back().x_end(); }
+    real_type x_end() const override { return back_data().X(back_length()); }
 
-    real_type y_end() const override { return m_clotoidList.back().y_end(); }
+    real_type y_end() const override { return back_data().Y(back_length()); }
 
-    real_type x_begin_ISO(real_type offs) const override { return m_clotoidList.front().x_begin_ISO(offs); }
+    real_type x_begin_ISO(real_type offs) const override { return m_clotoidList.data(0).X_ISO(0, offs); }
 
-    real_type y_begin_ISO(real_type offs) const override { return m_clotoidList.front().y_begin_ISO(offs); }
+    real_type y_begin_ISO(real_type offs) const override { return m_clotoidList.data(0).Y_ISO(0, offs); }
 
-    real_type x_end_ISO(real_type offs) const override { return m_clotoidList.back().x_end_ISO(offs); }
+    real_type x_end_ISO(real_type offs) const override { return back_data().X_ISO(back_length(), offs); }
 
-    real_type y_end_ISO(real_type offs) const override { return m_clotoidList.back().y_end_ISO(offs); }
+    real_type y_end_ISO(real_type offs) const override { return back_data().Y_ISO(back_length(), offs); }
 
-    real_type tx_Begin() const override { return m_clotoidList.front().tx_Begin(); }
+    real_type tx_Begin() const override { return m_clotoidList.data(0).tg0_x(); }
 
-    real_type ty_Begin() const override { return m_clotoidList.front().ty_Begin(); }
+    real_type ty_Begin() const override { return m_clotoidList.data(0).tg0_y(); }
 
-    real_type tx_End() const override { return m_clotoidList.back().tx_End(); }
+    real_type tx_End() const override { return back_data().tg_x(back_length()); }
 
-    real_type ty_End() const override { return m_clotoidList.back().ty_End(); }
+    real_type ty_End() const override { return back_data().tg_y(back_length()); }
 
-    real_type nx_Begin_ISO() const override { return m_clotoidList.front().nx_Begin_ISO(); }
+    real_type nx_Begin_ISO() const override { return m_clotoidList.data(0).nor0_x_ISO(); }
 
-    real_type ny_Begin_ISO() const override { return m_clotoidList.front().ny_Begin_ISO(); }
+    real_type ny_Begin_ISO() const override { return m_clotoidList.data(0).nor0_y_ISO(); }
 
-    real_type nx_End_ISO() const override { return m_clotoidList.back().nx_End_ISO(); }
+    real_type nx_End_ISO() const override { return -back_data().tg_y(back_length()); }
 
-    real_type ny_End_ISO() const override { return m_clotoidList.back().ny_End_ISO(); }
+    real_type ny_End_ISO() const override { return back_data().tg_x(back_length()); }
 
     /*\
      |  _   _          _
@@ -1323,6 +1417,63 @@ namespace G2lib {
 
     void eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const override;
 
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    void eval(int_type n, real_type const * s, real_type * x, real_type * y) const override;
+
+    void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const override;
+
+    void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const override;
+
+    /*\
+     |                  _           _
+     |   ___  ___  _ __| |_ ___  __| |
+     |  / __|/ _ \| '__| __/ _ \/ _` |
+     |  \__ \ (_) | |  | ||  __/ (_| |
+     |  |___/\___/|_|   \__\___|\__,_|
+    \*/
+
+    //!
+    //! Evaluate the list at the `n` nondecreasing curvilinear coordinates
+    //! `s[0..n-1]` walking segments and samples together in a single pass,
+    //! without interval search and without touching the per-thread cursor.
+    //! On a closed curve the coordinates are wrapped in range and the walk
+    //! restarts from the first segment at every lap. Unsorted input gives
+    //! the same values but degrades to a restart for each descending sample.
+    //! Output arrays must not overlap `s`.
+    //!
+    //! \param[in]  n number of points
+    //! \param[in]  s curvilinear coordinates
+    //! \param[out] x x-coordinates
+    //! \param[out] y y-coordinates
+    //!
+    void eval_sorted(int_type n, real_type const * s, real_type * x, real_type * y) const;
+
+    void eval_D_sorted(int_type n, real_type const * s, real_type * x_D, real_type * y_D) const;
+
+    void eval_DD_sorted(int_type n, real_type const * s, real_type * x_DD, real_type * y_DD) const;
+
+    void eval_DDD_sorted(int_type n, real_type const * s, real_type * x_DDD, real_type * y_DDD) const;
+
+    //!
+    //! As `eval_sorted` with offset `offs` (ISO)
+    //!
+    void eval_ISO_sorted(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const;
+
+    void eval_ISO_D_sorted(int_type n, real_type const * s, real_type offs, real_type * x_D, real_type * y_D) const;
+
+    void eval_ISO_DD_sorted(int_type n, real_type const * s, real_type offs, real_type * x_DD, real_type * y_DD) const;
+
+    void eval_ISO_DDD_sorted(
+        int_type n, real_type const * s, real_type offs, real_type * x_DDD, real_type * y_DDD) const;
+
+    //!
+    //! As `eval_sorted` returning also angle and curvature
+    //!
+    void evaluate_sorted(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const;
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -1399,6 +1550,95 @@ namespace G2lib {
     //!
     int_type closest_segment(real_type qx, real_type qy) const;
 
+    //!
+    //! Segments at distance not greater than `r` from the point `(qx,qy)`.
+    //!
+    //! \param[in]  qx   x-coordinate of the point
+    //! \param[in]  qy   y-coordinate of the point
+    //! \param[in]  offs offset of the curve
+    //! \param[in]  r    radius of the search
+    //! \param[out] out  segment, abscissa of the closest point and exact distance,
+    //!                  sorted by increasing distance (cleared first, its capacity is reused)
+    //!
+    void query_radius_ISO(
+        real_type qx, real_type qy, real_type offs, real_type r, vector<SegmentDistance> & out) const;
+
+    //!
+    //! Segments at distance not greater than `r` from the point `(qx,qy)`.
+    //!
+    void query_radius(real_type qx, real_type qy, real_type r, vector<SegmentDistance> & out) const {
+      query_radius_ISO(qx, qy, 0, r, out);
+    }
+
+    //!
+    //! The `k` segments nearest to the point `(qx,qy)`.
+    //!
+    //! \param[in]  qx   x-coordinate of the point
+    //! \param[in]  qy   y-coordinate of the point
+    //! \param[in]  offs offset of the curve
+    //! \param[in]  k    number of segments
+    //! \param[out] out  segment, abscissa of the closest point and exact distance,
+    //!                  sorted by increasing distance (cleared first, its capacity is reused)
+    //!
+    void knn_ISO(real_type qx, real_type qy, real_type offs, int_type k, vector<SegmentDistance> & out) const;
+
+    //!
+    //! The `k` segments nearest to the point `(qx,qy)`.
+    //!
+    void knn(real_type qx, real_type qy, int_type k, vector<SegmentDistance> & out) const {
+      knn_ISO(qx, qy, 0, k, out);
+    }
+
+    //!
+    //! First hit of the ray `(x0,y0) + t (dx,dy)` with the curve with offset (ISO).
+    //!
+    //! \param[in]  x0     x-coordinate of the origin of the ray
+    //! \param[in]  y0     y-coordinate of the origin of the ray
+    //! \param[in]  dx     x-component of the direction of the ray
+    //! \param[in]  dy     y-component of the direction of the ray
+    //! \param[in]  offs   offset of the curve
+    //! \param[in]  tmax   maximum range of the ray
+    //! \param[out] t      distance of the hit from the origin
+    //! \param[out] s      curvilinear abscissa of the hit
+    //! \param[out] icurve segment hit
+    //! \return true if the ray hits the curve within `tmax`
+    //!
+    bool raycast_ISO(
+        real_type   x0,
+        real_type   y0,
+        real_type   dx,
+        real_type   dy,
+        real_type   offs,
+        real_type   tmax,
+        real_type & t,
+        real_type & s,
+        int_type &  icurve) const;
+
+    //!
+    //! First hit of `n` rays with the curve with offset (ISO), see the single
+    //! ray version. A ray with no hit gets `icurve = -1`, `t = infinity`, `s = 0`.
+    //!
+    void raycast_ISO(
+        int_type          n,
+        real_type const * x0,
+        real_type const * y0,
+        real_type const * dx,
+        real_type const * dy,
+        real_type         offs,
+        real_type         tmax,
+        real_type *       t,
+        real_type *       s,
+        int_type *        icurve) const;
+
+    //!
+    //! First hit of the ray `(x0,y0) + t (dx,dy)` with the curve.
+    //!
+    bool raycast(
+        real_type x0, real_type y0, real_type dx, real_type dy, real_type tmax, real_type & t, real_type & s,
+        int_type & icurve) const {
+      return raycast_ISO(x0, y0, dx, dy, 0, tmax, t, s, icurve);
+    }
+
     //!
     //! \param  qx           x-coordinate of the point
     //! \param  qy           y-coordinate of the point
@@ -1692,6 +1932,174 @@ namespace G2lib {
     void load(istream_type & stream, real_type epsi = 1e-8);
   };
 
+  /*\
+   |   ____ _       _   _           _     _ _     _     _  _____
+   |  / ___| | ___ | |_| |__   ___ (_) __| | |   (_)___| ||_   _|
+   | | |   | |/ _ \| __| '_ \ / _ \| |/ _` | |   | / __| __|| |
+   | | |___| | (_) | |_| | | | (_) | | (_| | |___| \__ \ |_ | |
+   |  \____|_|\___/ \__|_| |_|\___/|_|\__,_|_____|_|___/\__||_|
+   |
+  \*/
+  //!
+  //! Non-virtual core of a list of clothoids, templated on the scalar
+  //! type: the segments (`ClothoidSoAT`) and their initial abscissae, with
+  //! the evaluations and the triangle covers. `ClothoidList` builds its
+  //! covers and refines its collisions and intersections with the static
+  //! functions of the `real_type` core, the `float` core
+  //! (`ClothoidListT<float>( L )`) does the same in single precision.
+  //!
+  //! The abscissae out of `[0,length()]` are evaluated on the first and on
+  //! the last segment. The core keeps no cache: `build_AABBtree_ISO` builds
+  //! a new cover at every call, `collision_ISO` and `intersect_ISO` build
+  //! the two covers they use.
+  //!
+  template <typename T>
+  class ClothoidListT {
+    ClothoidSoAT<T> m_segments;
+    vector<T>       m_s0;  // initial abscissa of the segments, then the length
+
+    template <typename U>
+    friend class ClothoidListT;
+
+    void init_s0();
+
+    // segment of `s`, `s` becomes the abscissa on the segment
+    size_t find_at_s(T & s) const;
+
+    // calls `fun(CD,i0,m,ss)` on the runs `s[i0..i0+m-1]` on the same segment, `ss` the abscissae on it
+    template <typename FUN>
+    void walk(int_type n, T const * s, FUN const & fun) const;
+
+   public:
+    using PtrCover      = shared_ptr<TriangleCoverT<T> const>;
+    using IntersectList = vector<pair<T, T>>;
+
+    ClothoidListT() = default;
+
+    //! List of the segments `S` converted to the scalar type `T`.
+    template <typename U>
+    explicit ClothoidListT(ClothoidSoAT<U> const & S) : m_segments(S) {
+      this->init_s0();
+    }
+
+    //! Copy of the segments of `L` converted to the scalar type `T`.
+    explicit ClothoidListT(ClothoidList const & L);
+
+    //! Append the segment `C`.
+    void push_back(ClothoidCurveT<T> const & C);
+
+    int_type                num_segments() const { return int_type(m_segments.size()); }  //!< number of segments
+    ClothoidSoAT<T> const & segments() const { return m_segments; }                      //!< the segments
+    T                       length() const { return m_s0.empty() ? 0 : m_s0.back(); }    //!< length of the list
+
+    //! The segment `i`.
+    ClothoidCurveT<T> segment(int_type i) const {
+      return ClothoidCurveT<T>(m_segments.data(size_t(i)), m_segments.length(size_t(i)));
+    }
+
+    //!
+    //! \name Evaluation
+    //! The batched versions take the abscissae `s[0..n-1]` (the output
+    //! arrays must not overlap `s`) and evaluate every run of abscissae on
+    //! the same segment in one batch, see `ClothoidDataT`.
+    //!
+    ///@{
+    void eval(T s, T & x, T & y) const;
+    void eval_ISO(T s, T offs, T & x, T & y) const;
+    void evaluate(T s, T & theta, T & kappa, T & x, T & y) const;
+
+    void eval(int_type n, T const * s, T * x, T * y) const;
+    void eval_ISO(int_type n, T const * s, T offs, T * x, T * y) const;
+    void evaluate(int_type n, T const * s, T * theta, T * kappa, T * x, T * y) const;
+    ///@}
+
+    //!
+    //! Triangles covering the segments `S` at offset `offs`, the triangles
+    //! of the segment `i` have `Icurve() == icurve + i`.
+    //!
+    static void bbTriangles_ISO(
+        ClothoidSoAT<T> const &  S,
+        T                        offs,
+        vector<Triangle2DT<T>> & tvec,
+        T                        max_angle,
+        T                        max_size,
+        int_type                 icurve);
+
+    //!
+    //! Triangle cover of the segments `S` and its AABB tree at offset
+    //! `offs`, the triangles are clipped when `aabb_clip_triangles` is set.
+    //!
+    static PtrCover build_AABBtree_ISO(ClothoidSoAT<T> const & S, T offs, T max_angle, T max_size);
+
+    //!
+    //! Check if the segments `S1` covered by `TC1` at offset `offs1`
+    //! collide with the segments `S2` covered by `TC2` at offset `offs2`,
+    //! see `ClothoidCurveT::aabb_intersect_ISO` for `max_iter` and `tolerance`.
+    //!
+    static bool collision_ISO(
+        ClothoidSoAT<T> const &   S1,
+        TriangleCoverT<T> const & TC1,
+        T                         offs1,
+        ClothoidSoAT<T> const &   S2,
+        TriangleCoverT<T> const & TC2,
+        T                         offs2,
+        int_type                  max_iter,
+        T                         tolerance);
+
+    //!
+    //! Intersections of the segments `S1` (initial abscissae `s01`)
+    //! covered by `TC1` at offset `offs1` with the segments `S2` (initial
+    //! abscissae `s02`) covered by `TC2` at offset `offs2`. The pairs of
+    //! triangles are found and refined on `nthreads` threads, the pairs of
+    //! abscissae are appended to `ilist` sorted, so that the result does not
+    //! depend on the number of threads.
+    //!
+    static void intersect_ISO(
+        ClothoidSoAT<T> const &   S1,
+        vector<T> const &         s01,
+        TriangleCoverT<T> const & TC1,
+        T                         offs1,
+        ClothoidSoAT<T> const &   S2,
+        vector<T> const &         s02,
+        TriangleCoverT<T> const & TC2,
+        T                         offs2,
+        int_type                  max_iter,
+        T                         tolerance,
+        int_type                  nthreads,
+        IntersectList &           ilist,
+        bool                      swap_s_vals);
+
+    void bbTriangles_ISO(
+        T                        offs,
+        vector<Triangle2DT<T>> & tvec,
+        T                        max_angle = T(Utils::m_pi / 6),  // 30 degree
+        T                        max_size  = std::numeric_limits<T>::max(),
+        int_type                 icurve    = 0) const {
+      bbTriangles_ISO(m_segments, offs, tvec, max_angle, max_size, icurve);
+    }
+
+    //! See the static `build_AABBtree_ISO`.
+    PtrCover build_AABBtree_ISO(
+        T offs,
+        T max_angle = T(Utils::m_pi / 18),  // 10 degree
+        T max_size  = std::numeric_limits<T>::max()) const {
+      return build_AABBtree_ISO(m_segments, offs, max_angle, max_size);
+    }
+
+    //! Check if the list at offset `offs` collides with `L` at offset `offs_L`.
+    bool collision_ISO(T offs, ClothoidListT const & L, T offs_L) const;
+
+    //!
+    //! Intersections of the list at offset `offs` with `L` at offset
+    //! `offs_L`, the pairs of abscissae `(s,s_L)` are appended to `ilist`
+    //! (on `aabb_intersect_threads` threads, see `threadsIntersectAABBtree`).
+    //!
+    void intersect_ISO(T offs, ClothoidListT const & L, T offs_L, IntersectList & ilist) const;
+  };
+
+  extern template class ClothoidListT<float>;
+  extern template class ClothoidListT<double>;
+
   /*\
    |
    |    ___ _     _   _        _    _ ___      _ _           ___ ___
@@ -0,0 +1,195 @@
+/** * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * @file ClothoidStepper.hxx
+ * @author Matteo Ragni (info@ragni.me)
+ *
+ * @copyright Copyright (c) 2022 Matteo Ragni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Based on the work of:
+ * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#pragma once
+#include "Clothoid.hxx"
+#include "ClothoidList.hxx"
+
+namespace G2lib {
+
+  using std::vector;
+
+  /*\
+   |   ____  _
+   |  / ___|| |_ ___ _ __  _ __   ___ _ __
+   |  \___ \| __/ _ \ '_ \| '_ \ / _ \ '__|
+   |   ___) | ||  __/ |_) | |_) |  __/ |
+   |  |____/ \__\___| .__/| .__/ \___|_|
+   |                |_|   |_|
+  \*/
+
+  //!
+  //! Fixed step marching evaluator of a clothoid curve.
+  //!
+  //! Visit the points \f$ s_k = k\,ds \f$ with \f$ s_k < L \f$ and then the
+  //! final point \f$ s = L \f$. Instead of computing the Fresnel integrals
+  //! from \f$ s=0 \f$ at each point, the chord of each step is expanded
+  //! locally around the previous point with a 4 points Gauss-Legendre rule
+  //!
+  //! \f[ P(s+h) = P(s) + h\sum_{j=1}^4 w_j\,\mathbf{t}(s+u_j h) \f]
+  //!
+  //! Since \f$ \theta(s) \f$ is quadratic, the unit tangents
+  //! \f$ \mathbf{t}(s+u_j h) \f$ at the nodes are advanced from one step to
+  //! the next by complex products (the rotation angle changes by the constant
+  //! \f$ \kappa' h^2 \f$), so no trigonometric function is evaluated along
+  //! the march. Every `reanchor` steps, at the last (shortened) step and when
+  //! the step angle \f$ |\kappa| h \f$ exceeds 0.25, the point is
+  //! recomputed exactly.
+  //!
+  //! **Accuracy:** the quadrature error of a step is below
+  //! \f$ 6\cdot 10^{-10}\,h\,(|\kappa| h)^8 \f$, to which the round-off
+  //! accumulated between two anchors is added. With the default
+  //! `reanchor = 64` the distance from the exact point is below
+  //! \f$ 10^{-12}\,(1+|offs|+L) \f$.
+  //!
+  //! \code{.cpp}
+  //! for ( ClothoidStepper st( C, ds ); !st.end(); st.next() )
+  //!   std::cout << st.s() << ' ' << st.x() << ' ' << st.y() << '\n';
+  //! \endcode
+  //!
+  class ClothoidStepper {
+    ClothoidData m_CD;
+    real_type    m_L;
+    real_type    m_ds;
+    real_type    m_offs;
+    int_type     m_reanchor;
+    int_type     m_nstep;  // steps since the last exact evaluation
+    int_type     m_k;      // index of the current sample
+    bool         m_end;
+    bool         m_exact;  // step angle too large, evaluate every point
+
+    real_type m_s;
+    real_type m_x;
+    real_type m_y;
+
+    // unit tangent at the point (index 0) and at the quadrature nodes
+    // of the next step, with their rotation per step
+    real_type m_tx[5], m_ty[5];
+    real_type m_rx[5], m_ry[5];
+    real_type m_qx, m_qy;  // rotation of the rotations: exp(i*dk*ds^2)
+
+    friend class ClothoidListStepper;
+
+    ClothoidStepper(real_type offs, int_type reanchor);
+
+    void setup(ClothoidCurve const & C);
+    void anchor(real_type s);
+    void advance(real_type h);
+
+   public:
+    ClothoidStepper() = delete;
+
+    //!
+    //! Build the stepper and place it at \f$ s=0 \f$
+    //!
+    //! \param C        the clothoid curve to walk
+    //! \param ds       sampling step (positive)
+    //! \param offs     ISO offset of the sampled points
+    //! \param reanchor number of incremental steps between exact evaluations
+    //!
+    ClothoidStepper(ClothoidCurve const & C, real_type ds, real_type offs = 0, int_type reanchor = 64);
+
+    //!
+    //! True when all the points have been visited
+    //!
+    bool end() const { return m_end; }
+
+    //!
+    //! Move to the next sample point
+    //!
+    void next();
+
+    real_type s() const { return m_s; }                      //!< curvilinear coordinate of the current point
+    real_type x() const { return m_x - m_offs * m_ty[0]; }   //!< \f$ x \f$ coordinate (with offset)
+    real_type y() const { return m_y + m_offs * m_tx[0]; }   //!< \f$ y \f$ coordinate (with offset)
+    real_type theta() const { return m_CD.theta(m_s); }      //!< tangent angle
+    real_type kappa() const { return m_CD.kappa(m_s); }      //!< curvature
+    real_type tx() const { return m_tx[0]; }                 //!< \f$ x \f$ component of the unit tangent
+    real_type ty() const { return m_ty[0]; }                 //!< \f$ y \f$ component of the unit tangent
+    real_type nx_ISO() const { return -m_ty[0]; }            //!< \f$ x \f$ component of the unit normal
+    real_type ny_ISO() const { return m_tx[0]; }             //!< \f$ y \f$ component of the unit normal
+  };
+
+  //!
+  //! Fixed step marching evaluator of a clothoid list.
+  //!
+  //! Visit the points \f$ s_k = k\,ds \f$ with \f$ s_k < L \f$ and then the
+  //! final point \f$ s = L \f$ of the whole list, using `ClothoidStepper`
+  //! inside each segment. Crossing a segment boundary restarts the march
+  //! with an exact evaluation in the new segment.
+  //!
+  class ClothoidListStepper {
+    ClothoidList const * m_list;
+    vector<real_type>    m_s0;
+    ClothoidStepper      m_seg;
+    real_type            m_L;
+    real_type            m_ds;
+    int_type             m_icurve;
+    int_type             m_k;
+    real_type            m_s;
+    bool                 m_end;
+
+   public:
+    ClothoidListStepper() = delete;
+
+    //!
+    //! Build the stepper and place it at \f$ s=0 \f$
+    //!
+    //! \param CL       the clothoid list to walk (must outlive the stepper)
+    //! \param ds       sampling step (positive)
+    //! \param offs     ISO offset of the sampled points
+    //! \param reanchor number of incremental steps between exact evaluations
+    //!
+    ClothoidListStepper(ClothoidList const & CL, real_type ds, real_type offs = 0, int_type reanchor = 64);
+
+    //!
+    //! True when all the points have been visited
+    //!
+    bool end() const { return m_end; }
+
+    //!
+    //! Move to the next sample point
+    //!
+    void next();
+
+    real_type s() const { return m_s; }                //!< curvilinear coordinate of the current point
+    int_type  icurve() const { return m_icurve; }      //!< segment containing the current point
+    real_type x() const { return m_seg.x(); }          //!< \f$ x \f$ coordinate (with offset)
+    real_type y() const { return m_seg.y(); }          //!< \f$ y \f$ coordinate (with offset)
+    real_type theta() const { return m_seg.theta(); }  //!< tangent angle
+    real_type kappa() const { return m_seg.kappa(); }  //!< curvature
+    real_type tx() const { return m_seg.tx(); }        //!< \f$ x \f$ component of the unit tangent
+    real_type ty() const { return m_seg.ty(); }        //!< \f$ y \f$ component of the unit tangent
+    real_type nx_ISO() const { return m_seg.nx_ISO(); }  //!< \f$ x \f$ component of the unit normal
+    real_type ny_ISO() const { return m_seg.ny_ISO(); }  //!< \f$ y \f$ component of the unit normal
+  };
+
+}  // namespace G2lib
+
+///
+/// eof: ClothoidStepper.hxx
+///
@@ -88,243 +88,413 @@ namespace G2lib {
   //!
   void GeneralizedFresnelCS(real_type a, real_type b, real_type c, real_type & intC, real_type & intS);
 
+  //!
+  //! Compute the Fresnel integrals for `n` independent triples \f$ (a_i,b_i,c_i) \f$
+  //!
+  //! \f[
+  //!   \int_0^1 \cos\left(a_i\frac{t^2}{2} + b_i t + c_i\right) dt,\qquad
+  //!   \int_0^1 \sin\left(a_i\frac{t^2}{2} + b_i t + c_i\right) dt
+  //! \f]
+  //!
+  //! The triples are processed in blocks: the series, the rational and
+  //! asymptotic approximations and sin/cos run over contiguous arrays
+  //! (with runtime selection of the instruction set when the library is
+  //! built with `CLOTHOIDS_ENABLE_SIMD_DISPATCH`). Every instruction set
+  //! gives the same results. They agree with `n` calls of the scalar
+  //! version up to rounding, because sin/cos do not come from libm: the
+  //! difference stays below `1e-12` in double and `1e-5` in float where
+  //! the scalar evaluation is well conditioned (\f$ |b_i| \le 10 \f$),
+  //! see `tests/testFresnel.cc`.
+  //!
+  //! \param n      number of triples
+  //! \param a      array of parameters \f$ a_i \f$
+  //! \param b      array of parameters \f$ b_i \f$
+  //! \param c      array of parameters \f$ c_i \f$
+  //! \param intC   output array of cosine integrals
+  //! \param intS   output array of sine integrals
+  //!
+  void GeneralizedFresnelCS(
+      int_type          n,
+      real_type const * a,
+      real_type const * b,
+      real_type const * c,
+      real_type *       intC,
+      real_type *       intS);
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // Single and double precision versions of the kernels above, both are
+  // compiled in the library whatever `real_type` is. The `float` versions
+  // iterate the series up to single precision accuracy.
+  //
+  void FresnelCS(float x, float & C, float & S);
+  void FresnelCS(double x, double & C, double & S);
+  void FresnelCS(int_type nk, float x, float * C, float * S);
+  void FresnelCS(int_type nk, double x, double * C, double * S);
+  void GeneralizedFresnelCS(int_type nk, float a, float b, float c, float * intC, float * intS);
+  void GeneralizedFresnelCS(int_type nk, double a, double b, double c, double * intC, double * intS);
+  void GeneralizedFresnelCS(float a, float b, float c, float & intC, float & intS);
+  void GeneralizedFresnelCS(double a, double b, double c, double & intC, double & intS);
+  void GeneralizedFresnelCS(
+      int_type n, float const * a, float const * b, float const * c, float * intC, float * intS);
+  void GeneralizedFresnelCS(
+      int_type n, double const * a, double const * b, double const * c, double * intC, double * intS);
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //!
+  //! Kernel used to evaluate the Fresnel integrals of a clothoid
+  //!
+  typedef enum {
+    G2LIB_FRESNEL_GLOBAL = 0,  //!< use the global setting `fresnel_mode`
+    G2LIB_FRESNEL_EXACT,       //!< full accuracy kernel
+    G2LIB_FRESNEL_APPROX       //!< tabulated kernel, see `fresnel_approx_tolerance`
+  } FresnelMode;
+
+  extern FresnelMode fresnel_mode;
+
+  //!
+  //! Use the full accuracy Fresnel kernel by default (initial setting)
+  //!
+  static inline void exactFresnel() { fresnel_mode = G2LIB_FRESNEL_EXACT; }
+
+  //!
+  //! Use the approximate Fresnel kernel by default
+  //!
+  static inline void approxFresnel() { fresnel_mode = G2LIB_FRESNEL_APPROX; }
+
+  //!
+  //! Set the error bound of the approximate Fresnel kernel (default `1e-9`)
+  //! and rebuild its tables. The bound holds for `FresnelCS_approx` and for
+  //! `GeneralizedFresnelCS` in `G2LIB_FRESNEL_APPROX` mode.
+  //! Must not be called concurrently with itself.
+  //!
+  //! \return `false` if the bound cannot be reached: the tables stop at
+  //!         their maximum size (or the small \f$ a \f$ series at its
+  //!         maximum length) and are used anyway, with the error given
+  //!         by `fresnel_approx_report`
+  //!
+  bool fresnel_approx_tolerance(real_type tol);
+
+  //!
+  //! Error bound of the approximate Fresnel kernel
+  //!
+  real_type fresnel_approx_tolerance();
+
+  //!
+  //! Compute the Fresnel integrals \f$ C(x) \f$ and \f$ S(x) \f$ using
+  //! piecewise Chebyshev interpolation on \f$ |x|<6 \f$
+  //! (the exact kernel is used outside).
+  //!
+  void FresnelCS_approx(real_type x, real_type & C, real_type & S);
+
+  //!
+  //! Compute the Fresnel integrals as `GeneralizedFresnelCS`
+  //! with the selected kernel
+  //!
+  void GeneralizedFresnelCS(
+      real_type   a,
+      real_type   b,
+      real_type   c,
+      real_type & intC,
+      real_type & intS,
+      FresnelMode mode);
+
+  //!
+  //! Single precision version of `GeneralizedFresnelCS` with the selected kernel
+  //! (the approximate kernel is evaluated in `double` and rounded)
+  //!
+  void GeneralizedFresnelCS(float a, float b, float c, float & intC, float & intS, FresnelMode mode);
+
+  //!
+  //! Accuracy of the approximate Fresnel kernel against the exact one
+  //!
+  struct FresnelApproxReport {
+    real_type tolerance;      //!< requested error bound
+    real_type table_error;    //!< max error measured when building the tables
+    bool      tolerance_met;  //!< false if the tables could not reach the requested bound
+    real_type max_error_CS;   //!< max error of `FresnelCS_approx` on the samples
+    real_type max_error_GCS;  //!< max error of `GeneralizedFresnelCS` (approx mode) on the samples
+    int_type  n_intervals;    //!< number of Chebyshev intervals on \f$ [0,6] \f$
+    int_type  degree;         //!< degree of the Chebyshev polynomials
+    int_type  series_size;    //!< terms of the small \f$ a \f$ series
+    int_type  n_samples;      //!< number of samples of each test
+  };
+
+  //!
+  //! Compare the approximate and the exact Fresnel kernels on
+  //! `n_samples` deterministic samples
+  //!
+  FresnelApproxReport fresnel_approx_report(int_type n_samples = 10000);
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
   //!
-  //! Data storage for clothoid type curve
+  //! Position, derivatives, angle, curvature and ISO normal of a clothoid
+  //! (with lateral offset) at a given curvilinear coordinate,
+  //! see `ClothoidData::eval_full`
+  //!
+  template <typename T>
+  struct ClothoidPointT {
+    T x, y;          //!< position
+    T x_D, y_D;      //!< first derivative of the position
+    T x_DD, y_DD;    //!< second derivative of the position
+    T x_DDD, y_DDD;  //!< third derivative of the position
+    T theta;         //!< angle of the tangent
+    T kappa;         //!< curvature of the reference curve (offset 0)
+    T nx, ny;        //!< unit normal (ISO)
+  };
+
+  //!
+  //! Data storage for clothoid type curve, templated on the scalar type.
+  //! The library provides the `float` and `double` instantiations,
+  //! `ClothoidData` is the `real_type` one.
   //!
-  class ClothoidData {
+  template <typename T>
+  class ClothoidDataT {
    public:
-    real_type x0;      //!< initial x coordinate of the clothoid
-    real_type y0;      //!< initial y coordinate of the clothoid
-    real_type theta0;  //!< initial angle of the clothoid
-    real_type kappa0;  //!< initial curvature
-    real_type dk;      //!< curvature derivative
+    T x0;      //!< initial x coordinate of the clothoid
+    T y0;      //!< initial y coordinate of the clothoid
+    T theta0;  //!< initial angle of the clothoid
+    T kappa0;  //!< initial curvature
+    T dk;      //!< curvature derivative
 
-    ClothoidData() : x0(0), y0(0), theta0(0), kappa0(0), dk(0) {}
+    FresnelMode fresnel;  //!< Fresnel kernel used in evaluation
 
-    real_type deltaTheta(real_type s) const { return s * (kappa0 + 0.5 * s * dk); }
+    ClothoidDataT() : x0(0), y0(0), theta0(0), kappa0(0), dk(0), fresnel(G2LIB_FRESNEL_GLOBAL) {}
+
+    //!
+    //! Generalized Fresnel integrals of the curve from 0 to `s` with the selected kernel
+    //!
+    void fresnelCS(T s, T & C, T & S) const {
+      GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S, fresnel);
+    }
+
+    T deltaTheta(T s) const { return s * (kappa0 + T(0.5) * s * dk); }
 
     //!
     //! Return angle at curvilinear coordinate `s`
     //!
-    real_type theta(real_type s) const { return theta0 + s * (kappa0 + 0.5 * s * dk); }
+    T theta(T s) const { return theta0 + s * (kappa0 + T(0.5) * s * dk); }
 
-    real_type theta_D(real_type s) const { return kappa0 + s * dk; }
-    real_type theta_DD(real_type) const { return dk; }
-    real_type theta_DDD(real_type) const { return 0; }
+    T theta_D(T s) const { return kappa0 + s * dk; }
+    T theta_DD(T) const { return dk; }
+    T theta_DDD(T) const { return 0; }
 
     //!
     //! Return curvature at curvilinear coordinate `s`
     //!
-    real_type kappa(real_type s) const { return kappa0 + s * dk; }
-    real_type kappa_D(real_type) const { return dk; }
-    real_type kappa_DD(real_type) const { return 0; }
-    real_type kappa_DDD(real_type) const { return 0; }
-
-    real_type X(real_type s) const;
-    real_type Y(real_type s) const;
-    real_type X_D(real_type s) const;
-    real_type Y_D(real_type s) const;
-    real_type X_DD(real_type s) const;
-    real_type Y_DD(real_type s) const;
-    real_type X_DDD(real_type s) const;
-    real_type Y_DDD(real_type s) const;
+    T kappa(T s) const { return kappa0 + s * dk; }
+    T kappa_D(T) const { return dk; }
+    T kappa_DD(T) const { return 0; }
+    T kappa_DDD(T) const { return 0; }
+
+    T X(T s) const;
+    T Y(T s) const;
+    T X_D(T s) const;
+    T Y_D(T s) const;
+    T X_DD(T s) const;
+    T Y_DD(T s) const;
+    T X_DDD(T s) const;
+    T Y_DDD(T s) const;
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    real_type X_ISO(real_type s, real_type offs) const;
-    real_type Y_ISO(real_type s, real_type offs) const;
-    real_type X_ISO_D(real_type s, real_type offs) const;
-    real_type Y_ISO_D(real_type s, real_type offs) const;
-    real_type X_ISO_DD(real_type s, real_type offs) const;
-    real_type Y_ISO_DD(real_type s, real_type offs) const;
-    real_type X_ISO_DDD(real_type s, real_type offs) const;
-    real_type Y_ISO_DDD(real_type s, real_type offs) const;
+    T X_ISO(T s, T offs) const;
+    T Y_ISO(T s, T offs) const;
+    T X_ISO_D(T s, T offs) const;
+    T Y_ISO_D(T s, T offs) const;
+    T X_ISO_DD(T s, T offs) const;
+    T Y_ISO_DD(T s, T offs) const;
+    T X_ISO_DDD(T s, T offs) const;
+    T Y_ISO_DDD(T s, T offs) const;
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    real_type X_SAE(real_type s, real_type offs) const;
-    real_type Y_SAE(real_type s, real_type offs) const;
-    real_type X_SAE_D(real_type s, real_type offs) const;
-    real_type Y_SAE_D(real_type s, real_type offs) const;
-    real_type X_SAE_DD(real_type s, real_type offs) const;
-    real_type Y_SAE_DD(real_type s, real_type offs) const;
-    real_type X_SAE_DDD(real_type s, real_type offs) const;
-    real_type Y_SAE_DDD(real_type s, real_type offs) const;
+    T X_SAE(T s, T offs) const;
+    T Y_SAE(T s, T offs) const;
+    T X_SAE_D(T s, T offs) const;
+    T Y_SAE_D(T s, T offs) const;
+    T X_SAE_DD(T s, T offs) const;
+    T Y_SAE_DD(T s, T offs) const;
+    T X_SAE_DDD(T s, T offs) const;
+    T Y_SAE_DDD(T s, T offs) const;
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    real_type tg0_x() const { return cos(this->theta0); }
-    real_type tg0_y() const { return sin(this->theta0); }
+    T tg0_x() const { return cos(this->theta0); }
+    T tg0_y() const { return sin(this->theta0); }
 
-    real_type tg_x(real_type s) const { return cos(this->theta(s)); }
-    real_type tg_y(real_type s) const { return sin(this->theta(s)); }
+    T tg_x(T s) const { return cos(this->theta(s)); }
+    T tg_y(T s) const { return sin(this->theta(s)); }
 
-    real_type tg_x_D(real_type s) const;
-    real_type tg_y_D(real_type s) const;
+    T tg_x_D(T s) const;
+    T tg_y_D(T s) const;
 
-    real_type tg_x_DD(real_type s) const;
-    real_type tg_y_DD(real_type s) const;
+    T tg_x_DD(T s) const;
+    T tg_y_DD(T s) const;
 
-    real_type tg_x_DDD(real_type s) const;
-    real_type tg_y_DDD(real_type s) const;
+    T tg_x_DDD(T s) const;
+    T tg_y_DDD(T s) const;
 
-    real_type nor0_x_ISO() const { return -this->tg0_y(); }
-    real_type nor0_y_ISO() const { return this->tg0_x(); }
+    T nor0_x_ISO() const { return -this->tg0_y(); }
+    T nor0_y_ISO() const { return this->tg0_x(); }
 
-    real_type nor_x_ISO(real_type s) const { return -this->tg_y(s); }
-    real_type nor_y_ISO(real_type s) const { return this->tg_x(s); }
+    T nor_x_ISO(T s) const { return -this->tg_y(s); }
+    T nor_y_ISO(T s) const { return this->tg_x(s); }
 
-    real_type nor_x_ISO_D(real_type s) const { return -this->tg_y_D(s); }
-    real_type nor_y_ISO_D(real_type s) const { return this->tg_x_D(s); }
+    T nor_x_ISO_D(T s) const { return -this->tg_y_D(s); }
+    T nor_y_ISO_D(T s) const { return this->tg_x_D(s); }
 
-    real_type nor_x_ISO_DD(real_type s) const { return -this->tg_y_DD(s); }
-    real_type nor_y_ISO_DD(real_type s) const { return this->tg_x_DD(s); }
+    T nor_x_ISO_DD(T s) const { return -this->tg_y_DD(s); }
+    T nor_y_ISO_DD(T s) const { return this->tg_x_DD(s); }
 
-    real_type nor_x_ISO_DDD(real_type s) const { return -this->tg_y_DDD(s); }
-    real_type nor_y_ISO_DDD(real_type s) const { return this->tg_x_DDD(s); }
+    T nor_x_ISO_DDD(T s) const { return -this->tg_y_DDD(s); }
+    T nor_y_ISO_DDD(T s) const { return this->tg_x_DDD(s); }
 
-    real_type nor0_x_SAE() const { return this->tg0_y(); }
-    real_type nor0_y_SAE() const { return -this->tg0_x(); }
+    T nor0_x_SAE() const { return this->tg0_y(); }
+    T nor0_y_SAE() const { return -this->tg0_x(); }
 
-    real_type nor_x_SAE(real_type s) const { return this->tg_y(s); }
-    real_type nor_y_SAE(real_type s) const { return -this->tg_x(s); }
+    T nor_x_SAE(T s) const { return this->tg_y(s); }
+    T nor_y_SAE(T s) const { return -this->tg_x(s); }
 
-    real_type nor_x_SAE_D(real_type s) const { return this->tg_y_D(s); }
-    real_type nor_y_SAE_D(real_type s) const { return -this->tg_x_D(s); }
+    T nor_x_SAE_D(T s) const { return this->tg_y_D(s); }
+    T nor_y_SAE_D(T s) const { return -this->tg_x_D(s); }
 
-    real_type nor_x_SAE_DD(real_type s) const { return this->tg_y_DD(s); }
-    real_type nor_y_SAE_DD(real_type s) const { return -this->tg_x_DD(s); }
+    T nor_x_SAE_DD(T s) const { return this->tg_y_DD(s); }
+    T nor_y_SAE_DD(T s) const { return -this->tg_x_DD(s); }
 
-    real_type nor_x_SAE_DDD(real_type s) const { return this->tg_y_DDD(s); }
-    real_type nor_y_SAE_DDD(real_type s) const { return -this->tg_x_DDD(s); }
+    T nor_x_SAE_DDD(T s) const { return this->tg_y_DDD(s); }
+    T nor_y_SAE_DDD(T s) const { return -this->tg_x_DDD(s); }
 
-    void tg(real_type s, real_type & tx, real_type & ty) const;
-    void tg_D(real_type s, real_type & tx, real_type & ty) const;
-    void tg_DD(real_type s, real_type & tx, real_type & ty) const;
-    void tg_DDD(real_type s, real_type & tx, real_type & ty) const;
+    void tg(T s, T & tx, T & ty) const;
+    void tg_D(T s, T & tx, T & ty) const;
+    void tg_DD(T s, T & tx, T & ty) const;
+    void tg_DDD(T s, T & tx, T & ty) const;
 
-    void nor_ISO(real_type s, real_type & nx, real_type & ny) const;
-    void nor_ISO_D(real_type s, real_type & nx_D, real_type & ny_D) const;
-    void nor_ISO_DD(real_type s, real_type & nx_DD, real_type & ny_DD) const;
-    void nor_ISO_DDD(real_type s, real_type & nx_DDD, real_type & ny_DDD) const;
+    void nor_ISO(T s, T & nx, T & ny) const;
+    void nor_ISO_D(T s, T & nx_D, T & ny_D) const;
+    void nor_ISO_DD(T s, T & nx_DD, T & ny_DD) const;
+    void nor_ISO_DDD(T s, T & nx_DDD, T & ny_DDD) const;
 
-    void nor_SAE(real_type s, real_type & nx, real_type & ny) const;
-    void nor_SAE_D(real_type s, real_type & nx_D, real_type & ny_D) const;
-    void nor_SAE_DD(real_type s, real_type & nx_DD, real_type & ny_DD) const;
-    void nor_SAE_DDD(real_type s, real_type & nx_DDD, real_type & ny_DDD) const;
+    void nor_SAE(T s, T & nx, T & ny) const;
+    void nor_SAE_D(T s, T & nx_D, T & ny_D) const;
+    void nor_SAE_DD(T s, T & nx_DD, T & ny_DD) const;
+    void nor_SAE_DDD(T s, T & nx_DDD, T & ny_DDD) const;
 
-    void evaluate(real_type s, real_type & theta, real_type & kappa, real_type & x, real_type & y) const;
+    void evaluate(T s, T & theta, T & kappa, T & x, T & y) const;
 
-    void eval(real_type s, real_type & x, real_type & y) const;
+    void eval(T s, T & x, T & y) const;
 
-    void eval_D(real_type s, real_type & x_D, real_type & y_D) const;
+    void eval_D(T s, T & x_D, T & y_D) const;
 
-    void eval_DD(real_type s, real_type & x_DD, real_type & y_DD) const;
+    void eval_DD(T s, T & x_DD, T & y_DD) const;
 
-    void eval_DDD(real_type s, real_type & x_DDD, real_type & y_DDD) const;
+    void eval_DDD(T s, T & x_DDD, T & y_DDD) const;
 
-    void eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const;
+    void eval_ISO(T s, T offs, T & x, T & y) const;
 
-    void eval_ISO_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) const;
+    void eval_ISO_D(T s, T offs, T & x_D, T & y_D) const;
 
-    void eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const;
+    void eval_ISO_DD(T s, T offs, T & x_DD, T & y_DD) const;
 
-    void eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const;
+    void eval_ISO_DDD(T s, T offs, T & x_DDD, T & y_DDD) const;
 
-    void eval_SAE(real_type s, real_type offs, real_type & x, real_type & y) const { this->eval_ISO(s, -offs, x, y); }
+    void eval_SAE(T s, T offs, T & x, T & y) const { this->eval_ISO(s, -offs, x, y); }
 
-    void eval_SAE_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) const {
+    void eval_SAE_D(T s, T offs, T & x_D, T & y_D) const {
       this->eval_ISO_D(s, -offs, x_D, y_D);
     }
 
-    void eval_DAE_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const {
+    void eval_DAE_DD(T s, T offs, T & x_DD, T & y_DD) const {
       this->eval_ISO_DD(s, -offs, x_DD, y_DD);
     }
 
-    void eval_SAE_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const {
+    void eval_SAE_DDD(T s, T offs, T & x_DDD, T & y_DDD) const {
       this->eval_ISO_DDD(s, -offs, x_DDD, y_DDD);
     }
 
-    void eval(real_type s, ClothoidData & C) const;
+    //!
+    //! Evaluate position (with ISO offset), its first three derivatives,
+    //! angle, curvature and normal at `s` with a single evaluation of the
+    //! Fresnel integrals and of the trigonometric functions.
+    //! Values are the same of `eval_ISO`, `eval_ISO_D`, `eval_ISO_DD`,
+    //! `eval_ISO_DDD`, `theta`, `kappa` and `nor_ISO`.
+    //!
+    void eval_full(T s, T offs, ClothoidPointT<T> & P) const;
+
+    //!
+    //! Batched `fresnelCS` on `s[0..n-1]`, the exact kernel goes through
+    //! the batched `GeneralizedFresnelCS`. Results agree with the scalar
+    //! calls within the bound of the batched `GeneralizedFresnelCS`
+    //! (`1e-12` in double for \f$ |\kappa_0 s| \le 10 \f$), not bit by bit.
+    //!
+    void fresnelCS(int_type n, T const * s, T * C, T * S) const;
+
+    //!
+    //! Batched `evaluate`, `eval` and `eval_ISO` on `s[0..n-1]`
+    //! (output arrays must not overlap `s`).
+    //!
+    void evaluate(int_type n, T const * s, T * theta, T * kappa, T * x, T * y) const;
+    void eval(int_type n, T const * s, T * x, T * y) const;
+    void eval_ISO(int_type n, T const * s, T offs, T * x, T * y) const;
+
+    void eval(T s, ClothoidDataT & C) const;
 
-    real_type c0x() const { return x0 - (sin(theta0) / kappa0); }
-    real_type c0y() const { return y0 + (cos(theta0) / kappa0); }
+    T c0x() const { return x0 - (sin(theta0) / kappa0); }
+    T c0y() const { return y0 + (cos(theta0) / kappa0); }
 
-    void Pinfinity(real_type & x, real_type & y, bool plus) const;
+    void Pinfinity(T & x, T & y, bool plus) const;
 
-    void reverse(real_type L);
+    void reverse(T L);
 
-    void reverse(real_type L, ClothoidData & out) const;
+    void reverse(T L, ClothoidDataT & out) const;
 
-    void rotate(real_type angle, real_type cx, real_type cy);
+    void rotate(T angle, T cx, T cy);
 
-    void origin_at(real_type s_origin);
+    void origin_at(T s_origin);
 
-    real_type split_at_flex(ClothoidData & C0, ClothoidData & C1) const;
+    T split_at_flex(ClothoidDataT & C0, ClothoidDataT & C1) const;
 
-    real_type aplus(real_type dtheta) const;
+    T aplus(T dtheta) const;
 
-    bool bbTriangle(
-        real_type   L,
-        real_type & xx0,
-        real_type & yy0,
-        real_type & xx1,
-        real_type & yy1,
-        real_type & xx2,
-        real_type & yy2) const;
+    bool bbTriangle(T L, T & xx0, T & yy0, T & xx1, T & yy1, T & xx2, T & yy2) const;
 
-    bool bbTriangle_ISO(
-        real_type   L,
-        real_type   offs,
-        real_type & xx0,
-        real_type & yy0,
-        real_type & xx1,
-        real_type & yy1,
-        real_type & xx2,
-        real_type & yy2) const;
+    bool bbTriangle_ISO(T L, T offs, T & xx0, T & yy0, T & xx1, T & yy1, T & xx2, T & yy2) const;
 
-    bool bbTriangle_SAE(
-        real_type   L,
-        real_type   offs,
-        real_type & xx0,
-        real_type & yy0,
-        real_type & xx1,
-        real_type & yy1,
-        real_type & xx2,
-        real_type & yy2) const {
+    bool bbTriangle_SAE(T L, T offs, T & xx0, T & yy0, T & xx1, T & yy1, T & xx2, T & yy2) const {
       return this->bbTriangle_ISO(L, -offs, xx0, yy0, xx1, yy1, xx2, yy2);
     }
 
     int build_G1(
-        real_type   x0,
-        real_type   y0,
-        real_type   theta0,
-        real_type   x1,
-        real_type   y1,
-        real_type   theta1,
-        real_type   tol,
-        real_type & L,
-        bool        compute_deriv = false,
-        real_type   L_D[2]        = nullptr,
-        real_type   k_D[2]        = nullptr,
-        real_type   dk_D[2]       = nullptr);
-
-    bool build_forward(
-        real_type   x0,
-        real_type   y0,
-        real_type   theta0,
-        real_type   kappa0,
-        real_type   x1,
-        real_type   y1,
-        real_type   tol,
-        real_type & L);
+        T    x0,
+        T    y0,
+        T    theta0,
+        T    x1,
+        T    y1,
+        T    theta1,
+        T    tol,
+        T &  L,
+        bool compute_deriv = false,
+        T    L_D[2]        = nullptr,
+        T    k_D[2]        = nullptr,
+        T    dk_D[2]       = nullptr);
+
+    bool build_forward(T x0, T y0, T theta0, T kappa0, T x1, T y1, T tol, T & L);
 
     void info(ostream_type & s) const;
   };
 
+  extern template struct ClothoidPointT<float>;
+  extern template struct ClothoidPointT<double>;
+  extern template class ClothoidDataT<float>;
+  extern template class ClothoidDataT<double>;
+
+  typedef ClothoidPointT<real_type> ClothoidPoint;
+  typedef ClothoidDataT<real_type>  ClothoidData;
+
 #endif
 }  // namespace G2lib
 
@@ -78,7 +78,8 @@ namespace G2lib {
   //!
   //! Return minumum and maximum of three numbers
   //!
-  inline void minmax3(real_type a, real_type b, real_type c, real_type & vmin, real_type & vmax) {
+  template <typename T>
+  inline void minmax3(T a, T b, T c, T & vmin, T & vmax) {
     vmin = vmax = a;
     if (b < vmin)
       vmin = b;
@@ -288,6 +289,15 @@ namespace G2lib {
   //!
   int_type isPointInTriangle(real_type const * pt, real_type const * P1, real_type const * P2, real_type const * P3);
 
+  //
+  // Single and double precision versions of the predicates above (used by
+  // `Triangle2DT`), both are compiled in the library whatever `real_type` is.
+  //
+  int_type isCounterClockwise(float const * P1, float const * P2, float const * P3);
+  int_type isCounterClockwise(double const * P1, double const * P2, double const * P3);
+  int_type isPointInTriangle(float const * pt, float const * P1, float const * P2, float const * P3);
+  int_type isPointInTriangle(double const * pt, double const * P1, double const * P2, double const * P3);
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   /*\
    |  __  ____   __  _          _____ _          _
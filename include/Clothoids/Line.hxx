@@ -290,6 +290,32 @@ namespace G2lib {
 
     void eval_ISO_DDD(real_type, real_type, real_type & x_DDD, real_type & y_DDD) const override { x_DDD = y_DDD = 0; }
 
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    void eval(int_type n, real_type const * s, real_type * x, real_type * y) const override {
+      for (int_type i = 0; i < n; ++i) {
+        x[i] = m_x0 + s[i] * m_c0;
+        y[i] = m_y0 + s[i] * m_s0;
+      }
+    }
+
+    void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const override {
+      for (int_type i = 0; i < n; ++i) {
+        x[i] = m_x0 + s[i] * m_c0 - offs * m_s0;
+        y[i] = m_y0 + s[i] * m_s0 + offs * m_c0;
+      }
+    }
+
+    void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const override {
+      for (int_type i = 0; i < n; ++i) {
+        x[i]  = m_x0 + s[i] * m_c0;
+        y[i]  = m_y0 + s[i] * m_s0;
+        th[i] = m_theta0;
+        k[i]  = 0;
+      }
+    }
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -418,6 +444,30 @@ namespace G2lib {
 
     bool collision_ISO(real_type offs, LineSegment const & S, real_type S_offs) const;
 
+    //!
+    //! First hit of the ray `(x0,y0) + t (dx,dy) / |(dx,dy)|`, `0 <= t <= tmax`,
+    //! with the curve at offset `offs` (ISO).
+    //!
+    //! \param[in]  x0   x-coordinate of the origin of the ray
+    //! \param[in]  y0   y-coordinate of the origin of the ray
+    //! \param[in]  dx   x-component of the direction of the ray
+    //! \param[in]  dy   y-component of the direction of the ray
+    //! \param[in]  offs offset of the curve
+    //! \param[in]  tmax maximum range of the ray
+    //! \param[out] t    distance of the hit from the origin of the ray
+    //! \param[out] s    curvilinear abscissa of the hit
+    //! \return true if the ray hits the curve
+    //!
+    bool raycast_ISO(
+        real_type   x0,
+        real_type   y0,
+        real_type   dx,
+        real_type   dy,
+        real_type   offs,
+        real_type   tmax,
+        real_type & t,
+        real_type & s) const;
+
     /*\
      |   _   _ _   _ ____  ____ ____
      |  | \ | | | | |  _ \| __ ) ___|
@@ -29,7 +29,6 @@
 #include "BaseCurve.hxx"
 #include "Line.hxx"
 #include "AABBtree.hxx"
-#include "ThreadLocalData.hxx"
 
 namespace G2lib {
 
@@ -59,10 +58,9 @@ namespace G2lib {
     real_type           m_xe;
     real_type           m_ye;
 
-    mutable Utils::ThreadLocalData<int_type> m_lastInterval;
 
-    mutable bool     m_aabb_done;
-    mutable AABBtree m_aabb_tree;
+    // AABB tree of the segments, built on demand and published atomically
+    mutable SnapshotSlot<AABBtree> m_aabb;
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     class Collision_list {
@@ -72,7 +70,7 @@ namespace G2lib {
      public:
       Collision_list(PolyLine const * _pPL1, PolyLine const * _pPL2) : pPL1(_pPL1), pPL2(_pPL2) {}
 
-      bool operator()(BBox::PtrBBox ptr1, BBox::PtrBBox ptr2) const {
+      bool operator()(BBox::PtrBBox const & ptr1, BBox::PtrBBox const & ptr2) const {
         LineSegment const & LS1 = pPL1->m_polylineList[size_t(ptr1->Ipos())];
         LineSegment const & LS2 = pPL2->m_polylineList[size_t(ptr2->Ipos())];
         return LS1.collision(LS2);
@@ -80,24 +78,35 @@ namespace G2lib {
     };
 #endif
 
-    void resetLastInterval() { *m_lastInterval.search(std::this_thread::get_id()) = 0; }
 
    public:
     // explicit
-    PolyLine() : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) { this->resetLastInterval(); }
+    PolyLine() : BaseCurve(G2LIB_POLYLINE) {}
 
     void init();
 
     void copy(PolyLine const & l);
 
     // explicit
-    PolyLine(PolyLine const & PL) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-      this->resetLastInterval();
-      copy(PL);
-    }
+    PolyLine(PolyLine const & PL) : BaseCurve(G2LIB_POLYLINE) { copy(PL); }
 
     int_type findAtS(real_type & s) const;
 
+    //!
+    //! As `findAtS(s)` using the caller-owned `cursor` (see `SegmentCursor`)
+    //!
+    int_type findAtS(real_type & s, SegmentCursor & cursor) const;
+
+    //!
+    //! Evaluate at `s` using the caller-owned `cursor` for the segment lookup
+    //!
+    void eval(real_type s, SegmentCursor & cursor, real_type & x, real_type & y) const;
+
+    void eval_ISO(real_type s, real_type offs, SegmentCursor & cursor, real_type & x, real_type & y) const;
+
+    void evaluate(
+        real_type s, SegmentCursor & cursor, real_type & th, real_type & k, real_type & x, real_type & y) const;
+
     explicit PolyLine(LineSegment const & LS);
     explicit PolyLine(CircleArc const & C, real_type tol);
     explicit PolyLine(Biarc const & B, real_type tol);
@@ -257,6 +266,17 @@ namespace G2lib {
 
     void eval_ISO_DDD(real_type, real_type, real_type & x_DDD, real_type & y_DDD) const override { x_DDD = y_DDD = 0; }
 
+    // ---
+
+    using BaseCurve::evaluate;
+
+    void eval(int_type n, real_type const * s, real_type * x, real_type * y) const override;
+
+    void eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const override;
+
+    void evaluate(
+        int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const override;
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -314,6 +334,28 @@ namespace G2lib {
         real_type & /* DST  */
     ) const override;
 
+    //!
+    //! Segments at distance not greater than `r` from the point `(qx,qy)`.
+    //!
+    //! \param[in]  qx  x-coordinate of the point
+    //! \param[in]  qy  y-coordinate of the point
+    //! \param[in]  r   radius of the search
+    //! \param[out] out segment, abscissa of the closest point and exact distance,
+    //!                 sorted by increasing distance (cleared first, its capacity is reused)
+    //!
+    void query_radius(real_type qx, real_type qy, real_type r, vector<SegmentDistance> & out) const;
+
+    //!
+    //! The `k` segments nearest to the point `(qx,qy)`.
+    //!
+    //! \param[in]  qx  x-coordinate of the point
+    //! \param[in]  qy  y-coordinate of the point
+    //! \param[in]  k   number of segments
+    //! \param[out] out segment, abscissa of the closest point and exact distance,
+    //!                 sorted by increasing distance (cleared first, its capacity is reused)
+    //!
+    void knn(real_type qx, real_type qy, int_type k, vector<SegmentDistance> & out) const;
+
     /*\
      |             _ _ _     _
      |    ___ ___ | | (_)___(_) ___  _ __
@@ -371,12 +413,18 @@ namespace G2lib {
 
     void build_AABBtree(AABBtree & aabb) const;
 
-    void build_AABBtree() const {
-      if (!m_aabb_done) {
-        this->build_AABBtree(m_aabb_tree);
-        m_aabb_done = true;
-      }
-    }
+    //!
+    //! Build (once, thread safe) and return the internal AABB tree
+    //! used by collision and intersection queries; the pointer keeps
+    //! the tree alive after the polyline is modified.
+    //!
+    shared_ptr<AABBtree const> build_AABBtree() const;
+
+    //!
+    //! Build in advance the internal AABB tree, so that concurrent
+    //! queries on a shared polyline never wait for its construction.
+    //!
+    void prepare() const { this->build_AABBtree(); }
   };
 
 }  // namespace G2lib
@@ -28,6 +28,8 @@
 #pragma once
 #include "Types.hxx"
 
+#include <vector>
+
 namespace G2lib {
 
   /*\
@@ -39,34 +41,28 @@ namespace G2lib {
    |                           |___/
   \*/
   //!
-  //!  Class to manage Triangle for BB of clothoid curve
+  //!  Class to manage Triangle for BB of clothoid curve, templated on the
+  //!  scalar type. The library provides the `float` and `double`
+  //!  instantiations, `Triangle2D` is the `real_type` one.
   //!
-  class Triangle2D {
-    real_type m_p1[2], m_p2[2], m_p3[2];
-    real_type m_s0;
-    real_type m_s1;
-    int_type  m_icurve;
+  template <typename T>
+  class Triangle2DT {
+    T        m_p1[2], m_p2[2], m_p3[2];
+    T        m_s0;
+    T        m_s1;
+    int_type m_icurve;
 
    public:
-    Triangle2D(Triangle2D const & t) { *this = t; }
+    Triangle2DT(Triangle2DT const & t) { *this = t; }
 
-    Triangle2D() {
+    Triangle2DT() {
       m_p1[0] = m_p1[1] = m_p2[0] = m_p2[1] = m_p3[0] = m_p3[1] = 0;
       m_s0                                                      = 0;
       m_s1                                                      = 0;
       m_icurve                                                  = 0;
     }
 
-    Triangle2D(
-        real_type x1,
-        real_type y1,
-        real_type x2,
-        real_type y2,
-        real_type x3,
-        real_type y3,
-        real_type s0,
-        real_type s1,
-        int_type  icurve) {
+    Triangle2DT(T x1, T y1, T x2, T y2, T x3, T y3, T s0, T s1, int_type icurve) {
       m_p1[0]  = x1;
       m_p1[1]  = y1;
       m_p2[0]  = x2;
@@ -78,13 +74,7 @@ namespace G2lib {
       m_icurve = icurve;
     }
 
-    Triangle2D(
-        real_type const p1[2],
-        real_type const p2[2],
-        real_type const p3[2],
-        real_type       s0,
-        real_type       s1,
-        int_type        icurve) {
+    Triangle2DT(T const p1[2], T const p2[2], T const p3[2], T s0, T s1, int_type icurve) {
       m_p1[0]  = p1[0];
       m_p1[1]  = p1[1];
       m_p2[0]  = p2[0];
@@ -96,9 +86,26 @@ namespace G2lib {
       m_icurve = icurve;
     }
 
-    ~Triangle2D() {}
+    //!
+    //! Copy of a triangle with another scalar type (e.g. a `float` cover of
+    //! the triangles of a `real_type` curve)
+    //!
+    template <typename U>
+    explicit Triangle2DT(Triangle2DT<U> const & t) {
+      m_p1[0]  = T(t.x1());
+      m_p1[1]  = T(t.y1());
+      m_p2[0]  = T(t.x2());
+      m_p2[1]  = T(t.y2());
+      m_p3[0]  = T(t.x3());
+      m_p3[1]  = T(t.y3());
+      m_s0     = T(t.S0());
+      m_s1     = T(t.S1());
+      m_icurve = t.Icurve();
+    }
+
+    ~Triangle2DT() {}
 
-    Triangle2D const & operator=(Triangle2D const & t) {
+    Triangle2DT const & operator=(Triangle2DT const & t) {
       m_p1[0]  = t.m_p1[0];
       m_p1[1]  = t.m_p1[1];
       m_p2[0]  = t.m_p2[0];
@@ -111,13 +118,7 @@ namespace G2lib {
       return *this;
     }
 
-    void build(
-        real_type const p1[2],
-        real_type const p2[2],
-        real_type const p3[2],
-        real_type       s0,
-        real_type       s1,
-        int_type        icurve) {
+    void build(T const p1[2], T const p2[2], T const p3[2], T s0, T s1, int_type icurve) {
       m_p1[0]  = p1[0];
       m_p1[1]  = p1[1];
       m_p2[0]  = p2[0];
@@ -129,16 +130,7 @@ namespace G2lib {
       m_icurve = icurve;
     }
 
-    void build(
-        real_type x1,
-        real_type y1,
-        real_type x2,
-        real_type y2,
-        real_type x3,
-        real_type y3,
-        real_type s0,
-        real_type s1,
-        int_type  icurve) {
+    void build(T x1, T y1, T x2, T y2, T x3, T y3, T s0, T s1, int_type icurve) {
       m_p1[0]  = x1;
       m_p1[1]  = y1;
       m_p2[0]  = x2;
@@ -152,19 +144,19 @@ namespace G2lib {
 
     int_type Icurve() const { return m_icurve; }
 
-    real_type x1() const { return m_p1[0]; }
-    real_type y1() const { return m_p1[1]; }
+    T x1() const { return m_p1[0]; }
+    T y1() const { return m_p1[1]; }
 
-    real_type x2() const { return m_p2[0]; }
-    real_type y2() const { return m_p2[1]; }
+    T x2() const { return m_p2[0]; }
+    T y2() const { return m_p2[1]; }
 
-    real_type x3() const { return m_p3[0]; }
-    real_type y3() const { return m_p3[1]; }
+    T x3() const { return m_p3[0]; }
+    T y3() const { return m_p3[1]; }
 
-    real_type S0() const { return m_s0; }
-    real_type S1() const { return m_s1; }
+    T S0() const { return m_s0; }
+    T S1() const { return m_s1; }
 
-    void translate(real_type tx, real_type ty) {
+    void translate(T tx, T ty) {
       m_p1[0] += tx;
       m_p2[0] += tx;
       m_p3[0] += tx;
@@ -173,9 +165,9 @@ namespace G2lib {
       m_p3[1] += ty;
     }
 
-    void rotate(real_type angle, real_type cx, real_type cy);
+    void rotate(T angle, T cx, T cy);
 
-    void scale(real_type sc) {
+    void scale(T sc) {
       m_p1[0] *= sc;
       m_p1[1] *= sc;
       m_p2[0] *= sc;
@@ -184,16 +176,16 @@ namespace G2lib {
       m_p3[1] *= sc;
     }
 
-    void bbox(real_type & xmin, real_type & ymin, real_type & xmax, real_type & ymax) const;
+    void bbox(T & xmin, T & ymin, T & xmax, T & ymax) const;
 
-    real_type baricenterX() const { return (m_p1[0] + m_p2[0] + m_p3[0]) / 3; }
-    real_type baricenterY() const { return (m_p1[1] + m_p2[1] + m_p3[1]) / 3; }
+    T baricenterX() const { return (m_p1[0] + m_p2[0] + m_p3[0]) / 3; }
+    T baricenterY() const { return (m_p1[1] + m_p2[1] + m_p3[1]) / 3; }
 
-    real_type const * P1() const { return m_p1; }
-    real_type const * P2() const { return m_p2; }
-    real_type const * P3() const { return m_p3; }
+    T const * P1() const { return m_p1; }
+    T const * P2() const { return m_p2; }
+    T const * P3() const { return m_p3; }
 
-    bool overlap(Triangle2D const &) const;
+    bool overlap(Triangle2DT const &) const;
 
     //!
     //! return +1 = CounterClockwise
@@ -207,19 +199,99 @@ namespace G2lib {
     //! return -1 = outside
     //! return  0 = on the border
     //!
-    int_type isInside(real_type x, real_type y) const;
+    int_type isInside(T x, T y) const;
 
-    int_type isInside(real_type const pt[2]) const;
+    int_type isInside(T const pt[2]) const;
 
-    real_type distMin(real_type x, real_type y) const;
+    T distMin(T x, T y) const;
 
-    real_type distMax(real_type x, real_type y) const;
+    T distMax(T x, T y) const;
 
     void info(ostream_type & stream) const { stream << "Triangle2D\n" << *this << '\n'; }
+  };
+
+  template <typename T>
+  ostream_type & operator<<(ostream_type & stream, Triangle2DT<T> const & t);
+
+  //!
+  //! Triangles stored by coordinate (structure of arrays) with batch kernels
+  //! testing one triangle or one point against a range of them, templated
+  //! on the scalar type as `Triangle2DT`.
+  //!
+  //! A triangle can be clipped with the line parallel to its side P1-P3 (the
+  //! chord of the piece of curve it covers) at the height of the curve, so
+  //! every entry is a convex polygon of four vertices, two of them equal
+  //! when the triangle is not clipped. Every entry keeps the outward unit
+  //! normals `(nx,ny)` and offsets `c` of its edges, so a point is outside
+  //! the edge `e` when `nx[e]*x + ny[e]*y - c[e] > 0`. The kernels are
+  //! branchless loops over the range, the tests are closed and use a
+  //! tolerance scaled with the coordinates: a degenerate triangle (a
+  //! segment) has the normals of both sides and is handled as the segment.
+  //!
+  template <typename T>
+  class Triangle2DSoAT {
+    std::vector<T> m_x[4], m_y[4];
+    std::vector<T> m_nx[4], m_ny[4], m_c[4];
+    T              m_tol{0};
+
+    int_type overlap_range(T const P[], T tol, size_t i0, size_t n, int_type hit[]) const;
+
+   public:
+    Triangle2DSoAT() = default;
 
-    friend ostream_type & operator<<(ostream_type & stream, Triangle2D const & c);
+    void clear();
+
+    void reserve(size_t n);
+
+    size_t size() const { return m_c[0].size(); }
+
+    //!
+    //! Append the triangle `tri`, clipped at distance `height` from its side
+    //! P1-P3 towards P2 when `height >= 0`.
+    //!
+    void push_back(Triangle2DT<T> const & tri, T height = -1);
+
+    //!
+    //! Overlap of `tri` with the triangles `i0,...,i0+n-1`.
+    //!
+    //! \param[in]  tri triangle
+    //! \param[in]  i0  first triangle of the range
+    //! \param[in]  n   number of triangles of the range
+    //! \param[out] hit `hit[k]` is 1 if `tri` overlaps the triangle `i0+k`, 0 otherwise
+    //! \return the number of overlapping triangles
+    //!
+    int_type overlap(Triangle2DT<T> const & tri, size_t i0, size_t n, int_type hit[]) const;
+
+    //!
+    //! Same as the `overlap` above with the triangle `i` of `S` (clipped
+    //! as stored there).
+    //!
+    int_type overlap(Triangle2DSoAT const & S, size_t i, size_t i0, size_t n, int_type hit[]) const;
+
+    //!
+    //! Minimum distance of the point `(x,y)` from the triangles `i0,...,i0+n-1`
+    //! (0 for a point inside, see `Triangle2D::distMin`).
+    //!
+    void distMin(T x, T y, size_t i0, size_t n, T d[]) const;
+
+    //!
+    //! Position of the point `(x,y)` with respect to the triangles `i0,...,i0+n-1`:
+    //! +1 = inside, -1 = outside, 0 = on the border (see `Triangle2D::isInside`).
+    //!
+    void isInside(T x, T y, size_t i0, size_t n, int_type in[]) const;
   };
 
+  extern template class Triangle2DT<float>;
+  extern template class Triangle2DT<double>;
+  extern template class Triangle2DSoAT<float>;
+  extern template class Triangle2DSoAT<double>;
+
+  extern template ostream_type & operator<<(ostream_type & stream, Triangle2DT<float> const & t);
+  extern template ostream_type & operator<<(ostream_type & stream, Triangle2DT<double> const & t);
+
+  typedef Triangle2DT<real_type>    Triangle2D;
+  typedef Triangle2DSoAT<real_type> Triangle2DSoA;
+
 }  // namespace G2lib
 
 ///
@@ -38,14 +38,42 @@
 #endif
 
 #include <algorithm>
+#include <cstring>
+#include <exception>
+#include <thread>
 
 namespace G2lib {
 
   using std::abs;
+  using std::hypot;
   using std::max;
   using std::min;
   using std::numeric_limits;
 
+  AABBbuildType aabb_build_type        = G2LIB_AABB_MIDPOINT;
+  int_type      aabb_max_leaf_size     = 1;
+  int_type      aabb_build_threads     = 1;
+  int_type      aabb_intersect_threads = 1;
+  bool          aabb_wide_nodes        = false;
+  bool          aabb_clip_triangles    = false;
+
+  // raw copy of `n` objects to and from the binary images of the trees and covers
+  template <typename T>
+  static void pack_data(vector<char> & buffer, T const * v, size_t n) {
+    char const * p = reinterpret_cast<char const *>(v);
+    buffer.insert(buffer.end(), p, p + n * sizeof(T));
+  }
+
+  template <typename T>
+  static bool unpack_data(char const *& data, char const * end, T * v, size_t n) {
+    if (size_t(end - data) / sizeof(T) < n)
+      return false;
+    if (n > 0)
+      std::memcpy(v, data, n * sizeof(T));
+    data += n * sizeof(T);
+    return true;
+  }
+
   /*\
    |   ____  ____
    |  | __ )| __ )  _____  __
@@ -54,11 +82,12 @@ namespace G2lib {
    |  |____/|____/ \___/_/\_\
   \*/
 
-  void BBox::join(vector<PtrBBox> const & bboxes) {
+  template <typename T>
+  void BBoxT<T>::join(vector<PtrBBox> const & bboxes) {
     if (bboxes.empty()) {
       std::fill_n(m_bbox, 4, 0.0);
     } else {
-      vector<PtrBBox>::const_iterator it = bboxes.begin();
+      auto it = bboxes.begin();
 
       x_min() = (*it)->x_min();
       y_min() = (*it)->y_min();
@@ -66,7 +95,7 @@ namespace G2lib {
       y_max() = (*it)->y_max();
 
       for (++it; it != bboxes.end(); ++it) {
-        BBox const & currBox = **it;
+        BBoxT const & currBox = **it;
         if (currBox.x_min() < x_min())
           x_min() = currBox.x_min();
         if (currBox.y_min() < y_min())
@@ -81,7 +110,8 @@ namespace G2lib {
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  real_type BBox::distance(real_type x, real_type y) const {
+  template <typename T>
+  static T bbox_distance(T const * bb, T x, T y) {
     /*\
      |
      |   6          7          8
@@ -94,41 +124,41 @@ namespace G2lib {
      |
     \*/
     int_type icase = 4;
-    if (x < x_min())
+    if (x < bb[0])
       icase = 3;
-    else if (x > x_max())
+    else if (x > bb[2])
       icase = 5;
-    if (y < y_min())
+    if (y < bb[1])
       icase -= 3;
-    else if (y > y_max())
+    else if (y > bb[3])
       icase += 3;
-    real_type dst = 0;
+    T dst = 0;
     switch (icase) {
       case 0:
-        dst = hypot(x - x_min(), y - y_min());
+        dst = hypot(x - bb[0], y - bb[1]);
         break;
       case 1:
-        dst = y_min() - y;
+        dst = bb[1] - y;
         break;
       case 2:
-        dst = hypot(x - x_max(), y - y_min());
+        dst = hypot(x - bb[2], y - bb[1]);
         break;
       case 3:
-        dst = x_min() - x;
+        dst = bb[0] - x;
         break;
       case 4:
         break;
       case 5:
-        dst = x - x_max();
+        dst = x - bb[2];
         break;
       case 6:
-        dst = hypot(x - x_min(), y - y_max());
+        dst = hypot(x - bb[0], y - bb[3]);
         break;
       case 7:
-        dst = y - y_max();
+        dst = y - bb[3];
         break;
       case 8:
-        dst = hypot(x - x_max(), y - y_max());
+        dst = hypot(x - bb[2], y - bb[3]);
         break;
     }
     return dst;
@@ -136,21 +166,34 @@ namespace G2lib {
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  real_type BBox::maxDistance(real_type x, real_type y) const {
-    real_type dx = max(abs(x - x_min()), abs(x - x_max()));
-    real_type dy = max(abs(y - y_min()), abs(y - y_max()));
+  template <typename T>
+  static T bbox_max_distance(T const * bb, T x, T y) {
+    T dx = max(abs(x - bb[0]), abs(x - bb[2]));
+    T dy = max(abs(y - bb[1]), abs(y - bb[3]));
     return hypot(dx, dy);
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void BBox::print(ostream_type & stream) const {
+  template <typename T>
+  T BBoxT<T>::distance(T x, T y) const { return bbox_distance(m_bbox, x, y); }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  T BBoxT<T>::maxDistance(T x, T y) const { return bbox_max_distance(m_bbox, x, y); }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void BBoxT<T>::print(ostream_type & stream) const {
     stream << Utils::format_string("BBOX (xmin,ymin,xmax,ymax) = (%f, %f, %f, %f)\n", x_min(), y_min(), x_max(), y_max());
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  BBox const & BBox::operator=(BBox const & rhs) {
+  template <typename T>
+  BBoxT<T> const & BBoxT<T>::operator=(BBoxT const & rhs) {
     std::copy_n(rhs.m_bbox, 4, m_bbox);
     m_id   = rhs.m_id;
     m_ipos = rhs.m_ipos;
@@ -159,7 +202,8 @@ namespace G2lib {
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  bool BBox::collision(BBox const & box) const {
+  template <typename T>
+  bool BBoxT<T>::collision(BBoxT const & box) const {
     return !((box.x_min() > x_max()) || (box.x_max() < x_min()) || (box.y_min() > y_max()) || (box.y_max() < y_min()));
   }
 
@@ -171,26 +215,31 @@ namespace G2lib {
    |  /_/   \_\/_/   \_\____/|____/ \__|_|  \___|\___|
   \*/
 
-  AABBtree::AABBtree() {
-    pBBox.reset();
-    children.clear();
-  }
+  template <typename T>
+  AABBtreeT<T>::AABBtreeT()
+      : m_build_type(aabb_build_type),
+        m_max_leaf_size(max(aabb_max_leaf_size, int_type(1))),
+        m_build_threads(max(aabb_build_threads, int_type(0))),
+        m_wide(aabb_wide_nodes) {}
 
-  AABBtree::~AABBtree() {
-    pBBox.reset();
-    children.clear();
-  }
+  template <typename T>
+  AABBtreeT<T>::~AABBtreeT() { clear(); }
 
-  void AABBtree::clear() {
-    pBBox.reset();
-    children.clear();
+  template <typename T>
+  void AABBtreeT<T>::clear() {
+    m_nodes.clear();
+    m_bboxes.clear();
+    m_prim_bbox.clear();
+    m_wide_nodes.clear();
   }
 
-  bool AABBtree::empty() const { return children.empty() && !pBBox; }
+  template <typename T>
+  bool AABBtreeT<T>::empty() const { return m_nodes.empty(); }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::build(vector<PtrBBox> const & bboxes) {
+  template <typename T>
+  void AABBtreeT<T>::build(vector<PtrBBox> const & bboxes) {
     clear();
 
     if (bboxes.empty())
@@ -198,165 +247,1541 @@ namespace G2lib {
 
     size_t size = bboxes.size();
 
-    if (size == 1) {
-      this->pBBox = bboxes.front();
+    // bounds of the boxes in input order, the builders permute `perm`
+    m_prim_bbox.resize(4 * size);
+    for (size_t i = 0; i < size; ++i) {
+      BBoxT<T> const & bb    = *bboxes[i];
+      m_prim_bbox[4 * i + 0] = bb.x_min();
+      m_prim_bbox[4 * i + 1] = bb.y_min();
+      m_prim_bbox[4 * i + 2] = bb.x_max();
+      m_prim_bbox[4 * i + 3] = bb.y_max();
+    }
+    vector<int_type> perm(size);
+    for (size_t i = 0; i < size; ++i)
+      perm[i] = int_type(i);
+
+    int_type nthreads = Utils::num_threads(m_build_threads);
+
+    m_nodes.reserve(2 * size - 1);
+    m_nodes.push_back(Node());
+    if (nthreads > 1 && size >= size_t(PARALLEL_GRAIN))
+      build_parallel(nthreads, perm);
+    else
+      build_subtree(m_nodes, 0, 0, int_type(size), perm);
+
+    // store boxes and bounds in leaf order
+    vector<T> bounds(4 * size);
+    m_bboxes.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      size_t j    = size_t(perm[i]);
+      m_bboxes[i] = bboxes[j];
+      std::copy_n(&m_prim_bbox[4 * j], 4, &bounds[4 * i]);
+    }
+    m_prim_bbox.swap(bounds);
+
+    build_wide();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // The nodes are stored in depth first order, the children after their
+  // parent, so a reverse sweep sees the children before the parent.
+  //
+  template <typename T>
+  void AABBtreeT<T>::refit_nodes() {
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+      Node &    N  = m_nodes[i];
+      T const * bb = N.is_leaf() ? &m_prim_bbox[4 * size_t(N.first)] : m_nodes[size_t(N.first)].bbox;
+      std::copy_n(bb, 4, N.bbox);
+      int_type n = N.is_leaf() ? N.num : 2;
+      for (int_type k = 1; k < n; ++k) {
+        T const * b = N.is_leaf() ? &m_prim_bbox[4 * size_t(N.first + k)] : m_nodes[size_t(N.first + k)].bbox;
+        N.bbox[0]   = min(N.bbox[0], b[0]);
+        N.bbox[1]   = min(N.bbox[1], b[1]);
+        N.bbox[2]   = max(N.bbox[2], b[2]);
+        N.bbox[3]   = max(N.bbox[3], b[3]);
+      }
+    }
+    build_wide();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::build_wide() {
+    m_wide_nodes.clear();
+    if (!m_wide || empty())
       return;
+    m_wide_nodes.reserve(m_nodes.size() / 2 + 1);
+    m_wide_nodes.push_back(WideNode());
+    build_wide_node(0, 0);
+  }
+
+  //
+  // The children of the wide node are found opening the binary subtree
+  // `inode`, the internal node with the largest perimeter first, until
+  // there are 4 of them. An opened node is replaced by its two children in
+  // place, so the leaves are met in the same order as in the binary tree.
+  //
+  template <typename T>
+  void AABBtreeT<T>::build_wide_node(int_type iwide, int_type inode) {
+    int_type c[4];
+    int_type n = 0;
+    if (m_nodes[size_t(inode)].is_leaf()) {
+      c[n++] = inode;
+    } else {
+      c[n++] = m_nodes[size_t(inode)].first;
+      c[n++] = m_nodes[size_t(inode)].first + 1;
+    }
+    while (n < 4) {
+      int_type iopen = -1;
+      T        Popen = -1;
+      for (int_type k = 0; k < n; ++k) {
+        Node const & N = m_nodes[size_t(c[k])];
+        T            P = (N.bbox[2] - N.bbox[0]) + (N.bbox[3] - N.bbox[1]);
+        if (!N.is_leaf() && P > Popen) {
+          iopen = k;
+          Popen = P;
+        }
+      }
+      if (iopen < 0)
+        break;
+      for (int_type k = n; k > iopen + 1; --k)
+        c[k] = c[k - 1];
+      c[iopen + 1] = m_nodes[size_t(c[iopen])].first + 1;
+      c[iopen]     = m_nodes[size_t(c[iopen])].first;
+      ++n;
     }
 
-    pBBox = shared_ptr<BBox>(new BBox(bboxes, 0, 0));
+    T const    inf = numeric_limits<T>::infinity();
+    WideNode & W   = m_wide_nodes[size_t(iwide)];
+    W.size         = n;
+    for (int_type k = 0; k < 4; ++k) {
+      T const * bb = k < n ? m_nodes[size_t(c[k])].bbox : nullptr;
+      W.xmin[k]    = bb ? bb[0] : inf;
+      W.ymin[k]    = bb ? bb[1] : inf;
+      W.xmax[k]    = bb ? bb[2] : -inf;
+      W.ymax[k]    = bb ? bb[3] : -inf;
+      W.child[k]   = k < n ? m_nodes[size_t(c[k])].first : -1;
+      W.num[k]     = k < n ? m_nodes[size_t(c[k])].num : 0;
+    }
+    for (int_type k = 0; k < n; ++k) {
+      if (m_nodes[size_t(c[k])].is_leaf())
+        continue;
+      int_type iw = int_type(m_wide_nodes.size());
+      m_wide_nodes.push_back(WideNode());  // invalidates `W`
+      m_wide_nodes[size_t(iwide)].child[k] = iw;
+      build_wide_node(iw, c[k]);
+    }
+  }
 
-    real_type xmin = pBBox->Xmin();
-    real_type ymin = pBBox->Ymin();
-    real_type xmax = pBBox->Xmax();
-    real_type ymax = pBBox->Ymax();
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-    vector<PtrBBox> posBoxes;
-    vector<PtrBBox> negBoxes;
+  template <typename T>
+  void AABBtreeT<T>::build_subtree(
+      vector<Node> & nodes, int_type inode, int_type ibegin, int_type iend, vector<int_type> & perm) const {
+    int_type imid;
+    if (!split_node(nodes[size_t(inode)], ibegin, iend, perm, imid))
+      return;
+    int_type ichild            = int_type(nodes.size());
+    nodes[size_t(inode)].first = ichild;
+    nodes[size_t(inode)].num   = 0;
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    build_subtree(nodes, ichild, ibegin, imid, perm);
+    build_subtree(nodes, ichild + 1, imid, iend, perm);
+  }
 
-    if ((ymax - ymin) > (xmax - xmin)) {
-      real_type                       cutPos = (ymax + ymin) / 2;
-      vector<PtrBBox>::const_iterator it;
-      for (it = bboxes.begin(); it != bboxes.end(); ++it) {
-        real_type ymid = ((*it)->Ymin() + (*it)->Ymax()) / 2;
-        if (ymid > cutPos)
-          posBoxes.push_back(*it);
-        else
-          negBoxes.push_back(*it);
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // Fork-join build. The top of the tree is expanded level by level, the
+  // nodes of a level being split in parallel, until there are a few tasks
+  // per thread (or the ranges are small); then the subtrees are built by
+  // the workers in private node arrays and spliced in. The splits only
+  // depend on the range of boxes of a node, so the topology is the one of
+  // the serial builder; a final pass renumbers the nodes in the serial
+  // (depth first) order, so the tree is identical to the one built with
+  // a single thread.
+  //
+  template <typename T>
+  void AABBtreeT<T>::build_parallel(int_type nthreads, vector<int_type> & perm) {
+    struct Task {
+      int_type     inode;
+      int_type     ibegin;
+      int_type     iend;
+      int_type     imid;  // split position, -1 for a leaf
+      vector<Node> nodes;
+    };
+
+    vector<Task> tasks(1);
+    tasks[0].inode  = 0;
+    tasks[0].ibegin = 0;
+    tasks[0].iend   = int_type(perm.size());
+    size_t ntasks   = 4 * size_t(nthreads);
+    while (tasks.size() < ntasks) {
+      vector<size_t> level;
+      for (size_t k = 0; k < tasks.size(); ++k)
+        if (tasks[k].iend - tasks[k].ibegin >= PARALLEL_GRAIN)
+          level.push_back(k);
+      if (level.empty())
+        break;
+      // the nodes and the ranges of `perm` of a level are disjoint
+      Utils::parallel_for(nthreads, level.size(), [&](size_t k) {
+        Task & task = tasks[level[k]];
+        if (!split_node(m_nodes[size_t(task.inode)], task.ibegin, task.iend, perm, task.imid))
+          task.imid = -1;
+      });
+      vector<Task> next;
+      next.reserve(2 * tasks.size());
+      for (size_t k = 0, l = 0; k < tasks.size(); ++k) {
+        Task & task = tasks[k];
+        if (l == level.size() || level[l] != k) {
+          next.push_back(std::move(task));
+          continue;
+        }
+        ++l;
+        if (task.imid < 0)
+          continue;  // leaf, done
+        int_type ichild                   = int_type(m_nodes.size());
+        m_nodes[size_t(task.inode)].first = ichild;
+        m_nodes[size_t(task.inode)].num   = 0;
+        m_nodes.push_back(Node());
+        m_nodes.push_back(Node());
+        next.push_back(Task{ichild, task.ibegin, task.imid, -1, vector<Node>()});
+        next.push_back(Task{ichild + 1, task.imid, task.iend, -1, vector<Node>()});
       }
+      tasks.swap(next);
+    }
+
+    // build the subtrees, the tasks are picked in turn by the workers
+    Utils::parallel_for(nthreads, tasks.size(), [&](size_t k) {
+      Task & task = tasks[k];
+      task.nodes.reserve(2 * size_t(task.iend - task.ibegin) - 1);
+      task.nodes.push_back(Node());
+      build_subtree(task.nodes, 0, task.ibegin, task.iend, perm);
+    });
+
+    // splice the subtrees: the local node k > 0 goes to offset + k
+    for (Task & task : tasks) {
+      int_type offset = int_type(m_nodes.size()) - 1;
+      for (Node & N : task.nodes)
+        if (!N.is_leaf())
+          N.first += offset;
+      m_nodes[size_t(task.inode)] = task.nodes.front();
+      m_nodes.insert(m_nodes.end(), task.nodes.begin() + 1, task.nodes.end());
+      vector<Node>().swap(task.nodes);
+    }
+
+    // renumber in the order of the serial builder: the two children of a
+    // node are allocated when it is visited, left subtree before the right
+    vector<Node> nodes;
+    nodes.reserve(m_nodes.size());
+    nodes.push_back(m_nodes.front());
+    vector<pair<int_type, int_type>> stack(1, pair<int_type, int_type>(0, 0));  // (old, new)
+    while (!stack.empty()) {
+      int_type iold = stack.back().first;
+      int_type inew = stack.back().second;
+      stack.pop_back();
+      Node const & N = m_nodes[size_t(iold)];
+      if (N.is_leaf())
+        continue;
+      int_type ichild           = int_type(nodes.size());
+      nodes[size_t(inew)].first = ichild;
+      nodes.push_back(m_nodes[size_t(N.first)]);
+      nodes.push_back(m_nodes[size_t(N.first + 1)]);
+      stack.push_back(pair<int_type, int_type>(N.first + 1, ichild + 1));
+      stack.push_back(pair<int_type, int_type>(N.first, ichild));
+    }
+    m_nodes.swap(nodes);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::set_node_bbox(Node & N, int_type ibegin, int_type iend, vector<int_type> const & perm) const {
+    T const * bb   = &m_prim_bbox[4 * size_t(perm[size_t(ibegin)])];
+    T         xmin = bb[0];
+    T         ymin = bb[1];
+    T         xmax = bb[2];
+    T         ymax = bb[3];
+    for (int_type i = ibegin + 1; i < iend; ++i) {
+      bb = &m_prim_bbox[4 * size_t(perm[size_t(i)])];
+      if (bb[0] < xmin)
+        xmin = bb[0];
+      if (bb[1] < ymin)
+        ymin = bb[1];
+      if (bb[2] > xmax)
+        xmax = bb[2];
+      if (bb[3] > ymax)
+        ymax = bb[3];
+    }
+    N.bbox[0] = xmin;
+    N.bbox[1] = ymin;
+    N.bbox[2] = xmax;
+    N.bbox[3] = ymax;
+    N.first   = ibegin;
+    N.num     = iend - ibegin;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool AABBtreeT<T>::split_node(
+      Node & N, int_type ibegin, int_type iend, vector<int_type> & perm, int_type & imid) const {
+    set_node_bbox(N, ibegin, iend, perm);
+    if (m_build_type == G2LIB_AABB_BINNED_SAH)
+      return split_sah(N, ibegin, iend, perm, imid);
+    return split_midpoint(N, ibegin, iend, perm, imid);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool AABBtreeT<T>::split_midpoint(
+      Node const & N, int_type ibegin, int_type iend, vector<int_type> & perm, int_type & imid) const {
+    if (iend - ibegin <= m_max_leaf_size)
+      return false;
+
+    T const * nb = N.bbox;
+    T const * pb = m_prim_bbox.data();
+
+    // split at the middle of the longest side, the boxes of the negative
+    // side first (stable, so that the order of the leaves follows the input)
+    vector<int_type>::iterator b = perm.begin() + ibegin;
+    vector<int_type>::iterator e = perm.begin() + iend;
+    vector<int_type>::iterator mid;
+    if ((nb[3] - nb[1]) > (nb[2] - nb[0])) {
+      T cutPos = (nb[3] + nb[1]) / 2;
+      mid      = std::stable_partition(
+          b, e, [pb, cutPos](int_type i) { return !((pb[4 * i + 1] + pb[4 * i + 3]) / 2 > cutPos); });
     } else {
-      real_type                       cutPos = (xmax + xmin) / 2;
-      vector<PtrBBox>::const_iterator it;
-      for (it = bboxes.begin(); it != bboxes.end(); ++it) {
-        real_type xmid = ((*it)->Xmin() + (*it)->Xmax()) / 2;
-        if (xmid > cutPos)
-          posBoxes.push_back(*it);
-        else
-          negBoxes.push_back(*it);
+      T cutPos = (nb[2] + nb[0]) / 2;
+      mid      = std::stable_partition(
+          b, e, [pb, cutPos](int_type i) { return !((pb[4 * i + 0] + pb[4 * i + 2]) / 2 > cutPos); });
+    }
+
+    if (mid == b) {
+      // no negative box: the second half of the positive ones becomes negative
+      vector<int_type>::iterator midIdx = b + (e - b) / 2;
+      mid                               = std::rotate(b, midIdx, e);
+    } else if (mid == e) {
+      // no positive box: the second half of the negative ones becomes positive
+      mid = b + (e - b) / 2;
+    }
+
+    imid = int_type(mid - perm.begin());
+    return true;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // Binned SAH: the centroids are binned along each axis and the split
+  // minimizing C_TRAV + (P(L) * n(L) + P(R) * n(R)) / P(node) is taken,
+  // P being the half perimeter of the box (the 2D "surface area") and
+  // the costs measured in box tests. A leaf costs n(node).
+  //
+  template <typename T>
+  bool AABBtreeT<T>::split_sah(
+      Node const & N, int_type ibegin, int_type iend, vector<int_type> & perm, int_type & imid) const {
+    static int_type const  NBINS  = 16;
+    static T const C_TRAV = 1;
+
+    int_type n = iend - ibegin;
+    if (n == 1)
+      return false;
+
+    T const * nb = N.bbox;
+    T const * pb = m_prim_bbox.data();
+
+    auto half_perimeter = [](T const * bb) { return (bb[2] - bb[0]) + (bb[3] - bb[1]); };
+
+    // bounds of the centroids
+    T cmin[2] = {numeric_limits<T>::infinity(), numeric_limits<T>::infinity()};
+    T cmax[2] = {-numeric_limits<T>::infinity(), -numeric_limits<T>::infinity()};
+    for (int_type i = ibegin; i < iend; ++i) {
+      T const * bb = pb + 4 * perm[size_t(i)];
+      for (int_type k = 0; k < 2; ++k) {
+        T c     = (bb[k] + bb[k + 2]) / 2;
+        cmin[k] = min(cmin[k], c);
+        cmax[k] = max(cmax[k], c);
       }
     }
 
-    if (negBoxes.empty()) {
-      vector<PtrBBox>::iterator midIdx;
-      midIdx = posBoxes.begin() + posBoxes.size() / 2;
-      negBoxes.insert(negBoxes.end(), midIdx, posBoxes.end());
-      posBoxes.erase(midIdx, posBoxes.end());
-    } else if (posBoxes.empty()) {
-      vector<PtrBBox>::iterator midIdx;
-      midIdx = negBoxes.begin() + negBoxes.size() / 2;
-      posBoxes.insert(posBoxes.end(), midIdx, negBoxes.end());
-      negBoxes.erase(midIdx, negBoxes.end());
+    T        P          = half_perimeter(nb);
+    T        best_cost  = numeric_limits<T>::infinity();
+    int_type best_axis  = -1;
+    int_type best_split = 0;
+
+    for (int_type axis = 0; axis < 2 && P > 0; ++axis) {
+      T ext = cmax[axis] - cmin[axis];
+      if (!(ext > 0))
+        continue;
+      T scale = NBINS / ext;
+
+      int_type count[NBINS];
+      T        bins[NBINS][4];
+      for (int_type j = 0; j < NBINS; ++j) {
+        count[j]   = 0;
+        bins[j][0] = bins[j][1] = numeric_limits<T>::infinity();
+        bins[j][2] = bins[j][3] = -numeric_limits<T>::infinity();
+      }
+      for (int_type i = ibegin; i < iend; ++i) {
+        T const * bb = pb + 4 * perm[size_t(i)];
+        int_type  j  = min(int_type(scale * ((bb[axis] + bb[axis + 2]) / 2 - cmin[axis])), NBINS - 1);
+        ++count[j];
+        bins[j][0] = min(bins[j][0], bb[0]);
+        bins[j][1] = min(bins[j][1], bb[1]);
+        bins[j][2] = max(bins[j][2], bb[2]);
+        bins[j][3] = max(bins[j][3], bb[3]);
+      }
+
+      // sweep from the right accumulating the cost of the right sides
+      T        right_cost[NBINS];
+      T        acc[4] = {bins[NBINS - 1][0], bins[NBINS - 1][1], bins[NBINS - 1][2], bins[NBINS - 1][3]};
+      int_type nacc   = count[NBINS - 1];
+      for (int_type j = NBINS - 1; j > 0; --j) {
+        if (j < NBINS - 1) {
+          nacc += count[j];
+          for (int_type k = 0; k < 2; ++k) {
+            acc[k]     = min(acc[k], bins[j][k]);
+            acc[k + 2] = max(acc[k + 2], bins[j][k + 2]);
+          }
+        }
+        right_cost[j] = nacc > 0 ? nacc * half_perimeter(acc) : 0;
+      }
+
+      // sweep from the left and evaluate the splits
+      acc[0] = acc[1] = numeric_limits<T>::infinity();
+      acc[2] = acc[3] = -numeric_limits<T>::infinity();
+      nacc   = 0;
+      for (int_type j = 1; j < NBINS; ++j) {
+        nacc += count[j - 1];
+        for (int_type k = 0; k < 2; ++k) {
+          acc[k]     = min(acc[k], bins[j - 1][k]);
+          acc[k + 2] = max(acc[k + 2], bins[j - 1][k + 2]);
+        }
+        if (nacc == 0 || nacc == n)
+          continue;
+        T cost = C_TRAV + (nacc * half_perimeter(acc) + right_cost[j]) / P;
+        if (cost < best_cost) {
+          best_cost  = cost;
+          best_axis  = axis;
+          best_split = j;
+        }
+      }
     }
 
-    PtrAABB neg = make_shared<AABBtree>();
-    PtrAABB pos = make_shared<AABBtree>();
+    if (n <= m_max_leaf_size && (best_axis < 0 || n <= best_cost))
+      return false;
+
+    vector<int_type>::iterator b = perm.begin() + ibegin;
+    vector<int_type>::iterator e = perm.begin() + iend;
+    vector<int_type>::iterator mid;
+    if (best_axis < 0) {
+      // coincident centroids: split by count
+      mid = b + n / 2;
+    } else {
+      T        scale = NBINS / (cmax[best_axis] - cmin[best_axis]);
+      T        c0    = cmin[best_axis];
+      int_type axis  = best_axis;
+      int_type split = best_split;
+      mid            = std::partition(b, e, [pb, scale, c0, axis, split](int_type i) {
+        T const * bb = pb + 4 * i;
+        return min(int_type(scale * ((bb[axis] + bb[axis + 2]) / 2 - c0)), NBINS - 1) < split;
+      });
+    }
 
-    neg->build(negBoxes);
-    if (!neg->empty())
-      children.push_back(neg);
+    imid = int_type(mid - perm.begin());
+    return true;
+  }
 
-    pos->build(posBoxes);
-    if (!pos->empty())
-      children.push_back(pos);
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::stats(Stats & S) const {
+    S.num_nodes      = int_type(m_nodes.size());
+    S.num_leaves     = 0;
+    S.max_depth      = 0;
+    S.avg_leaf_depth = 0;
+    S.avg_leaf_size  = 0;
+    S.sah_cost       = 0;
+    S.overlap        = 0;
+    if (empty())
+      return;
+
+    T const * rb    = m_nodes.front().bbox;
+    T         Proot = (rb[2] - rb[0]) + (rb[3] - rb[1]);
+    T         Aroot = (rb[2] - rb[0]) * (rb[3] - rb[1]);
+
+    vector<pair<int_type, int_type>> stack(1, pair<int_type, int_type>(0, 0));
+    while (!stack.empty()) {
+      int_type inode = stack.back().first;
+      int_type depth = stack.back().second;
+      stack.pop_back();
+      Node const & N = m_nodes[size_t(inode)];
+      T            P = (N.bbox[2] - N.bbox[0]) + (N.bbox[3] - N.bbox[1]);
+      T            w = Proot > 0 ? P / Proot : 1;
+      if (N.is_leaf()) {
+        ++S.num_leaves;
+        S.max_depth = max(S.max_depth, depth);
+        S.avg_leaf_depth += depth;
+        S.avg_leaf_size += N.num;
+        S.sah_cost += w * N.num;
+      } else {
+        S.sah_cost += w;
+        T const * L  = m_nodes[size_t(N.first)].bbox;
+        T const * R  = m_nodes[size_t(N.first + 1)].bbox;
+        T         dx = min(L[2], R[2]) - max(L[0], R[0]);
+        T         dy = min(L[3], R[3]) - max(L[1], R[1]);
+        if (dx > 0 && dy > 0 && Aroot > 0)
+          S.overlap += dx * dy / Aroot;
+        stack.push_back(pair<int_type, int_type>(N.first, depth + 1));
+        stack.push_back(pair<int_type, int_type>(N.first + 1, depth + 1));
+      }
+    }
+    S.avg_leaf_depth /= S.num_leaves;
+    S.avg_leaf_size /= S.num_leaves;
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::print(ostream_type & stream, int level) const {
+  template <typename T>
+  void AABBtreeT<T>::print(ostream_type & stream, int /* level */) const {
     if (empty()) {
       stream << "[EMPTY AABB tree]\n";
-    } else {
+      return;
+    }
+    // depth first, parent before children
+    vector<int_type> stack(1, 0);
+    while (!stack.empty()) {
+      Node const & N = m_nodes[size_t(stack.back())];
+      stack.pop_back();
       stream << Utils::format_string("BBOX xmin=%-12.4f ymin=%-12.4f xmax=%-12.4f ymax=%-12.4f\n", 
-        pBBox->x_min(), pBBox->y_min(), pBBox->x_max(), pBBox->y_max());
-      vector<PtrAABB>::const_iterator it;
-      for (it = children.begin(); it != children.end(); ++it)
-        (*it)->print(stream, level + 1);
+        N.bbox[0], N.bbox[1], N.bbox[2], N.bbox[3]);
+      if (!N.is_leaf()) {
+        stack.push_back(N.first + 1);
+        stack.push_back(N.first);
+      }
     }
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::intersect(AABBtree const & tree, VecPairPtrBBox & intersectionList, bool swap_tree) const {
-    // check bbox with
-    if (!tree.pBBox->collision(*pBBox))
+  template <typename T>
+  void AABBtreeT<T>::pack(vector<char> & buffer) const {
+    std::int32_t  head[6] = {std::int32_t(sizeof(Node)), std::int32_t(sizeof(WideNode)), std::int32_t(m_build_type),
+                             std::int32_t(m_max_leaf_size), m_wide ? 1 : 0, 0};
+    std::uint64_t size[3] = {m_nodes.size(), m_bboxes.size(), m_wide_nodes.size()};
+    vector<int_type> ids(2 * m_bboxes.size());
+    for (size_t k = 0; k < m_bboxes.size(); ++k) {
+      ids[2 * k]     = m_bboxes[k]->Id();
+      ids[2 * k + 1] = m_bboxes[k]->Ipos();
+    }
+    pack_data(buffer, head, 6);
+    pack_data(buffer, size, 3);
+    pack_data(buffer, m_nodes.data(), m_nodes.size());
+    pack_data(buffer, m_prim_bbox.data(), m_prim_bbox.size());
+    pack_data(buffer, ids.data(), ids.size());
+    pack_data(buffer, m_wide_nodes.data(), m_wide_nodes.size());
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // Besides the sizes, every child index must refer forward (the nodes
+  // are stored parent first) and every leaf to a range of boxes, so that
+  // a tree read from a corrupted image cannot loop or read out of bounds.
+  //
+  template <typename T>
+  bool AABBtreeT<T>::unpack(char const *& data, char const * end) {
+    clear();
+    std::int32_t  head[6];
+    std::uint64_t size[3];
+    if (!unpack_data(data, end, head, 6) || !unpack_data(data, end, size, 3))
+      return false;
+    if (head[0] != std::int32_t(sizeof(Node)) || head[1] != std::int32_t(sizeof(WideNode)) ||
+        (head[2] != G2LIB_AABB_MIDPOINT && head[2] != G2LIB_AABB_BINNED_SAH) || head[3] < 1)
+      return false;
+
+    size_t nn    = size_t(size[0]);
+    size_t nb    = size_t(size[1]);
+    size_t nw    = size_t(size[2]);
+    size_t avail = size_t(end - data);
+    if ((nn == 0) != (nb == 0) || nn > avail / sizeof(Node) || nb > avail / (4 * sizeof(T)) ||
+        nw > avail / sizeof(WideNode))
+      return false;
+
+    vector<int_type> ids(2 * nb);
+    m_nodes.resize(nn);
+    m_prim_bbox.resize(4 * nb);
+    m_wide_nodes.resize(nw);
+    bool ok = unpack_data(data, end, m_nodes.data(), nn) && unpack_data(data, end, m_prim_bbox.data(), 4 * nb) &&
+              unpack_data(data, end, ids.data(), 2 * nb) && unpack_data(data, end, m_wide_nodes.data(), nw);
+
+    auto leaf_ok = [nb](int_type first, int_type num) {
+      return first >= 0 && num > 0 && size_t(first) + size_t(num) <= nb;
+    };
+    for (size_t i = 0; ok && i < nn; ++i) {
+      Node const & N = m_nodes[i];
+      ok = N.num == 0 ? N.first > int_type(i) && size_t(N.first) + 1 < nn : leaf_ok(N.first, N.num);
+    }
+    for (size_t i = 0; ok && i < nw; ++i) {
+      WideNode const & W = m_wide_nodes[i];
+      ok                 = W.size > 0 && W.size <= 4;
+      for (int_type c = 0; ok && c < W.size; ++c)
+        ok = W.num[c] == 0 ? W.child[c] > int_type(i) && size_t(W.child[c]) < nw : leaf_ok(W.child[c], W.num[c]);
+    }
+    if (!ok) {
+      clear();
+      return false;
+    }
+
+    m_build_type    = AABBbuildType(head[2]);
+    m_max_leaf_size = head[3];
+    m_wide          = head[4] != 0;
+    m_bboxes.resize(nb);
+    for (size_t k = 0; k < nb; ++k) {
+      T const * bb = &m_prim_bbox[4 * k];
+      m_bboxes[k]  = make_shared<BBoxT<T> const>(bb[0], bb[1], bb[2], bb[3], ids[2 * k], ids[2 * k + 1]);
+    }
+    return true;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::intersect(AABBtreeT const & tree, VecPairPtrBBox & intersectionList, bool swap_tree) const {
+    auto fun = [&intersectionList](PtrBBox const & bb1, PtrBBox const & bb2) {
+      intersectionList.emplace_back(bb1, bb2);
+    };
+    this->intersect_visit(tree, fun, swap_tree);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // The top of the dual traversal is expanded level by level, keeping the
+  // order of the serial traversal, until there are several tasks (pairs of
+  // overlapping nodes) per thread. The tasks are handed out dynamically,
+  // each one collects the indices of the boxes of its subtraversal, and
+  // the lists are concatenated in task order.
+  //
+  template <typename T>
+  vector<pair<int_type, int_type>> AABBtreeT<T>::intersect_tasks(AABBtreeT const & tree, int_type nthreads) const {
+    using PairIndex = pair<int_type, int_type>;
+    vector<PairIndex> tasks;
+    if (this->empty() || tree.empty() || !overlap(m_nodes.front().bbox, tree.m_nodes.front().bbox))
+      return tasks;
+    tasks.emplace_back(0, 0);
+    size_t const ntasks = 16 * size_t(Utils::num_threads(nthreads));
+    while (tasks.size() < ntasks) {
+      vector<PairIndex> next;
+      next.reserve(4 * tasks.size());
+      bool expanded = false;
+      for (PairIndex const & P : tasks) {
+        Node const & A = m_nodes[size_t(P.first)];
+        Node const & B = tree.m_nodes[size_t(P.second)];
+        if (A.is_leaf() && B.is_leaf()) {
+          next.push_back(P);
+          continue;
+        }
+        expanded    = true;
+        int_type a0 = A.is_leaf() ? P.first : A.first;
+        int_type a1 = A.is_leaf() ? P.first : A.first + 1;
+        int_type b0 = B.is_leaf() ? P.second : B.first;
+        int_type b1 = B.is_leaf() ? P.second : B.first + 1;
+        for (int_type a = a0; a <= a1; ++a)
+          for (int_type b = b0; b <= b1; ++b)
+            if (overlap(m_nodes[size_t(a)].bbox, tree.m_nodes[size_t(b)].bbox))
+              next.emplace_back(a, b);
+      }
+      tasks.swap(next);
+      if (!expanded)
+        break;
+    }
+    return tasks;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::intersect_parallel(
+      AABBtreeT const & tree, int_type nthreads, VecPairPtrBBox & intersectionList, bool swap_tree) const {
+    if (this->empty() || tree.empty() || !overlap(m_nodes.front().bbox, tree.m_nodes.front().bbox))
       return;
+    nthreads = Utils::num_threads(nthreads);
 
-    int icase = (children.empty() ? 0 : 1) + (tree.children.empty() ? 0 : 2);
+    using PairIndex         = pair<int_type, int_type>;
+    vector<PairIndex> tasks = this->intersect_tasks(tree, nthreads);
 
-    switch (icase) {
-      case 0:  // both leaf
+    vector<vector<PairIndex>> found(tasks.size());
+    Utils::parallel_for(nthreads, tasks.size(), [&](size_t k) {
+      vector<PairIndex> & F   = found[k];
+      auto                fun = [&F](int_type i, int_type j) -> bool {
+        F.emplace_back(i, j);
+        return false;
+      };
+      auto leaves = this->box_pairs(tree, fun);
+      this->traverse_pairs(tasks[k].first, tree, tasks[k].second, leaves);
+    });
+
+    size_t n = intersectionList.size();
+    for (vector<PairIndex> const & F : found)
+      n += F.size();
+    intersectionList.reserve(n);
+    for (vector<PairIndex> const & F : found) {
+      for (PairIndex const & P : F) {
+        PtrBBox const & bb1 = m_bboxes[size_t(P.first)];
+        PtrBBox const & bb2 = tree.m_bboxes[size_t(P.second)];
         if (swap_tree)
-          intersectionList.push_back(PairPtrBBox(tree.pBBox, pBBox));
+          intersectionList.emplace_back(bb2, bb1);
         else
-          intersectionList.push_back(PairPtrBBox(pBBox, tree.pBBox));
-        break;
-      case 1:  // first is a tree, second is a leaf
-      {
-        vector<PtrAABB>::const_iterator it;
-        for (it = children.begin(); it != children.end(); ++it)
-          tree.intersect(**it, intersectionList, !swap_tree);
-      } break;
-      case 2:  // first leaf, second is a tree
-      {
-        vector<PtrAABB>::const_iterator it;
-        for (it = tree.children.begin(); it != tree.children.end(); ++it)
-          this->intersect(**it, intersectionList, swap_tree);
-      } break;
-      case 3:  // first is a tree, second is a tree
-      {
-        vector<PtrAABB>::const_iterator c1;
-        vector<PtrAABB>::const_iterator c2;
-        for (c1 = children.begin(); c1 != children.end(); ++c1)
-          for (c2 = tree.children.begin(); c2 != tree.children.end(); ++c2)
-            (*c1)->intersect(**c2, intersectionList, swap_tree);
-      } break;
+          intersectionList.emplace_back(bb1, bb2);
+      }
     }
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  real_type AABBtree::min_maxdist(real_type x, real_type y, AABBtree const & tree, real_type mmDist) {
-    vector<PtrAABB> const & children = tree.children;
+  template <typename T>
+  T AABBtreeT<T>::min_maxdist(T x, T y, int_type inode, T mmDist) const {
+    Node const & N = m_nodes[size_t(inode)];
 
-    if (children.empty()) {
-      real_type dst = tree.pBBox->maxDistance(x, y);
-      return min(dst, mmDist);
+    if (N.is_leaf()) {
+      for (int_type k = N.first; k < N.first + N.num; ++k)
+        mmDist = min(bbox_max_distance(&m_prim_bbox[4 * size_t(k)], x, y), mmDist);
+      return mmDist;
     }
 
-    real_type dmin = tree.pBBox->distance(x, y);
+    T dmin = bbox_distance(N.bbox, x, y);
     if (dmin > mmDist)
       return mmDist;
 
     // check bbox with
-    vector<PtrAABB>::const_iterator it;
-    for (it = children.begin(); it != children.end(); ++it)
-      mmDist = min_maxdist(x, y, **it, mmDist);
-
-    return mmDist;
+    mmDist = min_maxdist(x, y, N.first, mmDist);
+    return min_maxdist(x, y, N.first + 1, mmDist);
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::min_maxdist_select(
-      real_type x, real_type y, real_type mmDist, AABBtree const & tree, VecPtrBBox & candidateList) {
-    vector<PtrAABB> const & children = tree.children;
-    real_type               dst      = tree.pBBox->distance(x, y);
+  template <typename T>
+  void AABBtreeT<T>::min_maxdist_select(T x, T y, T mmDist, int_type inode, VecPtrBBox & candidateList) const {
+    Node const & N   = m_nodes[size_t(inode)];
+    T            dst = bbox_distance(N.bbox, x, y);
     if (dst <= mmDist) {
-      if (children.empty()) {
-        candidateList.push_back(tree.pBBox);
+      if (N.is_leaf()) {
+        for (int_type k = N.first; k < N.first + N.num; ++k)
+          if (N.num == 1 || bbox_distance(&m_prim_bbox[4 * size_t(k)], x, y) <= mmDist)
+            candidateList.push_back(m_bboxes[size_t(k)]);
       } else {
         // check bbox with
-        vector<PtrAABB>::const_iterator it;
-        for (it = children.begin(); it != children.end(); ++it)
-          min_maxdist_select(x, y, mmDist, **it, candidateList);
+        min_maxdist_select(x, y, mmDist, N.first, candidateList);
+        min_maxdist_select(x, y, mmDist, N.first + 1, candidateList);
+      }
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::min_distance(T x, T y, VecPtrBBox & candidateList) const {
+    if (empty())
+      return;
+    T mmDist = min_maxdist(x, y, 0, numeric_limits<T>::infinity());
+    min_maxdist_select(x, y, mmDist, 0, candidateList);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::query_radius(T x, T y, T r, VecPtrBBox & out) const {
+    out.clear();
+    this->visit_near(x, y, r, [&out, r](PtrBBox const & box, T) {
+      out.push_back(box);
+      return r;
+    });
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::query_box_node(int_type inode, T const * bb, VecPtrBBox & out) const {
+    Node const & N = m_nodes[size_t(inode)];
+    if (!overlap(N.bbox, bb))
+      return;
+    if (N.is_leaf()) {
+      for (int_type k = N.first; k < N.first + N.num; ++k)
+        if (N.num == 1 || overlap(&m_prim_bbox[4 * size_t(k)], bb))
+          out.push_back(m_bboxes[size_t(k)]);
+    } else {
+      query_box_node(N.first, bb, out);
+      query_box_node(N.first + 1, bb, out);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // The lanes are combined with `&` and `|`, not `&&`, so that the loops
+  // have no branch and every clone compiles them to vector compares.
+
+  template <typename T>
+  G2LIB_TARGET_CLONES
+  int_type AABBtreeT<T>::overlap4(T const * bb, WideNode const & W) {
+    int_type mask = 0;
+    for (int_type c = 0; c < 4; ++c)
+      mask |= int_type((W.xmin[c] <= bb[2]) & (W.xmax[c] >= bb[0]) & (W.ymin[c] <= bb[3]) & (W.ymax[c] >= bb[1])) << c;
+    return mask & ((1 << W.size) - 1);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  G2LIB_TARGET_CLONES
+  void AABBtreeT<T>::overlap4x4(WideNode const & A, WideNode const & B, int_type mask[4]) {
+    int_type used = (1 << B.size) - 1;
+    for (int_type a = 0; a < 4; ++a) {
+      int_type m = 0;
+      for (int_type b = 0; b < 4; ++b)
+        m |= int_type(
+                 (B.xmin[b] <= A.xmax[a]) & (B.xmax[b] >= A.xmin[a]) & (B.ymin[b] <= A.ymax[a]) &
+                 (B.ymax[b] >= A.ymin[a]))
+             << b;
+      mask[a] = m & used;
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  G2LIB_TARGET_CLONES
+  void AABBtreeT<T>::distance4(WideNode const & W, T x, T y, T d[4]) {
+    // the clamps are written as selects and kept apart from the products, so
+    // that they become vector max instead of branches
+    T dx[4], dy[4];
+    for (int_type c = 0; c < 4; ++c) {
+      T ax  = W.xmin[c] - x;
+      T ay  = W.ymin[c] - y;
+      T bx  = x - W.xmax[c];
+      T by  = y - W.ymax[c];
+      ax    = ax > bx ? ax : bx;
+      ay    = ay > by ? ay : by;
+      dx[c] = ax > 0 ? ax : 0;
+      dy[c] = ay > 0 ? ay : 0;
+    }
+    for (int_type c = 0; c < 4; ++c)
+      d[c] = std::sqrt(dx[c] * dx[c] + dy[c] * dy[c]);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::query_box_wide(int_type iwide, T const * bb, VecPtrBBox & out) const {
+    WideNode const & W = m_wide_nodes[size_t(iwide)];
+    for (int_type mask = overlap4(bb, W), c = 0; mask != 0; mask >>= 1, ++c) {
+      if ((mask & 1) == 0)
+        continue;
+      if (W.num[c] == 0) {
+        query_box_wide(W.child[c], bb, out);
+        continue;
+      }
+      for (int_type k = W.child[c]; k < W.child[c] + W.num[c]; ++k)
+        if (W.num[c] == 1 || overlap(&m_prim_bbox[4 * size_t(k)], bb))
+          out.push_back(m_bboxes[size_t(k)]);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::query_box(T xmin, T ymin, T xmax, T ymax, VecPtrBBox & out) const {
+    out.clear();
+    if (empty())
+      return;
+    T bb[4] = {xmin, ymin, xmax, ymax};
+    if (m_wide_nodes.empty())
+      query_box_node(0, bb, out);
+    else if (overlap(m_nodes.front().bbox, bb))
+      query_box_wide(0, bb, out);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void AABBtreeT<T>::knn(T x, T y, int_type k, VecDistPtrBBox & out) const {
+    out.clear();
+    if (k <= 0)
+      return;
+    // `out` is a max-heap on the distance of the k nearest bboxes found
+    size_t kk      = size_t(k);
+    auto   nearer  = [](DistPtrBBox const & a, DistPtrBBox const & b) { return a.first < b.first; };
+    auto   collect = [&out, kk, &nearer](PtrBBox const & box, T d) {
+      if (out.size() < kk) {
+        out.push_back(DistPtrBBox(d, box));
+        std::push_heap(out.begin(), out.end(), nearer);
+      } else if (d < out.front().first) {
+        std::pop_heap(out.begin(), out.end(), nearer);
+        out.back() = DistPtrBBox(d, box);
+        std::push_heap(out.begin(), out.end(), nearer);
       }
+      return out.size() < kk ? numeric_limits<T>::infinity() : out.front().first;
+    };
+    this->visit_near(x, y, numeric_limits<T>::infinity(), collect);
+    std::sort_heap(out.begin(), out.end(), nearer);
+  }
+
+  template class BBoxT<float>;
+  template class BBoxT<double>;
+  template class AABBtreeT<float>;
+  template class AABBtreeT<double>;
+
+  /*\
+   |   ____                              _
+   |  |  _ \ _   _ _ __   __ _ _ __ ___ (_) ___
+   |  | | | | | | | '_ \ / _` | '_ ` _ \| |/ __|
+   |  | |_| | |_| | | | | (_| | | | | | | | (__
+   |  |____/ \__, |_| |_|\__,_|_| |_| |_|_|\___|
+   |         |___/
+  \*/
+
+  template <typename T>
+  static inline void merge_bbox(T const * a, T const * b, T * c) {
+    c[0] = min(a[0], b[0]);
+    c[1] = min(a[1], b[1]);
+    c[2] = max(a[2], b[2]);
+    c[3] = max(a[3], b[3]);
+  }
+
+  template <typename T>
+  static inline T half_perimeter(T const * bb) { return (bb[2] - bb[0]) + (bb[3] - bb[1]); }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  DynamicAABBtreeT<T>::DynamicAABBtreeT(T margin)
+      : m_root(-1), m_free(-1), m_size(0), m_margin(margin > 0 ? margin : 0) {}
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::clear() {
+    m_nodes.clear();
+    m_root = -1;
+    m_free = -1;
+    m_size = 0;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  int_type DynamicAABBtreeT<T>::allocate_node() {
+    int_type i;
+    if (m_free >= 0) {
+      i      = m_free;
+      m_free = m_nodes[size_t(i)].parent;
+    } else {
+      i = int_type(m_nodes.size());
+      m_nodes.push_back(Node());
     }
+    Node & N   = m_nodes[size_t(i)];
+    N.parent   = -1;
+    N.child[0] = -1;
+    N.child[1] = -1;
+    N.height   = 0;
+    return i;
+  }
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::free_node(int_type i) {
+    Node & N = m_nodes[size_t(i)];
+    N.box.reset();
+    N.height = -1;
+    N.parent = m_free;
+    m_free   = i;
+  }
+
+  template <typename T>
+  bool DynamicAABBtreeT<T>::is_box(int_type id) const {
+    return id >= 0 && size_t(id) < m_nodes.size() && m_nodes[size_t(id)].height == 0 && m_nodes[size_t(id)].box;
+  }
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::set_leaf(int_type leaf, PtrBBox const & box) {
+    Node & N  = m_nodes[size_t(leaf)];
+    N.box     = box;
+    N.bbox[0] = box->x_min() - m_margin;
+    N.bbox[1] = box->y_min() - m_margin;
+    N.bbox[2] = box->x_max() + m_margin;
+    N.bbox[3] = box->y_max() + m_margin;
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::min_distance(real_type x, real_type y, VecPtrBBox & candidateList) const {
-    real_type mmDist = min_maxdist(x, y, *this, numeric_limits<real_type>::infinity());
-    min_maxdist_select(x, y, mmDist, *this, candidateList);
+  //
+  // Rotate the subtree rooted at `i` when the heights of its children
+  // differ by more than one: the taller child goes up and its taller
+  // child is kept, the other one moves under `i`. Returns the new root of
+  // the subtree.
+  //
+  template <typename T>
+  int_type DynamicAABBtreeT<T>::balance(int_type ia) {
+    Node & A = m_nodes[size_t(ia)];
+    if (A.is_leaf() || A.height < 2)
+      return ia;
+
+    int_type bal = m_nodes[size_t(A.child[1])].height - m_nodes[size_t(A.child[0])].height;
+    if (bal >= -1 && bal <= 1)
+      return ia;
+
+    int_type up   = bal > 1 ? 1 : 0;  // child going up
+    int_type iu   = A.child[up];
+    int_type io   = A.child[1 - up];  // child staying under A
+    Node &   U    = m_nodes[size_t(iu)];
+    int_type iu0  = U.child[0];
+    int_type iu1  = U.child[1];
+    bool     keep = m_nodes[size_t(iu0)].height > m_nodes[size_t(iu1)].height;
+    int_type ik   = keep ? iu0 : iu1;  // stays under U
+    int_type im   = keep ? iu1 : iu0;  // moves under A
+
+    // U takes the place of A
+    U.child[0] = ia;
+    U.child[1] = ik;
+    U.parent   = A.parent;
+    A.parent   = iu;
+    if (U.parent >= 0) {
+      Node & P = m_nodes[size_t(U.parent)];
+      P.child[P.child[0] == ia ? 0 : 1] = iu;
+    } else {
+      m_root = iu;
+    }
+
+    // A keeps the other child and takes the moved one
+    A.child[up]                = im;
+    A.child[1 - up]            = io;
+    m_nodes[size_t(im)].parent = ia;
+
+    Node const & O = m_nodes[size_t(io)];
+    Node const & M = m_nodes[size_t(im)];
+    Node const & K = m_nodes[size_t(ik)];
+    merge_bbox(O.bbox, M.bbox, A.bbox);
+    A.height = 1 + max(O.height, M.height);
+    merge_bbox(A.bbox, K.bbox, U.bbox);
+    U.height = 1 + max(A.height, K.height);
+    return iu;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::fix_upwards(int_type i) {
+    while (i >= 0) {
+      i               = balance(i);
+      Node &       N  = m_nodes[size_t(i)];
+      Node const & C0 = m_nodes[size_t(N.child[0])];
+      Node const & C1 = m_nodes[size_t(N.child[1])];
+      merge_bbox(C0.bbox, C1.bbox, N.bbox);
+      N.height = 1 + max(C0.height, C1.height);
+      i        = N.parent;
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // The leaf becomes the sibling of the node minimizing the increase of
+  // perimeter of the tree: a node is chosen when pairing the leaf with it
+  // costs less than the best pairing found down either child, where going
+  // down adds the growth of the bounds of the node.
+  //
+  template <typename T>
+  void DynamicAABBtreeT<T>::insert_leaf(int_type leaf) {
+    if (m_root < 0) {
+      m_root                       = leaf;
+      m_nodes[size_t(leaf)].parent = -1;
+      return;
+    }
+    T const * lb = m_nodes[size_t(leaf)].bbox;
+    int_type  i  = m_root;
+    while (!m_nodes[size_t(i)].is_leaf()) {
+      Node const & N = m_nodes[size_t(i)];
+      T            cb[4];
+      merge_bbox(N.bbox, lb, cb);
+      T P       = half_perimeter(N.bbox);
+      T cost    = 2 * half_perimeter(cb);
+      T inherit = 2 * (half_perimeter(cb) - P);
+      T cost_child[2];
+      for (int_type c = 0; c < 2; ++c) {
+        Node const & C = m_nodes[size_t(N.child[c])];
+        merge_bbox(C.bbox, lb, cb);
+        cost_child[c] = half_perimeter(cb) + inherit - (C.is_leaf() ? 0 : half_perimeter(C.bbox));
+      }
+      if (cost < cost_child[0] && cost < cost_child[1])
+        break;
+      i = N.child[cost_child[0] <= cost_child[1] ? 0 : 1];
+    }
+
+    int_type sibling = i;
+    int_type parent  = m_nodes[size_t(sibling)].parent;
+    int_type np      = allocate_node();  // may reallocate the nodes
+    Node &   P       = m_nodes[size_t(np)];
+    P.parent         = parent;
+    P.child[0]       = sibling;
+    P.child[1]       = leaf;
+    P.height         = m_nodes[size_t(sibling)].height + 1;
+    merge_bbox(m_nodes[size_t(sibling)].bbox, m_nodes[size_t(leaf)].bbox, P.bbox);
+    if (parent >= 0) {
+      Node & G                               = m_nodes[size_t(parent)];
+      G.child[G.child[0] == sibling ? 0 : 1] = np;
+    } else {
+      m_root = np;
+    }
+    m_nodes[size_t(sibling)].parent = np;
+    m_nodes[size_t(leaf)].parent    = np;
+    fix_upwards(parent);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::remove_leaf(int_type leaf) {
+    if (leaf == m_root) {
+      m_root = -1;
+      return;
+    }
+    int_type parent  = m_nodes[size_t(leaf)].parent;
+    Node &   P       = m_nodes[size_t(parent)];
+    int_type grand   = P.parent;
+    int_type sibling = P.child[P.child[0] == leaf ? 1 : 0];
+
+    m_nodes[size_t(sibling)].parent = grand;
+    if (grand >= 0) {
+      Node & G                              = m_nodes[size_t(grand)];
+      G.child[G.child[0] == parent ? 0 : 1] = sibling;
+    } else {
+      m_root = sibling;
+    }
+    free_node(parent);
+    fix_upwards(grand);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  int_type DynamicAABBtreeT<T>::insert(PtrBBox const & box) {
+    G2LIB_UTILS_ASSERT0(box, "DynamicAABBtree::insert, empty box\n");
+    int_type leaf = allocate_node();
+    set_leaf(leaf, box);
+    insert_leaf(leaf);
+    ++m_size;
+    return leaf;
+  }
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::remove(int_type id) {
+    G2LIB_UTILS_ASSERT(is_box(id), "DynamicAABBtree::remove, bad handle %d\n", id);
+    remove_leaf(id);
+    free_node(id);
+    --m_size;
+  }
+
+  template <typename T>
+  bool DynamicAABBtreeT<T>::update(int_type id, PtrBBox const & box) {
+    G2LIB_UTILS_ASSERT(is_box(id), "DynamicAABBtree::update, bad handle %d\n", id);
+    G2LIB_UTILS_ASSERT0(box, "DynamicAABBtree::update, empty box\n");
+    Node & N = m_nodes[size_t(id)];
+    if (box->x_min() >= N.bbox[0] && box->y_min() >= N.bbox[1] && box->x_max() <= N.bbox[2] &&
+        box->y_max() <= N.bbox[3]) {
+      N.box = box;  // still inside the enlarged bounds
+      return false;
+    }
+    remove_leaf(id);
+    set_leaf(id, box);
+    insert_leaf(id);
+    return true;
+  }
+
+  template <typename T>
+  typename DynamicAABBtreeT<T>::PtrBBox const & DynamicAABBtreeT<T>::get(int_type id) const {
+    G2LIB_UTILS_ASSERT(is_box(id), "DynamicAABBtree::get, bad handle %d\n", id);
+    return m_nodes[size_t(id)].box;
+  }
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::bbox(T & xmin, T & ymin, T & xmax, T & ymax) const {
+    G2LIB_UTILS_ASSERT0(!this->empty(), "DynamicAABBtree::bbox, empty tree\n");
+    T const * bb = m_nodes[size_t(m_root)].bbox;
+    xmin         = bb[0];
+    ymin         = bb[1];
+    xmax         = bb[2];
+    ymax         = bb[3];
+  }
+
+  template <typename T>
+  void DynamicAABBtreeT<T>::intersect(
+      AABBtreeT<T> const & tree, VecPairPtrBBox & intersectionList, bool swap_tree) const {
+    auto fun = [&intersectionList](PtrBBox const & bb1, PtrBBox const & bb2) {
+      intersectionList.emplace_back(bb1, bb2);
+    };
+    this->intersect_visit(tree, fun, swap_tree);
+  }
+
+  template class DynamicAABBtreeT<float>;
+  template class DynamicAABBtreeT<double>;
+
+  /*\
+   |   _____     _                   _       ____
+   |  |_   _| __(_) __ _ _ __   __ _| | ___ / ___|_____   _____ _ __
+   |    | || '__| |/ _` | '_ \ / _` | |/ _ \ |   / _ \ \ / / _ \ '__|
+   |    | || |  | | (_| | | | | (_| | |  __/ |__| (_) \ V /  __/ |
+   |    |_||_|  |_|\__,_|_| |_|\__, |_|\___|\____\___/ \_/ \___|_|
+   |                           |___/
+  \*/
+
+  template <typename T>
+  void TriangleCoverT<T>::build_tree(int_type id) {
+    vector<typename AABBtreeT<T>::PtrBBox> bboxes;
+    bboxes.reserve(tri.size());
+    typename vector<Triangle2DT<T>>::const_iterator it;
+    int_type                                        ipos = 0;
+    for (it = tri.begin(); it != tri.end(); ++it, ++ipos) {
+      T xmin, ymin, xmax, ymax;
+      it->bbox(xmin, ymin, xmax, ymax);
+      bboxes.push_back(make_shared<BBoxT<T> const>(xmin, ymin, xmax, ymax, id, ipos));
+    }
+    tree.build(bboxes);
+    build_soa();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void TriangleCoverT<T>::build_soa() {
+    soa.clear();
+    soa.reserve(tri.size());
+    for (typename AABBtreeT<T>::PtrBBox const & bb : tree.m_bboxes) {
+      size_t ipos = size_t(bb->Ipos());
+      soa.push_back(tri[ipos], clipped ? height[ipos] : -1);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool TriangleCoverT<T>::same(T _offs, T _max_angle, T _max_size) const {
+    return Utils::isZero(_offs - offs) && Utils::isZero(_max_angle - max_angle) &&
+           Utils::isZero(_max_size - max_size) && tree.wide() == aabb_wide_nodes;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void TriangleCoverT<T>::intersect_pairs(
+      TriangleCoverT const &                                         TC,
+      int_type                                                       nthreads,
+      vector<pair<Triangle2DT<T> const *, Triangle2DT<T> const *>> & pairs,
+      AABBintersectCounters *                                        counters) const {
+    using PairTri = pair<Triangle2DT<T> const *, Triangle2DT<T> const *>;
+    nthreads      = Utils::num_threads(nthreads);
+    vector<pair<int_type, int_type>> tasks = tree.intersect_tasks(TC.tree, nthreads);
+    vector<vector<PairTri>>          found(tasks.size());
+    vector<AABBintersectCounters>    count(tasks.size());
+    Utils::parallel_for(nthreads, tasks.size(), [&](size_t k) {
+      vector<PairTri> & F    = found[k];
+      auto              ifun = [&F](Triangle2DT<T> const & T1, Triangle2DT<T> const & T2) {
+        F.emplace_back(&T1, &T2);
+      };
+      vector<int_type> hit;
+      tree.intersect_leaves(TC.tree, tasks[k], [&](int_type k0, int_type nk, int_type l0, int_type nl) -> bool {
+        this->leaf_pairs(TC, k0, nk, l0, nl, hit, count[k], ifun);
+        return false;
+      });
+    });
+    size_t n = pairs.size();
+    for (vector<PairTri> const & F : found)
+      n += F.size();
+    pairs.reserve(n);
+    for (size_t k = 0; k < tasks.size(); ++k) {
+      pairs.insert(pairs.end(), found[k].begin(), found[k].end());
+      if (counters != nullptr) {
+        counters->tested += count[k].tested;
+        counters->refined += count[k].refined;
+      }
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void TriangleCoverT<T>::refit_tree(TriangleCoverT const & TC) {
+    tree.refit(TC.tree, [this](typename AABBtreeT<T>::PtrBBox const & bb) {
+      T xmin, ymin, xmax, ymax;
+      tri[size_t(bb->Ipos())].bbox(xmin, ymin, xmax, ymax);
+      return make_shared<BBoxT<T> const>(xmin, ymin, xmax, ymax, bb->Id(), bb->Ipos());
+    });
+    build_soa();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  typename TriangleCoverT<T>::PtrCover TriangleCoverT<T>::translated(T tx, T ty) const {
+    auto TC     = make_shared<TriangleCoverT>(offs, max_angle, max_size);
+    TC->tri     = tri;
+    TC->height  = height;
+    TC->clipped = clipped;
+    for (Triangle2DT<T> & Tri : TC->tri)
+      Tri.translate(tx, ty);
+    TC->refit_tree(*this);
+    return TC;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  typename TriangleCoverT<T>::PtrCover TriangleCoverT<T>::rotated(T angle, T cx, T cy) const {
+    auto TC     = make_shared<TriangleCoverT>(offs, max_angle, max_size);
+    TC->tri     = tri;
+    TC->height  = height;
+    TC->clipped = clipped;
+    for (Triangle2DT<T> & Tri : TC->tri)
+      Tri.rotate(angle, cx, cy);
+    TC->refit_tree(*this);
+    return TC;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // header of the saved covers: "G2LIBTC1", layout, key, number of covers, size and checksum of the data
+  static std::uint64_t const COVER_MAGIC = 0x31435442494c3247ULL;
+  template <typename T>
+  static std::uint64_t const COVER_LAYOUT = (std::uint64_t(2) << 16) | (sizeof(T) << 8) | sizeof(int_type);
+
+  template <typename T>
+  void TriangleCoverT<T>::save(ostream_type & stream, vector<PtrCover> const & covers, std::uint64_t key) {
+    vector<char> data;
+    for (PtrCover const & TC : covers) {
+      T                par[3] = {TC->offs, TC->max_angle, TC->max_size};
+      std::uint64_t    ntri   = TC->tri.size();
+      std::uint64_t    clip   = TC->clipped ? 1 : 0;
+      vector<T>        P;
+      vector<int_type> I;
+      P.reserve(8 * TC->tri.size());
+      I.reserve(TC->tri.size());
+      for (Triangle2DT<T> const & Tri : TC->tri) {
+        T const p[8] = {Tri.x1(), Tri.y1(), Tri.x2(), Tri.y2(), Tri.x3(), Tri.y3(), Tri.S0(), Tri.S1()};
+        P.insert(P.end(), p, p + 8);
+        I.push_back(Tri.Icurve());
+      }
+      pack_data(data, par, 3);
+      pack_data(data, &ntri, 1);
+      pack_data(data, P.data(), P.size());
+      pack_data(data, I.data(), I.size());
+      pack_data(data, &clip, 1);
+      if (TC->clipped)
+        pack_data(data, TC->height.data(), TC->height.size());
+      TC->tree.pack(data);
+    }
+    std::uint64_t head[6] = {COVER_MAGIC, COVER_LAYOUT<T>, key, covers.size(), data.size(),
+                             Utils::hash_bytes(data.data(), data.size())};
+    stream.write(reinterpret_cast<char const *>(head), sizeof(head));
+    stream.write(data.data(), std::streamsize(data.size()));
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool TriangleCoverT<T>::load(void const * data, size_t size, std::uint64_t key, vector<PtrCover> & covers) {
+    char const *  p   = static_cast<char const *>(data);
+    char const *  end = p + size;
+    std::uint64_t head[6];
+    if (!unpack_data(p, end, head, 6) || head[0] != COVER_MAGIC || head[1] != COVER_LAYOUT<T> || head[2] != key ||
+        head[4] > std::uint64_t(end - p))
+      return false;
+    end = p + head[4];
+    if (Utils::hash_bytes(p, size_t(head[4])) != head[5])
+      return false;
+
+    vector<PtrCover> C;
+    for (std::uint64_t k = 0; k < head[3]; ++k) {
+      T             par[3];
+      std::uint64_t ntri;
+      if (!unpack_data(p, end, par, 3) || !unpack_data(p, end, &ntri, 1) ||
+          ntri > std::uint64_t(end - p) / (8 * sizeof(T)))
+        return false;
+      size_t           n  = size_t(ntri);
+      auto             TC = make_shared<TriangleCoverT>(par[0], par[1], par[2]);
+      vector<T>        P(8 * n);
+      vector<int_type> I(n);
+      std::uint64_t    clip;
+      if (!unpack_data(p, end, P.data(), P.size()) || !unpack_data(p, end, I.data(), I.size()) ||
+          !unpack_data(p, end, &clip, 1) || clip > 1)
+        return false;
+      TC->clipped = clip != 0;
+      if (TC->clipped) {
+        TC->height.resize(n);
+        if (!unpack_data(p, end, TC->height.data(), n))
+          return false;
+      }
+      if (!TC->tree.unpack(p, end) || TC->tree.num_bboxes() != n)
+        return false;
+      // every box must refer to a triangle
+      for (typename AABBtreeT<T>::PtrBBox const & bb : TC->tree.m_bboxes)
+        if (bb->Ipos() < 0 || size_t(bb->Ipos()) >= n)
+          return false;
+      TC->tri.reserve(n);
+      for (size_t i = 0; i < n; ++i) {
+        T const * t = &P[8 * i];
+        TC->tri.emplace_back(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], I[i]);
+      }
+      TC->build_soa();
+      C.push_back(TC);
+    }
+    if (p != end)
+      return false;
+    covers.swap(C);
+    return true;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool TriangleCoverT<T>::load(istream_type & stream, std::uint64_t key, vector<PtrCover> & covers) {
+    std::uint64_t head[6];
+    if (!stream.read(reinterpret_cast<char *>(head), sizeof(head)) || head[0] != COVER_MAGIC ||
+        head[1] != COVER_LAYOUT<T> || head[2] != key)
+      return false;
+    vector<char> buffer(sizeof(head) + size_t(head[4]));
+    std::memcpy(buffer.data(), head, sizeof(head));
+    if (!stream.read(buffer.data() + sizeof(head), std::streamsize(head[4])))
+      return false;
+    return load(buffer.data(), buffer.size(), key, covers);
+  }
+
+  template class TriangleCoverT<float>;
+  template class TriangleCoverT<double>;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void TriangleCoverCache::insert(PtrTriangleCover const & TC) {
+    // called with m_mutex held: the covers used since the last miss become
+    // the most recent ones, then add `TC` and drop the least recently used
+    shared_ptr<Entries const> E = m_entries.load();
+    auto                      N = make_shared<Entries>();
+    if (E != nullptr) {
+      for (PtrTriangleCover const & T : *E) {
+        if (T->used.load(std::memory_order_relaxed)) {
+          T->used.store(false, std::memory_order_relaxed);
+          T->last_use.store(++m_clock, std::memory_order_relaxed);
+        }
+      }
+      *N = *E;
+    }
+    TC->used.store(false, std::memory_order_relaxed);
+    TC->last_use.store(++m_clock, std::memory_order_relaxed);
+    N->push_back(TC);
+    auto older = [](PtrTriangleCover const & a, PtrTriangleCover const & b) {
+      return a->last_use.load(std::memory_order_relaxed) < b->last_use.load(std::memory_order_relaxed);
+    };
+    while (N->size() > m_capacity)
+      N->erase(std::min_element(N->begin(), N->end(), older));
+    m_entries.publish(N);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  TriangleCoverCache::HitCounter * TriangleCoverCache::hit_counters() const {
+    // first hit: allocate the counters, the loser of a race frees its own
+    HitCounter * H       = new HitCounter[HIT_COUNTERS];
+    HitCounter * current = nullptr;
+    if (!m_hits.compare_exchange_strong(current, H, std::memory_order_acq_rel)) {
+      delete[] H;
+      H = current;
+    }
+    return H;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  std::uint64_t TriangleCoverCache::hits() const {
+    HitCounter const * H = m_hits.load(std::memory_order_acquire);
+    std::uint64_t      n = 0;
+    if (H != nullptr)
+      for (size_t i = 0; i < HIT_COUNTERS; ++i)
+        n += H[i].n.load(std::memory_order_relaxed);
+    return n;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void TriangleCoverCache::reset_counters() {
+    HitCounter * H = m_hits.load(std::memory_order_acquire);
+    if (H != nullptr)
+      for (size_t i = 0; i < HIT_COUNTERS; ++i)
+        H[i].n.store(0, std::memory_order_relaxed);
+    m_misses = 0;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void TriangleCoverCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  vector<PtrTriangleCover> TriangleCoverCache::covers() const {
+    shared_ptr<Entries const> E = m_entries.load();
+    vector<PtrTriangleCover>  C;
+    if (E != nullptr)
+      C = *E;
+    // used since the last miss first, then by LRU stamp
+    std::sort(C.begin(), C.end(), [](PtrTriangleCover const & a, PtrTriangleCover const & b) {
+      bool ua = a->used.load(std::memory_order_relaxed);
+      bool ub = b->used.load(std::memory_order_relaxed);
+      if (ua != ub)
+        return ua;
+      return a->last_use.load(std::memory_order_relaxed) > b->last_use.load(std::memory_order_relaxed);
+    });
+    return C;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void TriangleCoverCache::add(PtrTriangleCover const & TC) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    shared_ptr<Entries const>   E = m_entries.load();
+    if (E != nullptr) {
+      // drop the replaced cover, the readers holding it keep it alive
+      auto N = make_shared<Entries>();
+      for (PtrTriangleCover const & T : *E)
+        if (!Utils::isZero(T->offs - TC->offs) || !Utils::isZero(T->max_angle - TC->max_angle) ||
+            !Utils::isZero(T->max_size - TC->max_size))
+          N->push_back(T);
+      m_entries.publish(N);
+    }
+    this->insert(TC);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void TriangleCoverCache::set_capacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity                  = capacity > 0 ? capacity : 1;
+    shared_ptr<Entries const> E = m_entries.load();
+    if (E != nullptr && E->size() > m_capacity) {
+      // keep the most recently used
+      vector<PtrTriangleCover> C = this->covers();
+      C.resize(m_capacity);
+      m_entries.publish(make_shared<Entries>(std::move(C)));
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  size_t TriangleCoverCache::size() const {
+    shared_ptr<Entries const> E = m_entries.load();
+    return E != nullptr ? E->size() : 0;
   }
 
 }  // namespace G2lib
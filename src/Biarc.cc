@@ -717,6 +717,29 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  bool Biarc::raycast_ISO(
+      real_type   x0,
+      real_type   y0,
+      real_type   dx,
+      real_type   dy,
+      real_type   offs,
+      real_type   tmax,
+      real_type & t,
+      real_type & s) const {
+    bool ok = m_C0.raycast_ISO(x0, y0, dx, dy, offs, tmax, t, s);
+    if (ok)
+      tmax = t;
+    real_type t1, s1;
+    if (m_C1.raycast_ISO(x0, y0, dx, dy, offs, tmax, t1, s1) && (!ok || t1 < t)) {
+      t  = t1;
+      s  = s1 + m_C0.length();
+      ok = true;
+    }
+    return ok;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   void Biarc::intersect_ISO(
       real_type offs, Biarc const & B, real_type offs_B, IntersectList & ilist, bool swap_s_vals) const {
     IntersectList ilist00, ilist01, ilist10, ilist11;
@@ -57,32 +57,27 @@ namespace G2lib {
    |
   \*/
 
-  BiarcList::BiarcList(LineSegment const & LS) : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) {
-    this->resetLastInterval();
+  BiarcList::BiarcList(LineSegment const & LS) : BaseCurve(G2LIB_BIARC_LIST) {
     this->init();
     this->push_back(LS);
   }
 
-  BiarcList::BiarcList(CircleArc const & C) : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) {
-    this->resetLastInterval();
+  BiarcList::BiarcList(CircleArc const & C) : BaseCurve(G2LIB_BIARC_LIST) {
     this->init();
     this->push_back(C);
   }
 
-  BiarcList::BiarcList(Biarc const & C) : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) {
-    this->resetLastInterval();
+  BiarcList::BiarcList(Biarc const & C) : BaseCurve(G2LIB_BIARC_LIST) {
     this->init();
     this->push_back(C);
   }
 
-  BiarcList::BiarcList(PolyLine const & pl) : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) {
-    this->resetLastInterval();
+  BiarcList::BiarcList(PolyLine const & pl) : BaseCurve(G2LIB_BIARC_LIST) {
     this->init();
     this->push_back(pl);
   }
 
-  BiarcList::BiarcList(BaseCurve const & C) : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) {
-    this->resetLastInterval();
+  BiarcList::BiarcList(BaseCurve const & C) : BaseCurve(G2LIB_BIARC_LIST) {
     this->init();
     switch (C.type()) {
       case G2LIB_LINE:
@@ -111,8 +106,7 @@ namespace G2lib {
   void BiarcList::init() {
     m_s0.clear();
     m_biarcList.clear();
-    this->resetLastInterval();
-    m_aabb_done = false;
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -128,10 +122,40 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type BiarcList::findAtS(real_type & s) const {
-    auto lastInterval = m_lastInterval.search(std::this_thread::get_id());
+    int_type & lastInterval = Utils::last_interval_hint(this);
     Utils::search_interval<int_type, real_type>(
         static_cast<int_type>(m_s0.size()), &m_s0.front(), s, lastInterval, false, true);
-    return *lastInterval;
+    return lastInterval;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type BiarcList::findAtS(real_type & s, SegmentCursor & cursor) const {
+    Utils::search_interval<int_type, real_type>(
+        static_cast<int_type>(m_s0.size()), &m_s0.front(), s, cursor.interval, false, true);
+    return cursor.interval;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::eval(real_type s, SegmentCursor & cursor, real_type & x, real_type & y) const {
+    int_type idx = findAtS(s, cursor);
+    m_biarcList[idx].Biarc::eval(s - m_s0[idx], x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::eval_ISO(real_type s, real_type offs, SegmentCursor & cursor, real_type & x, real_type & y) const {
+    int_type idx = findAtS(s, cursor);
+    m_biarcList[idx].Biarc::eval_ISO(s - m_s0[idx], offs, x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::evaluate(
+      real_type s, SegmentCursor & cursor, real_type & th, real_type & k, real_type & x, real_type & y) const {
+    int_type idx = findAtS(s, cursor);
+    m_biarcList[idx].Biarc::evaluate(s - m_s0[idx], th, k, x, y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -721,6 +745,46 @@ namespace G2lib {
     return c.eval_ISO_DDD(s - m_s0[idx], offs, x_DDD, y_DDD);
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::eval(int_type n, real_type const * s, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, false, true);
+      int_type idx = lastInterval;
+      m_biarcList[idx].Biarc::eval(si - m_s0[idx], x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, false, true);
+      int_type idx = lastInterval;
+      m_biarcList[idx].Biarc::eval_ISO(si - m_s0[idx], offs, x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::evaluate(
+      int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, false, true);
+      int_type idx = lastInterval;
+      m_biarcList[idx].Biarc::evaluate(si - m_s0[idx], th[i], k[i], x[i], y[i]);
+    }
+  }
+
   /*\
    |  _                        __
    | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -816,7 +880,6 @@ namespace G2lib {
     size_t k = 0;
     for (++ic; ic != m_biarcList.end(); ++ic, ++k)
       m_s0[k + 1] = m_s0[k] + ic->length();
-    this->resetLastInterval();
   }
 
   /*\
@@ -828,27 +891,23 @@ namespace G2lib {
   \*/
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-  void BiarcList::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
-    if (m_aabb_done && Utils::isZero(offs - m_aabb_offs) && Utils::isZero(max_angle - m_aabb_max_angle) &&
-        Utils::isZero(max_size - m_aabb_max_size))
-      return;
+  PtrTriangleCover BiarcList::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
+    return m_aabb.get(
+        [&](TriangleCover const & TC) { return TC.same(offs, max_angle, max_size); },
+        [&]() {
+          auto TC = make_shared<TriangleCover>(offs, max_angle, max_size);
+          bbTriangles_ISO(offs, TC->tri, max_angle, max_size);
+          TC->build_tree(G2LIB_CLOTHOID);
+          return PtrTriangleCover(TC);
+        });
+  }
 
-    vector<shared_ptr<BBox const>> bboxes;
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    bbTriangles_ISO(offs, m_aabb_tri, max_angle, max_size);
-    bboxes.reserve(m_aabb_tri.size());
-    vector<Triangle2D>::const_iterator it;
-    int_type                           ipos = 0;
-    for (it = m_aabb_tri.begin(); it != m_aabb_tri.end(); ++it, ++ipos) {
-      real_type xmin, ymin, xmax, ymax;
-      it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos));
-    }
-    m_aabb_tree.build(bboxes);
-    m_aabb_done      = true;
-    m_aabb_offs      = offs;
-    m_aabb_max_angle = max_angle;
-    m_aabb_max_size  = max_size;
+  PtrTriangleCover BiarcList::aabb_ISO(real_type offs) const {
+    // any cached cover with the right offset is good for the queries
+    PtrTriangleCover TC = m_aabb.find([offs](TriangleCover const & T) { return Utils::isZero(T.offs - offs); });
+    return TC != nullptr ? TC : this->build_AABBtree_ISO(offs);
   }
 #endif
 
@@ -863,19 +922,19 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool BiarcList::collision(BiarcList const & C) const {
-    this->build_AABBtree_ISO(0);
-    C.build_AABBtree_ISO(0);
-    T2D_collision_list_ISO fun(this, 0, &C, 0);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    PtrTriangleCover       TC1 = this->aabb_ISO(0);
+    PtrTriangleCover       TC2 = C.aabb_ISO(0);
+    T2D_collision_list_ISO fun(this, 0, TC1->tri, &C, 0, TC2->tri);
+    return TC1->tree.collision(TC2->tree, fun, false);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool BiarcList::collision_ISO(real_type offs, BiarcList const & C, real_type offs_C) const {
-    this->build_AABBtree_ISO(offs);
-    C.build_AABBtree_ISO(offs_C);
-    T2D_collision_list_ISO fun(this, offs, &C, offs_C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    PtrTriangleCover       TC1 = this->aabb_ISO(offs);
+    PtrTriangleCover       TC2 = C.aabb_ISO(offs_C);
+    T2D_collision_list_ISO fun(this, offs, TC1->tri, &C, offs_C, TC2->tri);
+    return TC1->tree.collision(TC2->tree, fun, false);
   }
 
   /*\
@@ -890,18 +949,14 @@ namespace G2lib {
   void BiarcList::intersect_ISO(
       real_type offs, BiarcList const & CL, real_type offs_CL, IntersectList & ilist, bool swap_s_vals) const {
     if (intersect_with_AABBtree) {
-      this->build_AABBtree_ISO(offs);
-      CL.build_AABBtree_ISO(offs_CL);
-      AABBtree::VecPairPtrBBox iList;
-      m_aabb_tree.intersect(CL.m_aabb_tree, iList);
-
-      AABBtree::VecPairPtrBBox::const_iterator ip;
-      for (ip = iList.begin(); ip != iList.end(); ++ip) {
-        size_t ipos1 = size_t(ip->first->Ipos());
-        size_t ipos2 = size_t(ip->second->Ipos());
+      PtrTriangleCover TC1 = this->aabb_ISO(offs);
+      PtrTriangleCover TC2 = CL.aabb_ISO(offs_CL);
+      TC1->tree.intersect_visit(TC2->tree, [&](AABBtree::PtrBBox const & bb1, AABBtree::PtrBBox const & bb2) {
+        size_t ipos1 = size_t(bb1->Ipos());
+        size_t ipos2 = size_t(bb2->Ipos());
 
-        Triangle2D const & T1 = m_aabb_tri[ipos1];
-        Triangle2D const & T2 = CL.m_aabb_tri[ipos2];
+        Triangle2D const & T1 = TC1->tri[ipos1];
+        Triangle2D const & T2 = TC2->tri[ipos2];
 
         Biarc const & C1 = m_biarcList[T1.Icurve()];
         Biarc const & C2 = CL.m_biarcList[T2.Icurve()];
@@ -916,13 +971,14 @@ namespace G2lib {
             swap(ss1, ss2);
           ilist.push_back(Ipair(ss1, ss2));
         }
-      }
+      });
     } else {
-      bbTriangles_ISO(offs, m_aabb_tri, Utils::m_pi / 18, 1e100);
-      CL.bbTriangles_ISO(offs_CL, CL.m_aabb_tri, Utils::m_pi / 18, 1e100);
+      vector<Triangle2D> tri1, tri2;
+      bbTriangles_ISO(offs, tri1, Utils::m_pi / 18, 1e100);
+      CL.bbTriangles_ISO(offs_CL, tri2, Utils::m_pi / 18, 1e100);
       vector<Triangle2D>::const_iterator i1, i2;
-      for (i1 = m_aabb_tri.begin(); i1 != m_aabb_tri.end(); ++i1) {
-        for (i2 = CL.m_aabb_tri.begin(); i2 != CL.m_aabb_tri.end(); ++i2) {
+      for (i1 = tri1.begin(); i1 != tri1.end(); ++i1) {
+        for (i2 = tri2.begin(); i2 != tri2.end(); ++i2) {
           Triangle2D const & T1 = *i1;
           Triangle2D const & T2 = *i2;
 
@@ -954,31 +1010,27 @@ namespace G2lib {
 
   int_type BiarcList::closest_point_internal(
       real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const {
-    this->build_AABBtree_ISO(offs);
+    PtrTriangleCover TC = this->aabb_ISO(offs);
 
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "BiarcList::closest_point_internal no candidate\n");
+    // best-first: the triangles are refined in order of distance of their bbox
     int_type icurve = 0;
-    DST             = numeric_limits<real_type>::infinity();
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
-      if (dst < DST) {
-        // refine distance
+    auto     refine = [&](AABBtree::PtrBBox const & box, real_type best) -> real_type {
+      Triangle2D const & T   = TC->tri[size_t(box->Ipos())];
+      real_type          dst = T.distMin(qx, qy);
+      if (dst < best) {
         real_type xx, yy, ss, tt;
         m_biarcList[T.Icurve()].closest_point_ISO(qx, qy, offs, xx, yy, ss, tt, dst);
-        if (dst < DST) {
-          DST    = dst;
+        if (dst < best) {
           s      = ss + m_s0[T.Icurve()];
           x      = xx;
           y      = yy;
           icurve = T.Icurve();
         }
       }
-    }
+      return dst;
+    };
+    DST = TC->tree.nearest(qx, qy, refine);
+    G2LIB_UTILS_ASSERT0(Utils::isRegular(DST), "BiarcList::closest_point_internal no candidate\n");
     return icurve;
   }
 
@@ -1002,6 +1054,47 @@ namespace G2lib {
     real_type pt  = abs(qxx * ny - qyy * nx);
     return pt > GLIB2_TOL_ANGLE * hypot(qxx, qyy) ? -(icurve + 1) : icurve;
   }
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::query_radius_ISO(
+      real_type qx, real_type qy, real_type offs, real_type r, vector<SegmentDistance> & out) const {
+    out.clear();
+    PtrTriangleCover TC = this->aabb_ISO(offs);
+    TC->tree.visit_near(qx, qy, r, [&](AABBtree::PtrBBox const & box, real_type) {
+      Triangle2D const & T = TC->tri[size_t(box->Ipos())];
+      if (T.distMin(qx, qy) <= r) {
+        real_type xx, yy, ss, tt, dst;
+        m_biarcList[T.Icurve()].closest_point_ISO(qx, qy, offs, xx, yy, ss, tt, dst);
+        if (dst <= r)
+          out.push_back(SegmentDistance{T.Icurve(), ss + m_s0[T.Icurve()], dst});
+      }
+      return r;
+    });
+    Utils::unique_segments(out);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::knn_ISO(
+      real_type qx, real_type qy, real_type offs, int_type k, vector<SegmentDistance> & out) const {
+    out.clear();
+    if (k <= 0)
+      return;
+    size_t                kk = size_t(k);
+    PtrTriangleCover TC = this->aabb_ISO(offs);
+    TC->tree.visit_near(
+        qx, qy, numeric_limits<real_type>::infinity(), [&](AABBtree::PtrBBox const & box, real_type) {
+          Triangle2D const & T = TC->tri[size_t(box->Ipos())];
+          real_type          r = Utils::knn_radius(out, kk);
+          if (!(T.distMin(qx, qy) < r))
+            return r;
+          real_type xx, yy, ss, tt, dst;
+          m_biarcList[T.Icurve()].closest_point_ISO(qx, qy, offs, xx, yy, ss, tt, dst);
+          return Utils::knn_insert(out, kk, SegmentDistance{T.Icurve(), ss + m_s0[T.Icurve()], dst});
+        });
+    Utils::knn_sort(out);
+  }
+
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
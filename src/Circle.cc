@@ -96,6 +96,8 @@ namespace G2lib {
       m_x0         = x0;
       m_y0         = y0;
       m_theta0     = theta0;
+      m_c0         = cos(theta0);
+      m_s0         = sin(theta0);
       m_k          = 2 * sin(th) / d;
       m_L          = d / Sinc(th);
       return true;
@@ -245,6 +247,46 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  void CircleArc::eval(int_type n, real_type const * s, real_type * x, real_type * y) const {
+    for (int_type i = 0; i < n; ++i) {
+      real_type sk  = (s[i] * m_k) / 2;
+      real_type LS  = s[i] * Sinc(sk);
+      real_type arg = m_theta0 + sk;
+      x[i]          = m_x0 + LS * cos(arg);
+      y[i]          = m_y0 + LS * sin(arg);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void CircleArc::eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+    for (int_type i = 0; i < n; ++i) {
+      real_type sk  = (s[i] * m_k) / 2;
+      real_type LS  = s[i] * Sinc(sk);
+      real_type arg = m_theta0 + sk;
+      real_type th  = m_theta0 + s[i] * m_k;
+      x[i]          = m_x0 + LS * cos(arg) - offs * sin(th);
+      y[i]          = m_y0 + LS * sin(arg) + offs * cos(th);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void CircleArc::evaluate(
+      int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const {
+    for (int_type i = 0; i < n; ++i) {
+      real_type sk  = (s[i] * m_k) / 2;
+      real_type LS  = s[i] * Sinc(sk);
+      real_type arg = m_theta0 + sk;
+      x[i]          = m_x0 + LS * cos(arg);
+      y[i]          = m_y0 + LS * sin(arg);
+      th[i]         = m_theta0 + s[i] * m_k;
+      k[i]          = m_k;
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   void CircleArc::trim(real_type s_begin, real_type s_end) {
     G2LIB_UTILS_ASSERT(
         s_end > s_begin, "CircleArc::trim( begin=%f, s_end=%f ) s_end must be > s_begin\n", s_begin, s_end);
@@ -483,6 +525,76 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  //
+  // The arc at offset `offs` is the circle of center `C = P0 + N0 / k` and
+  // signed radius `rho = offs - 1/k`, written with `w = P0 + offs N0 - x0` to
+  // avoid the cancellation of `rho^2` for large radii. The abscissa of a hit
+  // comes from the chord from the initial point, accurate also for k -> 0.
+  //
+  bool CircleArc::raycast_ISO(
+      real_type   x0,
+      real_type   y0,
+      real_type   dx,
+      real_type   dy,
+      real_type   offs,
+      real_type   tmax,
+      real_type & t,
+      real_type & s) const {
+    real_type len = hypot(dx, dy);
+    if (!(len > 0))
+      return false;
+    dx /= len;
+    dy /= len;
+    if (abs(m_k * m_L) < Utils::machepsi) {
+      LineSegment L(m_x0, m_y0, m_theta0, m_L);
+      return L.raycast_ISO(x0, y0, dx, dy, offs, tmax, t, s);
+    }
+    real_type nx  = -m_s0;
+    real_type ny  = m_c0;
+    real_type rho = offs - 1 / m_k;
+    real_type wx  = m_x0 + offs * nx - x0;
+    real_type wy  = m_y0 + offs * ny - y0;
+    // t^2 + 2 b t + c = 0
+    real_type b    = rho * (dx * nx + dy * ny) - (dx * wx + dy * wy);
+    real_type c    = wx * wx + wy * wy - 2 * rho * (wx * nx + wy * ny);
+    real_type disc = b * b - c;
+    if (disc < 0)
+      return false;
+    real_type q     = -(b + (b < 0 ? -sqrt(disc) : sqrt(disc)));
+    real_type tt[2] = {q, q == 0 ? 0 : c / q};
+    if (tt[1] < tt[0])
+      swap(tt[0], tt[1]);
+
+    real_type sgn  = (1 - offs * m_k) > 0 ? 1 : -1;  // < 0: the offset arc runs backward
+    real_type per  = Utils::m_2pi / abs(m_k);
+    real_type epsi = m_L * Utils::machepsi100;
+    for (real_type const ti : tt) {
+      if (ti < 0 || ti > tmax)
+        continue;
+      // chord from the initial point of the offset arc
+      real_type cx   = sgn * (x0 + ti * dx - (m_x0 + offs * nx));
+      real_type cy   = sgn * (y0 + ti * dy - (m_y0 + offs * ny));
+      real_type half = atan2(m_c0 * cy - m_s0 * cx, m_c0 * cx + m_s0 * cy);  // (k s)/2
+      if (half * m_k < 0)
+        half += m_k > 0 ? Utils::m_pi : -Utils::m_pi;
+      real_type ss;
+      if (abs(half) < 0.5)
+        ss = hypot(cx, cy) / (abs(1 - offs * m_k) * Sinc(half));
+      else
+        ss = 2 * half / m_k;
+      if (ss > per - epsi)
+        ss -= per;  // a hit close to the initial point on the other side
+      if (ss < -epsi || ss > m_L + epsi)
+        continue;
+      t = ti;
+      s = max(real_type(0), min(ss, m_L));
+      return true;
+    }
+    return false;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   bool CircleArc::collision(CircleArc const & C) const {
     real_type s1[2], s2[2];
     int_type  ni   = intersectCircleCircle(m_x0, m_y0, m_theta0, m_k, C.m_x0, C.m_y0, C.m_theta0, C.m_k, s1, s2);
@@ -58,7 +58,7 @@ namespace G2lib {
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  ClothoidCurve::ClothoidCurve(BaseCurve const & C) : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) {
+  ClothoidCurve::ClothoidCurve(BaseCurve const & C) : BaseCurve(G2LIB_CLOTHOID) {
     switch (C.type()) {
       case G2LIB_LINE:
         build(*static_cast<LineSegment const *>(&C));
@@ -92,8 +92,7 @@ namespace G2lib {
     m_CD.kappa0 = _k;
     m_CD.dk     = _dk;
     m_L         = _L;
-    m_aabb_done = false;
-    m_aabb_tree.clear();
+    m_aabb.clear();
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -167,86 +166,15 @@ namespace G2lib {
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void ClothoidCurve::bbTriangles_internal_ISO(
-      real_type            offs,
-      vector<Triangle2D> & tvec,
-      real_type            s_begin,
-      real_type            s_end,
-      real_type            max_angle,
-      real_type            max_size,
-      int_type             icurve) const {
-    static real_type const one_degree = Utils::m_pi / 180;
-
-    real_type ss  = s_begin;
-    real_type thh = m_CD.theta(ss);
-    real_type MX  = min(m_L, max_size);
-    for (int_type npts = 0; ss < s_end; ++npts) {
-      G2LIB_UTILS_ASSERT0(
-          npts < 100000000,
-          "ClothoidCurve::bbTriangles_internal "
-          "is generating too much triangles (>100000000)\n"
-          "something is going wrong or parameters are not well set\n");
-
-      // estimate angle variation and compute step accodingly
-      real_type k   = m_CD.kappa(ss);
-      real_type dss = MX / (1 + k * offs);  // scale length with offset
-      real_type sss = ss + dss;
-      if (sss > s_end) {
-        sss = s_end;
-        dss = s_end - ss;
-      }
-      if (abs(k * dss) > max_angle) {
-        dss = abs(max_angle / k);
-        sss = ss + dss;
-      }
-      // check and recompute if necessary
-      real_type thhh = theta(sss);
-      if (abs(thh - thhh) > max_angle) {
-        k    = m_CD.kappa(sss);
-        dss  = abs(max_angle / k);
-        sss  = ss + dss;
-        thhh = theta(sss);
-      }
-
-      real_type x0, y0, x1, y1;
-      m_CD.eval_ISO(ss, offs, x0, y0);
-      m_CD.eval_ISO(sss, offs, x1, y1);
-
-      real_type tx0   = cos(thh);
-      real_type ty0   = sin(thh);
-      real_type alpha = sss - ss;  // se angolo troppo piccolo uso approx piu rozza
-      if (abs(thh - thhh) > one_degree) {
-        real_type tx1 = cos(thhh);
-        real_type ty1 = sin(thhh);
-        real_type det = tx1 * ty0 - tx0 * ty1;
-        real_type dx  = x1 - x0;
-        real_type dy  = y1 - y0;
-        alpha         = (dy * tx1 - dx * ty1) / det;
-      }
-
-      real_type  x2 = x0 + alpha * tx0;
-      real_type  y2 = y0 + alpha * ty0;
-      Triangle2D t(x0, y0, x2, y2, x1, y1, ss, sss, icurve);
-
-      tvec.push_back(t);
-
-      ss  = sss;
-      thh = thhh;
-    }
+  void ClothoidCurve::bbTriangles_ISO(
+      real_type offs, vector<Triangle2D> & tvec, real_type max_angle, real_type max_size, int_type icurve) const {
+    ClothoidCurveT<real_type>::bbTriangles_ISO(m_CD, m_L, offs, tvec, max_angle, max_size, icurve);
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void ClothoidCurve::bbTriangles_ISO(
-      real_type offs, vector<Triangle2D> & tvec, real_type max_angle, real_type max_size, int_type icurve) const {
-    if (m_CD.kappa0 * m_CD.dk >= 0 || m_CD.kappa(m_L) * m_CD.dk <= 0) {
-      bbTriangles_internal_ISO(offs, tvec, 0, m_L, max_angle, max_size, icurve);
-    } else {
-      // flex inside, split clothoid
-      real_type sflex = -m_CD.kappa0 / m_CD.dk;
-      bbTriangles_internal_ISO(offs, tvec, 0, sflex, max_angle, max_size, icurve);
-      bbTriangles_internal_ISO(offs, tvec, sflex, m_L, max_angle, max_size, icurve);
-    }
+  real_type ClothoidCurve::chord_height_ISO(ClothoidData const & CD, Triangle2D const & T, real_type offs) {
+    return ClothoidCurveT<real_type>::chord_height_ISO(CD, T, offs);
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -311,27 +239,21 @@ namespace G2lib {
   \*/
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-  void ClothoidCurve::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
-    if (m_aabb_done && Utils::isZero(offs - m_aabb_offs) && Utils::isZero(max_angle - m_aabb_max_angle) &&
-        Utils::isZero(max_size - m_aabb_max_size))
-      return;
+  PtrTriangleCover ClothoidCurve::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
+    return m_aabb.get(
+        [&](TriangleCover const & TC) {
+          return TC.same(offs, max_angle, max_size) && TC.clipped == aabb_clip_triangles;
+        },
+        [&]() { return ClothoidCurveT<real_type>(m_CD, m_L).build_AABBtree_ISO(offs, max_angle, max_size); });
+  }
 
-    vector<shared_ptr<BBox const>> bboxes;
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    bbTriangles_ISO(offs, m_aabb_tri, max_angle, max_size);
-    bboxes.reserve(m_aabb_tri.size());
-    vector<Triangle2D>::const_iterator it;
-    int_type                           ipos = 0;
-    for (it = m_aabb_tri.begin(); it != m_aabb_tri.end(); ++it, ++ipos) {
-      real_type xmin, ymin, xmax, ymax;
-      it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos));
-    }
-    m_aabb_tree.build(bboxes);
-    m_aabb_done      = true;
-    m_aabb_offs      = offs;
-    m_aabb_max_angle = max_angle;
-    m_aabb_max_size  = max_size;
+  PtrTriangleCover ClothoidCurve::aabb_ISO(real_type offs) const {
+    // any cached cover with the right offset is good for the queries
+    PtrTriangleCover TC = m_aabb.find(
+        [offs](TriangleCover const & T) { return Utils::isZero(T.offs - offs) && T.clipped == aabb_clip_triangles; });
+    return TC != nullptr ? TC : this->build_AABBtree_ISO(offs);
   }
 #endif
 
@@ -346,19 +268,19 @@ namespace G2lib {
   \*/
 
   bool ClothoidCurve::collision(ClothoidCurve const & C) const {
-    this->build_AABBtree_ISO(0);
-    C.build_AABBtree_ISO(0);
-    T2D_collision_ISO fun(this, 0, &C, 0);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    PtrTriangleCover  TC1 = this->aabb_ISO(0);
+    PtrTriangleCover  TC2 = C.aabb_ISO(0);
+    T2D_collision_ISO fun(this, 0, TC1->tri, &C, 0, TC2->tri);
+    return TC1->tree.collision(TC2->tree, fun, false);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidCurve::collision_ISO(real_type offs, ClothoidCurve const & C, real_type offs_C) const {
-    this->build_AABBtree_ISO(offs);
-    C.build_AABBtree_ISO(offs_C);
-    T2D_collision_ISO fun(this, offs, &C, offs_C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    PtrTriangleCover  TC1 = this->aabb_ISO(offs);
+    PtrTriangleCover  TC2 = C.aabb_ISO(offs_C);
+    T2D_collision_ISO fun(this, offs, TC1->tri, &C, offs_C, TC2->tri);
+    return TC1->tree.collision(TC2->tree, fun, false);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -374,10 +296,10 @@ namespace G2lib {
   //!
   bool ClothoidCurve::approximate_collision_ISO(
       real_type offs, ClothoidCurve const & C, real_type offs_C, real_type max_angle, real_type max_size) const {
-    this->build_AABBtree_ISO(offs, max_angle, max_size);
-    C.build_AABBtree_ISO(offs_C, max_angle, max_size);
-    T2D_approximate_collision fun(this, &C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    PtrTriangleCover          TC1 = this->build_AABBtree_ISO(offs, max_angle, max_size);
+    PtrTriangleCover          TC2 = C.build_AABBtree_ISO(offs_C, max_angle, max_size);
+    T2D_approximate_collision fun(TC1->tri, TC2->tri);
+    return TC1->tree.collision(TC2->tree, fun, false);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -393,78 +315,18 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidCurve::aabb_intersect_ISO(
-      Triangle2D const &    T1,
-      real_type             offs,
-      ClothoidCurve const * pC,
-      Triangle2D const &    T2,
-      real_type             offs_C,
-      real_type &           ss1,
-      real_type &           ss2) const {
-    real_type eps1      = Utils::machepsi1000 * m_L;
-    real_type eps2      = Utils::machepsi1000 * pC->m_L;
-    real_type s1_min    = T1.S0() - eps1;
-    real_type s1_max    = T1.S1() + eps1;
-    real_type s2_min    = T2.S0() - eps2;
-    real_type s2_max    = T2.S1() + eps2;
-    int_type  nout      = 0;
-    bool      converged = false;
-
-    ss1 = (s1_min + s1_max) / 2;
-    ss2 = (s2_min + s2_max) / 2;
-    for (int_type i = 0; i < m_max_iter && !converged; ++i) {
-      real_type t1[2], t2[2], p1[2], p2[2];
-      m_CD.eval_ISO(ss1, offs, p1[0], p1[1]);
-      m_CD.eval_ISO_D(ss1, offs, t1[0], t1[1]);
-      pC->m_CD.eval_ISO(ss2, offs_C, p2[0], p2[1]);
-      pC->m_CD.eval_ISO_D(ss2, offs_C, t2[0], t2[1]);
-      /*
-      // risolvo il sistema
-      // p1 + alpha * t1 = p2 + beta * t2
-      // alpha * t1 - beta * t2 = p2 - p1
-      //
-      //  / t1[0] -t2[0] \ / alpha \ = / p2[0] - p1[0] \
-      //  \ t1[1] -t2[1] / \ beta  /   \ p2[1] - p1[1] /
-      */
-      real_type det = t2[0] * t1[1] - t1[0] * t2[1];
-      real_type px  = p2[0] - p1[0];
-      real_type py  = p2[1] - p1[1];
-      ss1 += (py * t2[0] - px * t2[1]) / det;
-      ss2 += (t1[0] * py - t1[1] * px) / det;
-      if (!(isfinite(ss1) && isfinite(ss1)))
-        break;
-      bool out = false;
-      if (ss1 < s1_min) {
-        out = true;
-        ss1 = s1_min;
-      } else if (ss1 > s1_max) {
-        out = true;
-        ss1 = s1_max;
-      }
-      if (ss2 < s2_min) {
-        out = true;
-        ss2 = s2_min;
-      } else if (ss2 > s2_max) {
-        out = true;
-        ss2 = s2_max;
-      }
-      if (out) {
-        if (++nout > 3)
-          break;
-      } else {
-        converged = abs(px) <= m_tolerance && abs(py) <= m_tolerance;
-      }
-    }
-    if (converged) {
-      if (ss1 < T1.S0())
-        ss1 = T1.S0();
-      else if (ss1 > T1.S1())
-        ss1 = T1.S1();
-      if (ss2 < T2.S0())
-        ss2 = T2.S0();
-      else if (ss2 > T2.S1())
-        ss2 = T2.S1();
-    }
-    return converged;
+      ClothoidData const & CD1,
+      real_type            L1,
+      Triangle2D const &   T1,
+      real_type            offs1,
+      ClothoidData const & CD2,
+      real_type            L2,
+      Triangle2D const &   T2,
+      real_type            offs2,
+      real_type &          ss1,
+      real_type &          ss2) {
+    return ClothoidCurveT<real_type>::aabb_intersect_ISO(
+        CD1, L1, T1, offs1, CD2, L2, T2, offs2, m_max_iter, m_tolerance, ss1, ss2);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -472,19 +334,9 @@ namespace G2lib {
   void ClothoidCurve::intersect_ISO(
       real_type offs, ClothoidCurve const & C, real_type offs_C, IntersectList & ilist, bool swap_s_vals) const {
     if (intersect_with_AABBtree) {
-      this->build_AABBtree_ISO(offs);
-      C.build_AABBtree_ISO(offs_C);
-      AABBtree::VecPairPtrBBox iList;
-      m_aabb_tree.intersect(C.m_aabb_tree, iList);
-      AABBtree::VecPairPtrBBox::const_iterator ip;
-
-      for (ip = iList.begin(); ip != iList.end(); ++ip) {
-        size_t ipos1 = size_t(ip->first->Ipos());
-        size_t ipos2 = size_t(ip->second->Ipos());
-
-        Triangle2D const & T1 = m_aabb_tri[ipos1];
-        Triangle2D const & T2 = C.m_aabb_tri[ipos2];
-
+      PtrTriangleCover TC1 = this->aabb_ISO(offs);
+      PtrTriangleCover TC2 = C.aabb_ISO(offs_C);
+      TC1->intersect_visit(*TC2, [&](Triangle2D const & T1, Triangle2D const & T2) {
         real_type ss1, ss2;
         bool      converged = aabb_intersect_ISO(T1, offs, &C, T2, offs_C, ss1, ss2);
 
@@ -493,13 +345,14 @@ namespace G2lib {
             swap(ss1, ss2);
           ilist.push_back(Ipair(ss1, ss2));
         }
-      }
+      });
     } else {
-      bbTriangles_ISO(offs, m_aabb_tri, Utils::m_pi / 18, 1e100);
-      C.bbTriangles_ISO(offs_C, C.m_aabb_tri, Utils::m_pi / 18, 1e100);
+      vector<Triangle2D> tri1, tri2;
+      bbTriangles_ISO(offs, tri1, Utils::m_pi / 18, 1e100);
+      C.bbTriangles_ISO(offs_C, tri2, Utils::m_pi / 18, 1e100);
       vector<Triangle2D>::const_iterator i1, i2;
-      for (i1 = m_aabb_tri.begin(); i1 != m_aabb_tri.end(); ++i1) {
-        for (i2 = C.m_aabb_tri.begin(); i2 != C.m_aabb_tri.end(); ++i2) {
+      for (i1 = tri1.begin(); i1 != tri1.end(); ++i1) {
+        for (i2 = tri2.begin(); i2 != tri2.end(); ++i2) {
           Triangle2D const & T1 = *i1;
           Triangle2D const & T2 = *i2;
 
@@ -525,15 +378,16 @@ namespace G2lib {
   \*/
 
   void ClothoidCurve::closest_point_internal(
-      real_type   s_begin,
-      real_type   s_end,
-      real_type   qx,
-      real_type   qy,
-      real_type   offs,
-      real_type & x,
-      real_type & y,
-      real_type & s,
-      real_type & dst) const {
+      ClothoidData const & CD,
+      real_type            s_begin,
+      real_type            s_end,
+      real_type            qx,
+      real_type            qy,
+      real_type            offs,
+      real_type &          x,
+      real_type &          y,
+      real_type &          s,
+      real_type &          dst) {
 #if 1
     // minimize using circle approximation
     s             = (s_begin + s_end) / 2;
@@ -541,11 +395,12 @@ namespace G2lib {
     int_type n_ok = 0;
     for (int_type iter = 0; iter < m_max_iter; ++iter) {
       // osculating circle
-      m_CD.eval_ISO(s, offs, x, y);
-      real_type th = m_CD.theta(s);
-      real_type kk = m_CD.kappa(s);
-      real_type sc = 1 + kk * offs;
-      real_type ds = projectPointOnCircle(x, y, th, kk / sc, qx, qy) / sc;
+      ClothoidPoint P;
+      CD.eval_full(s, offs, P);
+      x            = P.x;
+      y            = P.y;
+      real_type sc = 1 + P.kappa * offs;
+      real_type ds = projectPointOnCircle(x, y, P.theta, P.kappa / sc, qx, qy) / sc;
 
       s += ds;
 
@@ -591,29 +446,168 @@ namespace G2lib {
 
   void ClothoidCurve::closest_point_internal(
       real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const {
-    DST = numeric_limits<real_type>::infinity();
-    this->build_AABBtree_ISO(offs);
-
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "ClothoidCurve::closest_point_internal no candidate\n");
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
-      if (dst < DST) {
-        // refine distance
+    PtrTriangleCover TC = this->aabb_ISO(offs);
+
+    // best-first: the triangles are refined in order of distance of their bbox
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type best) -> real_type {
+      Triangle2D const & T   = TC->tri[size_t(box->Ipos())];
+      real_type          dst = T.distMin(qx, qy);
+      if (dst < best) {
         real_type xx, yy, ss;
-        closest_point_internal(T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
-        if (dst < DST) {
-          DST = dst;
-          s   = ss;
-          x   = xx;
-          y   = yy;
+        closest_point_internal(m_CD, T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
+        if (dst < best) {
+          s = ss;
+          x = xx;
+          y = yy;
         }
       }
+      return dst;
+    };
+    DST = TC->tree.nearest(qx, qy, refine);
+    G2LIB_UTILS_ASSERT0(Utils::isRegular(DST), "ClothoidCurve::closest_point_internal no candidate\n");
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // Root in `[a,b]` of a function with `f(a)`, `f(b)` of opposite sign:
+  // Newton iteration falling back to bisection when it leaves the bracket.
+  // `fun(x, f, f_D)` evaluates the function and its derivative.
+  //
+  template <typename FUN>
+  static bool bracketed_root(
+      FUN const & fun, real_type a, real_type fa, real_type b, real_type fb, real_type tol, real_type & x) {
+    if (fa == 0) {
+      x = a;
+      return true;
+    }
+    if (fb == 0) {
+      x = b;
+      return true;
+    }
+    if ((fa > 0) == (fb > 0))
+      return false;
+    x = (a + b) / 2;
+    for (int_type iter = 0; iter < 100; ++iter) {
+      real_type f, f_D;
+      fun(x, f, f_D);
+      if (abs(f) <= tol)
+        return true;
+      if ((f > 0) == (fa > 0)) {
+        a  = x;
+        fa = f;
+      } else {
+        b = x;
+      }
+      real_type xn = x - f / f_D;
+      if (!(xn > a && xn < b))
+        xn = (a + b) / 2;
+      if (b - a <= Utils::machepsi * (abs(a) + abs(b)))
+        return true;
+      x = xn;
+    }
+    return true;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // First hit of the ray with the piece `[s_begin,s_end]` of the offset
+  // curve, the direction `(dx,dy)` is unit. The hits are the roots of
+  // f(s) = n . (P(s) - x0), n normal to the ray. On a piece of a triangle
+  // cover the tangent turns by less than pi/2, so f' vanishes at most once:
+  // the piece is split there and f is monotone on each part.
+  //
+  bool ClothoidCurve::raycast_internal(
+      ClothoidData const & CD,
+      real_type            s_begin,
+      real_type            s_end,
+      real_type            x0,
+      real_type            y0,
+      real_type            dx,
+      real_type            dy,
+      real_type            offs,
+      real_type            tmax,
+      real_type &          t,
+      real_type &          s) {
+    auto f = [&](real_type ss, real_type & F, real_type & F_D) {
+      ClothoidPoint P;
+      CD.eval_full(ss, offs, P);
+      F   = dx * (P.y - y0) - dy * (P.x - x0);
+      F_D = dx * P.y_D - dy * P.x_D;
+    };
+    auto f_D = [&](real_type ss, real_type & F_D, real_type & F_DD) {
+      ClothoidPoint P;
+      CD.eval_full(ss, offs, P);
+      F_D  = dx * P.y_D - dy * P.x_D;
+      F_DD = dx * P.y_DD - dy * P.x_DD;
+    };
+
+    real_type fa, fa_D, fb, fb_D;
+    f(s_begin, fa, fa_D);
+    f(s_end, fb, fb_D);
+
+    real_type sm[3] = {s_begin, s_end, s_end};
+    real_type fm[3] = {fa, fb, fb};
+    int_type  npart = 1;
+    if ((fa_D > 0) != (fb_D > 0) && fa_D != 0 && fb_D != 0) {
+      real_type ss, F, F_D;
+      if (bracketed_root(f_D, s_begin, fa_D, s_end, fb_D, m_tolerance * Utils::machepsi1000, ss)) {
+        f(ss, F, F_D);
+        sm[1] = ss;
+        fm[1] = F;
+        npart = 2;
+      }
+    }
+
+    bool ok = false;
+    for (int_type i = 0; i < npart; ++i) {
+      real_type ss;
+      if (!bracketed_root(f, sm[i], fm[i], sm[i + 1], fm[i + 1], m_tolerance, ss))
+        continue;
+      real_type xx, yy;
+      CD.eval_ISO(ss, offs, xx, yy);
+      real_type tt = dx * (xx - x0) + dy * (yy - y0);
+      if (tt >= 0 && tt <= tmax && (!ok || tt < t)) {
+        t  = tt;
+        s  = ss;
+        ok = true;
+      }
     }
+    return ok;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool ClothoidCurve::raycast_ISO(
+      real_type   x0,
+      real_type   y0,
+      real_type   dx,
+      real_type   dy,
+      real_type   offs,
+      real_type   tmax,
+      real_type & t,
+      real_type & s) const {
+    real_type len = hypot(dx, dy);
+    if (!(len > 0))
+      return false;
+    dx /= len;
+    dy /= len;
+    PtrTriangleCover TC = this->aabb_ISO(offs);
+
+    bool ok  = false;
+    auto hit = [&](AABBtree::PtrBBox const & box, real_type best) -> real_type {
+      Triangle2D const & T = TC->tri[size_t(box->Ipos())];
+      real_type          tt, ss;
+      if (!raycast_internal(m_CD, T.S0(), T.S1(), x0, y0, dx, dy, offs, best, tt, ss))
+        return best;
+      t  = tt;
+      s  = ss;
+      ok = true;
+      return tt;
+    };
+    TC->tree.raycast(x0, y0, dx, dy, tmax, hit);
+    return ok;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -771,6 +765,471 @@ namespace G2lib {
     return stream;
   }
 
+  /*\
+   |    ____ _       _   _           _     _ ____        _
+   |   / ___| | ___ | |_| |__   ___ (_) __| / ___|  ___ / \
+   |  | |   | |/ _ \| __| '_ \ / _ \| |/ _` \___ \ / _ \/ _ \
+   |  | |___| | (_) | |_| | | | (_) | | (_| |___) | (_) / ___ \
+   |   \____|_|\___/ \__|_| |_|\___/|_|\__,_|____/ \___/_/   \_\
+  \*/
+
+  template <typename T>
+  void ClothoidSoAT<T>::clear() {
+    m_x0.clear();
+    m_y0.clear();
+    m_theta0.clear();
+    m_kappa0.clear();
+    m_dk.clear();
+    m_L.clear();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::reserve(size_t n) {
+    m_x0.reserve(n);
+    m_y0.reserve(n);
+    m_theta0.reserve(n);
+    m_kappa0.reserve(n);
+    m_dk.reserve(n);
+    m_L.reserve(n);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::push_back(ClothoidCurve const & C) {
+    m_x0.push_back(C.x_begin());
+    m_y0.push_back(C.y_begin());
+    m_theta0.push_back(C.theta_begin());
+    m_kappa0.push_back(C.kappa_begin());
+    m_dk.push_back(C.dkappa());
+    m_L.push_back(C.length());
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::push_back(ClothoidDataT<T> const & CD, T L) {
+    m_x0.push_back(CD.x0);
+    m_y0.push_back(CD.y0);
+    m_theta0.push_back(CD.theta0);
+    m_kappa0.push_back(CD.kappa0);
+    m_dk.push_back(CD.dk);
+    m_L.push_back(L);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::append(ClothoidSoAT const & S) {
+    m_x0.insert(m_x0.end(), S.m_x0.begin(), S.m_x0.end());
+    m_y0.insert(m_y0.end(), S.m_y0.begin(), S.m_y0.end());
+    m_theta0.insert(m_theta0.end(), S.m_theta0.begin(), S.m_theta0.end());
+    m_kappa0.insert(m_kappa0.end(), S.m_kappa0.begin(), S.m_kappa0.end());
+    m_dk.insert(m_dk.end(), S.m_dk.begin(), S.m_dk.end());
+    m_L.insert(m_L.end(), S.m_L.begin(), S.m_L.end());
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::set(size_t i, ClothoidCurve const & C) {
+    m_x0[i]     = C.x_begin();
+    m_y0[i]     = C.y_begin();
+    m_theta0[i] = C.theta_begin();
+    m_kappa0[i] = C.kappa_begin();
+    m_dk[i]     = C.dkappa();
+    m_L[i]      = C.length();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::reverse_order() {
+    std::reverse(m_x0.begin(), m_x0.end());
+    std::reverse(m_y0.begin(), m_y0.end());
+    std::reverse(m_theta0.begin(), m_theta0.end());
+    std::reverse(m_kappa0.begin(), m_kappa0.end());
+    std::reverse(m_dk.begin(), m_dk.end());
+    std::reverse(m_L.begin(), m_L.end());
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::displacements(vector<T> & dx, vector<T> & dy) const {
+    size_t    n = this->size();
+    vector<T> a(n), b(n);
+    dx.resize(n);
+    dy.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = m_dk[i] * m_L[i] * m_L[i];
+      b[i] = m_kappa0[i] * m_L[i];
+    }
+    FresnelMode mode = m_fresnel == G2LIB_FRESNEL_GLOBAL ? G2lib::fresnel_mode : m_fresnel;
+    if (mode == G2LIB_FRESNEL_APPROX) {
+      for (size_t i = 0; i < n; ++i)
+        GeneralizedFresnelCS(a[i], b[i], m_theta0[i], dx[i], dy[i], mode);
+    } else {
+      GeneralizedFresnelCS(int_type(n), a.data(), b.data(), m_theta0.data(), dx.data(), dy.data());
+    }
+    for (size_t i = 0; i < n; ++i) {
+      dx[i] *= m_L[i];
+      dy[i] *= m_L[i];
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::translate(T tx, T ty) {
+    for (T & x : m_x0)
+      x += tx;
+    for (T & y : m_y0)
+      y += ty;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::rotate(T angle, T cx, T cy) {
+    T C = cos(angle);
+    T S = sin(angle);
+    for (size_t i = 0; i < this->size(); ++i) {
+      T dx    = m_x0[i] - cx;
+      T dy    = m_y0[i] - cy;
+      m_x0[i] = cx + C * dx - S * dy;
+      m_y0[i] = cy + C * dy + S * dx;
+    }
+    for (T & th : m_theta0)
+      th += angle;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::scale(T sfactor) {
+    for (T & k : m_kappa0)
+      k /= sfactor;
+    for (T & dk : m_dk)
+      dk /= sfactor * sfactor;
+    for (T & L : m_L)
+      L *= sfactor;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::reverse_segments() {
+    vector<T> dx, dy;
+    this->displacements(dx, dy);
+    for (size_t i = 0; i < this->size(); ++i) {
+      T L = m_L[i];
+      m_x0[i] += dx[i];
+      m_y0[i] += dy[i];
+      T th = m_theta0[i] + L * (m_kappa0[i] + T(0.5) * L * m_dk[i]) + Utils::m_pi;
+      while (th > Utils::m_pi)
+        th -= Utils::m_2pi;
+      while (th < -Utils::m_pi)
+        th += Utils::m_2pi;
+      m_theta0[i] = th;
+      m_kappa0[i] = -(m_kappa0[i] + L * m_dk[i]);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidSoAT<T>::change_origin(T x0, T y0) {
+    vector<T> dx, dy;
+    this->displacements(dx, dy);
+    for (size_t i = 0; i < this->size(); ++i) {
+      m_x0[i] = x0;
+      m_y0[i] = y0;
+      x0 += dx[i];
+      y0 += dy[i];
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  ClothoidCurve ClothoidSoAT<T>::operator[](size_t i) const {
+    ClothoidCurve C(m_x0[i], m_y0[i], m_theta0[i], m_kappa0[i], m_dk[i], m_L[i]);
+    C.fresnel_mode(m_fresnel);
+    return C;
+  }
+
+  template class ClothoidSoAT<float>;
+  template class ClothoidSoAT<double>;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  ClothoidCurveT<T>::ClothoidCurveT(ClothoidCurve const & C)
+      : ClothoidCurveT(
+            T(C.x_begin()), T(C.y_begin()), T(C.theta_begin()), T(C.kappa_begin()), T(C.dkappa()), T(C.length())) {
+    m_CD.fresnel = C.fresnel_mode();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidCurveT<T>::bbTriangles_internal_ISO(
+      ClothoidDataT<T> const & CD,
+      T                        L,
+      T                        offs,
+      vector<Triangle2DT<T>> & tvec,
+      T                        s_begin,
+      T                        s_end,
+      T                        max_angle,
+      T                        max_size,
+      int_type                 icurve) {
+    static T const one_degree = T(Utils::m_pi / 180);
+
+    T ss  = s_begin;
+    T thh = CD.theta(ss);
+    T MX  = min(L, max_size);
+    for (int_type npts = 0; ss < s_end; ++npts) {
+      G2LIB_UTILS_ASSERT0(
+          npts < 100000000,
+          "ClothoidCurve::bbTriangles_internal "
+          "is generating too much triangles (>100000000)\n"
+          "something is going wrong or parameters are not well set\n");
+
+      // estimate angle variation and compute step accodingly
+      T k   = CD.kappa(ss);
+      T dss = MX / (1 + k * offs);  // scale length with offset
+      T sss = ss + dss;
+      if (sss > s_end) {
+        sss = s_end;
+        dss = s_end - ss;
+      }
+      if (abs(k * dss) > max_angle) {
+        dss = abs(max_angle / k);
+        sss = ss + dss;
+      }
+      // check and recompute if necessary
+      T thhh = CD.theta(sss);
+      if (abs(thh - thhh) > max_angle) {
+        k    = CD.kappa(sss);
+        dss  = abs(max_angle / k);
+        sss  = ss + dss;
+        thhh = CD.theta(sss);
+      }
+
+      T x0, y0, x1, y1;
+      CD.eval_ISO(ss, offs, x0, y0);
+      CD.eval_ISO(sss, offs, x1, y1);
+
+      T tx0   = cos(thh);
+      T ty0   = sin(thh);
+      T alpha = sss - ss;  // se angolo troppo piccolo uso approx piu rozza
+      if (abs(thh - thhh) > one_degree) {
+        T tx1 = cos(thhh);
+        T ty1 = sin(thhh);
+        T det = tx1 * ty0 - tx0 * ty1;
+        T dx  = x1 - x0;
+        T dy  = y1 - y0;
+        alpha = (dy * tx1 - dx * ty1) / det;
+      }
+
+      T x2 = x0 + alpha * tx0;
+      T y2 = y0 + alpha * ty0;
+      tvec.emplace_back(x0, y0, x2, y2, x1, y1, ss, sss, icurve);
+
+      ss  = sss;
+      thh = thhh;
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidCurveT<T>::bbTriangles_ISO(
+      ClothoidDataT<T> const & CD,
+      T                        L,
+      T                        offs,
+      vector<Triangle2DT<T>> & tvec,
+      T                        max_angle,
+      T                        max_size,
+      int_type                 icurve) {
+    if (CD.kappa0 * CD.dk >= 0 || CD.kappa(L) * CD.dk <= 0) {
+      bbTriangles_internal_ISO(CD, L, offs, tvec, 0, L, max_angle, max_size, icurve);
+    } else {
+      // flex inside, split clothoid
+      T sflex = -CD.kappa0 / CD.dk;
+      bbTriangles_internal_ISO(CD, L, offs, tvec, 0, sflex, max_angle, max_size, icurve);
+      bbTriangles_internal_ISO(CD, L, offs, tvec, sflex, L, max_angle, max_size, icurve);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  T ClothoidCurveT<T>::chord_height_ISO(ClothoidDataT<T> const & CD, Triangle2DT<T> const & Tri, T offs) {
+    // the side P1-P3 of the triangle is the chord
+    T s0  = Tri.S0();
+    T x0  = Tri.x1();
+    T y0  = Tri.y1();
+    T dx  = Tri.x3() - x0;
+    T dy  = Tri.y3() - y0;
+    T len = hypot(dx, dy);
+    if (len <= 0)
+      return 0;
+    // the farthest point has the tangent parallel to the chord: the angle
+    // theta(s0+u) = theta(s0) + kappa(s0)*u + dk*u^2/2 is monotone in the
+    // range, the root is taken in the form without cancellation
+    real_type dth = atan2(dy, dx) - CD.theta(s0);
+    rangeSymm(dth);
+    T k    = CD.kappa(s0);
+    T disc = k * k + 2 * CD.dk * T(dth);
+    if (disc < 0)
+      return numeric_limits<T>::infinity();  // no point parallel to the chord, do not clip
+    T den = k + (dth < 0 ? -sqrt(disc) : sqrt(disc));
+    T u   = den != 0 ? 2 * T(dth) / den : 0;
+    u     = min(max(u, T(0)), Tri.S1() - s0);
+    T x, y;
+    CD.eval_ISO(s0 + u, offs, x, y);
+    // margin for the rounding of the evaluations
+    return abs(dx * (y - y0) - dy * (x - x0)) / len + sqrt(numeric_limits<T>::epsilon()) * len;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool ClothoidCurveT<T>::aabb_intersect_ISO(
+      ClothoidDataT<T> const & CD1,
+      T                        L1,
+      Triangle2DT<T> const &   T1,
+      T                        offs1,
+      ClothoidDataT<T> const & CD2,
+      T                        L2,
+      Triangle2DT<T> const &   T2,
+      T                        offs2,
+      int_type                 max_iter,
+      T                        tolerance,
+      T &                      ss1,
+      T &                      ss2) {
+    T        eps1      = 1000 * numeric_limits<T>::epsilon() * L1;
+    T        eps2      = 1000 * numeric_limits<T>::epsilon() * L2;
+    T        s1_min    = T1.S0() - eps1;
+    T        s1_max    = T1.S1() + eps1;
+    T        s2_min    = T2.S0() - eps2;
+    T        s2_max    = T2.S1() + eps2;
+    int_type nout      = 0;
+    bool     converged = false;
+
+    ss1 = (s1_min + s1_max) / 2;
+    ss2 = (s2_min + s2_max) / 2;
+    for (int_type i = 0; i < max_iter && !converged; ++i) {
+      ClothoidPointT<T> P1, P2;
+      CD1.eval_full(ss1, offs1, P1);
+      CD2.eval_full(ss2, offs2, P2);
+      T t1[2] = { P1.x_D, P1.y_D };
+      T t2[2] = { P2.x_D, P2.y_D };
+      T p1[2] = { P1.x, P1.y };
+      T p2[2] = { P2.x, P2.y };
+      /*
+      // risolvo il sistema
+      // p1 + alpha * t1 = p2 + beta * t2
+      // alpha * t1 - beta * t2 = p2 - p1
+      //
+      //  / t1[0] -t2[0] \ / alpha \ = / p2[0] - p1[0] \
+      //  \ t1[1] -t2[1] / \ beta  /   \ p2[1] - p1[1] /
+      */
+      T det = t2[0] * t1[1] - t1[0] * t2[1];
+      T px  = p2[0] - p1[0];
+      T py  = p2[1] - p1[1];
+      ss1 += (py * t2[0] - px * t2[1]) / det;
+      ss2 += (t1[0] * py - t1[1] * px) / det;
+      if (!(isfinite(ss1) && isfinite(ss1)))
+        break;
+      bool out = false;
+      if (ss1 < s1_min) {
+        out = true;
+        ss1 = s1_min;
+      } else if (ss1 > s1_max) {
+        out = true;
+        ss1 = s1_max;
+      }
+      if (ss2 < s2_min) {
+        out = true;
+        ss2 = s2_min;
+      } else if (ss2 > s2_max) {
+        out = true;
+        ss2 = s2_max;
+      }
+      if (out) {
+        if (++nout > 3)
+          break;
+      } else {
+        converged = abs(px) <= tolerance && abs(py) <= tolerance;
+      }
+    }
+    if (converged) {
+      if (ss1 < T1.S0())
+        ss1 = T1.S0();
+      else if (ss1 > T1.S1())
+        ss1 = T1.S1();
+      if (ss2 < T2.S0())
+        ss2 = T2.S0();
+      else if (ss2 > T2.S1())
+        ss2 = T2.S1();
+    }
+    return converged;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  typename ClothoidCurveT<T>::PtrCover ClothoidCurveT<T>::build_AABBtree_ISO(T offs, T max_angle, T max_size) const {
+    auto TC = make_shared<TriangleCoverT<T>>(offs, max_angle, max_size);
+    bbTriangles_ISO(offs, TC->tri, max_angle, max_size);
+    if (aabb_clip_triangles) {
+      TC->height.reserve(TC->tri.size());
+      for (Triangle2DT<T> const & Tri : TC->tri)
+        TC->height.push_back(chord_height_ISO(m_CD, Tri, offs));
+      TC->clipped = true;
+    }
+    TC->build_tree(G2LIB_CLOTHOID);
+    return TC;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  bool ClothoidCurveT<T>::collision_ISO(T offs, ClothoidCurveT const & C, T offs_C) const {
+    PtrCover TC1 = this->build_AABBtree_ISO(offs);
+    PtrCover TC2 = C.build_AABBtree_ISO(offs_C);
+    auto     fun = [&](typename AABBtreeT<T>::PtrBBox const & b1, typename AABBtreeT<T>::PtrBBox const & b2) {
+      Triangle2DT<T> const & T1 = TC1->tri[size_t(b1->Ipos())];
+      Triangle2DT<T> const & T2 = TC2->tri[size_t(b2->Ipos())];
+      T                      ss1, ss2;
+      return aabb_intersect_ISO(m_CD, m_L, T1, offs, C.m_CD, C.m_L, T2, offs_C, max_iter(), tolerance(), ss1, ss2);
+    };
+    return TC1->tree.collision(TC2->tree, fun, false);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template <typename T>
+  void ClothoidCurveT<T>::intersect_ISO(T offs, ClothoidCurveT const & C, T offs_C, IntersectList & ilist) const {
+    PtrCover TC1 = this->build_AABBtree_ISO(offs);
+    PtrCover TC2 = C.build_AABBtree_ISO(offs_C);
+    size_t   n0  = ilist.size();
+    TC1->intersect_visit(*TC2, [&](Triangle2DT<T> const & T1, Triangle2DT<T> const & T2) {
+      T ss1, ss2;
+      if (aabb_intersect_ISO(m_CD, m_L, T1, offs, C.m_CD, C.m_L, T2, offs_C, max_iter(), tolerance(), ss1, ss2))
+        ilist.emplace_back(ss1, ss2);
+    });
+    std::sort(ilist.begin() + ptrdiff_t(n0), ilist.end());
+  }
+
+  template class ClothoidCurveT<float>;
+  template class ClothoidCurveT<double>;
+
 }  // namespace G2lib
 
 // EOF: Clothoid.cc
@@ -77,15 +77,17 @@ namespace G2lib {
       real_type epsi, ClothoidData const & CD, real_type L, real_type qx, real_type qy, real_type & S) {
     // S = GUESS
     int       nb = 0;
-    real_type theta, kappa, dS, dx, dy;
+    real_type dS;
     real_type s = S;
     for (int iter = 0; iter < 20 && nb < 2; ++iter) {
-      CD.evaluate(s, theta, kappa, dx, dy);
-      dx -= qx;
-      dy -= qy;
-
-      real_type Cs  = cos(theta);
-      real_type Ss  = sin(theta);
+      ClothoidPoint P;
+      CD.eval_full(s, 0, P);
+      real_type kappa = P.kappa;
+      real_type dx    = P.x - qx;
+      real_type dy    = P.y - qy;
+
+      real_type Cs  = P.x_D;
+      real_type Ss  = P.y_D;
       real_type a0  = Cs * dy - Ss * dx;
       real_type b0  = Ss * dy + Cs * dx;
       real_type tmp = a0 * kappa;
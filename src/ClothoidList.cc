@@ -28,6 +28,7 @@
 #include "Clothoids/ClothoidList.hxx"
 #include "Utils.hxx"
 
+#include <algorithm>
 #include <cfloat>
 #include <limits>
 #include <sstream>
@@ -46,6 +47,7 @@ namespace G2lib {
   using std::abs;
   using std::lower_bound;
   using std::numeric_limits;
+  using std::sort;
   using std::swap;
   using std::vector;
 
@@ -59,51 +61,44 @@ namespace G2lib {
   \*/
 
   ClothoidList::ClothoidList(LineSegment const & LS)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     this->push_back(LS);
   }
 
   ClothoidList::ClothoidList(CircleArc const & C)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     this->push_back(C);
   }
 
   ClothoidList::ClothoidList(Biarc const & C)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     this->push_back(C.C0());
     this->push_back(C.C1());
   }
 
   ClothoidList::ClothoidList(BiarcList const & c)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     this->push_back(c);
   }
 
   ClothoidList::ClothoidList(ClothoidCurve const & c)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     this->push_back(c);
   }
 
   ClothoidList::ClothoidList(PolyLine const & pl)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     this->push_back(pl);
   }
 
   ClothoidList::ClothoidList(BaseCurve const & C)
-      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
-    this->resetLastInterval();
+      : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false) {
     this->init();
     switch (C.type()) {
       case G2LIB_LINE:
@@ -133,10 +128,61 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type ClothoidList::findAtS(real_type & s) const {
-    auto lastInterval = m_lastInterval.search(std::this_thread::get_id());
+    int_type & lastInterval = Utils::last_interval_hint(this);
     Utils::search_interval<int_type, real_type>(
         static_cast<int_type>(m_s0.size()), &m_s0.front(), s, lastInterval, m_curve_is_closed, true);
-    return *lastInterval;
+    return lastInterval;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type ClothoidList::findAtS(real_type & s, SegmentCursor & cursor) const {
+    Utils::search_interval<int_type, real_type>(
+        static_cast<int_type>(m_s0.size()), &m_s0.front(), s, cursor.interval, m_curve_is_closed, true);
+    return cursor.interval;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval(real_type s, SegmentCursor & cursor, real_type & x, real_type & y) const {
+    int_type idx = findAtS(s, cursor);
+    m_clotoidList.data(idx).eval(s - m_s0[idx], x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_ISO(real_type s, real_type offs, SegmentCursor & cursor, real_type & x, real_type & y) const {
+    int_type idx = findAtS(s, cursor);
+    m_clotoidList.data(idx).eval_ISO(s - m_s0[idx], offs, x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::evaluate(
+      real_type s, SegmentCursor & cursor, real_type & th, real_type & k, real_type & x, real_type & y) const {
+    int_type idx = findAtS(s, cursor);
+    m_clotoidList.data(idx).evaluate(s - m_s0[idx], th, k, x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  // Single pass over nondecreasing abscissae: the segment index only moves
+  // forward and goes back to 0 when the (wrapped) abscissa decreases.
+  template <typename FUN>
+  void ClothoidList::walk_sorted(int_type n, real_type const * s, FUN const & fun) const {
+    G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::walk_sorted, empty list\n");
+    int_type nseg = int_type(m_clotoidList.size());
+    int_type idx  = 0;
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      if (m_curve_is_closed)
+        wrap_in_range(si);
+      if (si < m_s0[idx])
+        idx = 0;
+      while (idx + 1 < nseg && m_s0[idx + 1] < si)
+        ++idx;
+      fun(i, m_clotoidList.data(idx), si - m_s0[idx]);
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -159,17 +205,15 @@ namespace G2lib {
   void ClothoidList::init() {
     m_s0.clear();
     m_clotoidList.clear();
-    this->resetLastInterval();
-    m_aabb_done = false;
-    this->resetLastInterval();
+    m_curves.clear();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::copy(ClothoidList const & L) {
     this->init();
-    m_clotoidList.reserve(L.m_clotoidList.size());
-    std::copy(L.m_clotoidList.begin(), L.m_clotoidList.end(), back_inserter(m_clotoidList));
+    m_clotoidList = L.m_clotoidList;
     m_s0.reserve(L.m_s0.size());
     std::copy(L.m_s0.begin(), L.m_s0.end(), back_inserter(m_s0));
   }
@@ -191,6 +235,7 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + LS.length());
     }
     m_clotoidList.push_back(ClothoidCurve(LS));
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -203,6 +248,7 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + C.length());
     }
     m_clotoidList.push_back(ClothoidCurve(C));
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -216,6 +262,7 @@ namespace G2lib {
     m_s0.push_back(m_s0.back() + C1.length());
     m_clotoidList.push_back(ClothoidCurve(C0));
     m_clotoidList.push_back(ClothoidCurve(C1));
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -228,6 +275,7 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + c.length());
     }
     m_clotoidList.push_back(c);
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -246,6 +294,7 @@ namespace G2lib {
       m_clotoidList.push_back(ClothoidCurve(b.C0()));
       m_clotoidList.push_back(ClothoidCurve(b.C1()));
     }
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -262,6 +311,7 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + ip->length());
       m_clotoidList.push_back(ClothoidCurve(*ip));
     }
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -273,11 +323,10 @@ namespace G2lib {
     if (m_s0.empty())
       m_s0.push_back(0);
 
-    vector<ClothoidCurve>::const_iterator ip = c.m_clotoidList.begin();
-    for (; ip != c.m_clotoidList.end(); ++ip) {
-      m_s0.push_back(m_s0.back() + ip->length());
-      m_clotoidList.push_back(*ip);
-    }
+    for (size_t i = 0; i < c.m_clotoidList.size(); ++i)
+      m_s0.push_back(m_s0.back() + c.m_clotoidList.length(i));
+    m_clotoidList.append(c.m_clotoidList);
+    m_curves.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -285,9 +334,9 @@ namespace G2lib {
   void ClothoidList::push_back(real_type kappa0, real_type dkappa, real_type L) {
     G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::push_back_G1(...) empty list!\n");
     ClothoidCurve c;
-    real_type     x0     = m_clotoidList.back().x_end();
-    real_type     y0     = m_clotoidList.back().y_end();
-    real_type     theta0 = m_clotoidList.back().theta_end();
+    real_type     x0     = x_end();
+    real_type     y0     = y_end();
+    real_type     theta0 = theta_end();
     c.build(x0, y0, theta0, kappa0, dkappa, L);
     push_back(c);
   }
@@ -305,9 +354,9 @@ namespace G2lib {
   void ClothoidList::push_back_G1(real_type x1, real_type y1, real_type theta1) {
     G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::push_back_G1(...) empty list!\n");
     ClothoidCurve c;
-    real_type     x0     = m_clotoidList.back().x_end();
-    real_type     y0     = m_clotoidList.back().y_end();
-    real_type     theta0 = m_clotoidList.back().theta_end();
+    real_type     x0     = x_end();
+    real_type     y0     = y_end();
+    real_type     theta0 = theta_end();
     c.build_G1(x0, y0, theta0, x1, y1, theta1);
     push_back(c);
   }
@@ -450,7 +499,17 @@ namespace G2lib {
     G2LIB_UTILS_ASSERT(
         idx >= 0 && idx < int_type(m_clotoidList.size()), "ClothoidList::get( %d ) bad index, must be in [0,%d]\n", idx,
         m_clotoidList.size() - 1);
-    return m_clotoidList[idx];
+    shared_ptr<vector<ClothoidCurve> const> curves = Utils::lazy_publish(
+        m_curves, this, [](vector<ClothoidCurve> const &) { return true; },
+        [this]() {
+          auto C = make_shared<vector<ClothoidCurve>>();
+          C->reserve(m_clotoidList.size());
+          for (size_t i = 0; i < m_clotoidList.size(); ++i)
+            C->push_back(m_clotoidList[i]);
+          return shared_ptr<vector<ClothoidCurve> const>(C);
+        });
+    // the slot keeps the curves alive until the list is modified
+    return (*curves)[size_t(idx)];
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -460,6 +519,16 @@ namespace G2lib {
     return get(idx);
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  ClothoidCurve ClothoidList::segment(int_type idx) const {
+    G2LIB_UTILS_ASSERT(!m_clotoidList.empty(), "ClothoidList::segment( %d ) empty list\n", idx);
+    G2LIB_UTILS_ASSERT(
+        idx >= 0 && idx < int_type(m_clotoidList.size()), "ClothoidList::segment( %d ) bad index, must be in [0,%d]\n",
+        idx, m_clotoidList.size() - 1);
+    return m_clotoidList[size_t(idx)];
+  }
+
   /*\
    |   _                  _   _
    |  | | ___ _ __   __ _| |_| |__
@@ -476,20 +545,19 @@ namespace G2lib {
   }
 
   real_type ClothoidList::length_ISO(real_type offs) const {
-    real_type                             L  = 0;
-    vector<ClothoidCurve>::const_iterator is = m_clotoidList.begin();
-    for (; is != m_clotoidList.end(); ++is)
-      L += is->length_ISO(offs);
+    real_type L = 0;
+    for (size_t i = 0; i < m_clotoidList.size(); ++i)
+      L += m_clotoidList[i].length_ISO(offs);
     return L;
   }
 
   real_type ClothoidList::segment_length(int_type nseg) const {
-    ClothoidCurve const & c = get(nseg);
+    ClothoidCurve c = segment(nseg);
     return c.length();
   }
 
   real_type ClothoidList::segment_length_ISO(int_type nseg, real_type offs) const {
-    ClothoidCurve const & c = get(nseg);
+    ClothoidCurve c = segment(nseg);
     return c.length_ISO(offs);
   }
 
@@ -503,18 +571,15 @@ namespace G2lib {
 
   void ClothoidList::bbTriangles(
       vector<Triangle2D> & tvec, real_type max_angle, real_type max_size, int_type icurve) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    for (int_type ipos = icurve; ic != m_clotoidList.end(); ++ic, ++ipos)
-      ic->bbTriangles(tvec, max_angle, max_size, ipos);
+    for (size_t i = 0; i < m_clotoidList.size(); ++i)
+      m_clotoidList[i].bbTriangles(tvec, max_angle, max_size, icurve + int_type(i));
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
   void ClothoidList::bbTriangles_ISO(
       real_type offs, vector<Triangle2D> & tvec, real_type max_angle, real_type max_size, int_type icurve) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    for (int_type ipos = icurve; ic != m_clotoidList.end(); ++ic, ++ipos)
-      ic->bbTriangles_ISO(offs, tvec, max_angle, max_size, ipos);
+    ClothoidListT<real_type>::bbTriangles_ISO(m_clotoidList, offs, tvec, max_angle, max_size, icurve);
   }
 
   /*\
@@ -571,32 +636,32 @@ namespace G2lib {
   \*/
 
   real_type ClothoidList::theta(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.theta(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::theta_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.theta_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::theta_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.theta_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::theta_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.theta_DDD(s - m_s0[idx]);
   }
 
@@ -609,104 +674,104 @@ namespace G2lib {
   \*/
 
   real_type ClothoidList::tx(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.tx(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_x(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.ty(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_y(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::tx_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.tx_D(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_x_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.ty_D(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_y_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::tx_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.tx_DD(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_x_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.ty_DD(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_y_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::tx_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.tx_DDD(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_x_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    return c.ty_DDD(s - m_s0[idx]);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    return c.tg_y_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg(real_type s, real_type & tg_x, real_type & tg_y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.tg(s - m_s0[idx], tg_x, tg_y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg_D(real_type s, real_type & tg_x_D, real_type & tg_y_D) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.tg_D(s - m_s0[idx], tg_x_D, tg_y_D);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg_DD(real_type s, real_type & tg_x_DD, real_type & tg_y_DD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.tg_DD(s - m_s0[idx], tg_x_DD, tg_y_DD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg_DDD(real_type s, real_type & tg_x_DDD, real_type & tg_y_DDD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.tg_DDD(s - m_s0[idx], tg_x_DDD, tg_y_DDD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::evaluate(real_type s, real_type & th, real_type & k, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     c.evaluate(s - m_s0[idx], th, k, x, y);
   }
 
@@ -714,104 +779,108 @@ namespace G2lib {
 
   void ClothoidList::evaluate_ISO(
       real_type s, real_type offs, real_type & th, real_type & k, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
-    c.evaluate_ISO(s - m_s0[idx], offs, th, k, x, y);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
+    real_type          ss  = s - m_s0[idx];
+    c.eval_ISO(ss, offs, x, y);
+    th = c.theta(ss);
+    k  = c.kappa(ss);
+    k /= 1 + offs * k;  // scale curvature
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval(real_type s, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval(s - m_s0[idx], x, y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_D(real_type s, real_type & x_D, real_type & y_D) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_D(s - m_s0[idx], x_D, y_D);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_DD(real_type s, real_type & x_DD, real_type & y_DD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_DD(s - m_s0[idx], x_DD, y_DD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_DDD(real_type s, real_type & x_DDD, real_type & y_DDD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_DDD(s - m_s0[idx], x_DDD, y_DDD);
   }
 
@@ -824,99 +893,206 @@ namespace G2lib {
   \*/
 
   real_type ClothoidList::X_ISO(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_ISO(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_ISO(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_ISO_D(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_ISO_D(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO_D(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_ISO_D(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_ISO_DD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_ISO_DD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO_DD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_ISO_DD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_ISO_DDD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.X_ISO_DDD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO_DDD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.Y_ISO_DDD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_ISO(s - m_s0[idx], offs, x, y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_ISO_D(s - m_s0[idx], offs, x_D, y_D);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_ISO_DD(s - m_s0[idx], offs, x_DD, y_DD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type           idx = findAtS(s);
+    ClothoidData const c   = m_clotoidList.data(idx);
     return c.eval_ISO_DDD(s - m_s0[idx], offs, x_DDD, y_DDD);
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval(int_type n, real_type const * s, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, m_curve_is_closed, true);
+      int_type idx = lastInterval;
+      m_clotoidList.data(idx).eval(si - m_s0[idx], x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, m_curve_is_closed, true);
+      int_type idx = lastInterval;
+      m_clotoidList.data(idx).eval_ISO(si - m_s0[idx], offs, x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::evaluate(
+      int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, m_curve_is_closed, true);
+      int_type idx = lastInterval;
+      m_clotoidList.data(idx).evaluate(si - m_s0[idx], th[i], k[i], x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_sorted(int_type n, real_type const * s, real_type * x, real_type * y) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) { CD.eval(ss, x[i], y[i]); });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_D_sorted(int_type n, real_type const * s, real_type * x_D, real_type * y_D) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) { CD.eval_D(ss, x_D[i], y_D[i]); });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_DD_sorted(int_type n, real_type const * s, real_type * x_DD, real_type * y_DD) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) { CD.eval_DD(ss, x_DD[i], y_DD[i]); });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_DDD_sorted(int_type n, real_type const * s, real_type * x_DDD, real_type * y_DDD) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) { CD.eval_DDD(ss, x_DDD[i], y_DDD[i]); });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_ISO_sorted(
+      int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) { CD.eval_ISO(ss, offs, x[i], y[i]); });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_ISO_D_sorted(
+      int_type n, real_type const * s, real_type offs, real_type * x_D, real_type * y_D) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) {
+      CD.eval_ISO_D(ss, offs, x_D[i], y_D[i]);
+    });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_ISO_DD_sorted(
+      int_type n, real_type const * s, real_type offs, real_type * x_DD, real_type * y_DD) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) {
+      CD.eval_ISO_DD(ss, offs, x_DD[i], y_DD[i]);
+    });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_ISO_DDD_sorted(
+      int_type n, real_type const * s, real_type offs, real_type * x_DDD, real_type * y_DDD) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) {
+      CD.eval_ISO_DDD(ss, offs, x_DDD[i], y_DDD[i]);
+    });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::evaluate_sorted(
+      int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const {
+    walk_sorted(n, s, [&](int_type i, ClothoidData const & CD, real_type ss) {
+      CD.evaluate(ss, th[i], k[i], x[i], y[i]);
+    });
+  }
+
   /*\
    |  _                        __
    | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -926,64 +1102,52 @@ namespace G2lib {
   \*/
 
   void ClothoidList::translate(real_type tx, real_type ty) {
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
-    for (; ic != m_clotoidList.end(); ++ic)
-      ic->translate(tx, ty);
+    m_clotoidList.translate(tx, ty);
+    m_curves.clear();
+    m_aabb.refit([tx, ty](TriangleCover const & TC) { return TC.translated(tx, ty); });
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::rotate(real_type angle, real_type cx, real_type cy) {
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
-    for (; ic != m_clotoidList.end(); ++ic)
-      ic->rotate(angle, cx, cy);
+    m_clotoidList.rotate(angle, cx, cy);
+    m_curves.clear();
+    m_aabb.refit([angle, cx, cy](TriangleCover const & TC) { return TC.rotated(angle, cx, cy); });
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::scale(real_type sfactor) {
-    vector<ClothoidCurve>::iterator ic    = m_clotoidList.begin();
-    real_type                       newx0 = ic->x_begin();
-    real_type                       newy0 = ic->y_begin();
-    m_s0[0]                               = 0;
-    for (size_t k = 0; ic != m_clotoidList.end(); ++ic, ++k) {
-      ic->scale(sfactor);
-      ic->change_origin(newx0, newy0);
-      newx0       = ic->x_end();
-      newy0       = ic->y_end();
-      m_s0[k + 1] = m_s0[k] + ic->length();
-    }
+    ClothoidData const CD0 = m_clotoidList.data(0);
+    m_clotoidList.scale(sfactor);
+    m_clotoidList.change_origin(CD0.x0, CD0.y0);
+    m_s0[0] = 0;
+    for (size_t k = 0; k < m_clotoidList.size(); ++k)
+      m_s0[k + 1] = m_s0[k] + m_clotoidList.length(k);
+    m_curves.clear();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::reverse() {
-    std::reverse(m_clotoidList.begin(), m_clotoidList.end());
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
-    ic->reverse();
-    real_type newx0 = ic->x_end();
-    real_type newy0 = ic->y_end();
-    m_s0[0]         = 0;
-    m_s0[1]         = ic->length();
-    size_t k        = 1;
-    for (++ic; ic != m_clotoidList.end(); ++ic, ++k) {
-      ic->reverse();
-      ic->change_origin(newx0, newy0);
-      newx0       = ic->x_end();
-      newy0       = ic->y_end();
-      m_s0[k + 1] = m_s0[k] + ic->length();
-    }
+    m_clotoidList.reverse_order();
+    m_clotoidList.reverse_segments();
+    ClothoidData const CD0 = m_clotoidList.data(0);
+    m_clotoidList.change_origin(CD0.x0, CD0.y0);
+    m_s0[0] = 0;
+    for (size_t k = 0; k < m_clotoidList.size(); ++k)
+      m_s0[k + 1] = m_s0[k] + m_clotoidList.length(k);
+    m_curves.clear();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::change_origin(real_type newx0, real_type newy0) {
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
-    for (; ic != m_clotoidList.end(); ++ic) {
-      ic->change_origin(newx0, newy0);
-      newx0 = ic->x_end();
-      newy0 = ic->y_end();
-    }
+    m_clotoidList.change_origin(newx0, newy0);
+    m_curves.clear();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1062,30 +1226,65 @@ namespace G2lib {
   \*/
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-  void ClothoidList::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
-    if (m_aabb_done && Utils::isZero(offs - m_aabb_offs) && Utils::isZero(max_angle - m_aabb_max_angle) &&
-        Utils::isZero(max_size - m_aabb_max_size))
-      return;
+  PtrTriangleCover ClothoidList::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
+    return m_aabb.get(
+        [&](TriangleCover const & TC) {
+          return TC.same(offs, max_angle, max_size) && TC.clipped == aabb_clip_triangles;
+        },
+        [&]() { return ClothoidListT<real_type>::build_AABBtree_ISO(m_clotoidList, offs, max_angle, max_size); });
+  }
 
-    vector<shared_ptr<BBox const>> bboxes;
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    bbTriangles_ISO(offs, m_aabb_tri, max_angle, max_size);
-    bboxes.reserve(m_aabb_tri.size());
-    vector<Triangle2D>::const_iterator it;
-    int_type                           ipos = 0;
-    for (it = m_aabb_tri.begin(); it != m_aabb_tri.end(); ++it, ++ipos) {
-      real_type xmin, ymin, xmax, ymax;
-      it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos));
-    }
-    m_aabb_tree.build(bboxes);
-    m_aabb_done      = true;
-    m_aabb_offs      = offs;
-    m_aabb_max_angle = max_angle;
-    m_aabb_max_size  = max_size;
+  PtrTriangleCover ClothoidList::aabb_ISO(real_type offs) const {
+    // any cached cover with the right offset is good for the queries
+    PtrTriangleCover TC = m_aabb.find(
+        [offs](TriangleCover const & T) { return Utils::isZero(T.offs - offs) && T.clipped == aabb_clip_triangles; });
+    return TC != nullptr ? TC : this->build_AABBtree_ISO(offs);
   }
 #endif
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  std::uint64_t ClothoidList::geometry_hash() const {
+    std::uint64_t h = Utils::hash_bytes(nullptr, 0);
+    for (size_t i = 0; i < m_clotoidList.size(); ++i) {
+      ClothoidData const CD      = m_clotoidList.data(i);
+      real_type const    data[6] = {CD.x0, CD.y0, CD.theta0, CD.kappa0, CD.dk, m_clotoidList.length(i)};
+      h                          = Utils::hash_bytes(data, sizeof(data), h);
+    }
+    return h;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::save_aabb(ostream_type & stream) const {
+    TriangleCover::save(stream, m_aabb.covers(), this->geometry_hash());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool ClothoidList::load_aabb(istream_type & stream) const {
+    vector<PtrTriangleCover> covers;
+    if (!TriangleCover::load(stream, this->geometry_hash(), covers))
+      return false;
+    // the least recently used first, so that the LRU order is kept
+    for (auto it = covers.rbegin(); it != covers.rend(); ++it)
+      m_aabb.add(*it);
+    return true;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool ClothoidList::load_aabb(void const * data, size_t size) const {
+    vector<PtrTriangleCover> covers;
+    if (!TriangleCover::load(data, size, this->geometry_hash(), covers))
+      return false;
+    for (auto it = covers.rbegin(); it != covers.rend(); ++it)
+      m_aabb.add(*it);
+    return true;
+  }
+
   /*\
    |   _       _                          _
    |  (_)_ __ | |_ ___ _ __ ___  ___  ___| |_
@@ -1096,20 +1295,16 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  bool ClothoidList::collision(ClothoidList const & C) const {
-    this->build_AABBtree_ISO(0);
-    C.build_AABBtree_ISO(0);
-    T2D_collision_list_ISO fun(this, 0, &C, 0);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
-  }
+  bool ClothoidList::collision(ClothoidList const & C) const { return this->collision_ISO(0, C, 0); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidList::collision_ISO(real_type offs, ClothoidList const & C, real_type offs_C) const {
-    this->build_AABBtree_ISO(offs);
-    C.build_AABBtree_ISO(offs_C);
-    T2D_collision_list_ISO fun(this, offs, &C, offs_C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    PtrTriangleCover TC1 = this->aabb_ISO(offs);
+    PtrTriangleCover TC2 = C.aabb_ISO(offs_C);
+    return ClothoidListT<real_type>::collision_ISO(
+        m_clotoidList, *TC1, offs, C.m_clotoidList, *TC2, offs_C, ClothoidCurve::m_max_iter,
+        ClothoidCurve::m_tolerance);
   }
 
   /*\
@@ -1124,47 +1319,28 @@ namespace G2lib {
   void ClothoidList::intersect_ISO(
       real_type offs, ClothoidList const & CL, real_type offs_CL, IntersectList & ilist, bool swap_s_vals) const {
     if (intersect_with_AABBtree) {
-      this->build_AABBtree_ISO(offs);
-      CL.build_AABBtree_ISO(offs_CL);
-      AABBtree::VecPairPtrBBox iList;
-      m_aabb_tree.intersect(CL.m_aabb_tree, iList);
-
-      AABBtree::VecPairPtrBBox::const_iterator ip;
-      for (ip = iList.begin(); ip != iList.end(); ++ip) {
-        size_t ipos1 = size_t(ip->first->Ipos());
-        size_t ipos2 = size_t(ip->second->Ipos());
-
-        Triangle2D const & T1 = m_aabb_tri[ipos1];
-        Triangle2D const & T2 = CL.m_aabb_tri[ipos2];
-
-        ClothoidCurve const & C1 = m_clotoidList[T1.Icurve()];
-        ClothoidCurve const & C2 = CL.m_clotoidList[T2.Icurve()];
-
-        real_type ss1, ss2;
-        bool      converged = C1.aabb_intersect_ISO(T1, offs, &C2, T2, offs_CL, ss1, ss2);
-
-        if (converged) {
-          ss1 += m_s0[T1.Icurve()];
-          ss2 += CL.m_s0[T2.Icurve()];
-          if (swap_s_vals)
-            swap(ss1, ss2);
-          ilist.push_back(Ipair(ss1, ss2));
-        }
-      }
+      PtrTriangleCover TC1 = this->aabb_ISO(offs);
+      PtrTriangleCover TC2 = CL.aabb_ISO(offs_CL);
+      ClothoidListT<real_type>::intersect_ISO(
+          m_clotoidList, m_s0, *TC1, offs, CL.m_clotoidList, CL.m_s0, *TC2, offs_CL, ClothoidCurve::m_max_iter,
+          ClothoidCurve::m_tolerance, Utils::num_threads(aabb_intersect_threads), ilist, swap_s_vals);
     } else {
-      bbTriangles_ISO(offs, m_aabb_tri, Utils::m_pi / 18, 1e100);
-      CL.bbTriangles_ISO(offs_CL, CL.m_aabb_tri, Utils::m_pi / 18, 1e100);
+      vector<Triangle2D> tri1, tri2;
+      bbTriangles_ISO(offs, tri1, Utils::m_pi / 18, 1e100);
+      CL.bbTriangles_ISO(offs_CL, tri2, Utils::m_pi / 18, 1e100);
+      size_t                             n0 = ilist.size();
       vector<Triangle2D>::const_iterator i1, i2;
-      for (i1 = m_aabb_tri.begin(); i1 != m_aabb_tri.end(); ++i1) {
-        for (i2 = CL.m_aabb_tri.begin(); i2 != CL.m_aabb_tri.end(); ++i2) {
+      for (i1 = tri1.begin(); i1 != tri1.end(); ++i1) {
+        for (i2 = tri2.begin(); i2 != tri2.end(); ++i2) {
           Triangle2D const & T1 = *i1;
           Triangle2D const & T2 = *i2;
 
-          ClothoidCurve const & C1 = m_clotoidList[T1.Icurve()];
-          ClothoidCurve const & C2 = CL.m_clotoidList[T2.Icurve()];
-
+          size_t    i1 = size_t(T1.Icurve());
+          size_t    i2 = size_t(T2.Icurve());
           real_type ss1, ss2;
-          bool      converged = C1.aabb_intersect_ISO(T1, offs, &C2, T2, offs_CL, ss1, ss2);
+          bool      converged = ClothoidCurve::aabb_intersect_ISO(
+              m_clotoidList.data(i1), m_clotoidList.length(i1), T1, offs, CL.m_clotoidList.data(i2),
+              CL.m_clotoidList.length(i2), T2, offs_CL, ss1, ss2);
 
           if (converged) {
             ss1 += m_s0[T1.Icurve()];
@@ -1175,6 +1351,7 @@ namespace G2lib {
           }
         }
       }
+      sort(ilist.begin() + ptrdiff_t(n0), ilist.end());
     }
   }
 
@@ -1188,32 +1365,79 @@ namespace G2lib {
 
   int_type ClothoidList::closest_point_internal(
       real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const {
-    this->build_AABBtree_ISO(offs);
+    PtrTriangleCover TC = this->aabb_ISO(offs);
 
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "ClothoidList::closest_point_internal no candidate\n");
+    // best-first: the triangles are refined in order of distance, the
+    // triangles of a leaf are measured at once
     int_type icurve = 0;
-    DST             = numeric_limits<real_type>::infinity();
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
+    auto     refine = [&](Triangle2D const & T, real_type, real_type best) -> real_type {
+      real_type xx, yy, ss, dst;
+      ClothoidCurve::closest_point_internal(
+          m_clotoidList.data(T.Icurve()), T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
+      if (dst < best) {
+        s      = ss + m_s0[T.Icurve()];
+        x      = xx;
+        y      = yy;
+        icurve = T.Icurve();
+      }
+      return dst;
+    };
+    DST = TC->nearest(qx, qy, refine);
+    G2LIB_UTILS_ASSERT0(Utils::isRegular(DST), "ClothoidList::closest_point_internal no candidate\n");
+    return icurve;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // Closest point of the segment `i` alone, as `ClothoidCurve::closest_point_ISO`
+  // with `s` from the start of the segment. The triangles of the segment are
+  // a contiguous range of the cover `TC` of the list (zero offset).
+  //
+  int_type ClothoidList::closest_point_segment(
+      TriangleCover const & TC,
+      int_type              i,
+      real_type             qx,
+      real_type             qy,
+      real_type &           x,
+      real_type &           y,
+      real_type &           s,
+      real_type &           t,
+      real_type &           DST) const {
+    ClothoidData CD = m_clotoidList.data(size_t(i));
+    auto         it = lower_bound(
+        TC.tri.begin(), TC.tri.end(), i, [](Triangle2D const & T, int_type k) { return T.Icurve() < k; });
+
+    // the triangles of the segment are refined in order of distance
+    vector<pair<real_type, Triangle2D const *>> near;
+    for (; it != TC.tri.end() && it->Icurve() == i; ++it)
+      near.emplace_back(it->distMin(qx, qy), &*it);
+    sort(near.begin(), near.end(), [](auto const & a, auto const & b) { return a.first < b.first; });
+
+    DST = numeric_limits<real_type>::infinity();
+    for (auto const & n : near) {
+      if (!(n.first < DST))
+        break;
+      Triangle2D const & T = *n.second;
+      real_type          xx, yy, ss, dst;
+      ClothoidCurve::closest_point_internal(CD, T.S0(), T.S1(), qx, qy, 0, xx, yy, ss, dst);
       if (dst < DST) {
-        // refine distance
-        real_type xx, yy, ss;
-        m_clotoidList[T.Icurve()].closest_point_internal(T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
-        if (dst < DST) {
-          DST    = dst;
-          s      = ss + m_s0[T.Icurve()];
-          x      = xx;
-          y      = yy;
-          icurve = T.Icurve();
-        }
+        x   = xx;
+        y   = yy;
+        s   = ss;
+        DST = dst;
       }
     }
-    return icurve;
+    G2LIB_UTILS_ASSERT0(Utils::isRegular(DST), "ClothoidList::closest_point_segment no candidate\n");
+
+    // check if projection is orthogonal
+    real_type nx, ny;
+    CD.nor_ISO(s, nx, ny);
+    real_type qxx = qx - x;
+    real_type qyy = qy - y;
+    t             = qxx * nx + qyy * ny;  // signed distance
+    real_type pt  = abs(qxx * ny - qyy * nx);
+    return pt > GLIB2_TOL_ANGLE * hypot(qxx, qyy) ? -1 : 1;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1231,7 +1455,7 @@ namespace G2lib {
 
     // check if projection is orthogonal
     real_type nx, ny;
-    m_clotoidList[icurve].nor_ISO(s - m_s0[icurve], nx, ny);
+    m_clotoidList.data(icurve).nor_ISO(s - m_s0[icurve], nx, ny);
     real_type qxx = qx - x;
     real_type qyy = qy - y;
     t             = qxx * nx + qyy * ny - offs;  // signed distance
@@ -1255,31 +1479,120 @@ namespace G2lib {
   \*/
 
   int_type ClothoidList::closest_segment(real_type qx, real_type qy) const {
-    this->build_AABBtree_ISO(0);
-
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "ClothoidList::closest_segment no candidate\n");
-    int_type  icurve = 0;
-    real_type DST    = numeric_limits<real_type>::infinity();
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
-      if (dst < DST) {
-        // refine distance
-        real_type xx, yy, ss;
-        m_clotoidList[T.Icurve()].closest_point_internal(T.S0(), T.S1(), qx, qy, 0, xx, yy, ss, dst);
-        if (dst < DST) {
-          DST    = dst;
-          icurve = T.Icurve();
-        }
+    PtrTriangleCover TC = this->aabb_ISO(0);
+
+    int_type icurve = 0;
+    auto     refine = [&](Triangle2D const & T, real_type, real_type best) -> real_type {
+      real_type xx, yy, ss, dst;
+      ClothoidCurve::closest_point_internal(m_clotoidList.data(T.Icurve()), T.S0(), T.S1(), qx, qy, 0, xx, yy, ss, dst);
+      if (dst < best)
+        icurve = T.Icurve();
+      return dst;
+    };
+    real_type DST = TC->nearest(qx, qy, refine);
+    G2LIB_UTILS_ASSERT0(Utils::isRegular(DST), "ClothoidList::closest_segment no candidate\n");
+    return icurve;
+  }
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::query_radius_ISO(
+      real_type qx, real_type qy, real_type offs, real_type r, vector<SegmentDistance> & out) const {
+    out.clear();
+    PtrTriangleCover TC = this->aabb_ISO(offs);
+    // every triangle in range is refined on its own piece of segment
+    TC->tree.visit_near(qx, qy, r, [&](AABBtree::PtrBBox const & box, real_type) {
+      Triangle2D const & T = TC->tri[size_t(box->Ipos())];
+      if (T.distMin(qx, qy) <= r) {
+        real_type xx, yy, ss, dst;
+        ClothoidCurve::closest_point_internal(
+          m_clotoidList.data(T.Icurve()), T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
+        if (dst <= r)
+          out.push_back(SegmentDistance{T.Icurve(), ss + m_s0[T.Icurve()], dst});
+      }
+      return r;
+    });
+    Utils::unique_segments(out);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::knn_ISO(
+      real_type qx, real_type qy, real_type offs, int_type k, vector<SegmentDistance> & out) const {
+    out.clear();
+    if (k <= 0)
+      return;
+    size_t                kk = size_t(k);
+    PtrTriangleCover TC = this->aabb_ISO(offs);
+    TC->tree.visit_near(
+        qx, qy, numeric_limits<real_type>::infinity(), [&](AABBtree::PtrBBox const & box, real_type) {
+          Triangle2D const & T = TC->tri[size_t(box->Ipos())];
+          real_type          r = Utils::knn_radius(out, kk);
+          if (!(T.distMin(qx, qy) < r))
+            return r;
+          real_type xx, yy, ss, dst;
+          ClothoidCurve::closest_point_internal(
+          m_clotoidList.data(T.Icurve()), T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
+          return Utils::knn_insert(out, kk, SegmentDistance{T.Icurve(), ss + m_s0[T.Icurve()], dst});
+        });
+    Utils::knn_sort(out);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool ClothoidList::raycast_ISO(
+      real_type   x0,
+      real_type   y0,
+      real_type   dx,
+      real_type   dy,
+      real_type   offs,
+      real_type   tmax,
+      real_type & t,
+      real_type & s,
+      int_type &  icurve) const {
+    icurve        = -1;
+    real_type len = hypot(dx, dy);
+    if (m_clotoidList.empty() || !(len > 0))
+      return false;
+    dx /= len;
+    dy /= len;
+    PtrTriangleCover TC  = this->aabb_ISO(offs);
+    auto             hit = [&](AABBtree::PtrBBox const & box, real_type best) -> real_type {
+      Triangle2D const & T = TC->tri[size_t(box->Ipos())];
+      real_type          tt, ss;
+      if (!ClothoidCurve::raycast_internal(
+              m_clotoidList.data(T.Icurve()), T.S0(), T.S1(), x0, y0, dx, dy, offs, best, tt, ss))
+        return best;
+      t      = tt;
+      s      = ss + m_s0[T.Icurve()];
+      icurve = T.Icurve();
+      return tt;
+    };
+    TC->tree.raycast(x0, y0, dx, dy, tmax, hit);
+    return icurve >= 0;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::raycast_ISO(
+      int_type          n,
+      real_type const * x0,
+      real_type const * y0,
+      real_type const * dx,
+      real_type const * dy,
+      real_type         offs,
+      real_type         tmax,
+      real_type *       t,
+      real_type *       s,
+      int_type *        icurve) const {
+    for (int_type i = 0; i < n; ++i) {
+      if (!raycast_ISO(x0[i], y0[i], dx[i], dy[i], offs, tmax, t[i], s[i], icurve[i])) {
+        t[i] = numeric_limits<real_type>::infinity();
+        s[i] = 0;
       }
     }
-    return icurve;
   }
 
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type ClothoidList::closest_point_in_range_ISO(
@@ -1294,10 +1607,11 @@ namespace G2lib {
       real_type & dst,
       int_type &  icurve) const {
     G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::closest_point_in_range_ISO, empty list\n");
-    int_type nsegs = this->num_segments();
+    PtrTriangleCover TC    = this->aabb_ISO(0);
+    int_type         nsegs = this->num_segments();
     if (nsegs == 1) {  // only 1 segment to check
       icurve       = 0;
-      int_type res = m_clotoidList.front().closest_point_ISO(qx, qy, x, y, s, t, dst);
+      int_type res = closest_point_segment(*TC, 0, qx, qy, x, y, s, t, dst);
       s += m_s0[0];
       return res;
     }
@@ -1311,7 +1625,7 @@ namespace G2lib {
     G2LIB_UTILS_ASSERT(ib >= 0 && ie >= 0, "ClothoidList::closest_point_in_range_ISO, ib = %d ie = %d\n", ib, ie);
 
     icurve       = ib;
-    int_type res = m_clotoidList[icurve].closest_point_ISO(qx, qy, x, y, s, t, dst);
+    int_type res = closest_point_segment(*TC, icurve, qx, qy, x, y, s, t, dst);
     s += m_s0[icurve];
 
     if (ib == ie)
@@ -1322,7 +1636,7 @@ namespace G2lib {
       if (++iseg >= nsegs)
         iseg -= nsegs;  // next segment
       real_type C_x, C_y, C_s, C_t, C_dst;
-      int_type  C_res = m_clotoidList[iseg].closest_point_ISO(qx, qy, C_x, C_y, C_s, C_t, C_dst);
+      int_type  C_res = closest_point_segment(*TC, iseg, qx, qy, C_x, C_y, C_s, C_t, C_dst);
       if (C_dst < dst) {
         dst    = C_dst;
         x      = C_x;
@@ -1430,19 +1744,16 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getSK(real_type * s, real_type * kappa) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    real_type                             ss = 0;
-    while (ic != m_clotoidList.end()) {
+    size_t    n  = m_clotoidList.size();
+    real_type ss = 0;
+    for (size_t k = 0; k < n; ++k) {
       s[k]     = ss;
-      kappa[k] = ic->kappa_begin();
-      ss += ic->length();
-      ++k;
-      ++ic;
+      kappa[k] = m_clotoidList.data(k).kappa0;
+      ss += m_clotoidList.length(k);
     }
-    --ic;  // last element
-    s[k]     = ss;
-    kappa[k] = ic->kappa_end();
+    // last element
+    s[n]     = ss;
+    kappa[n] = m_clotoidList.data(n - 1).kappa(m_clotoidList.length(n - 1));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1451,46 +1762,41 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getSTK(real_type * s, real_type * theta, real_type * kappa) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    real_type                             ss = 0;
-    while (ic != m_clotoidList.end()) {
-      s[k]     = ss;
-      theta[k] = ic->theta_begin();
-      kappa[k] = ic->kappa_begin();
-      ss += ic->length();
-      ++k;
-      ++ic;
+    size_t    n  = m_clotoidList.size();
+    real_type ss = 0;
+    for (size_t k = 0; k < n; ++k) {
+      ClothoidData const CD = m_clotoidList.data(k);
+      s[k]                  = ss;
+      theta[k]              = CD.theta0;
+      kappa[k]              = CD.kappa0;
+      ss += m_clotoidList.length(k);
     }
-    --ic;  // last element
-    s[k]     = ss;
-    theta[k] = ic->theta_end();
-    kappa[k] = ic->kappa_end();
+    // last element
+    ClothoidData const CD = m_clotoidList.data(n - 1);
+    s[n]                  = ss;
+    theta[n]              = CD.theta(m_clotoidList.length(n - 1));
+    kappa[n]              = CD.kappa(m_clotoidList.length(n - 1));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getXY(real_type * x, real_type * y) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    while (ic != m_clotoidList.end()) {
-      x[k] = ic->x_begin();
-      y[k] = ic->y_begin();
-      ++k;
-      ++ic;
+    size_t n = m_clotoidList.size();
+    for (size_t k = 0; k < n; ++k) {
+      ClothoidData const CD = m_clotoidList.data(k);
+      x[k]                  = CD.x0;
+      y[k]                  = CD.y0;
     }
-    --ic;
-    x[k] = ic->x_end();
-    y[k] = ic->y_end();
+    ClothoidData const CD = m_clotoidList.data(n - 1);
+    x[n]                  = CD.X(m_clotoidList.length(n - 1));
+    y[n]                  = CD.Y(m_clotoidList.length(n - 1));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getDeltaTheta(real_type * deltaTheta) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    for (++ic; ic != m_clotoidList.end(); ++ic, ++k) {
-      real_type tmp = ic->theta_begin() - ic[-1].theta_end();
+    for (size_t k = 0; k + 1 < m_clotoidList.size(); ++k) {
+      real_type tmp = m_clotoidList.data(k + 1).theta0 - m_clotoidList.data(k).theta(m_clotoidList.length(k));
       if (tmp > Utils::m_pi)
         tmp -= Utils::m_2pi;
       else if (tmp < -Utils::m_pi)
@@ -1502,37 +1808,33 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getDeltaKappa(real_type * deltaKappa) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    for (++ic; ic != m_clotoidList.end(); ++ic, ++k)
-      deltaKappa[k] = ic->kappa_begin() - ic[-1].kappa_end();
+    for (size_t k = 0; k + 1 < m_clotoidList.size(); ++k)
+      deltaKappa[k] = m_clotoidList.data(k + 1).kappa0 - m_clotoidList.data(k).kappa(m_clotoidList.length(k));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type ClothoidList::findST1(real_type x, real_type y, real_type & s, real_type & t) const {
     G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::findST, empty list\n");
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    vector<real_type>::const_iterator     is = m_s0.begin();
+    PtrTriangleCover TC = this->aabb_ISO(0);
 
     s = t          = 0;
-    int_type  ipos = 0;
     int_type  iseg = 0;
-    real_type S, T;
-    bool      ok = ic->findST_ISO(x, y, S, T);
+    real_type X, Y, S, T, D;
+    bool      ok = closest_point_segment(*TC, 0, x, y, X, Y, S, T, D) >= 0;
     if (ok) {
-      s    = *is + S;
+      s    = m_s0[0] + S;
       t    = T;
       iseg = 0;
     }
 
-    for (++ic, ++is, ++ipos; ic != m_clotoidList.end(); ++ic, ++is, ++ipos) {
-      bool ok1 = ic->findST_ISO(x, y, S, T);
+    for (int_type ipos = 1; ipos < int_type(m_clotoidList.size()); ++ipos) {
+      bool ok1 = closest_point_segment(*TC, ipos, x, y, X, Y, S, T, D) >= 0;
       if (ok && ok1)
         ok1 = abs(T) < abs(t);
       if (ok1) {
         ok   = true;
-        s    = *is + S;
+        s    = m_s0[ipos] + S;
         t    = T;
         iseg = ipos;
       }
@@ -1550,13 +1852,14 @@ namespace G2lib {
         ibegin >= 0 && ibegin <= iend && iend < int_type(m_clotoidList.size()),
         "ClothoidList::findST( ibegin=%d, iend=%d, x, y, s, t ) bad range not in [0,%d]\n", ibegin, iend,
         m_clotoidList.size() - 1);
+    PtrTriangleCover TC = this->aabb_ISO(0);
+
     s = t         = 0;
     int_type iseg = 0;
     bool     ok   = false;
     for (int_type k = ibegin; k <= iend; ++k) {
-      ClothoidCurve const & ck = m_clotoidList[k];
-      real_type             S, T;
-      bool                  ok1 = ck.findST_ISO(x, y, S, T);
+      real_type X, Y, S, T, D;
+      bool      ok1 = closest_point_segment(*TC, k, x, y, X, Y, S, T, D) >= 0;
       if (ok && ok1)
         ok1 = abs(T) < abs(t);
       if (ok1) {
@@ -1573,31 +1876,32 @@ namespace G2lib {
 
   void ClothoidList::export_table(ostream_type & stream) const {
     stream << "x\ty\ttheta0\tkappa0\tdkappa\tL\n";
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    for (; ic != m_clotoidList.end(); ++ic)
+    for (size_t i = 0; i < m_clotoidList.size(); ++i) {
+      ClothoidData const CD = m_clotoidList.data(i);
       stream << Utils::format_string("%f\t%f\t%f\t%f\t%f\t%f\n", 
-        ic->x_begin(), ic->y_begin(), ic->theta_begin(), ic->kappa_begin(),
-        ic->dkappa(), ic->length());
+        CD.x0, CD.y0, CD.theta0, CD.kappa0,
+        CD.dk, m_clotoidList.length(i));
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::export_ruby(ostream_type & stream) const {
     stream << "data = {\n";
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    for (; ic != m_clotoidList.end(); ++ic)
+    for (size_t i = 0; i < m_clotoidList.size(); ++i) {
+      ClothoidData const CD = m_clotoidList.data(i);
       stream << Utils::format_string("%f\t%f\t%f\t%f\t%f\t%f\n", 
-          ic->x_begin(), ic->y_begin(), ic->theta_begin(), ic->kappa_begin(),
-          ic->dkappa(), ic->length());
+          CD.x0, CD.y0, CD.theta0, CD.kappa0,
+          CD.dk, m_clotoidList.length(i));
+    }
     stream << "}\n";
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   ostream_type & operator<<(ostream_type & stream, ClothoidList const & CL) {
-    vector<ClothoidCurve>::const_iterator ic = CL.m_clotoidList.begin();
-    for (; ic != CL.m_clotoidList.end(); ++ic)
-      stream << *ic << '\n';
+    for (size_t i = 0; i < CL.m_clotoidList.size(); ++i)
+      stream << CL.m_clotoidList[i] << '\n';
     return stream;
   }
 
@@ -1655,11 +1959,10 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::save(ostream_type & stream) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
     stream << "# x y theta kappa\n";
-    for (int_type nseg = 1; ic != m_clotoidList.end(); ++ic, ++nseg) {
-      stream << "# segment n." << nseg << '\n';
-      save_segment(stream, *ic);
+    for (size_t i = 0; i < m_clotoidList.size(); ++i) {
+      stream << "# segment n." << i + 1 << '\n';
+      save_segment(stream, m_clotoidList[i]);
     }
     stream << "# EOF\n";
   }
@@ -1699,6 +2002,248 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  /*\
+   |   ____ _       _   _           _     _ _     _     _  _____
+   |  / ___| | ___ | |_| |__   ___ (_) __| | |   (_)___| ||_   _|
+   | | |   | |/ _ \| __| '_ \ / _ \| |/ _` | |   | / __| __|| |
+   | | |___| | (_) | |_| | | | (_) | | (_| | |___| \__ \ |_ | |
+   |  \____|_|\___/ \__|_| |_|\___/|_|\__,_|_____|_|___/\__||_|
+   |
+  \*/
+
+  template <typename T>
+  ClothoidListT<T>::ClothoidListT(ClothoidList const & L) : ClothoidListT(L.segments()) {}
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::init_s0() {
+    m_s0.clear();
+    m_s0.reserve(m_segments.size() + 1);
+    m_s0.push_back(0);
+    for (size_t i = 0; i < m_segments.size(); ++i)
+      m_s0.push_back(m_s0.back() + m_segments.length(i));
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::push_back(ClothoidCurveT<T> const & C) {
+    if (m_s0.empty())
+      m_s0.push_back(0);
+    m_segments.push_back(C.data(), C.length());
+    m_s0.push_back(m_s0.back() + C.length());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  size_t ClothoidListT<T>::find_at_s(T & s) const {
+    G2LIB_UTILS_ASSERT0(!m_segments.empty(), "ClothoidListT::find_at_s, empty list\n");
+    // the first segment whose end is after `s`, the last one if none
+    size_t k = size_t(std::upper_bound(m_s0.begin() + 1, m_s0.end() - 1, s) - m_s0.begin()) - 1;
+    s -= m_s0[k];
+    return k;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  template <typename FUN>
+  void ClothoidListT<T>::walk(int_type n, T const * s, FUN const & fun) const {
+    vector<T> ss(size_t(n > 0 ? n : 0));
+    int_type  i0 = 0;
+    while (i0 < n) {
+      ss[size_t(i0)] = s[i0];
+      size_t   k     = this->find_at_s(ss[size_t(i0)]);
+      int_type i1    = i0 + 1;
+      for (; i1 < n; ++i1) {
+        ss[size_t(i1)] = s[i1];
+        if (this->find_at_s(ss[size_t(i1)]) != k)
+          break;
+      }
+      fun(m_segments.data(k), i0, i1 - i0, ss.data() + i0);
+      i0 = i1;
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::eval(T s, T & x, T & y) const {
+    size_t k = this->find_at_s(s);
+    m_segments.data(k).eval(s, x, y);
+  }
+
+  template <typename T>
+  void ClothoidListT<T>::eval_ISO(T s, T offs, T & x, T & y) const {
+    size_t k = this->find_at_s(s);
+    m_segments.data(k).eval_ISO(s, offs, x, y);
+  }
+
+  template <typename T>
+  void ClothoidListT<T>::evaluate(T s, T & theta, T & kappa, T & x, T & y) const {
+    size_t k = this->find_at_s(s);
+    m_segments.data(k).evaluate(s, theta, kappa, x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::eval(int_type n, T const * s, T * x, T * y) const {
+    this->walk(n, s, [&](ClothoidDataT<T> const & CD, int_type i0, int_type m, T const * ss) {
+      CD.eval(m, ss, x + i0, y + i0);
+    });
+  }
+
+  template <typename T>
+  void ClothoidListT<T>::eval_ISO(int_type n, T const * s, T offs, T * x, T * y) const {
+    this->walk(n, s, [&](ClothoidDataT<T> const & CD, int_type i0, int_type m, T const * ss) {
+      CD.eval_ISO(m, ss, offs, x + i0, y + i0);
+    });
+  }
+
+  template <typename T>
+  void ClothoidListT<T>::evaluate(int_type n, T const * s, T * theta, T * kappa, T * x, T * y) const {
+    this->walk(n, s, [&](ClothoidDataT<T> const & CD, int_type i0, int_type m, T const * ss) {
+      CD.evaluate(m, ss, theta + i0, kappa + i0, x + i0, y + i0);
+    });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::bbTriangles_ISO(
+      ClothoidSoAT<T> const &  S,
+      T                        offs,
+      vector<Triangle2DT<T>> & tvec,
+      T                        max_angle,
+      T                        max_size,
+      int_type                 icurve) {
+    for (size_t i = 0; i < S.size(); ++i)
+      ClothoidCurveT<T>::bbTriangles_ISO(S.data(i), S.length(i), offs, tvec, max_angle, max_size, icurve + int_type(i));
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  typename ClothoidListT<T>::PtrCover ClothoidListT<T>::build_AABBtree_ISO(
+      ClothoidSoAT<T> const & S, T offs, T max_angle, T max_size) {
+    auto TC = make_shared<TriangleCoverT<T>>(offs, max_angle, max_size);
+    bbTriangles_ISO(S, offs, TC->tri, max_angle, max_size, 0);
+    if (aabb_clip_triangles) {
+      TC->height.reserve(TC->tri.size());
+      for (Triangle2DT<T> const & Tri : TC->tri)
+        TC->height.push_back(ClothoidCurveT<T>::chord_height_ISO(S.data(size_t(Tri.Icurve())), Tri, offs));
+      TC->clipped = true;
+    }
+    TC->build_tree(G2LIB_CLOTHOID);
+    return TC;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  bool ClothoidListT<T>::collision_ISO(
+      ClothoidSoAT<T> const &   S1,
+      TriangleCoverT<T> const & TC1,
+      T                         offs1,
+      ClothoidSoAT<T> const &   S2,
+      TriangleCoverT<T> const & TC2,
+      T                         offs2,
+      int_type                  max_iter,
+      T                         tolerance) {
+    auto fun = [&](typename AABBtreeT<T>::PtrBBox const & ptr1, typename AABBtreeT<T>::PtrBBox const & ptr2) {
+      Triangle2DT<T> const & T1 = TC1.tri[size_t(ptr1->Ipos())];
+      Triangle2DT<T> const & T2 = TC2.tri[size_t(ptr2->Ipos())];
+      size_t                 i1 = size_t(T1.Icurve());
+      size_t                 i2 = size_t(T2.Icurve());
+      T                      ss1, ss2;
+      return ClothoidCurveT<T>::aabb_intersect_ISO(
+          S1.data(i1), S1.length(i1), T1, offs1, S2.data(i2), S2.length(i2), T2, offs2, max_iter, tolerance, ss1,
+          ss2);
+    };
+    return TC1.tree.collision(TC2.tree, fun, false);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::intersect_ISO(
+      ClothoidSoAT<T> const &   S1,
+      vector<T> const &         s01,
+      TriangleCoverT<T> const & TC1,
+      T                         offs1,
+      ClothoidSoAT<T> const &   S2,
+      vector<T> const &         s02,
+      TriangleCoverT<T> const & TC2,
+      T                         offs2,
+      int_type                  max_iter,
+      T                         tolerance,
+      int_type                  nthreads,
+      IntersectList &           ilist,
+      bool                      swap_s_vals) {
+    using PairT = pair<T, T>;
+
+    // intersection of the pieces of curve covered by a pair of overlapping triangles
+    auto refine = [&](Triangle2DT<T> const & T1, Triangle2DT<T> const & T2, PairT & I) -> bool {
+      size_t i1 = size_t(T1.Icurve());
+      size_t i2 = size_t(T2.Icurve());
+      T      ss1, ss2;
+      if (!ClothoidCurveT<T>::aabb_intersect_ISO(
+              S1.data(i1), S1.length(i1), T1, offs1, S2.data(i2), S2.length(i2), T2, offs2, max_iter, tolerance, ss1,
+              ss2))
+        return false;
+      ss1 += s01[i1];
+      ss2 += s02[i2];
+      if (swap_s_vals)
+        swap(ss1, ss2);
+      I = PairT(ss1, ss2);
+      return true;
+    };
+
+    // the pairs of overlapping triangles are found and refined on `nthreads`
+    // threads, the intersections are sorted so that the result does not
+    // depend on the number of threads
+    vector<pair<Triangle2DT<T> const *, Triangle2DT<T> const *>> iList;
+    TC1.intersect_pairs(TC2, nthreads, iList);
+    vector<PairT> found(iList.size());
+    vector<char>  converged(iList.size());
+    Utils::parallel_for(nthreads, iList.size(), [&](size_t k) {
+      converged[k] = refine(*iList[k].first, *iList[k].second, found[k]) ? 1 : 0;
+    });
+    size_t n0 = ilist.size();
+    for (size_t k = 0; k < found.size(); ++k)
+      if (converged[k] != 0)
+        ilist.push_back(found[k]);
+    sort(ilist.begin() + ptrdiff_t(n0), ilist.end());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  bool ClothoidListT<T>::collision_ISO(T offs, ClothoidListT const & L, T offs_L) const {
+    PtrCover TC1 = this->build_AABBtree_ISO(offs);
+    PtrCover TC2 = L.build_AABBtree_ISO(offs_L);
+    return collision_ISO(
+        m_segments, *TC1, offs, L.m_segments, *TC2, offs_L, ClothoidCurveT<T>::max_iter(),
+        ClothoidCurveT<T>::tolerance());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidListT<T>::intersect_ISO(T offs, ClothoidListT const & L, T offs_L, IntersectList & ilist) const {
+    PtrCover TC1 = this->build_AABBtree_ISO(offs);
+    PtrCover TC2 = L.build_AABBtree_ISO(offs_L);
+    intersect_ISO(
+        m_segments, m_s0, *TC1, offs, L.m_segments, L.m_s0, *TC2, offs_L, ClothoidCurveT<T>::max_iter(),
+        ClothoidCurveT<T>::tolerance(), Utils::num_threads(aabb_intersect_threads), ilist, false);
+  }
+
+  template class ClothoidListT<float>;
+  template class ClothoidListT<double>;
+
 }  // namespace G2lib
 
 // EOF: ClothoidList.cc
@@ -0,0 +1,247 @@
+/** * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * @file ClothoidStepper.cc
+ * @author Matteo Ragni (info@ragni.me)
+ *
+ * @copyright Copyright (c) 2022 Matteo Ragni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Based on the work of:
+ * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "Clothoids/ClothoidStepper.hxx"
+#include "Utils.hxx"
+
+#include <cmath>
+
+// Workaround for Visual Studio
+#ifdef min
+#undef min
+#endif
+
+#ifdef max
+#undef max
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define STEPPER_MAX_ANGLE 0.25
+#endif
+
+namespace G2lib {
+
+  using std::abs;
+  using std::cos;
+  using std::max;
+  using std::sin;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  // 4 points Gauss-Legendre rule on [0,1], index 0 is the sample point
+  static real_type const stepper_node[5] = { 0,
+                                             0.5 - 0.43056815579702629,
+                                             0.5 - 0.16999052179242813,
+                                             0.5 + 0.16999052179242813,
+                                             0.5 + 0.43056815579702629 };
+
+  static real_type const stepper_weight[5] = { 0,
+                                               0.17392742256872693,
+                                               0.32607257743127307,
+                                               0.32607257743127307,
+                                               0.17392742256872693 };
+#endif
+
+  /*\
+   |   ____  _
+   |  / ___|| |_ ___ _ __  _ __   ___ _ __
+   |  \___ \| __/ _ \ '_ \| '_ \ / _ \ '__|
+   |   ___) | ||  __/ |_) | |_) |  __/ |
+   |  |____/ \__\___| .__/| .__/ \___|_|
+   |                |_|   |_|
+  \*/
+
+  ClothoidStepper::ClothoidStepper(real_type offs, int_type reanchor)
+      : m_L(0),
+        m_ds(0),
+        m_offs(offs),
+        m_reanchor(reanchor),
+        m_nstep(0),
+        m_k(0),
+        m_end(false),
+        m_exact(true),
+        m_s(0),
+        m_x(0),
+        m_y(0),
+        m_qx(1),
+        m_qy(0) {
+    G2LIB_UTILS_ASSERT(reanchor > 0, "ClothoidStepper, reanchor = %d must be positive\n", reanchor);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  ClothoidStepper::ClothoidStepper(ClothoidCurve const & C, real_type ds, real_type offs, int_type reanchor)
+      : ClothoidStepper(offs, reanchor) {
+    G2LIB_UTILS_ASSERT(ds > 0, "ClothoidStepper, ds = %g must be positive\n", ds);
+    m_ds = ds;
+    this->setup(C);
+    this->anchor(0);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidStepper::setup(ClothoidCurve const & C) {
+    m_CD.x0      = C.x_begin();
+    m_CD.y0      = C.y_begin();
+    m_CD.theta0  = C.theta_begin();
+    m_CD.kappa0  = C.kappa_begin();
+    m_CD.dk      = C.dkappa();
+    m_CD.fresnel = C.fresnel_mode();
+    m_L          = C.length();
+
+    real_type kmax = max(abs(m_CD.kappa0), abs(m_CD.kappa(m_L)));
+    m_exact        = kmax * m_ds + abs(m_CD.dk) * (m_ds * m_ds) > STEPPER_MAX_ANGLE;
+
+    real_type dq = m_CD.dk * (m_ds * m_ds);
+    m_qx         = cos(dq);
+    m_qy         = sin(dq);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidStepper::anchor(real_type s) {
+    real_type theta, kappa;
+    m_CD.evaluate(s, theta, kappa, m_x, m_y);
+    m_s     = s;
+    m_nstep = 0;
+    m_tx[0] = cos(theta);
+    m_ty[0] = sin(theta);
+    if (m_exact)
+      return;
+    // rotation of the tangent at s+u*ds over a step: ds*kappa(s+u*ds)+dk*ds^2/2
+    real_type hdq = 0.5 * m_CD.dk * (m_ds * m_ds);
+    for (int_type j = 0; j < 5; ++j) {
+      real_type sj = s + stepper_node[j] * m_ds;
+      if (j > 0) {
+        real_type th = m_CD.theta(sj);
+        m_tx[j]      = cos(th);
+        m_ty[j]      = sin(th);
+      }
+      real_type dth = m_ds * m_CD.kappa(sj) + hdq;
+      m_rx[j]       = cos(dth);
+      m_ry[j]       = sin(dth);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidStepper::advance(real_type h) {
+    real_type s1 = m_s + h;
+    // h differs from ds only by the round-off of the grid, unless it is the last step
+    if (m_exact || ++m_nstep >= m_reanchor || abs(h - m_ds) > Utils::machepsi1000 * max(m_ds, abs(s1))) {
+      this->anchor(s1);
+      return;
+    }
+    real_type dx = 0, dy = 0;
+    for (int_type j = 1; j < 5; ++j) {
+      dx += stepper_weight[j] * m_tx[j];
+      dy += stepper_weight[j] * m_ty[j];
+    }
+    m_x += h * dx;
+    m_y += h * dy;
+    // advance tangents and rotations (quadratic angle: constant second difference)
+    for (int_type j = 0; j < 5; ++j) {
+      real_type tx = m_tx[j] * m_rx[j] - m_ty[j] * m_ry[j];
+      real_type ty = m_ty[j] * m_rx[j] + m_tx[j] * m_ry[j];
+      real_type rx = m_rx[j] * m_qx - m_ry[j] * m_qy;
+      real_type ry = m_ry[j] * m_qx + m_rx[j] * m_qy;
+      m_tx[j]      = tx;
+      m_ty[j]      = ty;
+      m_rx[j]      = rx;
+      m_ry[j]      = ry;
+    }
+    m_s = s1;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidStepper::next() {
+    if (m_end)
+      return;
+    if (m_s >= m_L) {
+      m_end = true;
+      return;
+    }
+    real_type s1 = (++m_k) * m_ds;
+    if (s1 > m_L)
+      s1 = m_L;
+    this->advance(s1 - m_s);
+  }
+
+  /*\
+   |   _    _    _   ___ _
+   |  | |  (_)__| |_/ __| |_ ___ _ __ _ __  ___ _ _
+   |  | |__| (_-<  _\__ \  _/ -_) '_ \ '_ \/ -_) '_|
+   |  |____|_/__/\__|___/\__\___| .__/ .__/\___|_|
+   |                            |_|  |_|
+  \*/
+
+  ClothoidListStepper::ClothoidListStepper(ClothoidList const & CL, real_type ds, real_type offs, int_type reanchor)
+      : m_list(&CL), m_seg(offs, reanchor), m_L(0), m_ds(ds), m_icurve(0), m_k(0), m_s(0), m_end(false) {
+    m_seg.m_ds = ds;
+    G2LIB_UTILS_ASSERT(ds > 0, "ClothoidListStepper, ds = %g must be positive\n", ds);
+    int_type ns = CL.num_segments();
+    G2LIB_UTILS_ASSERT0(ns > 0, "ClothoidListStepper, empty clothoid list\n");
+    m_s0.reserve(ns + 1);
+    m_s0.push_back(0);
+    for (int_type i = 0; i < ns; ++i)
+      m_s0.push_back(m_s0.back() + CL.segment_length(i));
+    m_L = m_s0.back();
+    m_seg.setup(CL.segment(0));
+    m_seg.anchor(0);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidListStepper::next() {
+    if (m_end)
+      return;
+    if (m_s >= m_L) {
+      m_end = true;
+      return;
+    }
+    real_type s1 = (++m_k) * m_ds;
+    if (s1 > m_L)
+      s1 = m_L;
+
+    int_type ns  = m_list->num_segments();
+    int_type old = m_icurve;
+    while (m_icurve + 1 < ns && s1 > m_s0[m_icurve + 1])
+      ++m_icurve;
+
+    real_type ss = s1 - m_s0[m_icurve];
+    if (m_icurve != old) {
+      m_seg.setup(m_list->segment(m_icurve));
+      m_seg.anchor(ss);
+    } else {
+      m_seg.advance(ss - m_seg.m_s);
+    }
+    m_s = s1;
+  }
+
+}  // namespace G2lib
+
+// EOF: ClothoidStepper.cc
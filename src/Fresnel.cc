@@ -33,6 +33,17 @@
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 #define A_THRESOLD 0.01
 #define A_SERIE_SIZE 3
+#define FRESNEL_BATCH_BLOCK 64
+#define FRESNEL_SMALL_NK (4 * A_SERIE_SIZE + 3)
+#define FRESNEL_SINCOS_XMAX 1e8
+#define FRESNEL_APPROX_XMAX 6.0
+#define FRESNEL_APPROX_NC 8
+#define FRESNEL_APPROX_MAX_INTERVALS 65536
+#define FRESNEL_APPROX_DEFAULT_TOL 1e-9
+
+// The block kernels of the batched API are marked G2LIB_TARGET_CLONES
+// (Utils.hxx). Fresnel.cc is compiled with -ffp-contract=off when the dispatch
+// is enabled, so that every clone gives the same results of the baseline one.
 #endif
 
 #ifdef __GNUC__
@@ -57,12 +68,18 @@
 #include <cmath>
 #include <cfloat>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
 
 namespace G2lib {
 
   using std::abs;
   using std::max;
   using std::min;
+  using std::sqrt;
+  using std::vector;
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
@@ -120,6 +137,36 @@ namespace G2lib {
                                   0.0044099273693067311209,
                                   -0.00009070958410429993314 };
 
+  // sin and cos of the batched kernels (Cephes): pi/2 split in three parts,
+  // exact when multiplied by the quadrant, and the polynomials on [-pi/4,pi/4]
+  static const real_type m_2_pi = 0.63661977236758134308;
+
+  static const real_type pio2[] = { 1.57079625129699707031, 7.54978941586159635336e-8, 5.39030285815811905290e-15 };
+
+  static const real_type sincof[] = { 1.58962301576546568060E-10, -2.50507477628578072866E-8,
+                                      2.75573136213857245213E-6,  -1.98412698295895385996E-4,
+                                      8.33333333332211858878E-3,  -1.66666666666666307295E-1 };
+
+  static const real_type coscof[] = { -1.13585365213876817300E-11, 2.08757008419747316778E-9,
+                                      -2.75573141792967388112E-7,  2.48015872888517045348E-5,
+                                      -1.38888888888730564116E-3,  4.16666666666665929218E-2 };
+
+  // stopping thresholds of the series for each scalar type
+  template <typename T>
+  struct FresnelTraits;
+
+  template <>
+  struct FresnelTraits<double> {
+    static constexpr double eps        = 1E-15;
+    static constexpr double lommel_eps = 1E-50;
+  };
+
+  template <>
+  struct FresnelTraits<float> {
+    static constexpr float eps        = 1E-7f;
+    static constexpr float lommel_eps = 1E-30f;
+  };
+
 #endif
 
   /*
@@ -169,26 +216,27 @@ namespace G2lib {
   //! \param[out] C \f$ C(x) \f$
   //! \param[out] S \f$ S(x) \f$
   //!
-  void FresnelCS(real_type y, real_type & C, real_type & S) {
-    real_type const eps = 1E-15;
-    real_type const x   = y > 0 ? y : -y;
+  template <typename T>
+  static void FresnelCS_T(T y, T & C, T & S) {
+    T const eps = FresnelTraits<T>::eps;
+    T const x   = y > 0 ? y : -y;
 
-    if (x < 1.0) {
-      real_type twofn, fact, denterm, numterm, sum, term;
+    if (x < T(1.0)) {
+      T twofn, fact, denterm, numterm, sum, term;
 
-      real_type const s = Utils::m_pi_2 * (x * x);
-      real_type const t = -s * s;
+      T const s = T(Utils::m_pi_2) * (x * x);
+      T const t = -s * s;
 
       // Cosine integral series
-      twofn   = 0.0;
-      fact    = 1.0;
-      denterm = 1.0;
-      numterm = 1.0;
-      sum     = 1.0;
+      twofn   = T(0.0);
+      fact    = T(1.0);
+      denterm = T(1.0);
+      numterm = T(1.0);
+      sum     = T(1.0);
       do {
-        twofn += 2.0;
-        fact *= twofn * (twofn - 1.0);
-        denterm += 4.0;
+        twofn += T(2.0);
+        fact *= twofn * (twofn - T(1.0));
+        denterm += T(4.0);
         numterm *= t;
         term = numterm / (fact * denterm);
         sum += term;
@@ -197,65 +245,65 @@ namespace G2lib {
       C = x * sum;
 
       // Sine integral series
-      twofn   = 1.0;
-      fact    = 1.0;
-      denterm = 3.0;
-      numterm = 1.0;
-      sum     = 1.0 / 3.0;
+      twofn   = T(1.0);
+      fact    = T(1.0);
+      denterm = T(3.0);
+      numterm = T(1.0);
+      sum     = T(1.0) / T(3.0);
       do {
-        twofn += 2.0;
-        fact *= twofn * (twofn - 1.0);
-        denterm += 4.0;
+        twofn += T(2.0);
+        fact *= twofn * (twofn - T(1.0));
+        denterm += T(4.0);
         numterm *= t;
         term = numterm / (fact * denterm);
         sum += term;
       } while (abs(term) > eps * abs(sum));
 
-      S = Utils::m_pi_2 * sum * (x * x * x);
+      S = T(Utils::m_pi_2) * sum * (x * x * x);
 
-    } else if (x < 6.0) {
+    } else if (x < T(6.0)) {
       // Rational approximation for f
-      real_type sumn = 0.0;
-      real_type sumd = fd[11];
+      T sumn = T(0.0);
+      T sumd = T(fd[11]);
       for (int_type k = 10; k >= 0; --k) {
-        sumn = fn[k] + x * sumn;
-        sumd = fd[k] + x * sumd;
+        sumn = T(fn[k]) + x * sumn;
+        sumd = T(fd[k]) + x * sumd;
       }
-      real_type f = sumn / sumd;
+      T f = sumn / sumd;
 
       // Rational approximation for g
-      sumn = 0.0;
-      sumd = gd[11];
+      sumn = T(0.0);
+      sumd = T(gd[11]);
       for (int_type k = 10; k >= 0; --k) {
-        sumn = gn[k] + x * sumn;
-        sumd = gd[k] + x * sumd;
+        sumn = T(gn[k]) + x * sumn;
+        sumd = T(gd[k]) + x * sumd;
       }
-      real_type g = sumn / sumd;
+      T g = sumn / sumd;
 
-      real_type U    = Utils::m_pi_2 * (x * x);
-      real_type SinU = sin(U);
-      real_type CosU = cos(U);
-      C              = 0.5 + f * SinU - g * CosU;
-      S              = 0.5 - f * CosU - g * SinU;
+      T U    = T(Utils::m_pi_2) * (x * x);
+      T SinU = sin(U);
+      T CosU = cos(U);
+      C      = T(0.5) + f * SinU - g * CosU;
+      S      = T(0.5) - f * CosU - g * SinU;
 
     } else {
-      real_type absterm;
+      T absterm;
 
       // x >= 6; asymptotic expansions for  f  and  g
 
-      real_type const s = Utils::m_pi * x * x;
-      real_type const t = -1 / (s * s);
+      T const s = T(Utils::m_pi) * x * x;
+      T const t = -1 / (s * s);
 
       // Expansion for f
-      real_type numterm = -1.0;
-      real_type term    = 1.0;
-      real_type sum     = 1.0;
-      real_type oldterm = 1.0;
-      real_type eps10   = 0.1 * eps;
+      T numterm = -T(1.0);
+      T term    = T(1.0);
+      T sum     = T(1.0);
+      T oldterm = T(1.0);
+      T eps10   = T(0.1) * eps;
 
       do {
-        numterm += 4.0;
-        term *= numterm * (numterm - 2.0) * t;
+        numterm += T(4.0);
+        term *= numterm * (numterm - T(2.0)) * t;
         sum += term;
         absterm = abs(term);
         G2LIB_UTILS_ASSERT(
@@ -264,17 +312,17 @@ namespace G2lib {
         oldterm = absterm;
       } while (absterm > eps10 * abs(sum));
 
-      real_type f = sum / (Utils::m_pi * x);
+      T f = sum / (T(Utils::m_pi) * x);
 
       //  Expansion for  g
-      numterm = -1.0;
-      term    = 1.0;
-      sum     = 1.0;
-      oldterm = 1.0;
+      numterm = -T(1.0);
+      term    = T(1.0);
+      sum     = T(1.0);
+      oldterm = T(1.0);
 
       do {
-        numterm += 4.0;
-        term *= numterm * (numterm + 2.0) * t;
+        numterm += T(4.0);
+        term *= numterm * (numterm + T(2.0)) * t;
         sum += term;
         absterm = abs(term);
         G2LIB_UTILS_ASSERT(
@@ -283,14 +331,14 @@ namespace G2lib {
         oldterm = absterm;
       } while (absterm > eps10 * abs(sum));
 
-      real_type g = Utils::m_pi * x;
-      g           = sum / (g * g * x);
+      T g = T(Utils::m_pi) * x;
+      g   = sum / (g * g * x);
 
-      real_type U    = Utils::m_pi_2 * (x * x);
-      real_type SinU = sin(U);
-      real_type CosU = cos(U);
-      C              = 0.5 + f * SinU - g * CosU;
-      S              = 0.5 - f * CosU - g * SinU;
+      T U    = T(Utils::m_pi_2) * (x * x);
+      T SinU = sin(U);
+      T CosU = cos(U);
+      C      = T(0.5) + f * SinU - g * CosU;
+      S      = T(0.5) - f * CosU - g * SinU;
     }
     if (y < 0) {
       C = -C;
@@ -301,40 +349,48 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  void FresnelCS(int_type nk, real_type t, real_type * C, real_type * S) {
-    FresnelCS(t, C[0], S[0]);
+  template <typename T>
+  static void FresnelCS_T(int_type nk, T t, T * C, T * S) {
+    FresnelCS_T(t, C[0], S[0]);
     if (nk > 1) {
-      real_type tt = Utils::m_pi_2 * (t * t);
-      real_type ss = sin(tt);
-      real_type cc = cos(tt);
-      C[1]         = ss * Utils::m_1_pi;
-      S[1]         = (1 - cc) * Utils::m_1_pi;
+      T tt = T(Utils::m_pi_2) * (t * t);
+      T ss = sin(tt);
+      T cc = cos(tt);
+      C[1] = ss * T(Utils::m_1_pi);
+      S[1] = (1 - cc) * T(Utils::m_1_pi);
       if (nk > 2) {
-        C[2] = (t * ss - S[0]) * Utils::m_1_pi;
-        S[2] = (C[0] - t * cc) * Utils::m_1_pi;
+        C[2] = (t * ss - S[0]) * T(Utils::m_1_pi);
+        S[2] = (C[0] - t * cc) * T(Utils::m_1_pi);
       }
     }
   }
 
+  void FresnelCS(float y, float & C, float & S) { FresnelCS_T(y, C, S); }
+  void FresnelCS(double y, double & C, double & S) { FresnelCS_T(y, C, S); }
+
+  void FresnelCS(int_type nk, float t, float * C, float * S) { FresnelCS_T(nk, t, C, S); }
+  void FresnelCS(int_type nk, double t, double * C, double * S) { FresnelCS_T(nk, t, C, S); }
+
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-  static void evalXYaLarge(real_type a, real_type b, real_type & X, real_type & Y) {
-    real_type s    = a > 0 ? +1 : -1;
-    real_type absa = abs(a);
-    real_type z    = Utils::m_1_sqrt_pi * sqrt(absa);
-    real_type ell  = s * b * Utils::m_1_sqrt_pi / sqrt(absa);
-    real_type g    = -0.5 * s * (b * b) / absa;
-    real_type cg   = cos(g) / z;
-    real_type sg   = sin(g) / z;
-
-    real_type Cl, Sl, Cz, Sz;
-    FresnelCS(ell, Cl, Sl);
-    FresnelCS(ell + z, Cz, Sz);
-
-    real_type dC0 = Cz - Cl;
-    real_type dS0 = Sz - Sl;
+  template <typename T>
+  static void evalXYaLarge(T a, T b, T & X, T & Y) {
+    T s    = a > 0 ? +1 : -1;
+    T absa = abs(a);
+    T z    = T(Utils::m_1_sqrt_pi) * sqrt(absa);
+    T ell  = s * b * T(Utils::m_1_sqrt_pi) / sqrt(absa);
+    T g    = -T(0.5) * s * (b * b) / absa;
+    T cg   = cos(g) / z;
+    T sg   = sin(g) / z;
+
+    T Cl, Sl, Cz, Sz;
+    FresnelCS_T(ell, Cl, Sl);
+    FresnelCS_T(ell + z, Cz, Sz);
+
+    T dC0 = Cz - Cl;
+    T dS0 = Sz - Sl;
 
     X = cg * dC0 - s * sg * dS0;
     Y = sg * dC0 + s * cg * dS0;
@@ -342,44 +398,45 @@ namespace G2lib {
 
   // -------------------------------------------------------------------------
   // nk max 3
-  static void evalXYaLarge(int_type nk, real_type a, real_type b, real_type * X, real_type * Y) {
+  template <typename T>
+  static void evalXYaLarge(int_type nk, T a, T b, T * X, T * Y) {
     G2LIB_UTILS_ASSERT(nk < 4 && nk > 0, "In evalXYaLarge first argument nk must be in 1..3, nk %d\n", nk);
 
-    real_type s    = a > 0 ? +1 : -1;
-    real_type absa = abs(a);
-    real_type z    = Utils::m_1_sqrt_pi * sqrt(absa);
-    real_type ell  = s * b * Utils::m_1_sqrt_pi / sqrt(absa);
-    real_type g    = -0.5 * s * (b * b) / absa;
-    real_type cg   = cos(g) / z;
-    real_type sg   = sin(g) / z;
+    T s    = a > 0 ? +1 : -1;
+    T absa = abs(a);
+    T z    = T(Utils::m_1_sqrt_pi) * sqrt(absa);
+    T ell  = s * b * T(Utils::m_1_sqrt_pi) / sqrt(absa);
+    T g    = -T(0.5) * s * (b * b) / absa;
+    T cg   = cos(g) / z;
+    T sg   = sin(g) / z;
 
-    real_type Cl[3], Sl[3], Cz[3], Sz[3];
+    T Cl[3], Sl[3], Cz[3], Sz[3];
 
-    FresnelCS(nk, ell, Cl, Sl);
-    FresnelCS(nk, ell + z, Cz, Sz);
+    FresnelCS_T(nk, ell, Cl, Sl);
+    FresnelCS_T(nk, ell + z, Cz, Sz);
 
-    real_type dC0 = Cz[0] - Cl[0];
-    real_type dS0 = Sz[0] - Sl[0];
-    X[0]          = cg * dC0 - s * sg * dS0;
-    Y[0]          = sg * dC0 + s * cg * dS0;
+    T dC0 = Cz[0] - Cl[0];
+    T dS0 = Sz[0] - Sl[0];
+    X[0]  = cg * dC0 - s * sg * dS0;
+    Y[0]  = sg * dC0 + s * cg * dS0;
     if (nk > 1) {
       cg /= z;
       sg /= z;
-      real_type dC1 = Cz[1] - Cl[1];
-      real_type dS1 = Sz[1] - Sl[1];
-      real_type DC  = dC1 - ell * dC0;
-      real_type DS  = dS1 - ell * dS0;
-      X[1]          = cg * DC - s * sg * DS;
-      Y[1]          = sg * DC + s * cg * DS;
+      T dC1 = Cz[1] - Cl[1];
+      T dS1 = Sz[1] - Sl[1];
+      T DC  = dC1 - ell * dC0;
+      T DS  = dS1 - ell * dS0;
+      X[1]  = cg * DC - s * sg * DS;
+      Y[1]  = sg * DC + s * cg * DS;
       if (nk > 2) {
-        real_type dC2 = Cz[2] - Cl[2];
-        real_type dS2 = Sz[2] - Sl[2];
-        DC            = dC2 + ell * (ell * dC0 - 2 * dC1);
-        DS            = dS2 + ell * (ell * dS0 - 2 * dS1);
-        cg            = cg / z;
-        sg            = sg / z;
-        X[2]          = cg * DC - s * sg * DS;
-        Y[2]          = sg * DC + s * cg * DS;
+        T dC2 = Cz[2] - Cl[2];
+        T dS2 = Sz[2] - Sl[2];
+        DC    = dC2 + ell * (ell * dC0 - 2 * dC1);
+        DS    = dS2 + ell * (ell * dS0 - 2 * dS1);
+        cg    = cg / z;
+        sg    = sg / z;
+        X[2]  = cg * DC - s * sg * DS;
+        Y[2]  = sg * DC + s * cg * DS;
       }
     }
   }
@@ -387,13 +444,14 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  static real_type LommelReduced(real_type mu, real_type nu, real_type b) {
-    real_type tmp = 1 / ((mu + nu + 1) * (mu - nu + 1));
-    real_type res = tmp;
+  template <typename T>
+  static T LommelReduced(T mu, T nu, T b) {
+    T tmp = 1 / ((mu + nu + 1) * (mu - nu + 1));
+    T res = tmp;
     for (int_type n = 1; n <= 100; ++n) {
       tmp *= (-b / (2 * n + mu - nu + 1)) * (b / (2 * n + mu + nu + 1));
       res += tmp;
-      if (abs(tmp) < abs(res) * 1e-50)
+      if (abs(tmp) < abs(res) * FresnelTraits<T>::lommel_eps)
         break;
     }
     return res;
@@ -402,11 +460,12 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  static void evalXYazero(int_type nk, real_type b, real_type * X, real_type * Y) {
-    real_type sb = sin(b);
-    real_type cb = cos(b);
-    real_type b2 = b * b;
-    if (abs(b) < 1e-3) {
+  template <typename T>
+  static void evalXYazero(int_type nk, T b, T * X, T * Y) {
+    T sb = sin(b);
+    T cb = cos(b);
+    T b2 = b * b;
+    if (abs(b) < T(1e-3)) {
       X[0] = 1 - (b2 / 6) * (1 - (b2 / 20) * (1 - (b2 / 42)));
       Y[0] = (b / 2) * (1 - (b2 / 12) * (1 - (b2 / 30)));
     } else {
@@ -425,19 +484,19 @@ namespace G2lib {
     }
     //  use Lommel for the unstable part
     if (m < nk) {
-      real_type A   = b * sb;
-      real_type D   = sb - b * cb;
-      real_type B   = b * D;
-      real_type C   = -b2 * sb;
-      real_type rLa = LommelReduced(m + 0.5, 1.5, b);
-      real_type rLd = LommelReduced(m + 0.5, 0.5, b);
+      T A   = b * sb;
+      T D   = sb - b * cb;
+      T B   = b * D;
+      T C   = -b2 * sb;
+      T rLa = LommelReduced<T>(m + T(0.5), T(1.5), b);
+      T rLd = LommelReduced<T>(m + T(0.5), T(0.5), b);
       for (int_type k = m; k < nk; ++k) {
-        real_type rLb = LommelReduced(k + 1.5, 0.5, b);
-        real_type rLc = LommelReduced(k + 1.5, 1.5, b);
-        X[k]          = (k * A * rLa + B * rLb + cb) / (1 + k);
-        Y[k]          = (C * rLc + sb) / (2 + k) + D * rLd;
-        rLa           = rLc;
-        rLd           = rLb;
+        T rLb = LommelReduced<T>(k + T(1.5), T(0.5), b);
+        T rLc = LommelReduced<T>(k + T(1.5), T(1.5), b);
+        X[k]  = (k * A * rLa + B * rLb + cb) / (1 + k);
+        Y[k]  = (C * rLc + sb) / (2 + k) + D * rLd;
+        rLa   = rLc;
+        rLd   = rLb;
       }
     }
   }
@@ -445,10 +504,11 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  static void evalXYaSmall(real_type a, real_type b, int_type p, real_type & X, real_type & Y) {
+  template <typename T>
+  static void evalXYaSmall(T a, T b, int_type p, T & X, T & Y) {
     G2LIB_UTILS_ASSERT(p < 11 && p > 0, "In evalXYaSmall p = %d must be in 1..10\n", p);
 
-    real_type X0[43], Y0[43];
+    T X0[43], Y0[43];
 
     int_type nkk = 4 * p + 3;  // max 43
     evalXYazero(nkk, b, X0, Y0);
@@ -456,12 +516,12 @@ namespace G2lib {
     X = X0[0] - (a / 2) * Y0[2];
     Y = Y0[0] + (a / 2) * X0[2];
 
-    real_type t  = 1;
-    real_type aa = -a * a / 4;  // controllare!
+    T t  = 1;
+    T aa = -a * a / 4;  // controllare!
     for (int_type n = 1; n <= p; ++n) {
       t *= aa / (2 * n * (2 * n - 1));
-      real_type bf = a / (4 * n + 2);
-      int_type  jj = 4 * n;
+      T        bf = a / (4 * n + 2);
+      int_type jj = 4 * n;
       X += t * (X0[jj] - bf * Y0[jj + 2]);
       Y += t * (Y0[jj] + bf * X0[jj + 2]);
     }
@@ -469,9 +529,10 @@ namespace G2lib {
 
   // -------------------------------------------------------------------------
 
-  static void evalXYaSmall(int_type nk, real_type a, real_type b, int_type p, real_type * X, real_type * Y) {
-    int_type  nkk = nk + 4 * p + 2;  // max 45
-    real_type X0[45], Y0[45];
+  template <typename T>
+  static void evalXYaSmall(int_type nk, T a, T b, int_type p, T * X, T * Y) {
+    int_type nkk = nk + 4 * p + 2;  // max 45
+    T        X0[45], Y0[45];
 
     G2LIB_UTILS_ASSERT(
         nkk < 46,
@@ -486,11 +547,11 @@ namespace G2lib {
       Y[j] = Y0[j] + (a / 2) * X0[j + 2];
     }
 
-    real_type t  = 1;
-    real_type aa = -a * a / 4;  // controllare!
+    T t  = 1;
+    T aa = -a * a / 4;  // controllare!
     for (int_type n = 1; n <= p; ++n) {
       t *= aa / (2 * n * (2 * n - 1));
-      real_type bf = a / (4 * n + 2);
+      T bf = a / (4 * n + 2);
       for (int_type j = 0; j < nk; ++j) {
         int_type jj = 4 * n + j;
         X[j] += t * (X0[jj] - bf * Y0[jj + 2]);
@@ -498,20 +559,20 @@ namespace G2lib {
       }
     }
   }
-#endif
 
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  void GeneralizedFresnelCS(real_type a, real_type b, real_type c, real_type & intC, real_type & intS) {
-    real_type xx, yy;
-    if (abs(a) < A_THRESOLD)
+  template <typename T>
+  static void GeneralizedFresnelCS_T(T a, T b, T c, T & intC, T & intS) {
+    T xx, yy;
+    if (abs(a) < T(A_THRESOLD))
       evalXYaSmall(a, b, A_SERIE_SIZE, xx, yy);
     else
       evalXYaLarge(a, b, xx, yy);
 
-    real_type cosc = cos(c);
-    real_type sinc = sin(c);
+    T cosc = cos(c);
+    T sinc = sin(c);
 
     intC = xx * cosc - yy * sinc;
     intS = xx * sinc + yy * cosc;
@@ -520,371 +581,1348 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  void GeneralizedFresnelCS(int_type nk, real_type a, real_type b, real_type c, real_type * intC, real_type * intS) {
+  template <typename T>
+  static void GeneralizedFresnelCS_T(int_type nk, T a, T b, T c, T * intC, T * intS) {
     G2LIB_UTILS_ASSERT(nk > 0 && nk < 4, "nk = %d must be in 1..3\n", nk);
 
-    if (abs(a) < A_THRESOLD)
+    if (abs(a) < T(A_THRESOLD))
       evalXYaSmall(nk, a, b, A_SERIE_SIZE, intC, intS);
     else
       evalXYaLarge(nk, a, b, intC, intS);
 
+    T cosc = cos(c);
+    T sinc = sin(c);
+
+    for (int_type k = 0; k < nk; ++k) {
+      T xx    = intC[k];
+      T yy    = intS[k];
+      intC[k] = xx * cosc - yy * sinc;
+      intS[k] = xx * sinc + yy * cosc;
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  // Block kernels of the batched GeneralizedFresnelCS, n <= FRESNEL_BATCH_BLOCK.
+  // The branches of the scalar code are replaced by a split of the block in the
+  // regimes, and the series run on the whole block with a per entry stop mask,
+  // so every entry sums the same terms of the scalar code. Arrays of more than
+  // one row are stored row by row: X0[k][i] is row k of entry i.
+  // -------------------------------------------------------------------------
+
+  // sin and cos without branches: reduction by pi/2 split in three parts and
+  // the polynomials of Cephes on [-pi/4,pi/4], evaluated in double precision.
+  // The quadrant is rounded to an integer adding and subtracting 1.5*2^52.
+  template <typename T>
+  G2LIB_TARGET_CLONES static void sinCosKernel(int_type n, T const * x, T * s, T * c) {
+    real_type const rnd = 6755399441055744.0;
+    for (int_type i = 0; i < n; ++i) {
+      real_type xi = real_type(x[i]);
+      real_type q  = (xi * m_2_pi + rnd) - rnd;
+      real_type k  = ((q - 1.5) * 0.25 + rnd) - rnd;  // floor(q/4), no ties
+      real_type r  = q - 4 * k;                       // quadrant 0..3
+      real_type y  = ((xi - q * pio2[0]) - q * pio2[1]) - q * pio2[2];
+      real_type z  = y * y;
+      real_type ps = ((((sincof[0] * z + sincof[1]) * z + sincof[2]) * z + sincof[3]) * z + sincof[4]) * z + sincof[5];
+      real_type pc = ((((coscof[0] * z + coscof[1]) * z + coscof[2]) * z + coscof[3]) * z + coscof[4]) * z + coscof[5];
+      real_type sy = y + y * z * ps;
+      real_type cy = 1.0 - 0.5 * z + z * z * pc;
+      bool      sw = r == 1 || r == 3;
+      real_type ss = sw ? cy : sy;
+      real_type cc = sw ? sy : cy;
+      s[i]         = T(r >= 2 ? -ss : ss);
+      c[i]         = T(r == 1 || r == 2 ? -cc : cc);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  static void sinCosBlock(int_type n, T const * x, T * s, T * c) {
+    sinCosKernel(n, x, s, c);
+    // out of the range of the reduction (or not finite), fall back on libm
+    for (int_type i = 0; i < n; ++i) {
+      if (!(abs(x[i]) <= T(FRESNEL_SINCOS_XMAX))) {
+        s[i] = sin(x[i]);
+        c[i] = cos(x[i]);
+      }
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // FresnelCS for 0 <= x < 1, power series
+  template <typename T>
+  G2LIB_TARGET_CLONES static void fresnelSeriesKernel(int_type n, T const * x, T * C, T * S) {
+    T const  eps = FresnelTraits<T>::eps;
+    T        t[FRESNEL_BATCH_BLOCK], numterm[FRESNEL_BATCH_BLOCK], sum[FRESNEL_BATCH_BLOCK];
+    T        active[FRESNEL_BATCH_BLOCK];
+    T        twofn, fact, denterm;
+    int_type nact;
+
+    for (int_type i = 0; i < n; ++i) {
+      T s  = T(Utils::m_pi_2) * (x[i] * x[i]);
+      t[i] = -s * s;
+    }
+
+    // Cosine integral series
+    twofn   = T(0.0);
+    fact    = T(1.0);
+    denterm = T(1.0);
+    for (int_type i = 0; i < n; ++i) {
+      numterm[i] = T(1.0);
+      sum[i]     = T(1.0);
+      active[i]  = T(1.0);
+    }
+    do {
+      twofn += T(2.0);
+      fact *= twofn * (twofn - T(1.0));
+      denterm += T(4.0);
+      T rden = 1 / (fact * denterm);
+      nact   = 0;
+      for (int_type i = 0; i < n; ++i) {
+        numterm[i] *= t[i];
+        T term = numterm[i] * rden;
+        sum[i] += active[i] > 0 ? term : T(0);
+        active[i] = abs(term) > eps * abs(sum[i]) ? active[i] : T(0);
+        nact += active[i] > 0;
+      }
+    } while (nact > 0);
+
+    for (int_type i = 0; i < n; ++i) C[i] = x[i] * sum[i];
+
+    // Sine integral series
+    twofn   = T(1.0);
+    fact    = T(1.0);
+    denterm = T(3.0);
+    for (int_type i = 0; i < n; ++i) {
+      numterm[i] = T(1.0);
+      sum[i]     = T(1.0) / T(3.0);
+      active[i]  = T(1.0);
+    }
+    do {
+      twofn += T(2.0);
+      fact *= twofn * (twofn - T(1.0));
+      denterm += T(4.0);
+      T rden = 1 / (fact * denterm);
+      nact   = 0;
+      for (int_type i = 0; i < n; ++i) {
+        numterm[i] *= t[i];
+        T term = numterm[i] * rden;
+        sum[i] += active[i] > 0 ? term : T(0);
+        active[i] = abs(term) > eps * abs(sum[i]) ? active[i] : T(0);
+        nact += active[i] > 0;
+      }
+    } while (nact > 0);
+
+    for (int_type i = 0; i < n; ++i) S[i] = T(Utils::m_pi_2) * sum[i] * (x[i] * x[i] * x[i]);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // FresnelCS for 1 <= x < 6, rational approximations of f and g
+  template <typename T>
+  G2LIB_TARGET_CLONES static void fresnelRationalKernel(int_type n, T const * x, T * f, T * g, T * U) {
+    T sumn[FRESNEL_BATCH_BLOCK], sumd[FRESNEL_BATCH_BLOCK];
+
+    for (int_type i = 0; i < n; ++i) {
+      sumn[i] = T(0.0);
+      sumd[i] = T(fd[11]);
+    }
+    for (int_type k = 10; k >= 0; --k) {
+      for (int_type i = 0; i < n; ++i) {
+        sumn[i] = T(fn[k]) + x[i] * sumn[i];
+        sumd[i] = T(fd[k]) + x[i] * sumd[i];
+      }
+    }
+    for (int_type i = 0; i < n; ++i) {
+      f[i]    = sumn[i] / sumd[i];
+      sumn[i] = T(0.0);
+      sumd[i] = T(gd[11]);
+    }
+    for (int_type k = 10; k >= 0; --k) {
+      for (int_type i = 0; i < n; ++i) {
+        sumn[i] = T(gn[k]) + x[i] * sumn[i];
+        sumd[i] = T(gd[k]) + x[i] * sumd[i];
+      }
+    }
+    for (int_type i = 0; i < n; ++i) {
+      g[i] = sumn[i] / sumd[i];
+      U[i] = T(Utils::m_pi_2) * (x[i] * x[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // FresnelCS for x >= 6, asymptotic expansions of f and g
+  template <typename T>
+  G2LIB_TARGET_CLONES static void fresnelAsymptoticKernel(int_type n, T const * x, T * f, T * g, T * U) {
+    T const  eps10 = T(0.1) * FresnelTraits<T>::eps;
+    T        t[FRESNEL_BATCH_BLOCK], term[FRESNEL_BATCH_BLOCK], sum[FRESNEL_BATCH_BLOCK];
+    T        active[FRESNEL_BATCH_BLOCK];
+    T        numterm;
+    int_type nact;
+
+    for (int_type i = 0; i < n; ++i) {
+      T s  = T(Utils::m_pi) * x[i] * x[i];
+      t[i] = -1 / (s * s);
+    }
+
+    // Expansion for f
+    numterm = -T(1.0);
+    for (int_type i = 0; i < n; ++i) {
+      term[i]   = T(1.0);
+      sum[i]    = T(1.0);
+      active[i] = T(1.0);
+    }
+    do {
+      numterm += T(4.0);
+      T nn = numterm * (numterm - T(2.0));
+      nact = 0;
+      for (int_type i = 0; i < n; ++i) {
+        term[i] *= nn * t[i];
+        sum[i] += active[i] > 0 ? term[i] : T(0);
+        active[i] = abs(term[i]) > eps10 * abs(sum[i]) ? active[i] : T(0);
+        nact += active[i] > 0;
+      }
+    } while (nact > 0);
+
+    for (int_type i = 0; i < n; ++i) f[i] = sum[i] / (T(Utils::m_pi) * x[i]);
+
+    // Expansion for g
+    numterm = -T(1.0);
+    for (int_type i = 0; i < n; ++i) {
+      term[i]   = T(1.0);
+      sum[i]    = T(1.0);
+      active[i] = T(1.0);
+    }
+    do {
+      numterm += T(4.0);
+      T nn = numterm * (numterm + T(2.0));
+      nact = 0;
+      for (int_type i = 0; i < n; ++i) {
+        term[i] *= nn * t[i];
+        sum[i] += active[i] > 0 ? term[i] : T(0);
+        active[i] = abs(term[i]) > eps10 * abs(sum[i]) ? active[i] : T(0);
+        nact += active[i] > 0;
+      }
+    } while (nact > 0);
+
+    for (int_type i = 0; i < n; ++i) {
+      T gg = T(Utils::m_pi) * x[i];
+      g[i] = sum[i] / (gg * gg * x[i]);
+      U[i] = T(Utils::m_pi_2) * (x[i] * x[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void fresnelFGCombine(
+      int_type n, T const * f, T const * g, T const * SinU, T const * CosU, T * C, T * S) {
+    for (int_type i = 0; i < n; ++i) {
+      C[i] = T(0.5) + f[i] * SinU[i] - g[i] * CosU[i];
+      S[i] = T(0.5) - f[i] * CosU[i] - g[i] * SinU[i];
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  static void FresnelCSBlock(int_type n, T const * y, T * C, T * S) {
+    T        xs[FRESNEL_BATCH_BLOCK], xr[FRESNEL_BATCH_BLOCK], xa[FRESNEL_BATCH_BLOCK];
+    T        Cs[FRESNEL_BATCH_BLOCK], Ss[FRESNEL_BATCH_BLOCK], Cf[FRESNEL_BATCH_BLOCK], Sf[FRESNEL_BATCH_BLOCK];
+    T        f[FRESNEL_BATCH_BLOCK], g[FRESNEL_BATCH_BLOCK], U[FRESNEL_BATCH_BLOCK];
+    T        SinU[FRESNEL_BATCH_BLOCK], CosU[FRESNEL_BATCH_BLOCK];
+    int_type is[FRESNEL_BATCH_BLOCK], ir[FRESNEL_BATCH_BLOCK], ia[FRESNEL_BATCH_BLOCK];
+
+    // split in series (x < 1), rational (1 <= x < 6) and asymptotic (x >= 6),
+    // every entry is stored in all the lists and only one counter advances
+    int_type ns = 0, nr = 0, na = 0;
+    for (int_type i = 0; i < n; ++i) {
+      T x    = y[i] > 0 ? y[i] : -y[i];
+      xs[ns] = xr[nr] = xa[na] = x;
+      is[ns] = ir[nr] = ia[na] = i;
+      ns += x < T(1.0);
+      nr += !(x < T(1.0)) & (x < T(6.0));
+      na += !(x < T(6.0));
+    }
+
+    // f and g of the two asymptotic regimes are stored one after the other
+    int_type nf = nr + na;
+    if (ns > 0)
+      fresnelSeriesKernel(ns, xs, Cs, Ss);
+    if (nr > 0)
+      fresnelRationalKernel(nr, xr, f, g, U);
+    if (na > 0)
+      fresnelAsymptoticKernel(na, xa, f + nr, g + nr, U + nr);
+    if (nf > 0) {
+      sinCosBlock(nf, U, SinU, CosU);
+      fresnelFGCombine(nf, f, g, SinU, CosU, Cf, Sf);
+    }
+
+    for (int_type k = 0; k < ns; ++k) {
+      int_type i = is[k];
+      C[i]       = y[i] < 0 ? -Cs[k] : Cs[k];
+      S[i]       = y[i] < 0 ? -Ss[k] : Ss[k];
+    }
+    for (int_type k = 0; k < nf; ++k) {
+      int_type i = k < nr ? ir[k] : ia[k - nr];
+      C[i]       = y[i] < 0 ? -Cf[k] : Cf[k];
+      S[i]       = y[i] < 0 ? -Sf[k] : Sf[k];
+    }
+  }
+
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // Scratch of evalXYaLargeBlock, the arrays of one object do not overlap so
+  // that the kernels need no run time alias checks
+  template <typename T>
+  struct EvalXYaLargeWork {
+    T sgn[FRESNEL_BATCH_BLOCK], z[FRESNEL_BATCH_BLOCK], g[FRESNEL_BATCH_BLOCK];
+    T ell[FRESNEL_BATCH_BLOCK], ellz[FRESNEL_BATCH_BLOCK];
+    T cosg[FRESNEL_BATCH_BLOCK], sing[FRESNEL_BATCH_BLOCK];
+    T Cl[FRESNEL_BATCH_BLOCK], Sl[FRESNEL_BATCH_BLOCK], Cz[FRESNEL_BATCH_BLOCK], Sz[FRESNEL_BATCH_BLOCK];
+  };
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void evalXYaLargeSetup(int_type n, T const * a, T const * b, EvalXYaLargeWork<T> & W) {
+    for (int_type i = 0; i < n; ++i) {
+      T s       = a[i] > 0 ? +1 : -1;
+      T absa    = abs(a[i]);
+      T sqa     = sqrt(absa);
+      T z       = T(Utils::m_1_sqrt_pi) * sqa;
+      T ell     = s * b[i] * T(Utils::m_1_sqrt_pi) / sqa;
+      W.sgn[i]  = s;
+      W.z[i]    = z;
+      W.ell[i]  = ell;
+      W.ellz[i] = ell + z;
+      W.g[i]    = -T(0.5) * s * (b[i] * b[i]) / absa;
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void evalXYaLargeCombine(int_type n, EvalXYaLargeWork<T> const & W, T * X, T * Y) {
+    for (int_type i = 0; i < n; ++i) {
+      T cg  = W.cosg[i] / W.z[i];
+      T sg  = W.sing[i] / W.z[i];
+      T dC0 = W.Cz[i] - W.Cl[i];
+      T dS0 = W.Sz[i] - W.Sl[i];
+      X[i]  = cg * dC0 - W.sgn[i] * sg * dS0;
+      Y[i]  = sg * dC0 + W.sgn[i] * cg * dS0;
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  static void evalXYaLargeBlock(int_type n, T const * a, T const * b, T * X, T * Y) {
+    EvalXYaLargeWork<T> W;
+    evalXYaLargeSetup(n, a, b, W);
+    sinCosBlock(n, W.g, W.sing, W.cosg);
+    FresnelCSBlock(n, W.ell, W.Cl, W.Sl);
+    FresnelCSBlock(n, W.ellz, W.Cz, W.Sz);
+    evalXYaLargeCombine(n, W, X, Y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // Scratch of evalXYaSmallBlock: the moments X0[k], Y0[k] of evalXYazero for
+  // nk = FRESNEL_SMALL_NK, the first row m of the unstable part and the Lommel
+  // functions La[j] = L(j+1/2,3/2,b), Ld[j] = L(j+1/2,1/2,b) for j >= mmin
+  template <typename T>
+  struct EvalXYaSmallWork {
+    T        sb[FRESNEL_BATCH_BLOCK], cb[FRESNEL_BATCH_BLOCK], m[FRESNEL_BATCH_BLOCK];
+    T        La[FRESNEL_SMALL_NK + 1][FRESNEL_BATCH_BLOCK], Ld[FRESNEL_SMALL_NK + 1][FRESNEL_BATCH_BLOCK];
+    T        X0[FRESNEL_SMALL_NK][FRESNEL_BATCH_BLOCK], Y0[FRESNEL_SMALL_NK][FRESNEL_BATCH_BLOCK];
+    int_type mmin;
+  };
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void lommelReducedKernel(int_type n, T mu, T nu, T const * b, T * res) {
+    T tmp[FRESNEL_BATCH_BLOCK], mb2[FRESNEL_BATCH_BLOCK], active[FRESNEL_BATCH_BLOCK];
+    for (int_type i = 0; i < n; ++i) {
+      tmp[i]    = 1 / ((mu + nu + 1) * (mu - nu + 1));
+      res[i]    = tmp[i];
+      mb2[i]    = -b[i] * b[i];
+      active[i] = T(1.0);
+    }
+    for (int_type k = 1, nact = n; k <= 100 && nact > 0; ++k) {
+      T r  = 1 / ((2 * k + mu - nu + 1) * (2 * k + mu + nu + 1));
+      nact = 0;
+      for (int_type i = 0; i < n; ++i) {
+        tmp[i] *= mb2[i] * r;
+        res[i] += active[i] > 0 ? tmp[i] : T(0);
+        active[i] = abs(tmp[i]) < abs(res[i]) * FresnelTraits<T>::lommel_eps ? T(0) : active[i];
+        nact += active[i] > 0;
+      }
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void evalXYazeroKernel(int_type n, T const * b, EvalXYaSmallWork<T> & W) {
+    for (int_type i = 0; i < n; ++i) {
+      T    b2    = b[i] * b[i];
+      T    Xs    = 1 - (b2 / 6) * (1 - (b2 / 20) * (1 - (b2 / 42)));
+      T    Ys    = (b[i] / 2) * (1 - (b2 / 12) * (1 - (b2 / 30)));
+      T    Xb    = W.sb[i] / b[i];
+      T    Yb    = (1 - W.cb[i]) / b[i];
+      bool sm    = abs(b[i]) < T(1e-3);
+      W.X0[0][i] = sm ? Xs : Xb;
+      W.Y0[0][i] = sm ? Ys : Yb;
+    }
+    // use recurrence in the stable part
+    for (int_type k = 1; k < W.mmin; ++k) {
+      for (int_type i = 0; i < n; ++i) {
+        W.X0[k][i] = (W.sb[i] - k * W.Y0[k - 1][i]) / b[i];
+        W.Y0[k][i] = (k * W.X0[k - 1][i] - W.cb[i]) / b[i];
+      }
+    }
+    //  use Lommel for the unstable part
+    for (int_type k = W.mmin; k < FRESNEL_SMALL_NK; ++k) {
+      for (int_type i = 0; i < n; ++i) {
+        T    sb    = W.sb[i];
+        T    cb    = W.cb[i];
+        T    A     = b[i] * sb;
+        T    D     = sb - b[i] * cb;
+        T    B     = b[i] * D;
+        T    C     = -(b[i] * b[i]) * sb;
+        T    Xr    = (sb - k * W.Y0[k - 1][i]) / b[i];
+        T    Yr    = (k * W.X0[k - 1][i] - cb) / b[i];
+        T    Xl    = (k * A * W.La[k][i] + B * W.Ld[k + 1][i] + cb) / (1 + k);
+        T    Yl    = (C * W.La[k + 1][i] + sb) / (2 + k) + D * W.Ld[k][i];
+        bool rc    = k < W.m[i];
+        W.X0[k][i] = rc ? Xr : Xl;
+        W.Y0[k][i] = rc ? Yr : Yl;
+      }
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void evalXYaSmallCombine(
+      int_type n, T const * a, EvalXYaSmallWork<T> const & W, T * X, T * Y) {
+    T t[FRESNEL_BATCH_BLOCK], aa[FRESNEL_BATCH_BLOCK];
+    for (int_type i = 0; i < n; ++i) {
+      X[i]  = W.X0[0][i] - (a[i] / 2) * W.Y0[2][i];
+      Y[i]  = W.Y0[0][i] + (a[i] / 2) * W.X0[2][i];
+      t[i]  = 1;
+      aa[i] = -a[i] * a[i] / 4;
+    }
+    for (int_type n1 = 1; n1 <= A_SERIE_SIZE; ++n1) {
+      int_type jj = 4 * n1;
+      for (int_type i = 0; i < n; ++i) {
+        t[i] *= aa[i] / (2 * n1 * (2 * n1 - 1));
+        T bf = a[i] / (4 * n1 + 2);
+        X[i] += t[i] * (W.X0[jj][i] - bf * W.Y0[jj + 2][i]);
+        Y[i] += t[i] * (W.Y0[jj][i] + bf * W.X0[jj + 2][i]);
+      }
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  static void evalXYaSmallBlock(int_type n, T const * a, T const * b, T * X, T * Y) {
+    EvalXYaSmallWork<T> W;
+
+    sinCosBlock(n, b, W.sb, W.cb);
+
+    // first row of the unstable part, as in evalXYazero
+    W.mmin = FRESNEL_SMALL_NK;
+    for (int_type i = 0; i < n; ++i) {
+      int_type m = int_type(floor(2 * b[i]));
+      if (m >= FRESNEL_SMALL_NK)
+        m = FRESNEL_SMALL_NK - 1;
+      if (m < 1)
+        m = 1;
+      W.m[i] = T(m);
+      W.mmin = min(W.mmin, m);
+    }
+    for (int_type j = W.mmin; j <= FRESNEL_SMALL_NK; ++j) {
+      lommelReducedKernel(n, j + T(0.5), T(1.5), b, W.La[j]);
+      lommelReducedKernel(n, j + T(0.5), T(0.5), b, W.Ld[j]);
+    }
+
+    evalXYazeroKernel(n, b, W);
+    evalXYaSmallCombine(n, a, W, X, Y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES static void rotateXY(
+      int_type n, T const * xx, T const * yy, T const * cosc, T const * sinc, T * intC, T * intS) {
+    for (int_type i = 0; i < n; ++i) {
+      intC[i] = xx[i] * cosc[i] - yy[i] * sinc[i];
+      intS[i] = xx[i] * sinc[i] + yy[i] * cosc[i];
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  // -------------------------------------------------------------------------
+
+  template <typename T>
+  static void GeneralizedFresnelCS_T(int_type n, T const * a, T const * b, T const * c, T * intC, T * intS) {
+    G2LIB_UTILS_ASSERT(n >= 0, "GeneralizedFresnelCS, n = %d must be non negative\n", n);
+
+    T        xx[FRESNEL_BATCH_BLOCK], yy[FRESNEL_BATCH_BLOCK];
+    T        cosc[FRESNEL_BATCH_BLOCK], sinc[FRESNEL_BATCH_BLOCK];
+    T        aS[FRESNEL_BATCH_BLOCK], bS[FRESNEL_BATCH_BLOCK], xS[FRESNEL_BATCH_BLOCK], yS[FRESNEL_BATCH_BLOCK];
+    T        aL[FRESNEL_BATCH_BLOCK], bL[FRESNEL_BATCH_BLOCK], xL[FRESNEL_BATCH_BLOCK], yL[FRESNEL_BATCH_BLOCK];
+    int_type iS[FRESNEL_BATCH_BLOCK], iL[FRESNEL_BATCH_BLOCK];
+
+    for (int_type i0 = 0; i0 < n; i0 += FRESNEL_BATCH_BLOCK) {
+      int_type nb = min(n - i0, int_type(FRESNEL_BATCH_BLOCK));
+
+      // split the block in the two regimes, gathered in contiguous arrays
+      // (every entry is stored in both and only one counter advances)
+      int_type nS = 0, nL = 0;
+      for (int_type i = 0; i < nb; ++i) {
+        T    ai = a[i0 + i];
+        bool sm = abs(ai) < T(A_THRESOLD);
+        aS[nS]  = aL[nL] = ai;
+        bS[nS]  = bL[nL] = b[i0 + i];
+        iS[nS]  = iL[nL] = i;
+        nS += sm;
+        nL += !sm;
+      }
+      if (nS > 0) {
+        evalXYaSmallBlock(nS, aS, bS, xS, yS);
+        for (int_type k = 0; k < nS; ++k) {
+          xx[iS[k]] = xS[k];
+          yy[iS[k]] = yS[k];
+        }
+      }
+      if (nL > 0) {
+        evalXYaLargeBlock(nL, aL, bL, xL, yL);
+        for (int_type k = 0; k < nL; ++k) {
+          xx[iL[k]] = xL[k];
+          yy[iL[k]] = yL[k];
+        }
+      }
+
+      sinCosBlock(nb, c + i0, sinc, cosc);
+      rotateXY(nb, xx, yy, cosc, sinc, intC + i0, intS + i0);
+    }
+  }
+#endif
+
+  // -------------------------------------------------------------------------
+  // -------------------------------------------------------------------------
+
+  void GeneralizedFresnelCS(float a, float b, float c, float & intC, float & intS) {
+    GeneralizedFresnelCS_T(a, b, c, intC, intS);
+  }
+
+  void GeneralizedFresnelCS(double a, double b, double c, double & intC, double & intS) {
+    GeneralizedFresnelCS_T(a, b, c, intC, intS);
+  }
+
+  void GeneralizedFresnelCS(int_type nk, float a, float b, float c, float * intC, float * intS) {
+    GeneralizedFresnelCS_T(nk, a, b, c, intC, intS);
+  }
+
+  void GeneralizedFresnelCS(int_type nk, double a, double b, double c, double * intC, double * intS) {
+    GeneralizedFresnelCS_T(nk, a, b, c, intC, intS);
+  }
+
+  void GeneralizedFresnelCS(
+      int_type n, float const * a, float const * b, float const * c, float * intC, float * intS) {
+    GeneralizedFresnelCS_T(n, a, b, c, intC, intS);
+  }
+
+  void GeneralizedFresnelCS(
+      int_type n, double const * a, double const * b, double const * c, double * intC, double * intS) {
+    GeneralizedFresnelCS_T(n, a, b, c, intC, intS);
+  }
+
+  /*\
+   |      _                               _
+   |     / \   _ __  _ __  _ __ _____  __
+   |    / _ \ | '_ \| '_ \| '__/ _ \ \/ /
+   |   / ___ \| |_) | |_) | | | (_) >  <
+   |  /_/   \_\ .__/| .__/|_|  \___/_/\_\
+   |          |_|   |_|
+  \*/
+
+  FresnelMode fresnel_mode = G2LIB_FRESNEL_EXACT;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+  //
+  // Piecewise Chebyshev interpolation of C(x) and S(x) on [0,FRESNEL_APPROX_XMAX)
+  // with uniform intervals. Tables are immutable once published, old tables
+  // are kept alive until exit so that concurrent readers never dangle.
+  //
+  class FresnelApproxTable {
+   public:
+    real_type         tolerance;      // requested bound of GeneralizedFresnelCS
+    real_type         table_error;    // measured error of C(x), S(x)
+    bool              tolerance_met;  // false if the tables stopped at their maximum size
+    real_type         inv_h;
+    int_type          n_intervals;
+    int_type          series_size;
+    vector<real_type> cC, cS;  // FRESNEL_APPROX_NC coefficients per interval
+
+    explicit FresnelApproxTable(real_type tol);
+
+    void eval(real_type x, real_type & C, real_type & S) const;
+  };
+
+  static std::atomic<FresnelApproxTable const *>          fresnel_table(nullptr);
+  static std::mutex                                       fresnel_table_mutex;
+  static vector<std::unique_ptr<FresnelApproxTable const>> fresnel_table_store;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  // Chebyshev interpolation on [x0,x0+h], converted to the monomial basis
+  // in t in [-1,1] so that the evaluation is a short Horner scheme
+  static void chebyshev_fit(real_type x0, real_type h, real_type * cC, real_type * cS) {
+    real_type fC[FRESNEL_APPROX_NC], fS[FRESNEL_APPROX_NC], th[FRESNEL_APPROX_NC];
+    for (int_type k = 0; k < FRESNEL_APPROX_NC; ++k) {
+      th[k] = Utils::m_pi * (k + 0.5) / FRESNEL_APPROX_NC;
+      FresnelCS(x0 + h * (1 + cos(th[k])) / 2, fC[k], fS[k]);
+    }
+    // Tm[j] = T_{j-1}, T[j] = T_j as monomial coefficients
+    real_type Tm[FRESNEL_APPROX_NC], T[FRESNEL_APPROX_NC], Tp[FRESNEL_APPROX_NC];
+    std::fill_n(Tm, FRESNEL_APPROX_NC, 0);
+    std::fill_n(T, FRESNEL_APPROX_NC, 0);
+    std::fill_n(cC, FRESNEL_APPROX_NC, 0);
+    std::fill_n(cS, FRESNEL_APPROX_NC, 0);
+    T[0] = 1;
+    for (int_type j = 0; j < FRESNEL_APPROX_NC; ++j) {
+      real_type sC = 0, sS = 0;
+      for (int_type k = 0; k < FRESNEL_APPROX_NC; ++k) {
+        real_type cj = cos(j * th[k]);
+        sC += fC[k] * cj;
+        sS += fS[k] * cj;
+      }
+      real_type scale = (j == 0 ? 1.0 : 2.0) / FRESNEL_APPROX_NC;
+      for (int_type m = 0; m <= j; ++m) {
+        cC[m] += sC * scale * T[m];
+        cS[m] += sS * scale * T[m];
+      }
+      // T_1 = t, T_{j+1} = 2 t T_j - T_{j-1}
+      real_type two = j == 0 ? 1 : 2;
+      Tp[0]         = -Tm[0];
+      for (int_type m = 1; m < FRESNEL_APPROX_NC; ++m)
+        Tp[m] = two * T[m - 1] - Tm[m];
+      std::copy_n(T, FRESNEL_APPROX_NC, Tm);
+      std::copy_n(Tp, FRESNEL_APPROX_NC, T);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  static inline void chebyshev_eval(
+      real_type t, real_type const * cC, real_type const * cS, real_type & C, real_type & S) {
+    C = cC[FRESNEL_APPROX_NC - 1];
+    S = cS[FRESNEL_APPROX_NC - 1];
+    for (int_type j = FRESNEL_APPROX_NC - 2; j >= 0; --j) {
+      C = C * t + cC[j];
+      S = S * t + cS[j];
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  FresnelApproxTable::FresnelApproxTable(real_type tol) : tolerance(tol) {
+    // in the large |a| regime the error of C,S is amplified by 1/z <= 1/sqrt(A_THRESOLD/pi)
+    real_type tol_table = tol * sqrt(A_THRESOLD * Utils::m_1_pi) / 2;
+
+    // the first neglected term of the small |a| series is bounded by (a^2/4)^(p+1)/(2p+2)!
+    real_type aa = A_THRESOLD * A_THRESOLD / 4;
+    real_type t  = 1;
+    series_size  = A_SERIE_SIZE;
+
+    bool series_met = false;
+    for (int_type p = 1; p < A_SERIE_SIZE; ++p) {
+      t *= aa / ((2 * p) * (2 * p - 1));
+      if (t * aa / ((2 * p + 2) * (2 * p + 1)) <= tol) {
+        series_size = p;
+        series_met  = true;
+        break;
+      }
+    }
+
+    // double the number of intervals until the error is below the bound
+    for (n_intervals = 8;; n_intervals *= 2) {
+      real_type h = FRESNEL_APPROX_XMAX / n_intervals;
+      inv_h       = n_intervals / FRESNEL_APPROX_XMAX;
+      cC.resize(n_intervals * FRESNEL_APPROX_NC);
+      cS.resize(n_intervals * FRESNEL_APPROX_NC);
+      table_error = 0;
+      for (int_type i = 0; i < n_intervals; ++i) {
+        real_type * pC = &cC[i * FRESNEL_APPROX_NC];
+        real_type * pS = &cS[i * FRESNEL_APPROX_NC];
+        chebyshev_fit(i * h, h, pC, pS);
+        for (int_type k = 0; k <= 8; ++k) {
+          real_type tt = k / 4.0 - 1, Ca, Sa, Ce, Se;
+          chebyshev_eval(tt, pC, pS, Ca, Sa);
+          FresnelCS(i * h + h * (1 + tt) / 2, Ce, Se);
+          table_error = max(table_error, max(abs(Ca - Ce), abs(Sa - Se)));
+        }
+      }
+      if (table_error <= tol_table || n_intervals >= FRESNEL_APPROX_MAX_INTERVALS)
+        break;
+    }
+    tolerance_met = series_met && table_error <= tol_table;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void FresnelApproxTable::eval(real_type x, real_type & C, real_type & S) const {
+    real_type ax = abs(x);
+    if (ax >= FRESNEL_APPROX_XMAX) {
+      FresnelCS(x, C, S);
+      return;
+    }
+    real_type u = ax * inv_h;
+    int_type  i = min(int_type(u), n_intervals - 1);
+    chebyshev_eval(2 * (u - i) - 1, &cC[i * FRESNEL_APPROX_NC], &cS[i * FRESNEL_APPROX_NC], C, S);
+    if (x < 0) {
+      C = -C;
+      S = -S;
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  static FresnelApproxTable const * get_fresnel_table() {
+    FresnelApproxTable const * T = fresnel_table.load(std::memory_order_acquire);
+    if (T == nullptr) {
+      std::lock_guard<std::mutex> lock(fresnel_table_mutex);
+      T = fresnel_table.load(std::memory_order_acquire);
+      if (T == nullptr) {
+        fresnel_table_store.emplace_back(new FresnelApproxTable(FRESNEL_APPROX_DEFAULT_TOL));
+        T = fresnel_table_store.back().get();
+        fresnel_table.store(T, std::memory_order_release);
+      }
+    }
+    return T;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  static void evalXYaLargeApprox(
+      FresnelApproxTable const * T, real_type a, real_type b, real_type & X, real_type & Y) {
+    real_type s    = a > 0 ? +1 : -1;
+    real_type absa = abs(a);
+    real_type z    = Utils::m_1_sqrt_pi * sqrt(absa);
+    real_type ell  = s * b * Utils::m_1_sqrt_pi / sqrt(absa);
+    real_type g    = -0.5 * s * (b * b) / absa;
+    real_type cg   = cos(g) / z;
+    real_type sg   = sin(g) / z;
+
+    real_type Cl, Sl, Cz, Sz;
+    T->eval(ell, Cl, Sl);
+    T->eval(ell + z, Cz, Sz);
+
+    real_type dC0 = Cz - Cl;
+    real_type dS0 = Sz - Sl;
+
+    X = cg * dC0 - s * sg * dS0;
+    Y = sg * dC0 + s * cg * dS0;
+  }
+
+#endif
+
+  // -------------------------------------------------------------------------
+
+  bool fresnel_approx_tolerance(real_type tol) {
+    G2LIB_UTILS_ASSERT(tol > 0, "fresnel_approx_tolerance, tol = %g must be positive\n", tol);
+    std::lock_guard<std::mutex> lock(fresnel_table_mutex);
+    fresnel_table_store.emplace_back(new FresnelApproxTable(tol));
+    fresnel_table.store(fresnel_table_store.back().get(), std::memory_order_release);
+    return fresnel_table_store.back()->tolerance_met;
+  }
+
+  real_type fresnel_approx_tolerance() { return get_fresnel_table()->tolerance; }
+
+  // -------------------------------------------------------------------------
+
+  void FresnelCS_approx(real_type x, real_type & C, real_type & S) { get_fresnel_table()->eval(x, C, S); }
+
+  // -------------------------------------------------------------------------
+
+  void GeneralizedFresnelCS(
+      real_type a, real_type b, real_type c, real_type & intC, real_type & intS, FresnelMode mode) {
+    if (mode == G2LIB_FRESNEL_GLOBAL)
+      mode = fresnel_mode;
+    if (mode != G2LIB_FRESNEL_APPROX) {
+      GeneralizedFresnelCS(a, b, c, intC, intS);
+      return;
+    }
+
+    FresnelApproxTable const * T = get_fresnel_table();
+
+    real_type xx, yy;
+    if (abs(a) < A_THRESOLD)
+      evalXYaSmall(a, b, T->series_size, xx, yy);
+    else
+      evalXYaLargeApprox(T, a, b, xx, yy);
+
     real_type cosc = cos(c);
     real_type sinc = sin(c);
 
-    for (int_type k = 0; k < nk; ++k) {
-      real_type xx = intC[k];
-      real_type yy = intS[k];
-      intC[k]      = xx * cosc - yy * sinc;
-      intS[k]      = xx * sinc + yy * cosc;
+    intC = xx * cosc - yy * sinc;
+    intS = xx * sinc + yy * cosc;
+  }
+
+  void GeneralizedFresnelCS(float a, float b, float c, float & intC, float & intS, FresnelMode mode) {
+    if (mode == G2LIB_FRESNEL_GLOBAL)
+      mode = fresnel_mode;
+    if (mode != G2LIB_FRESNEL_APPROX) {
+      GeneralizedFresnelCS_T(a, b, c, intC, intS);
+      return;
     }
+    real_type C, S;
+    GeneralizedFresnelCS(real_type(a), real_type(b), real_type(c), C, S, G2LIB_FRESNEL_APPROX);
+    intC = float(C);
+    intS = float(S);
+  }
+
+  // -------------------------------------------------------------------------
+
+  FresnelApproxReport fresnel_approx_report(int_type n_samples) {
+    G2LIB_UTILS_ASSERT(n_samples > 1, "fresnel_approx_report, n_samples = %d must be > 1\n", n_samples);
+    FresnelApproxTable const * T = get_fresnel_table();
+
+    FresnelApproxReport R;
+    R.tolerance     = T->tolerance;
+    R.table_error   = T->table_error;
+    R.tolerance_met = T->tolerance_met;
+    R.max_error_CS  = 0;
+    R.max_error_GCS = 0;
+    R.n_intervals   = T->n_intervals;
+    R.degree        = FRESNEL_APPROX_NC - 1;
+    R.series_size   = T->series_size;
+    R.n_samples     = n_samples;
+
+    // FresnelCS on a uniform grid of [-8,8]
+    for (int_type i = 0; i < n_samples; ++i) {
+      real_type x = -8 + (16.0 * i) / (n_samples - 1);
+      real_type Ca, Sa, Ce, Se;
+      T->eval(x, Ca, Sa);
+      FresnelCS(x, Ce, Se);
+      R.max_error_CS = max(R.max_error_CS, max(abs(Ca - Ce), abs(Sa - Se)));
+    }
+
+    // GeneralizedFresnelCS on a deterministic (Weyl) sequence of
+    // a in [-50,50] (half of the samples in the small |a| range), b in [-20,20], c in [-pi,pi]
+    for (int_type i = 0; i < n_samples; ++i) {
+      real_type u1 = fmod(0.5 + i * 0.6180339887498949, 1.0);
+      real_type u2 = fmod(0.5 + i * 0.7548776662466927, 1.0);
+      real_type u3 = fmod(0.5 + i * 0.5698402909980532, 1.0);
+      real_type a  = (2 * u1 - 1) * ((i % 2) == 0 ? 50 : A_THRESOLD);
+      real_type b  = (2 * u2 - 1) * 20;
+      real_type c  = (2 * u3 - 1) * Utils::m_pi;
+      real_type Ca, Sa, Ce, Se;
+      GeneralizedFresnelCS(a, b, c, Ca, Sa, G2LIB_FRESNEL_APPROX);
+      GeneralizedFresnelCS(a, b, c, Ce, Se);
+      R.max_error_GCS = max(R.max_error_GCS, max(abs(Ca - Ce), abs(Sa - Se)));
+    }
+    return R;
   }
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
   // -------------------------------------------------------------------------
 
-  void ClothoidData::nor_ISO(real_type s, real_type & nx, real_type & ny) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_ISO(T s, T & nx, T & ny) const {
     this->tg(s, ny, nx);
     nx = -nx;
   }
 
-  void ClothoidData::nor_SAE(real_type s, real_type & nx, real_type & ny) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_SAE(T s, T & nx, T & ny) const {
     this->tg(s, ny, nx);
     ny = -ny;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::nor_ISO_D(real_type s, real_type & nx_D, real_type & ny_D) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_ISO_D(T s, T & nx_D, T & ny_D) const {
     this->tg_D(s, ny_D, nx_D);
     nx_D = -nx_D;
   }
 
-  void ClothoidData::nor_SAE_D(real_type s, real_type & nx_D, real_type & ny_D) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_SAE_D(T s, T & nx_D, T & ny_D) const {
     this->tg_D(s, ny_D, nx_D);
     ny_D = -ny_D;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::nor_ISO_DD(real_type s, real_type & nx_DD, real_type & ny_DD) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_ISO_DD(T s, T & nx_DD, T & ny_DD) const {
     this->tg_DD(s, ny_DD, nx_DD);
     nx_DD = -nx_DD;
   }
 
-  void ClothoidData::nor_SAE_DD(real_type s, real_type & nx_DD, real_type & ny_DD) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_SAE_DD(T s, T & nx_DD, T & ny_DD) const {
     this->tg_DD(s, ny_DD, nx_DD);
     ny_DD = -ny_DD;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::nor_ISO_DDD(real_type s, real_type & nx_DDD, real_type & ny_DDD) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_ISO_DDD(T s, T & nx_DDD, T & ny_DDD) const {
     this->tg_DDD(s, ny_DDD, nx_DDD);
     nx_DDD = -nx_DDD;
   }
 
-  void ClothoidData::nor_SAE_DDD(real_type s, real_type & nx_DDD, real_type & ny_DDD) const {
+  template <typename T>
+  void ClothoidDataT<T>::nor_SAE_DDD(T s, T & nx_DDD, T & ny_DDD) const {
     this->tg_DDD(s, ny_DDD, nx_DDD);
     ny_DDD = -ny_DDD;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::tg_x_D(real_type s) const { return -sin(theta(s)) * theta_D(s); }
+  template <typename T>
+  T ClothoidDataT<T>::tg_x_D(T s) const { return -sin(theta(s)) * theta_D(s); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::tg_y_D(real_type s) const { return cos(theta(s)) * theta_D(s); }
+  template <typename T>
+  T ClothoidDataT<T>::tg_y_D(T s) const { return cos(theta(s)) * theta_D(s); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::tg_x_DD(real_type s) const {
-    real_type th    = theta(s);
-    real_type th_D  = theta_D(s);
-    real_type th_DD = theta_DD(s);
-    real_type S     = sin(th);
-    real_type C     = cos(th);
+  template <typename T>
+  T ClothoidDataT<T>::tg_x_DD(T s) const {
+    T th    = theta(s);
+    T th_D  = theta_D(s);
+    T th_DD = theta_DD(s);
+    T S     = sin(th);
+    T C     = cos(th);
     return -C * th_D * th_D - S * th_DD;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::tg_y_DD(real_type s) const {
-    real_type th    = theta(s);
-    real_type th_D  = theta_D(s);
-    real_type th_DD = theta_DD(s);
-    real_type S     = sin(th);
-    real_type C     = cos(th);
+  template <typename T>
+  T ClothoidDataT<T>::tg_y_DD(T s) const {
+    T th    = theta(s);
+    T th_D  = theta_D(s);
+    T th_DD = theta_DD(s);
+    T S     = sin(th);
+    T C     = cos(th);
     return -S * th_D * th_D + C * th_DD;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::tg_x_DDD(real_type s) const {
-    real_type th    = theta(s);
-    real_type th_D  = theta_D(s);
-    real_type th_DD = theta_DD(s);
-    real_type S     = sin(th);
-    real_type C     = cos(th);
-    real_type th_D2 = th_D * th_D;
+  template <typename T>
+  T ClothoidDataT<T>::tg_x_DDD(T s) const {
+    T th    = theta(s);
+    T th_D  = theta_D(s);
+    T th_DD = theta_DD(s);
+    T S     = sin(th);
+    T C     = cos(th);
+    T th_D2 = th_D * th_D;
     return th_D * (S * th_D2 - C * th_DD * (2 * th_D - 1));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::tg_y_DDD(real_type s) const {
-    real_type th    = theta(s);
-    real_type th_D  = theta_D(s);
-    real_type th_DD = theta_DD(s);
-    real_type S     = sin(th);
-    real_type C     = cos(th);
-    real_type th_D2 = th_D * th_D;
+  template <typename T>
+  T ClothoidDataT<T>::tg_y_DDD(T s) const {
+    T th    = theta(s);
+    T th_D  = theta_D(s);
+    T th_DD = theta_DD(s);
+    T S     = sin(th);
+    T C     = cos(th);
+    T th_D2 = th_D * th_D;
     return -th_D * (C * th_D2 + S * th_DD * (2 * th_D + 1));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::tg(real_type s, real_type & tx, real_type & ty) const {
-    real_type th = theta(s);
-    tx           = cos(th);
-    ty           = sin(th);
+  template <typename T>
+  void ClothoidDataT<T>::tg(T s, T & tx, T & ty) const {
+    T th = theta(s);
+    tx   = cos(th);
+    ty   = sin(th);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::tg_D(real_type s, real_type & tx_D, real_type & ty_D) const {
-    real_type th   = theta(s);
-    real_type th_D = theta_D(s);
-    tx_D           = sin(th) * th_D;
-    ty_D           = -cos(th) * th_D;
+  template <typename T>
+  void ClothoidDataT<T>::tg_D(T s, T & tx_D, T & ty_D) const {
+    T th   = theta(s);
+    T th_D = theta_D(s);
+    tx_D   = sin(th) * th_D;
+    ty_D   = -cos(th) * th_D;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::tg_DD(real_type s, real_type & tx_DD, real_type & ty_DD) const {
-    real_type th    = theta(s);
-    real_type th_D  = theta_D(s);
-    real_type th_DD = theta_DD(s);
-    real_type S     = sin(th);
-    real_type C     = cos(th);
-    tx_DD           = C * th_D * th_D + S * th_DD;
-    ty_DD           = S * th_D * th_D - C * th_DD;
+  template <typename T>
+  void ClothoidDataT<T>::tg_DD(T s, T & tx_DD, T & ty_DD) const {
+    T th    = theta(s);
+    T th_D  = theta_D(s);
+    T th_DD = theta_DD(s);
+    T S     = sin(th);
+    T C     = cos(th);
+    tx_DD   = C * th_D * th_D + S * th_DD;
+    ty_DD   = S * th_D * th_D - C * th_DD;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::tg_DDD(real_type s, real_type & tx_DDD, real_type & ty_DDD) const {
-    real_type th    = theta(s);
-    real_type th_D  = theta_D(s);
-    real_type th_DD = theta_DD(s);
-    real_type S     = sin(th);
-    real_type C     = cos(th);
-    real_type th_D2 = th_D * th_D;
-    tx_DDD          = th_D * (C * th_DD * (2 * th_D - 1) - S * th_D2);
-    ty_DDD          = th_D * (C * th_D2 + S * th_DD * (2 * th_D + 1));
+  template <typename T>
+  void ClothoidDataT<T>::tg_DDD(T s, T & tx_DDD, T & ty_DDD) const {
+    T th    = theta(s);
+    T th_D  = theta_D(s);
+    T th_DD = theta_DD(s);
+    T S     = sin(th);
+    T C     = cos(th);
+    T th_D2 = th_D * th_D;
+    tx_DDD  = th_D * (C * th_DD * (2 * th_D - 1) - S * th_D2);
+    ty_DDD  = th_D * (C * th_D2 + S * th_DD * (2 * th_D + 1));
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::X(real_type s) const {
-    real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+  template <typename T>
+  T ClothoidDataT<T>::X(T s) const {
+    T C, S;
+    fresnelCS(s, C, S);
     return x0 + s * C;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::Y(real_type s) const {
-    real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+  template <typename T>
+  T ClothoidDataT<T>::Y(T s) const {
+    T C, S;
+    fresnelCS(s, C, S);
     return y0 + s * S;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::X_D(real_type s) const { return cos(theta(s)); }
+  template <typename T>
+  T ClothoidDataT<T>::X_D(T s) const { return cos(theta(s)); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::Y_D(real_type s) const { return sin(theta(s)); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_D(T s) const { return sin(theta(s)); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::X_DD(real_type s) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
+  template <typename T>
+  T ClothoidDataT<T>::X_DD(T s) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
     return -sin(theta) * theta_D;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::Y_DD(real_type s) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
+  template <typename T>
+  T ClothoidDataT<T>::Y_DD(T s) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
     return cos(theta) * theta_D;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::X_DDD(real_type s) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
+  template <typename T>
+  T ClothoidDataT<T>::X_DDD(T s) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
     return -cos(theta) * theta_D * theta_D - sin(theta) * dk;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::Y_DDD(real_type s) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
+  template <typename T>
+  T ClothoidDataT<T>::Y_DDD(T s) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
     return -sin(theta) * theta_D * theta_D + cos(theta) * dk;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::X_ISO(real_type s, real_type offs) const { return X(s) + offs * nor_x_ISO(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_ISO(T s, T offs) const { return X(s) + offs * nor_x_ISO(s); }
 
-  real_type ClothoidData::Y_ISO(real_type s, real_type offs) const { return Y(s) + offs * nor_y_ISO(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_ISO(T s, T offs) const { return Y(s) + offs * nor_y_ISO(s); }
 
-  real_type ClothoidData::X_ISO_D(real_type s, real_type offs) const { return X_D(s) + offs * nor_x_ISO_D(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_ISO_D(T s, T offs) const { return X_D(s) + offs * nor_x_ISO_D(s); }
 
-  real_type ClothoidData::Y_ISO_D(real_type s, real_type offs) const { return Y_D(s) + offs * nor_y_ISO_D(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_ISO_D(T s, T offs) const { return Y_D(s) + offs * nor_y_ISO_D(s); }
 
-  real_type ClothoidData::X_ISO_DD(real_type s, real_type offs) const { return X_DD(s) + offs * nor_x_ISO_DD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_ISO_DD(T s, T offs) const { return X_DD(s) + offs * nor_x_ISO_DD(s); }
 
-  real_type ClothoidData::Y_ISO_DD(real_type s, real_type offs) const { return Y_DD(s) + offs * nor_y_ISO_DD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_ISO_DD(T s, T offs) const { return Y_DD(s) + offs * nor_y_ISO_DD(s); }
 
-  real_type ClothoidData::X_ISO_DDD(real_type s, real_type offs) const { return X_DDD(s) + offs * nor_x_ISO_DDD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_ISO_DDD(T s, T offs) const { return X_DDD(s) + offs * nor_x_ISO_DDD(s); }
 
-  real_type ClothoidData::Y_ISO_DDD(real_type s, real_type offs) const { return Y_DDD(s) + offs * nor_y_ISO_DDD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_ISO_DDD(T s, T offs) const { return Y_DDD(s) + offs * nor_y_ISO_DDD(s); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::X_SAE(real_type s, real_type offs) const { return X(s) + offs * nor_x_SAE(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_SAE(T s, T offs) const { return X(s) + offs * nor_x_SAE(s); }
 
-  real_type ClothoidData::Y_SAE(real_type s, real_type offs) const { return Y(s) + offs * nor_y_SAE(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_SAE(T s, T offs) const { return Y(s) + offs * nor_y_SAE(s); }
 
-  real_type ClothoidData::X_SAE_D(real_type s, real_type offs) const { return X_D(s) + offs * nor_x_SAE_D(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_SAE_D(T s, T offs) const { return X_D(s) + offs * nor_x_SAE_D(s); }
 
-  real_type ClothoidData::Y_SAE_D(real_type s, real_type offs) const { return Y_D(s) + offs * nor_y_SAE_D(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_SAE_D(T s, T offs) const { return Y_D(s) + offs * nor_y_SAE_D(s); }
 
-  real_type ClothoidData::X_SAE_DD(real_type s, real_type offs) const { return X_DD(s) + offs * nor_x_SAE_DD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_SAE_DD(T s, T offs) const { return X_DD(s) + offs * nor_x_SAE_DD(s); }
 
-  real_type ClothoidData::Y_SAE_DD(real_type s, real_type offs) const { return Y_DD(s) + offs * nor_y_SAE_DD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_SAE_DD(T s, T offs) const { return Y_DD(s) + offs * nor_y_SAE_DD(s); }
 
-  real_type ClothoidData::X_SAE_DDD(real_type s, real_type offs) const { return X_DDD(s) + offs * nor_x_SAE_DDD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::X_SAE_DDD(T s, T offs) const { return X_DDD(s) + offs * nor_x_SAE_DDD(s); }
 
-  real_type ClothoidData::Y_SAE_DDD(real_type s, real_type offs) const { return Y_DDD(s) + offs * nor_y_SAE_DDD(s); }
+  template <typename T>
+  T ClothoidDataT<T>::Y_SAE_DDD(T s, T offs) const { return Y_DDD(s) + offs * nor_y_SAE_DDD(s); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::evaluate(real_type s, real_type & theta, real_type & kappa, real_type & x, real_type & y) const {
-    real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+  template <typename T>
+  void ClothoidDataT<T>::evaluate(T s, T & theta, T & kappa, T & x, T & y) const {
+    T C, S;
+    fresnelCS(s, C, S);
     x     = x0 + s * C;
     y     = y0 + s * S;
-    theta = theta0 + s * (kappa0 + 0.5 * s * dk);
+    theta = theta0 + s * (kappa0 + T(0.5) * s * dk);
     kappa = kappa0 + s * dk;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval(real_type s, real_type & x, real_type & y) const {
-    real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+  template <typename T>
+  void ClothoidDataT<T>::eval(T s, T & x, T & y) const {
+    T C, S;
+    fresnelCS(s, C, S);
     x = x0 + s * C;
     y = y0 + s * S;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_D(real_type s, real_type & x_D, real_type & y_D) const {
-    real_type theta = theta0 + s * (kappa0 + 0.5 * s * dk);
-    x_D             = cos(theta);
-    y_D             = sin(theta);
+  template <typename T>
+  void ClothoidDataT<T>::eval_D(T s, T & x_D, T & y_D) const {
+    T theta = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    x_D     = cos(theta);
+    y_D     = sin(theta);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_DD(real_type s, real_type & x_DD, real_type & y_DD) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
-    x_DD              = -sin(theta) * theta_D;
-    y_DD              = cos(theta) * theta_D;
+  template <typename T>
+  void ClothoidDataT<T>::eval_DD(T s, T & x_DD, T & y_DD) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
+    x_DD      = -sin(theta) * theta_D;
+    y_DD      = cos(theta) * theta_D;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_DDD(real_type s, real_type & x_DDD, real_type & y_DDD) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
-    real_type C       = cos(theta);
-    real_type S       = sin(theta);
-    real_type th2     = theta_D * theta_D;
-    x_DDD             = -C * th2 - S * dk;
-    y_DDD             = -S * th2 + C * dk;
+  template <typename T>
+  void ClothoidDataT<T>::eval_DDD(T s, T & x_DDD, T & y_DDD) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
+    T C       = cos(theta);
+    T S       = sin(theta);
+    T th2     = theta_D * theta_D;
+    x_DDD     = -C * th2 - S * dk;
+    y_DDD     = -S * th2 + C * dk;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const {
-    real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
-    real_type theta = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type tx    = cos(theta);
-    real_type ty    = sin(theta);
-    real_type nx    = -ty;
-    real_type ny    = tx;
-    x               = x0 + s * C + offs * nx;
-    y               = y0 + s * S + offs * ny;
+  template <typename T>
+  void ClothoidDataT<T>::eval_ISO(T s, T offs, T & x, T & y) const {
+    T C, S;
+    fresnelCS(s, C, S);
+    T theta = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T tx    = cos(theta);
+    T ty    = sin(theta);
+    T nx    = -ty;
+    T ny    = tx;
+    x       = x0 + s * C + offs * nx;
+    y       = y0 + s * S + offs * ny;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidDataT<T>::eval_ISO_D(T s, T offs, T & x_D, T & y_D) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
+    T scale   = 1 - offs * theta_D;
+    x_D       = cos(theta) * scale;
+    y_D       = sin(theta) * scale;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidDataT<T>::eval_ISO_DD(T s, T offs, T & x_DD, T & y_DD) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
+    T C       = cos(theta);
+    T S       = sin(theta);
+    T tmp1    = theta_D * (1 - theta_D * offs);
+    T tmp2    = -offs * dk;
+    x_DD      = -tmp1 * S + C * tmp2;
+    y_DD      = tmp1 * C + S * tmp2;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidDataT<T>::eval_ISO_DDD(T s, T offs, T & x_DDD, T & y_DDD) const {
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
+    T C       = cos(theta);
+    T S       = sin(theta);
+    T tmp0    = -theta_D * offs;
+    T tmp1    = -theta_D * theta_D * (1 + tmp0);
+    T tmp2    = dk * (1 + 3 * tmp0);
+    x_DDD     = tmp1 * C - tmp2 * S;
+    y_DDD     = tmp1 * S + tmp2 * C;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidDataT<T>::eval_full(T s, T offs, ClothoidPointT<T> & P) const {
+    T C, S;
+    fresnelCS(s, C, S);
+    T theta   = theta0 + s * (kappa0 + T(0.5) * s * dk);
+    T theta_D = kappa0 + s * dk;
+    T tx      = cos(theta);
+    T ty      = sin(theta);
+
+    P.theta = theta;
+    P.kappa = theta_D;
+    P.nx    = -ty;
+    P.ny    = tx;
+
+    P.x = x0 + s * C + offs * P.nx;
+    P.y = y0 + s * S + offs * P.ny;
+
+    T scale = 1 - offs * theta_D;
+    P.x_D   = tx * scale;
+    P.y_D   = ty * scale;
+
+    T tmp1 = theta_D * (1 - theta_D * offs);
+    T tmp2 = -offs * dk;
+    P.x_DD = -tmp1 * ty + tx * tmp2;
+    P.y_DD = tmp1 * tx + ty * tmp2;
+
+    T tmp0  = -theta_D * offs;
+    tmp1    = -theta_D * theta_D * (1 + tmp0);
+    tmp2    = dk * (1 + 3 * tmp0);
+    P.x_DDD = tmp1 * tx - tmp2 * ty;
+    P.y_DDD = tmp1 * ty + tmp2 * tx;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void ClothoidDataT<T>::fresnelCS(int_type n, T const * s, T * C, T * S) const {
+    FresnelMode mode = fresnel == G2LIB_FRESNEL_GLOBAL ? fresnel_mode : fresnel;
+    if (mode == G2LIB_FRESNEL_APPROX) {
+      for (int_type i = 0; i < n; ++i)
+        GeneralizedFresnelCS(dk * s[i] * s[i], kappa0 * s[i], theta0, C[i], S[i], mode);
+      return;
+    }
+    T a[FRESNEL_BATCH_BLOCK], b[FRESNEL_BATCH_BLOCK], c[FRESNEL_BATCH_BLOCK];
+    std::fill_n(c, FRESNEL_BATCH_BLOCK, theta0);
+    for (int_type i0 = 0; i0 < n; i0 += FRESNEL_BATCH_BLOCK) {
+      int_type nb = min(n - i0, int_type(FRESNEL_BATCH_BLOCK));
+      for (int_type j = 0; j < nb; ++j) {
+        a[j] = dk * s[i0 + j] * s[i0 + j];
+        b[j] = kappa0 * s[i0 + j];
+      }
+      GeneralizedFresnelCS(nb, a, b, c, C + i0, S + i0);
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_ISO_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
-    real_type scale   = 1 - offs * theta_D;
-    x_D               = cos(theta) * scale;
-    y_D               = sin(theta) * scale;
+  template <typename T>
+  void ClothoidDataT<T>::evaluate(int_type n, T const * s, T * theta, T * kappa, T * x, T * y) const {
+    this->fresnelCS(n, s, x, y);
+    for (int_type i = 0; i < n; ++i) {
+      T si     = s[i];
+      x[i]     = x0 + si * x[i];
+      y[i]     = y0 + si * y[i];
+      theta[i] = theta0 + si * (kappa0 + T(0.5) * si * dk);
+      kappa[i] = kappa0 + si * dk;
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
-    real_type C       = cos(theta);
-    real_type S       = sin(theta);
-    real_type tmp1    = theta_D * (1 - theta_D * offs);
-    real_type tmp2    = -offs * dk;
-    x_DD              = -tmp1 * S + C * tmp2;
-    y_DD              = tmp1 * C + S * tmp2;
+  template <typename T>
+  void ClothoidDataT<T>::eval(int_type n, T const * s, T * x, T * y) const {
+    this->fresnelCS(n, s, x, y);
+    for (int_type i = 0; i < n; ++i) {
+      x[i] = x0 + s[i] * x[i];
+      y[i] = y0 + s[i] * y[i];
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const {
-    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
-    real_type theta_D = kappa0 + s * dk;
-    real_type C       = cos(theta);
-    real_type S       = sin(theta);
-    real_type tmp0    = -theta_D * offs;
-    real_type tmp1    = -theta_D * theta_D * (1 + tmp0);
-    real_type tmp2    = dk * (1 + 3 * tmp0);
-    x_DDD             = tmp1 * C - tmp2 * S;
-    y_DDD             = tmp1 * S + tmp2 * C;
+  template <typename T>
+  void ClothoidDataT<T>::eval_ISO(int_type n, T const * s, T offs, T * x, T * y) const {
+    this->fresnelCS(n, s, x, y);
+    for (int_type i = 0; i < n; ++i) {
+      T si    = s[i];
+      T theta = theta0 + si * (kappa0 + T(0.5) * si * dk);
+      x[i]    = x0 + si * x[i] - offs * sin(theta);
+      y[i]    = y0 + si * y[i] + offs * cos(theta);
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::Pinfinity(real_type & x, real_type & y, bool plus) const {
-    real_type theta, tmp;
+  template <typename T>
+  void ClothoidDataT<T>::Pinfinity(T & x, T & y, bool plus) const {
+    T theta, tmp;
     this->evaluate(-kappa0 / dk, theta, tmp, x, y);
-    real_type Ct = cos(theta);
-    real_type St = sin(theta);
-    tmp          = 0.5 * sqrt(Utils::m_pi / abs(dk));
+    T Ct = cos(theta);
+    T St = sin(theta);
+    tmp  = 0.5 * sqrt(Utils::m_pi / abs(dk));
     if (!plus)
       tmp = -tmp;
     if (dk > 0) {
@@ -898,19 +1936,21 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::eval(real_type s, ClothoidData & C) const {
+  template <typename T>
+  void ClothoidDataT<T>::eval(T s, ClothoidDataT & C) const {
     this->evaluate(s, C.theta0, C.kappa0, C.x0, C.y0);
     C.dk = dk;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::reverse(real_type L) {
-    real_type C, S;
+  template <typename T>
+  void ClothoidDataT<T>::reverse(T L) {
+    T C, S;
     GeneralizedFresnelCS(dk * L * L, kappa0 * L, theta0, C, S);
     x0 += L * C;
     y0 += L * S;
-    theta0 += L * (kappa0 + 0.5 * L * dk);
+    theta0 += L * (kappa0 + T(0.5) * L * dk);
     kappa0 += L * dk;
     theta0 += Utils::m_pi;
     while (theta0 > Utils::m_pi)
@@ -922,7 +1962,8 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::reverse(real_type L, ClothoidData & out) const {
+  template <typename T>
+  void ClothoidDataT<T>::reverse(T L, ClothoidDataT & out) const {
     this->evaluate(L, out.theta0, out.kappa0, out.x0, out.y0);
     out.theta0 += Utils::m_pi;
     out.kappa0 = -(out.kappa0);
@@ -935,34 +1976,37 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::rotate(real_type angle, real_type cx, real_type cy) {
-    real_type dx  = x0 - cx;
-    real_type dy  = y0 - cy;
-    real_type C   = cos(angle);
-    real_type S   = sin(angle);
-    real_type ndx = C * dx - S * dy;
-    real_type ndy = C * dy + S * dx;
-    x0            = cx + ndx;
-    y0            = cy + ndy;
+  template <typename T>
+  void ClothoidDataT<T>::rotate(T angle, T cx, T cy) {
+    T dx  = x0 - cx;
+    T dy  = y0 - cy;
+    T C   = cos(angle);
+    T S   = sin(angle);
+    T ndx = C * dx - S * dy;
+    T ndy = C * dy + S * dx;
+    x0    = cx + ndx;
+    y0    = cy + ndy;
     theta0 += angle;
   }
 
-  void ClothoidData::origin_at(real_type s_origin) {
-    real_type C, S;
-    real_type sdk = s_origin * dk;
+  template <typename T>
+  void ClothoidDataT<T>::origin_at(T s_origin) {
+    T C, S;
+    T sdk = s_origin * dk;
     GeneralizedFresnelCS(sdk * s_origin, kappa0 * s_origin, theta0, C, S);
     x0 += s_origin * C;
     y0 += s_origin * S;
-    theta0 += s_origin * (kappa0 + 0.5 * sdk);
+    theta0 += s_origin * (kappa0 + T(0.5) * sdk);
     kappa0 += sdk;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::split_at_flex(ClothoidData & C0, ClothoidData & C1) const {
+  template <typename T>
+  T ClothoidDataT<T>::split_at_flex(ClothoidDataT & C0, ClothoidDataT & C1) const {
     // flex inside, split clothoid
-    real_type sflex = -kappa0 / dk;
-    C0.theta0       = theta0 + 0.5 * kappa0 * sflex;
+    T sflex   = -kappa0 / dk;
+    C0.theta0 = theta0 + T(0.5) * kappa0 * sflex;
     eval(sflex, C0.x0, C0.y0);
     C1.x0     = C0.x0;
     C1.y0     = C0.y0;
@@ -974,9 +2018,10 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type ClothoidData::aplus(real_type dtheta) const {
-    real_type tmp = 2 * dtheta * dk;
-    real_type k0  = kappa0;
+  template <typename T>
+  T ClothoidDataT<T>::aplus(T dtheta) const {
+    T tmp = 2 * dtheta * dk;
+    T k0  = kappa0;
     if (k0 < 0) {
       tmp = -tmp;
       k0  = -k0;
@@ -988,22 +2033,21 @@ namespace G2lib {
 
   static real_type const one_degree = Utils::m_pi / 180;
 
-  bool ClothoidData::bbTriangle(
-      real_type L, real_type & xx0, real_type & yy0, real_type & xx1, real_type & yy1, real_type & xx2, real_type & yy2)
-      const {
-    real_type theta_max = theta(L);
-    real_type theta_min = theta0;
-    real_type dtheta    = abs(theta_max - theta_min);
+  template <typename T>
+  bool ClothoidDataT<T>::bbTriangle(T L, T & xx0, T & yy0, T & xx1, T & yy1, T & xx2, T & yy2) const {
+    T theta_max = theta(L);
+    T theta_min = theta0;
+    T dtheta    = abs(theta_max - theta_min);
     if (dtheta < Utils::m_pi_2) {
-      real_type alpha, tx0, ty0;
+      T alpha, tx0, ty0;
       eval(0, xx0, yy0);
       eval_D(0, tx0, ty0);
       if (dtheta > one_degree) {
-        real_type tx1, ty1;
+        T tx1, ty1;
         eval(L, xx1, yy1);
         eval_D(L, tx1, ty1);
-        real_type det = tx1 * ty0 - tx0 * ty1;
-        alpha         = ((yy1 - yy0) * tx1 - (xx1 - xx0) * ty1) / det;
+        T det = tx1 * ty0 - tx0 * ty1;
+        alpha = ((yy1 - yy0) * tx1 - (xx1 - xx0) * ty1) / det;
       } else {
         // se angolo troppo piccolo uso approx piu rozza
         alpha = L;
@@ -1018,28 +2062,21 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  bool ClothoidData::bbTriangle_ISO(
-      real_type   L,
-      real_type   offs,
-      real_type & xx0,
-      real_type & yy0,
-      real_type & xx1,
-      real_type & yy1,
-      real_type & xx2,
-      real_type & yy2) const {
-    real_type theta_max = theta(L);
-    real_type theta_min = theta0;
-    real_type dtheta    = abs(theta_max - theta_min);
+  template <typename T>
+  bool ClothoidDataT<T>::bbTriangle_ISO(T L, T offs, T & xx0, T & yy0, T & xx1, T & yy1, T & xx2, T & yy2) const {
+    T theta_max = theta(L);
+    T theta_min = theta0;
+    T dtheta    = abs(theta_max - theta_min);
     if (dtheta < Utils::m_pi_2) {
-      real_type alpha, tx0, ty0;
+      T alpha, tx0, ty0;
       eval_ISO(0, offs, xx0, yy0);
       eval_D(0, tx0, ty0);  // no offset solo scalato
       if (dtheta > one_degree) {
-        real_type tx1, ty1;
+        T tx1, ty1;
         eval_ISO(L, offs, xx1, yy1);
         eval_D(L, tx1, ty1);  // no offset solo scalato
-        real_type det = tx1 * ty0 - tx0 * ty1;
-        alpha         = ((yy1 - yy0) * tx1 - (xx1 - xx0) * ty1) / det;
+        T det = tx1 * ty0 - tx0 * ty1;
+        alpha = ((yy1 - yy0) * tx1 - (xx1 - xx0) * ty1) / det;
       } else {
         // se angolo troppo piccolo uso approx piu rozza
         alpha = L;
@@ -1054,19 +2091,20 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  int ClothoidData::build_G1(
-      real_type   _x0,
-      real_type   _y0,
-      real_type   _theta0,
-      real_type   x1,
-      real_type   y1,
-      real_type   theta1,
-      real_type   tol,
-      real_type & L,
-      bool        compute_deriv,
-      real_type   L_D[2],
-      real_type   k_D[2],
-      real_type   dk_D[2]) {
+  template <typename T>
+  int ClothoidDataT<T>::build_G1(
+      T    _x0,
+      T    _y0,
+      T    _theta0,
+      T    x1,
+      T    y1,
+      T    theta1,
+      T    tol,
+      T &  L,
+      bool compute_deriv,
+      T    L_D[2],
+      T    k_D[2],
+      T    dk_D[2]) {
     static real_type const CF[] = { 2.989696028701907,  0.716228953608281, -0.458969738821509,
                                     -0.502821153340377, 0.261062141752652, -0.045854475238709 };
 
@@ -1075,12 +2113,12 @@ namespace G2lib {
     theta0 = _theta0;
 
     // traslazione in (0,0)
-    real_type dx   = x1 - x0;
-    real_type dy   = y1 - y0;
-    real_type r    = hypot(dx, dy);
-    real_type phi  = atan2(dy, dx);
-    real_type phi0 = theta0 - phi;
-    real_type phi1 = theta1 - phi;
+    T dx   = x1 - x0;
+    T dy   = y1 - y0;
+    T r    = hypot(dx, dy);
+    T phi  = atan2(dy, dx);
+    T phi0 = theta0 - phi;
+    T phi1 = theta1 - phi;
 
     phi0 -= Utils::m_2pi * round(phi0 / Utils::m_2pi);
     phi1 -= Utils::m_2pi * round(phi1 / Utils::m_2pi);
@@ -1094,19 +2132,19 @@ namespace G2lib {
     else if (phi1 < -Utils::m_pi)
       phi1 += Utils::m_2pi;
 
-    real_type delta = phi1 - phi0;
+    T delta = phi1 - phi0;
 
     // punto iniziale
-    real_type X  = phi0 * Utils::m_1_pi;
-    real_type Y  = phi1 * Utils::m_1_pi;
-    real_type xy = X * Y;
+    T X  = phi0 * Utils::m_1_pi;
+    T Y  = phi1 * Utils::m_1_pi;
+    T xy = X * Y;
     Y *= Y;
     X *= X;
-    real_type A =
+    T A =
         (phi0 + phi1) * (CF[0] + xy * (CF[1] + xy * CF[2]) + (CF[3] + xy * CF[4]) * (X + Y) + CF[5] * (X * X + Y * Y));
     // newton
-    real_type g     = 0, dg, intC[3], intS[3];
-    int_type  niter = 0;
+    T        g     = 0, dg, intC[3], intS[3];
+    int_type niter = 0;
     do {
       GeneralizedFresnelCS(3, 2 * A, delta - A, phi0, intC, intS);
       g  = intS[0];
@@ -1123,13 +2161,13 @@ namespace G2lib {
     this->dk     = 2 * A / L / L;
 
     if (compute_deriv) {
-      real_type alpha = intC[0] * intC[1] + intS[0] * intS[1];
-      real_type beta  = intC[0] * intC[2] + intS[0] * intS[2];
-      real_type gamma = intC[0] * intC[0] + intS[0] * intS[0];
-      real_type tx    = intC[1] - intC[2];
-      real_type ty    = intS[1] - intS[2];
-      real_type txy   = L * (intC[1] * intS[2] - intC[2] * intS[1]);
-      real_type omega = L * (intS[0] * tx - intC[0] * ty) - txy;
+      T alpha = intC[0] * intC[1] + intS[0] * intS[1];
+      T beta  = intC[0] * intC[2] + intS[0] * intS[2];
+      T gamma = intC[0] * intC[0] + intS[0] * intS[0];
+      T tx    = intC[1] - intC[2];
+      T ty    = intS[1] - intS[2];
+      T txy   = L * (intC[1] * intS[2] - intC[2] * intS[1]);
+      T omega = L * (intS[0] * tx - intC[0] * ty) - txy;
 
       delta = intC[0] * tx + intS[0] * ty;
 
@@ -1220,21 +2258,14 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-  bool ClothoidData::build_forward(
-      real_type   x0,
-      real_type   y0,
-      real_type   theta0,
-      real_type   kappa0,
-      real_type   x1,
-      real_type   y1,
-      real_type   tol,
-      real_type & L) {
+  template <typename T>
+  bool ClothoidDataT<T>::build_forward(T x0, T y0, T theta0, T kappa0, T x1, T y1, T tol, T & L) {
     // Compute guess angles
-    real_type dx   = x1 - x0;
-    real_type dy   = y1 - y0;
-    real_type len  = hypot(dy, dx);
-    real_type arot = atan2(dy, dx);
-    real_type th0  = theta0 - arot;
+    T dx   = x1 - x0;
+    T dy   = y1 - y0;
+    T len  = hypot(dy, dx);
+    T arot = atan2(dy, dx);
+    T th0  = theta0 - arot;
     // normalize angle
     while (th0 > Utils::m_pi)
       th0 -= Utils::m_2pi;
@@ -1242,21 +2273,21 @@ namespace G2lib {
       th0 += Utils::m_2pi;
 
     // solve the problem from (0,0) to (1,0)
-    real_type k0    = kappa0 * len;
-    real_type alpha = 2.6;
-    real_type thmin = max(-Utils::m_pi, -theta0 / 2 - alpha);
-    real_type thmax = min(Utils::m_pi, -theta0 / 2 + alpha);
-    real_type Kmin  = kappa_fun(th0, thmax);
-    real_type Kmax  = kappa_fun(th0, thmin);
-    bool      ok;
-    real_type th = theta_guess(th0, max(min(k0, Kmax), Kmin), ok);
+    T    k0    = kappa0 * len;
+    T    alpha = 2.6;
+    T    thmin = max(T(-Utils::m_pi), -theta0 / 2 - alpha);
+    T    thmax = min(T(Utils::m_pi), -theta0 / 2 + alpha);
+    T    Kmin  = kappa_fun(th0, thmax);
+    T    Kmax  = kappa_fun(th0, thmin);
+    bool ok;
+    T    th    = theta_guess(th0, max(min(k0, Kmax), Kmin), ok);
     if (ok) {
       for (int_type iter = 0; iter < 20; ++iter) {
-        real_type LL, L_D[2], k_D[2], dk_D[2];
+        T LL, L_D[2], k_D[2], dk_D[2];
         build_G1(0, 0, th0, 1, 0, th, tol, LL, true, L_D, k_D, dk_D);
-        real_type f   = this->kappa0 - k0;  // use kappa0 of the class
-        real_type df  = k_D[1];
-        real_type dth = f / df;
+        T f   = this->kappa0 - k0;  // use kappa0 of the class
+        T df  = k_D[1];
+        T dth = f / df;
         th -= dth;
         if (abs(dth) < tol && abs(f) < tol) {
           // transform solution
@@ -1270,7 +2301,8 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidData::info(ostream_type & s) const {
+  template <typename T>
+  void ClothoidDataT<T>::info(ostream_type & s) const {
     s << Utils::format_string(
         "x0     = %f\n"
         "y0     = %f\n"
@@ -1282,6 +2314,11 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  template struct ClothoidPointT<float>;
+  template struct ClothoidPointT<double>;
+  template class ClothoidDataT<float>;
+  template class ClothoidDataT<double>;
+
 #endif
 }  // namespace G2lib
 
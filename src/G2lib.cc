@@ -548,13 +548,14 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  int_type isCounterClockwise(real_type const * P1, real_type const * P2, real_type const * P3) {
-    real_type dx1 = P2[0] - P1[0];
-    real_type dy1 = P2[1] - P1[1];
-    real_type dx2 = P3[0] - P1[0];
-    real_type dy2 = P3[1] - P1[1];
-    real_type tol = Utils::machepsi10 * (hypot(dx1, dy1) * hypot(dx2, dy2));
-    real_type det = dx1 * dy2 - dy1 * dx2;
+  template <typename T>
+  static int_type isCounterClockwise_T(T const * P1, T const * P2, T const * P3) {
+    T dx1 = P2[0] - P1[0];
+    T dy1 = P2[1] - P1[1];
+    T dx2 = P3[0] - P1[0];
+    T dy2 = P3[1] - P1[1];
+    T tol = 10 * numeric_limits<T>::epsilon() * (std::hypot(dx1, dy1) * std::hypot(dx2, dy2));
+    T det = dx1 * dy2 - dy1 * dx2;
     if (det > tol)
       return 1;
     else if (det < -tol)
@@ -562,6 +563,14 @@ namespace G2lib {
     return 0;
   }
 
+  int_type isCounterClockwise(float const * P1, float const * P2, float const * P3) {
+    return isCounterClockwise_T(P1, P2, P3);
+  }
+
+  int_type isCounterClockwise(double const * P1, double const * P2, double const * P3) {
+    return isCounterClockwise_T(P1, P2, P3);
+  }
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type projectPointOnCircleArc(
@@ -629,12 +638,12 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  int_type isPointInTriangle(
-      real_type const * point, real_type const * p1, real_type const * p2, real_type const * p3) {
-    int_type d = isCounterClockwise(p1, p2, p3);
-    int_type a = isCounterClockwise(p1, p2, point);
-    int_type b = isCounterClockwise(p2, p3, point);
-    int_type c = isCounterClockwise(p3, p1, point);
+  template <typename T>
+  static int_type isPointInTriangle_T(T const * point, T const * p1, T const * p2, T const * p3) {
+    int_type d = isCounterClockwise_T(p1, p2, p3);
+    int_type a = isCounterClockwise_T(p1, p2, point);
+    int_type b = isCounterClockwise_T(p2, p3, point);
+    int_type c = isCounterClockwise_T(p3, p1, point);
     if (d < 0) {
       a = -a;
       b = -b;
@@ -651,6 +660,14 @@ namespace G2lib {
     return 0;
   }
 
+  int_type isPointInTriangle(float const * point, float const * p1, float const * p2, float const * p3) {
+    return isPointInTriangle_T(point, p1, p2, p3);
+  }
+
+  int_type isPointInTriangle(double const * point, double const * p1, double const * p2, double const * p3) {
+    return isPointInTriangle_T(point, p1, p2, p3);
+  }
+
   /*\
    |  ____                  ____
    | | __ )  __ _ ___  ___ / ___|   _ _ ____   _____
@@ -773,6 +790,24 @@ namespace G2lib {
     y_DDD += offs * ny_DDD;
   }
 
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BaseCurve::eval(int_type n, real_type const * s, real_type * x, real_type * y) const {
+    for (int_type i = 0; i < n; ++i)
+      eval(s[i], x[i], y[i]);
+  }
+
+  void BaseCurve::eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+    for (int_type i = 0; i < n; ++i)
+      eval_ISO(s[i], offs, x[i], y[i]);
+  }
+
+  void BaseCurve::evaluate(
+      int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const {
+    for (int_type i = 0; i < n; ++i)
+      evaluate(s[i], th[i], k[i], x[i], y[i]);
+  }
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 }  // namespace G2lib
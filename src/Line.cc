@@ -426,6 +426,39 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  bool LineSegment::raycast_ISO(
+      real_type   x0,
+      real_type   y0,
+      real_type   dx,
+      real_type   dy,
+      real_type   offs,
+      real_type   tmax,
+      real_type & t,
+      real_type & s) const {
+    real_type len = hypot(dx, dy);
+    if (!(len > 0))
+      return false;
+    dx /= len;
+    dy /= len;
+    // x0 + t d = P0 + offs N0 + s T0, solved with cross products
+    // (a ray parallel to the segment does not hit it)
+    real_type wx  = m_x0 - offs * m_s0 - x0;
+    real_type wy  = m_y0 + offs * m_c0 - y0;
+    real_type den = dx * m_s0 - dy * m_c0;
+    if (den == 0)
+      return false;
+    real_type tt   = (wx * m_s0 - wy * m_c0) / den;
+    real_type ss   = (wx * dy - wy * dx) / den;
+    real_type epsi = m_L * Utils::machepsi100;
+    if (tt < 0 || tt > tmax || ss < -epsi || ss > m_L + epsi)
+      return false;
+    t = tt;
+    s = max(real_type(0), min(ss, m_L));
+    return true;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   bool LineSegment::collision(LineSegment const & S) const {
     // The main function that returns true if line segment 'p1q1'
     // and 'p2q2' intersect.
@@ -68,8 +68,7 @@ namespace G2lib {
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  PolyLine::PolyLine(BaseCurve const & C) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-    this->resetLastInterval();
+  PolyLine::PolyLine(BaseCurve const & C) : BaseCurve(G2LIB_POLYLINE) {
     switch (C.type()) {
       case G2LIB_LINE:
         build(*static_cast<LineSegment const *>(&C));
@@ -88,40 +87,35 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  PolyLine::PolyLine(LineSegment const & LS) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-    this->resetLastInterval();
+  PolyLine::PolyLine(LineSegment const & LS) : BaseCurve(G2LIB_POLYLINE) {
     this->init(LS.x_begin(), LS.y_begin());
     this->push_back(LS);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  PolyLine::PolyLine(CircleArc const & C, real_type tol) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-    this->resetLastInterval();
+  PolyLine::PolyLine(CircleArc const & C, real_type tol) : BaseCurve(G2LIB_POLYLINE) {
     this->init(C.x_begin(), C.y_begin());
     this->push_back(C, tol);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  PolyLine::PolyLine(Biarc const & B, real_type tol) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-    this->resetLastInterval();
+  PolyLine::PolyLine(Biarc const & B, real_type tol) : BaseCurve(G2LIB_POLYLINE) {
     this->init(B.x_begin(), B.y_begin());
     this->push_back(B, tol);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  PolyLine::PolyLine(ClothoidCurve const & C, real_type tol) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-    this->resetLastInterval();
+  PolyLine::PolyLine(ClothoidCurve const & C, real_type tol) : BaseCurve(G2LIB_POLYLINE) {
     this->init(C.x_begin(), C.y_begin());
     this->push_back(C, tol);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  PolyLine::PolyLine(ClothoidList const & PL, real_type tol) : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) {
-    this->resetLastInterval();
+  PolyLine::PolyLine(ClothoidList const & PL, real_type tol) : BaseCurve(G2LIB_POLYLINE) {
     this->init(PL.x_begin(), PL.y_begin());
     this->push_back(PL, tol);
   }
@@ -129,10 +123,43 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type PolyLine::findAtS(real_type & s) const {
-    auto lastInterval = m_lastInterval.search(std::this_thread::get_id());
+    int_type & lastInterval = Utils::last_interval_hint(this);
     Utils::search_interval<int_type, real_type>(
         static_cast<int_type>(m_s0.size()), &m_s0.front(), s, lastInterval, false, true);
-    return *lastInterval;
+    return lastInterval;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type PolyLine::findAtS(real_type & s, SegmentCursor & cursor) const {
+    Utils::search_interval<int_type, real_type>(
+        static_cast<int_type>(m_s0.size()), &m_s0.front(), s, cursor.interval, false, true);
+    return cursor.interval;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::eval(real_type s, SegmentCursor & cursor, real_type & x, real_type & y) const {
+    size_t idx = size_t(findAtS(s, cursor));
+    m_polylineList[idx].LineSegment::eval(s - m_s0[idx], x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::eval_ISO(real_type s, real_type offs, SegmentCursor & cursor, real_type & x, real_type & y) const {
+    size_t idx = size_t(findAtS(s, cursor));
+    m_polylineList[idx].LineSegment::eval_ISO(s - m_s0[idx], offs, x, y);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::evaluate(
+      real_type s, SegmentCursor & cursor, real_type & th, real_type & k, real_type & x, real_type & y) const {
+    size_t              idx = size_t(findAtS(s, cursor));
+    LineSegment const & LS  = m_polylineList[idx];
+    LS.LineSegment::eval(s - m_s0[idx], x, y);
+    th = LS.m_theta0;
+    k  = 0;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -140,9 +167,7 @@ namespace G2lib {
   void PolyLine::init() {
     m_s0.clear();
     m_polylineList.clear();
-    this->resetLastInterval();
-    m_aabb_done = false;
-    this->resetLastInterval();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -190,8 +215,9 @@ namespace G2lib {
   void PolyLine::bbox(real_type & xmin, real_type & ymin, real_type & xmax, real_type & ymax) const {
     G2LIB_UTILS_ASSERT0(!m_polylineList.empty(), "PolyLine::bbox, empty list\n");
 
-    if (m_aabb_done) {
-      m_aabb_tree.bbox(xmin, ymin, xmax, ymax);
+    shared_ptr<AABBtree const> aabb = m_aabb.load();
+    if (aabb != nullptr) {
+      aabb->bbox(xmin, ymin, xmax, ymax);
     } else {
       vector<LineSegment>::const_iterator ic = m_polylineList.begin();
       xmin = xmax = ic->x_begin();
@@ -282,6 +308,49 @@ namespace G2lib {
 
   real_type PolyLine::theta_DDD(real_type) const { return 0; }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::eval(int_type n, real_type const * s, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, false, true);
+      size_t idx = size_t(lastInterval);
+      m_polylineList[idx].LineSegment::eval(si - m_s0[idx], x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::eval_ISO(int_type n, real_type const * s, real_type offs, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, false, true);
+      size_t idx = size_t(lastInterval);
+      m_polylineList[idx].LineSegment::eval_ISO(si - m_s0[idx], offs, x[i], y[i]);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::evaluate(
+      int_type n, real_type const * s, real_type * th, real_type * k, real_type * x, real_type * y) const {
+    int_type & lastInterval = Utils::last_interval_hint(this);
+    int_type   ns           = static_cast<int_type>(m_s0.size());
+    for (int_type i = 0; i < n; ++i) {
+      real_type si = s[i];
+      Utils::search_interval<int_type, real_type>(ns, &m_s0.front(), si, lastInterval, false, true);
+      size_t              idx = size_t(lastInterval);
+      LineSegment const & LS  = m_polylineList[idx];
+      LS.LineSegment::eval(si - m_s0[idx], x[i], y[i]);
+      th[i] = LS.m_theta0;
+      k[i]  = 0;
+    }
+  }
+
   /*\
    |  _                        __
    | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -356,7 +425,6 @@ namespace G2lib {
     size_t k                         = 0;
     for (; ic != m_polylineList.end(); ++ic, ++k)
       m_s0[k + 1] = m_s0[k] + ic->length();
-    this->resetLastInterval();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -435,13 +503,25 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  shared_ptr<AABBtree const> PolyLine::build_AABBtree() const {
+    return Utils::lazy_publish(
+        m_aabb, this, [](AABBtree const & T) { return T.wide() == aabb_wide_nodes; },
+        [this]() {
+          auto aabb = make_shared<AABBtree>();
+          this->build_AABBtree(*aabb);
+          return shared_ptr<AABBtree const>(aabb);
+        });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   void PolyLine::init(real_type x0, real_type y0) {
     m_xe = x0;
     m_ye = y0;
     m_polylineList.clear();
     m_s0.clear();
     m_s0.push_back(0);
-    m_aabb_done = false;
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -452,9 +532,9 @@ namespace G2lib {
     m_polylineList.push_back(s);
     real_type slast = m_s0.back() + s.length();
     m_s0.push_back(slast);
-    m_xe        = x;
-    m_ye        = y;
-    m_aabb_done = false;
+    m_xe = x;
+    m_ye = y;
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -465,9 +545,9 @@ namespace G2lib {
     S.change_origin(m_xe, m_ye);
     real_type slast = m_s0.back() + S.length();
     m_s0.push_back(slast);
-    m_xe        = S.x_end();
-    m_ye        = S.y_end();
-    m_aabb_done = false;
+    m_xe = S.x_end();
+    m_ye = S.y_end();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -482,9 +562,9 @@ namespace G2lib {
       push_back(tx + C.X(s), ty + C.Y(s));
     }
     push_back(tx + C.x_end(), ty + C.y_end());
-    m_xe        = tx + C.x_end();
-    m_ye        = ty + C.y_end();
-    m_aabb_done = false;
+    m_xe = tx + C.x_end();
+    m_ye = ty + C.y_end();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -510,9 +590,9 @@ namespace G2lib {
       push_back(tx + C1.X(s), ty + C1.Y(s));
     }
     push_back(tx + C1.x_end(), ty + C1.y_end());
-    m_xe        = tx + C1.x_end();
-    m_ye        = ty + C1.y_end();
-    m_aabb_done = false;
+    m_xe = tx + C1.x_end();
+    m_ye = ty + C1.y_end();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -533,9 +613,9 @@ namespace G2lib {
     }
 
     push_back(tx + C.x_end(), ty + C.y_end());
-    m_xe        = tx + C.x_end();
-    m_ye        = ty + C.y_end();
-    m_aabb_done = false;
+    m_xe = tx + C.x_end();
+    m_ye = ty + C.y_end();
+    m_aabb.clear();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -543,7 +623,7 @@ namespace G2lib {
   void PolyLine::push_back(ClothoidList const & L, real_type tol) {
     int_type ns = L.num_segments();
     for (int_type idx = 0; idx < ns; ++idx) {
-      ClothoidCurve const & C = L.get(idx);
+      ClothoidCurve C = L.segment(idx);
       push_back(C, tol);
     }
     // aabb_done = false;
@@ -636,6 +716,39 @@ namespace G2lib {
     G2LIB_UTILS_ERROR("PolyLine::closest_point_ISO( ... offs ... ) not available!\n");
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::query_radius(real_type qx, real_type qy, real_type r, vector<SegmentDistance> & out) const {
+    out.clear();
+    shared_ptr<AABBtree const> aabb = this->build_AABBtree();
+    aabb->visit_near(qx, qy, r, [&](AABBtree::PtrBBox const & box, real_type) {
+      int_type  ipos = box->Ipos();
+      real_type xx, yy, ss, tt, dst;
+      m_polylineList[size_t(ipos)].closest_point_ISO(qx, qy, xx, yy, ss, tt, dst);
+      if (dst <= r)
+        out.push_back(SegmentDistance{ipos, ss + m_s0[size_t(ipos)], dst});
+      return r;
+    });
+    Utils::unique_segments(out);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::knn(real_type qx, real_type qy, int_type k, vector<SegmentDistance> & out) const {
+    out.clear();
+    if (k <= 0)
+      return;
+    size_t                     kk   = size_t(k);
+    shared_ptr<AABBtree const> aabb = this->build_AABBtree();
+    aabb->visit_near(qx, qy, std::numeric_limits<real_type>::infinity(), [&](AABBtree::PtrBBox const & box, real_type) {
+      int_type  ipos = box->Ipos();
+      real_type xx, yy, ss, tt, dst;
+      m_polylineList[size_t(ipos)].closest_point_ISO(qx, qy, xx, yy, ss, tt, dst);
+      return Utils::knn_insert(out, kk, SegmentDistance{ipos, ss + m_s0[size_t(ipos)], dst});
+    });
+    Utils::knn_sort(out);
+  }
+
   /*\
    |             _ _ _     _
    |    ___ ___ | | (_)___(_) ___  _ __
@@ -645,10 +758,10 @@ namespace G2lib {
   \*/
 
   bool PolyLine::collision(PolyLine const & C) const {
-    this->build_AABBtree();
-    C.build_AABBtree();
-    Collision_list fun(this, &C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    shared_ptr<AABBtree const> aabb1 = this->build_AABBtree();
+    shared_ptr<AABBtree const> aabb2 = C.build_AABBtree();
+    Collision_list             fun(this, &C);
+    return aabb1->collision(*aabb2, fun, false);
   }
 
   bool PolyLine::collision_ISO(real_type offs, PolyLine const & CL, real_type offs_CL) const {
@@ -670,14 +783,11 @@ namespace G2lib {
     G2LIB_UTILS_ASSERT(!pl.m_polylineList.empty(), "PolyLine::intersect, empty secondary list\n");
 
 #if 1
-    build_AABBtree();
-    pl.build_AABBtree();
-    AABBtree::VecPairPtrBBox intersectionList;
-    m_aabb_tree.intersect(pl.m_aabb_tree, intersectionList);
-    AABBtree::VecPairPtrBBox::const_iterator ip;
-    for (ip = intersectionList.begin(); ip != intersectionList.end(); ++ip) {
-      size_t ipos0 = size_t(ip->first->Ipos());
-      size_t ipos1 = size_t(ip->second->Ipos());
+    shared_ptr<AABBtree const> aabb1 = build_AABBtree();
+    shared_ptr<AABBtree const> aabb2 = pl.build_AABBtree();
+    aabb1->intersect_visit(*aabb2, [&](AABBtree::PtrBBox const & bb0, AABBtree::PtrBBox const & bb1) {
+      size_t ipos0 = size_t(bb0->Ipos());
+      size_t ipos1 = size_t(bb1->Ipos());
       G2LIB_UTILS_ASSERT(ipos0 < m_polylineList.size(), "Bad ipos0 = %d\n", ipos0);
       G2LIB_UTILS_ASSERT(ipos1 < pl.m_polylineList.size(), "Bad ipos1 = %d\n", ipos1);
       real_type sss0, sss1;
@@ -686,7 +796,7 @@ namespace G2lib {
         ss0.push_back(sss0 + m_s0[ipos0]);
         ss1.push_back(sss1 + pl.m_s0[ipos1]);
       }
-    }
+    });
 
 #else
     ss0.clear();
@@ -85,27 +85,35 @@
 
 #include <functional>
 #include <algorithm>
+#include <limits>
 
 namespace G2lib {
 
+  using std::abs;
+  using std::cos;
+  using std::hypot;
   using std::max;
   using std::min;
+  using std::sin;
+  using std::sqrt;
   using std::swap;
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
-  static inline real_type orient_2d(real_type const a[2], real_type const b[2], real_type const c[2]) {
+  template <typename T>
+  static inline T orient_2d(T const a[2], T const b[2], T const c[2]) {
     return (a[0] - c[0]) * (b[1] - c[1]) - (a[1] - c[1]) * (b[0] - c[0]);
   }
 
+  template <typename T>
   static inline bool intersection_test_vertex(
-      real_type const P1[2],
-      real_type const Q1[2],
-      real_type const R1[2],
+      T const P1[2],
+      T const Q1[2],
+      T const R1[2],
       // - - - - - - - - - -
-      real_type const P2[2],
-      real_type const Q2[2],
-      real_type const R2[2]) {
+      T const P2[2],
+      T const Q2[2],
+      T const R2[2]) {
     if (orient_2d(R2, P2, Q1) >= 0) {
       if (orient_2d(R2, Q2, Q1) <= 0) {
         if (orient_2d(P1, P2, Q1) > 0) {
@@ -131,12 +139,8 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  static inline bool intersection_test_edge(
-      real_type const P1[2],
-      real_type const Q1[2],
-      real_type const R1[2],
-      real_type const P2[2],
-      real_type const R2[2]) {
+  template <typename T>
+  static inline bool intersection_test_edge(T const P1[2], T const Q1[2], T const R1[2], T const P2[2], T const R2[2]) {
     if (orient_2d(R2, P2, Q1) >= 0) {
       if (orient_2d(P1, P2, Q1) >= 0) {
         return orient_2d(P1, Q1, R2) >= 0;
@@ -151,13 +155,9 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  template <typename T>
   static inline bool tri_tri_intersection_2d(
-      real_type const p1[2],
-      real_type const q1[2],
-      real_type const r1[2],
-      real_type const p2[2],
-      real_type const q2[2],
-      real_type const r2[2]) {
+      T const p1[2], T const q1[2], T const r1[2], T const p2[2], T const q2[2], T const r2[2]) {
     if (orient_2d(p2, q2, p1) >= 0) {
       if (orient_2d(q2, r2, p1) >= 0) {
         return orient_2d(r2, p2, p1) >= 0 || intersection_test_edge(p1, q1, r1, p2, r2);
@@ -181,13 +181,9 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  template <typename T>
   static inline bool tri_tri_overlap_test_2d(
-      real_type const p1[2],
-      real_type const q1[2],
-      real_type const r1[2],
-      real_type const p2[2],
-      real_type const q2[2],
-      real_type const r2[2]) {
+      T const p1[2], T const q1[2], T const r1[2], T const p2[2], T const q2[2], T const r2[2]) {
     if (orient_2d(p1, q1, r1) < 0) {
       if (orient_2d(p2, q2, r2) < 0)
         return tri_tri_intersection_2d(p1, r1, q1, p2, r2, q2);
@@ -205,16 +201,17 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void Triangle2D::rotate(real_type angle, real_type cx, real_type cy) {
-    real_type C = cos(angle);
-    real_type S = sin(angle);
+  template <typename T>
+  void Triangle2DT<T>::rotate(T angle, T cx, T cy) {
+    T C = cos(angle);
+    T S = sin(angle);
 
-    real_type dx  = m_p1[0] - cx;
-    real_type dy  = m_p1[1] - cy;
-    real_type ndx = C * dx - S * dy;
-    real_type ndy = C * dy + S * dx;
-    m_p1[0]       = cx + ndx;
-    m_p1[1]       = cy + ndy;
+    T dx    = m_p1[0] - cx;
+    T dy    = m_p1[1] - cy;
+    T ndx   = C * dx - S * dy;
+    T ndy   = C * dy + S * dx;
+    m_p1[0] = cx + ndx;
+    m_p1[1] = cy + ndy;
 
     dx      = m_p2[0] - cx;
     dy      = m_p2[1] - cy;
@@ -233,36 +230,42 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void Triangle2D::bbox(real_type & xmin, real_type & ymin, real_type & xmax, real_type & ymax) const {
+  template <typename T>
+  void Triangle2DT<T>::bbox(T & xmin, T & ymin, T & xmax, T & ymax) const {
     minmax3(m_p1[0], m_p2[0], m_p3[0], xmin, xmax);
     minmax3(m_p1[1], m_p2[1], m_p3[1], ymin, ymax);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  bool Triangle2D::overlap(Triangle2D const & t2) const {
+  template <typename T>
+  bool Triangle2DT<T>::overlap(Triangle2DT const & t2) const {
     return tri_tri_overlap_test_2d(m_p1, m_p2, m_p3, t2.m_p1, t2.m_p2, t2.m_p3);
   }
 
-  int_type Triangle2D::isInside(real_type x, real_type y) const {
-    real_type const pt[2] = { x, y };
+  template <typename T>
+  int_type Triangle2DT<T>::isInside(T x, T y) const {
+    T const pt[2] = { x, y };
     return isPointInTriangle(pt, m_p1, m_p2, m_p3);
   }
 
-  int_type Triangle2D::isInside(real_type const pt[2]) const { 
+  template <typename T>
+  int_type Triangle2DT<T>::isInside(T const pt[2]) const { 
     return isPointInTriangle(pt, m_p1, m_p2, m_p3); 
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  int_type Triangle2D::isCounterClockwise() const { return G2lib::isCounterClockwise(m_p1, m_p2, m_p3); }
+  template <typename T>
+  int_type Triangle2DT<T>::isCounterClockwise() const { return G2lib::isCounterClockwise(m_p1, m_p2, m_p3); }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  real_type Triangle2D::distMax(real_type x, real_type y) const {
-    real_type d1 = hypot(x - m_p1[0], y - m_p1[1]);
-    real_type d2 = hypot(x - m_p2[0], y - m_p2[1]);
-    real_type d3 = hypot(x - m_p3[0], y - m_p3[1]);
+  template <typename T>
+  T Triangle2DT<T>::distMax(T x, T y) const {
+    T d1 = hypot(x - m_p1[0], y - m_p1[1]);
+    T d2 = hypot(x - m_p2[0], y - m_p2[1]);
+    T d3 = hypot(x - m_p3[0], y - m_p3[1]);
     return max(d1, max(d2, d3));
   }
 
@@ -270,35 +273,37 @@ namespace G2lib {
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
-  static real_type distSeg(real_type x, real_type y, real_type const * A, real_type const * B) {
-    real_type dx  = x - A[0];
-    real_type dy  = y - A[1];
-    real_type dx1 = B[0] - A[0];
-    real_type dy1 = B[1] - A[1];
+  template <typename T>
+  static T distSeg(T x, T y, T const * A, T const * B) {
+    T dx  = x - A[0];
+    T dy  = y - A[1];
+    T dx1 = B[0] - A[0];
+    T dy1 = B[1] - A[1];
 
     // < P-A - s*(B-A), B-A> = 0
     // <P-A, B-A> = s <B-A,B-A>
 
-    real_type tmp = dx * dx1 + dy * dy1;
+    T tmp = dx * dx1 + dy * dy1;
 
     if (tmp < 0)
       return hypot(dx, dy);
 
-    real_type tmp2 = dx1 * dx1 + dy1 * dy1;
+    T tmp2 = dx1 * dx1 + dy1 * dy1;
 
     if (tmp > tmp2)
       return hypot(x - B[0], y - B[1]);
 
-    real_type S = tmp / tmp2;
-    real_type X = A[0] + S * dx1;
-    real_type Y = A[1] + S * dy1;
+    T S = tmp / tmp2;
+    T X = A[0] + S * dx1;
+    T Y = A[1] + S * dy1;
 
     return hypot(x - X, y - Y);
   }
 
 #endif
 
-  real_type Triangle2D::distMin(real_type x, real_type y) const {
+  template <typename T>
+  T Triangle2DT<T>::distMin(T x, T y) const {
     int_type in = isInside(x, y);
     if (in >= 0)
       return 0;
@@ -309,13 +314,13 @@ namespace G2lib {
     L2.build_2P( p2, p3 );
     L3.build_2P( p3, p1 );
 
-    real_type d1 = L1.distance( x, y );
-    real_type d2 = L2.distance( x, y );
-    real_type d3 = L3.distance( x, y );
+    T d1 = L1.distance( x, y );
+    T d2 = L2.distance( x, y );
+    T d3 = L3.distance( x, y );
 #else
-    real_type d1 = distSeg(x, y, m_p1, m_p2);
-    real_type d2 = distSeg(x, y, m_p2, m_p3);
-    real_type d3 = distSeg(x, y, m_p3, m_p1);
+    T d1 = distSeg(x, y, m_p1, m_p2);
+    T d2 = distSeg(x, y, m_p2, m_p3);
+    T d3 = distSeg(x, y, m_p3, m_p1);
 #endif
 
     if (d1 > d2)
@@ -325,18 +330,280 @@ namespace G2lib {
     return d1;
   }
 
+  /*\
+   |   ____          _
+   |  / ___|  ___   / \
+   |  \___ \ / _ \ / _ \
+   |   ___) | (_) / ___ \
+   |  |____/ \___/_/   \_\
+  \*/
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+  // tolerance of the tests: the rounding of the distances from the edges
+  template <typename T>
+  static T coord_tol(T const x[4], T const y[4]) {
+    T m = 1;
+    for (int_type i = 0; i < 4; ++i)
+      m = max(m, max(abs(x[i]), abs(y[i])));
+    return 1000 * std::numeric_limits<T>::epsilon() * m;
+  }
+
+  //
+  // Vertices of the triangle `tri` clipped with the line parallel to the side
+  // P1-P3 at distance `height` towards P2: (P1, Q0, Q1, P3) with Q0 on the
+  // side P1-P2 and Q1 on P2-P3, Q0 = Q1 = P2 when it is not clipped.
+  //
+  template <typename T>
+  static void clipped_vertices(Triangle2DT<T> const & tri, T height, T x[4], T y[4]) {
+    x[0]  = tri.x1();
+    y[0]  = tri.y1();
+    x[1]  = x[2] = tri.x2();
+    y[1]  = y[2] = tri.y2();
+    x[3]  = tri.x3();
+    y[3]  = tri.y3();
+    T dx  = x[3] - x[0];
+    T dy  = y[3] - y[0];
+    T len = hypot(dx, dy);
+    T H   = len > 0 ? abs(dx * (y[1] - y[0]) - dy * (x[1] - x[0])) / len : 0;
+    if (height >= 0 && height < H) {
+      T t  = height / H;
+      x[1] = x[0] + t * (tri.x2() - x[0]);
+      y[1] = y[0] + t * (tri.y2() - y[0]);
+      x[2] = x[3] + t * (tri.x2() - x[3]);
+      y[2] = y[3] + t * (tri.y2() - y[3]);
+    }
+  }
+
+  //
+  // Outward unit normals and offsets of the edges of the convex polygon
+  // `(x,y)`. The edges of a degenerate polygon go forth and back along a
+  // line, so the normals of both sides are there. The normal of a very
+  // short edge (or of an edge of a polygon with an orientation lost in the
+  // rounding) can point anywhere: an edge which does not leave the whole
+  // polygon on its inner side within `tol` is dropped and takes the plane
+  // of a kept edge, so that it never separates nor counts as a border.
+  //
+  template <typename T>
+  static void edge_planes(T const x[4], T const y[4], T tol, T nx[4], T ny[4], T c[4]) {
+    T area = (x[2] - x[0]) * (y[3] - y[1]) - (y[2] - y[0]) * (x[3] - x[1]);
+    T sgn  = area < 0 ? -1 : 1;
+    for (int_type e = 0; e < 4; ++e) {
+      int_type b   = (e + 1) % 4;
+      T        dx  = x[b] - x[e];
+      T        dy  = y[b] - y[e];
+      T        len = hypot(dx, dy);
+      nx[e]        = len > 0 ? sgn * dy / len : 0;
+      ny[e]        = len > 0 ? -sgn * dx / len : 0;
+      c[e]         = nx[e] * x[e] + ny[e] * y[e];
+      T        out = nx[e] * x[0] + ny[e] * y[0] - c[e];
+      for (int_type i = 1; i < 4; ++i)
+        out = max(out, nx[e] * x[i] + ny[e] * y[i] - c[e]);
+      if (out > tol || len <= 0)
+        nx[e] = ny[e] = c[e] = 0;
+    }
+    for (int_type e = 0; e < 4; ++e) {
+      if (nx[e] != 0 || ny[e] != 0)
+        continue;
+      for (int_type f = 1; f < 4; ++f) {
+        int_type b = (e + f) % 4;
+        if (nx[b] != 0 || ny[b] != 0) {
+          nx[e] = nx[b];
+          ny[e] = ny[b];
+          c[e]  = c[b];
+          break;
+        }
+      }
+    }
+  }
+
+#endif
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void Triangle2DSoAT<T>::clear() {
+    for (int_type i = 0; i < 4; ++i) {
+      m_x[i].clear();
+      m_y[i].clear();
+      m_nx[i].clear();
+      m_ny[i].clear();
+      m_c[i].clear();
+    }
+    m_tol = 0;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void Triangle2DSoAT<T>::reserve(size_t n) {
+    for (int_type i = 0; i < 4; ++i) {
+      m_x[i].reserve(n);
+      m_y[i].reserve(n);
+      m_nx[i].reserve(n);
+      m_ny[i].reserve(n);
+      m_c[i].reserve(n);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  void Triangle2DSoAT<T>::push_back(Triangle2DT<T> const & tri, T height) {
+    T x[4], y[4], nx[4], ny[4], c[4];
+    clipped_vertices(tri, height, x, y);
+    T tol = coord_tol(x, y);
+    edge_planes(x, y, tol, nx, ny, c);
+    for (int_type i = 0; i < 4; ++i) {
+      m_x[i].push_back(x[i]);
+      m_y[i].push_back(y[i]);
+      m_nx[i].push_back(nx[i]);
+      m_ny[i].push_back(ny[i]);
+      m_c[i].push_back(c[i]);
+    }
+    m_tol = max(m_tol, tol);
+  }
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  ostream_type & operator<<(ostream_type & stream, Triangle2D const & t) {
+  template <typename T>
+  int_type Triangle2DSoAT<T>::overlap(Triangle2DT<T> const & tri, size_t i0, size_t n, int_type hit[]) const {
+    T P[20];
+    clipped_vertices(tri, T(-1), P, P + 4);
+    T tol = coord_tol(P, P + 4);
+    edge_planes(P, P + 4, tol, P + 8, P + 12, P + 16);
+    return overlap_range(P, max(m_tol, tol), i0, n, hit);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  int_type Triangle2DSoAT<T>::overlap(Triangle2DSoAT const & S, size_t i, size_t i0, size_t n, int_type hit[]) const {
+    T P[20];
+    for (int_type v = 0; v < 4; ++v) {
+      P[v]      = S.m_x[v][i];
+      P[4 + v]  = S.m_y[v][i];
+      P[8 + v]  = S.m_nx[v][i];
+      P[12 + v] = S.m_ny[v][i];
+      P[16 + v] = S.m_c[v][i];
+    }
+    return overlap_range(P, max(m_tol, S.m_tol), i0, n, hit);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // Separating axis test: two convex polygons are disjoint if and only if
+  // all the vertices of one of them are outside an edge of the other one.
+  //
+  template <typename T>
+  G2LIB_TARGET_CLONES
+  int_type Triangle2DSoAT<T>::overlap_range(T const P[], T tol, size_t i0, size_t n, int_type hit[]) const {
+    if (n == 0)
+      return 0;
+    T const * x  = P;
+    T const * y  = P + 4;
+    T const * nx = P + 8;
+    T const * ny = P + 12;
+    T const * c  = P + 16;
+
+    T const * X[4]  = {&m_x[0][i0], &m_x[1][i0], &m_x[2][i0], &m_x[3][i0]};
+    T const * Y[4]  = {&m_y[0][i0], &m_y[1][i0], &m_y[2][i0], &m_y[3][i0]};
+    T const * NX[4] = {&m_nx[0][i0], &m_nx[1][i0], &m_nx[2][i0], &m_nx[3][i0]};
+    T const * NY[4] = {&m_ny[0][i0], &m_ny[1][i0], &m_ny[2][i0], &m_ny[3][i0]};
+    T const * C[4]  = {&m_c[0][i0], &m_c[1][i0], &m_c[2][i0], &m_c[3][i0]};
+
+    int_type nhit = 0;
+    for (size_t k = 0; k < n; ++k) {
+      bool sep = false;
+      for (int_type e = 0; e < 4; ++e) {
+        // the vertices of the range against the edge of P and the vertices of P against the edge of the range
+        T d = nx[e] * X[0][k] + ny[e] * Y[0][k] - c[e];
+        T f = NX[e][k] * x[0] + NY[e][k] * y[0] - C[e][k];
+        for (int_type v = 1; v < 4; ++v) {
+          d = min(d, nx[e] * X[v][k] + ny[e] * Y[v][k] - c[e]);
+          f = min(f, NX[e][k] * x[v] + NY[e][k] * y[v] - C[e][k]);
+        }
+        sep = sep | (d > tol) | (f > tol);
+      }
+      hit[k] = sep ? 0 : 1;
+      nhit += hit[k];
+    }
+    return nhit;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES
+  void Triangle2DSoAT<T>::distMin(T x, T y, size_t i0, size_t n, T d[]) const {
+    if (n == 0)
+      return;
+    T const * X[4]  = {&m_x[0][i0], &m_x[1][i0], &m_x[2][i0], &m_x[3][i0]};
+    T const * Y[4]  = {&m_y[0][i0], &m_y[1][i0], &m_y[2][i0], &m_y[3][i0]};
+    T const * NX[4] = {&m_nx[0][i0], &m_nx[1][i0], &m_nx[2][i0], &m_nx[3][i0]};
+    T const * NY[4] = {&m_ny[0][i0], &m_ny[1][i0], &m_ny[2][i0], &m_ny[3][i0]};
+    T const * C[4]  = {&m_c[0][i0], &m_c[1][i0], &m_c[2][i0], &m_c[3][i0]};
+    for (size_t k = 0; k < n; ++k) {
+      T out = -std::numeric_limits<T>::infinity();
+      T d2  = std::numeric_limits<T>::infinity();
+      for (int_type e = 0; e < 4; ++e) {
+        int_type b  = (e + 1) % 4;
+        T        ex = X[b][k] - X[e][k];
+        T        ey = Y[b][k] - Y[e][k];
+        T        px = x - X[e][k];
+        T        py = y - Y[e][k];
+        // projection on the edge clamped to its end points (a null edge gives 0)
+        T ee = max(ex * ex + ey * ey, std::numeric_limits<T>::min());
+        T t  = min(max((px * ex + py * ey) / ee, T(0)), T(1));
+        T qx = px - t * ex;
+        T qy = py - t * ey;
+        d2   = min(d2, qx * qx + qy * qy);
+        out  = max(out, NX[e][k] * x + NY[e][k] * y - C[e][k]);
+      }
+      d[k] = out <= m_tol ? 0 : sqrt(d2);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  G2LIB_TARGET_CLONES
+  void Triangle2DSoAT<T>::isInside(T x, T y, size_t i0, size_t n, int_type in[]) const {
+    if (n == 0)
+      return;
+    T const * NX[4] = {&m_nx[0][i0], &m_nx[1][i0], &m_nx[2][i0], &m_nx[3][i0]};
+    T const * NY[4] = {&m_ny[0][i0], &m_ny[1][i0], &m_ny[2][i0], &m_ny[3][i0]};
+    T const * C[4]  = {&m_c[0][i0], &m_c[1][i0], &m_c[2][i0], &m_c[3][i0]};
+    for (size_t k = 0; k < n; ++k) {
+      T out = NX[0][k] * x + NY[0][k] * y - C[0][k];
+      for (int_type e = 1; e < 4; ++e)
+        out = max(out, NX[e][k] * x + NY[e][k] * y - C[e][k]);
+      in[k] = out < -m_tol ? 1 : (out <= m_tol ? 0 : -1);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  template <typename T>
+  ostream_type & operator<<(ostream_type & stream, Triangle2DT<T> const & t) {
     stream << Utils::format_string(
         "Triangle2D\n"
         "P0 = [%f,%f]\n"
         "P1 = [%f,%f]\n"
         "P2 = [%f,%f]\n",
-        t.m_p1[0], t.m_p1[1], t.m_p2[0], t.m_p2[1], t.m_p3[0], t.m_p3[1]);
+        t.x1(), t.y1(), t.x2(), t.y2(), t.x3(), t.y3());
     return stream;
   }
 
+  template class Triangle2DT<float>;
+  template class Triangle2DT<double>;
+  template class Triangle2DSoAT<float>;
+  template class Triangle2DSoAT<double>;
+
+  template ostream_type & operator<<(ostream_type & stream, Triangle2DT<float> const & t);
+  template ostream_type & operator<<(ostream_type & stream, Triangle2DT<double> const & t);
+
 }  // namespace G2lib
 
 ///
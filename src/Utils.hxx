@@ -30,12 +30,17 @@
 #pragma once
 #include <map>
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <thread>
 #include <mutex>
 #include <cmath>
 #include <limits>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 #include "Format.hxx"
 
@@ -45,6 +50,16 @@
 #define GLIB2_TOL_ANGLE 1e-8
 #endif
 
+// Runtime instruction set selection (GNU ifunc) for the loops of the batch
+// kernels: every function marked with it is compiled for avx512f, avx2 and
+// the baseline, and the loader picks the best one for the running CPU.
+#if defined(G2LIB_SIMD_DISPATCH) && defined(__GNUC__) && !defined(__clang__) && defined(__linux__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define G2LIB_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define G2LIB_TARGET_CLONES
+#endif
+
 namespace G2lib {
   namespace Utils {
 
@@ -54,24 +69,20 @@ namespace G2lib {
       return !(FP_INFINITE == std::fpclassify(x) || FP_NAN == std::fpclassify(x));
     }
 
-    // template<typename T_int, typename T_real>
-    // void search_interval(
-    //     T_int npts, T_real const * X, T_real & x, std::shared_ptr<T_int> lastInterval, bool closed, bool can_extend) {
-    //   int & lastInterval_ = *lastInterval;
-    //   search_interval<T_int, T_real>(npts, X, x, lastInterval, closed, can_extend);
-    // }
-
     template<typename T_int, typename T_real>
-    void search_interval(T_int npts, T_real const * X, T_real & x, std::shared_ptr<T_int> lastInterval, bool closed, bool can_extend) {
+    void search_interval(T_int npts, T_real const * X, T_real & x, T_int & lastInterval, bool closed, bool can_extend) {
       // For this implementation we must ensure a number of points greater than 1 (there
       // must be at least one interval). The number of intervals is npts - 2. The last
-      // point is in n = npts - 1;
+      // point is in n = npts - 1; lastInterval is only a hint: when out of range
+      // (e.g. a cursor used on a different curve) the search restarts from 0.
       const T_int n = npts - 1;
       G2LIB_UTILS_ASSERT(
-          npts > 1 && *lastInterval >= 0 && *lastInterval < n,
-          "In search_interval( npts=%d, X, x=%d, lastInterval=%d, closed=%d, can_extend=%d)\n"
-          "npts musrt be >= 2 and lastInterval must be in [0,npts-2]\n",
-          npts, x, *lastInterval, closed, can_extend);
+          npts > 1,
+          "In search_interval( npts=%d, X, x=%f, lastInterval=%d, closed=%d, can_extend=%d)\n"
+          "npts must be >= 2\n",
+          npts, x, lastInterval, closed, can_extend);
+      if (lastInterval < 0 || lastInterval >= n)
+        lastInterval = 0;
 
       // Handles the "closed" search, by limiting the value of x for the search inside the
       // limit of [X[0], X[n]]. This function will use fmod for detecting multiple "loops".
@@ -91,11 +102,11 @@ namespace G2lib {
             can_extend || (x >= xl && x <= xr),
             "In search_interval( npts=%d, X, x=%f, lastInterval=%d, closed=%d, can_extend=%d)\n"
             "out of range: [%f,%f]\n",
-            npts, x, *lastInterval, closed, can_extend, xl, xr);
+            npts, x, lastInterval, closed, can_extend, xl, xr);
       }
 
       // Find the interval of the support of the B-spline, using lastInterval as an hot start
-      T_real const * XL = X + *lastInterval;
+      T_real const * XL = X + lastInterval;
 
       // We must consider 3 possible scenario:
       // 1. the searched point lies on the right of the current interval
@@ -107,15 +118,15 @@ namespace G2lib {
         // 1.2: the point is in the very next interval
         // 1.3: we must search the interval of the point in the intervals next to the current one, up to last
         if (x >= X[n - 1]) {
-          *lastInterval = n - 1;
+          lastInterval = n - 1;
         } else if (x < XL[2]) {
-          ++(*lastInterval);
+          ++lastInterval;
         } else {
           T_real const * XE = X + n;
-          *lastInterval += T_int(std::lower_bound(XL, XE, x) - XL);
-          T_real const * XX = X + *lastInterval;
+          lastInterval += T_int(std::lower_bound(XL, XE, x) - XL);
+          T_real const * XX = X + lastInterval;
           if (x < XX[0] || isZero(XX[0] - XX[1]))
-            --(*lastInterval);
+            --lastInterval;
         }
       } else if (x < XL[0]) /* situation 2. */ {
         // We considers three situations in order to maximize performances:
@@ -123,22 +134,180 @@ namespace G2lib {
         // 1.2: the point is in the very next interval
         // 1.3: we must search the interval of the point in the intervals next to the current one, up to first
         if (x <= X[1]) {
-          *lastInterval = 0;
+          lastInterval = 0;
         } else if (XL[-1] <= x) {
-          --(*lastInterval);
+          --lastInterval;
         } else {
-          *lastInterval      = T_int(std::lower_bound(X + 1, XL, x) - X);
-          T_real const * XX = X + *lastInterval;
+          lastInterval      = T_int(std::lower_bound(X + 1, XL, x) - X);
+          T_real const * XX = X + lastInterval;
           if (x < XX[0] || isZero(XX[0] - XX[1]))
-            --*lastInterval;
+            --lastInterval;
         }
       } /* situation 3: Do nothing. */
       // Check the computed interval
       G2LIB_UTILS_ASSERT(
-          *lastInterval >= 0 && *lastInterval < n,
+          lastInterval >= 0 && lastInterval < n,
           "In search_interval( npts=%d, X, x=%f, lastInterval=%d, closed=%d, can_extend=%d)\n"
           "computed lastInterval of range: [%f,%f]\n",
-          npts, x, *lastInterval, closed, can_extend, xl, xr);
+          npts, x, lastInterval, closed, can_extend, xl, xr);
+    }
+
+    //
+    // Per-thread hint of the last interval found on a piecewise curve
+    // (ClothoidList, BiarcList, PolyLine). It replaces a mutex-protected
+    // map: a small direct-mapped table keyed by the curve address, private
+    // to each thread, with no lock and no allocation. A stale entry (curve
+    // destroyed, moved or modified) only costs a longer search because
+    // `search_interval` restarts from 0 on an out of range hint.
+    //
+    inline int_type & last_interval_hint(void const * owner) {
+      struct Slot {
+        void const * owner;
+        int_type     interval;
+      };
+      static thread_local Slot slots[16] = {};
+      Slot & S = slots[(reinterpret_cast<std::uintptr_t>(owner) >> 4) & 15];
+      if (S.owner != owner) {
+        S.owner    = owner;
+        S.interval = 0;
+      }
+      return S.interval;
+    }
+
+    //
+    // Lazy construction of an immutable acceleration structure stored in
+    // `slot` (a `mutable SnapshotSlot` member of the curve `owner`). Once
+    // the structure is published a reader takes no lock and gets a shared
+    // pointer, which keeps the structure alive while the reader holds it.
+    // Builders are serialized on a small pool of mutexes striped by owner
+    // address and re-check the slot under lock, so a structure is built
+    // once even when many threads miss together; `build` returns a
+    // pointer to the new structure.
+    //
+    template <typename SLOT, typename MATCH, typename BUILD>
+    inline auto lazy_publish(SLOT & slot, void const * owner, MATCH const & match, BUILD const & build)
+        -> decltype(slot.load()) {
+      auto ptr = slot.load();
+      if (ptr != nullptr && match(*ptr))
+        return ptr;
+      static std::mutex           mtx[32];
+      std::lock_guard<std::mutex> lock(mtx[(reinterpret_cast<std::uintptr_t>(owner) >> 4) & 31]);
+      ptr = slot.load();
+      if (ptr != nullptr && match(*ptr))
+        return ptr;
+      return slot.publish(build());
+    }
+
+    //
+    // 64 bit FNV-1a style hash of `n` bytes, taken 8 at a time so that it
+    // runs close to memory speed; used as checksum and as geometry key of
+    // the saved acceleration structures (not a cryptographic hash).
+    //
+    inline std::uint64_t hash_bytes(void const * data, size_t n, std::uint64_t h = 14695981039346656037ULL) {
+      std::uint64_t const   prime = 1099511628211ULL;
+      unsigned char const * p     = static_cast<unsigned char const *>(data);
+      for (; n >= 8; n -= 8, p += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * prime;
+      }
+      for (; n > 0; --n, ++p)
+        h = (h ^ *p) * prime;
+      return h;
+    }
+
+    //
+    // Run `fun(0)`, ..., `fun(n-1)` on up to `nthreads` threads (the calling
+    // one included), the first exception thrown is rethrown to the caller.
+    // The indices are handed out one at a time, so a thread that finishes
+    // its work early takes the next one: tasks of uneven cost balance out.
+    //
+    template <typename FUN>
+    inline void parallel_for(int_type nthreads, size_t n, FUN const & fun) {
+      std::atomic<size_t> next(0);
+      std::exception_ptr  error;
+      std::mutex          error_mtx;
+      auto                worker = [&]() {
+        try {
+          for (size_t k = next++; k < n; k = next++)
+            fun(k);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mtx);
+          if (!error)
+            error = std::current_exception();
+        }
+      };
+      std::vector<std::thread> pool;
+      for (int_type t = 1; t < nthreads && size_t(t) < n; ++t)
+        pool.emplace_back(worker);
+      worker();
+      for (std::thread & th : pool)
+        th.join();
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+    //
+    // Number of threads for a setting where 0 means all the cores.
+    //
+    inline int_type num_threads(int_type nthreads) {
+      if (nthreads > 0)
+        return nthreads;
+      int_type ncores = int_type(std::thread::hardware_concurrency());
+      return ncores > 0 ? ncores : 1;
+    }
+
+    //
+    // Collection of the results of the radius and k-nearest queries of the
+    // piecewise curves; an entry `E` has the fields `segment` and `dst`.
+    // A segment is covered by several boxes, so the same segment may be
+    // found more than once and only its nearest entry is kept.
+    //
+
+    // keep the nearest entry of every segment, sorted by increasing distance
+    template <typename E>
+    inline void unique_segments(std::vector<E> & out) {
+      std::sort(out.begin(), out.end(), [](E const & a, E const & b) {
+        return a.segment < b.segment || (a.segment == b.segment && a.dst < b.dst);
+      });
+      out.erase(
+          std::unique(out.begin(), out.end(), [](E const & a, E const & b) { return a.segment == b.segment; }),
+          out.end());
+      std::stable_sort(out.begin(), out.end(), [](E const & a, E const & b) { return a.dst < b.dst; });
+    }
+
+    // radius of the search of the `k` nearest segments collected in `heap`
+    template <typename E>
+    inline real_type knn_radius(std::vector<E> const & heap, size_t k) {
+      return heap.size() < k ? std::numeric_limits<real_type>::infinity() : heap.front().dst;
+    }
+
+    // add `e` to `heap`, a max-heap on `dst` with the `k` nearest segments
+    // (one entry each), and return the radius for the rest of the search
+    template <typename E>
+    inline real_type knn_insert(std::vector<E> & heap, size_t k, E const & e) {
+      auto nearer = [](E const & a, E const & b) { return a.dst < b.dst; };
+      auto it     = std::find_if(heap.begin(), heap.end(), [&e](E const & a) { return a.segment == e.segment; });
+      if (it != heap.end()) {
+        if (e.dst < it->dst) {
+          *it = e;
+          std::make_heap(heap.begin(), heap.end(), nearer);
+        }
+      } else if (heap.size() < k) {
+        heap.push_back(e);
+        std::push_heap(heap.begin(), heap.end(), nearer);
+      } else if (e.dst < heap.front().dst) {
+        std::pop_heap(heap.begin(), heap.end(), nearer);
+        heap.back() = e;
+        std::push_heap(heap.begin(), heap.end(), nearer);
+      }
+      return knn_radius(heap, k);
+    }
+
+    // sort by increasing distance the entries collected by `knn_insert`
+    template <typename E>
+    inline void knn_sort(std::vector<E> & heap) {
+      std::sort_heap(heap.begin(), heap.end(), [](E const & a, E const & b) { return a.dst < b.dst; });
     }
 
   }  // namespace Utils
@@ -527,7 +527,7 @@ namespace G2lib {
         :rtype: float
       )S")
       
-      .def("build_AABBtree_ISO", &BiarcList::build_AABBtree_ISO,
+      .def("build_AABBtree_ISO", &BiarcList::prepare,
         py::arg("offs"), py::arg("max_angle") = Utils::m_pi/6, py::arg("max_size") = 1e100,
       R"S(
         Build the internal AABB tree of the biarc list with offset (ISO)
@@ -539,7 +539,9 @@ namespace G2lib {
         :rtype: NoneType
       )S")
       
-      .def("build_AABBtree_SAE", &BiarcList::build_AABBtree_SAE,
+      .def("build_AABBtree_SAE", [](BiarcList const & self, real_type offs, real_type max_angle, real_type max_size) {
+        self.prepare(-offs, max_angle, max_size);
+      },
         py::arg("offs"), py::arg("max_angle") = Utils::m_pi/6, py::arg("max_size") = 1e100,
       R"S(
         Build the internal AABB tree of the biarc list with offset (SAE)
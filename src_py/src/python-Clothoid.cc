@@ -440,7 +440,7 @@ namespace G2lib {
         :rtype: NoneType
       )S")
       
-      .def("build_AABBtree_ISO", &ClothoidCurve::build_AABBtree_ISO,
+      .def("build_AABBtree_ISO", &ClothoidCurve::prepare,
         py::arg("offs"), py::arg("max_angle"), py::arg("max_size"),
       R"S(
         Builds the AABB tree of the current curve. Uses ISO reference 
@@ -1238,7 +1238,7 @@ namespace G2lib {
         :rtype: Tuple[int, float, float, float, float, float, int]
       )S")
 
-      .def("build_AABBtree_ISO", &ClothoidList::build_AABBtree_ISO,
+      .def("build_AABBtree_ISO", &ClothoidList::prepare,
         py::arg("offs"), py::arg("max_angle") = Utils::m_pi/6, py::arg("max_size") = 1e100,
       R"S(
         Build the internal AABB tree of the clothoid list with offset (ISO)
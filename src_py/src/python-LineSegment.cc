@@ -512,7 +512,7 @@ namespace G2lib {
           :rtype: AABBtree
         )S")
 
-        .def("build_AABBtree", py::overload_cast<>(&PolyLine::build_AABBtree, py::const_),
+        .def("build_AABBtree", &PolyLine::prepare,
         R"S(
           Builds an AABB tree on the current poly line
 
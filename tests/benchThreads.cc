@@ -0,0 +1,185 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+//
+// Scaling with the number of threads of the parallel parts of the library,
+// on a track of 4000 segments (straights and hairpins) and a shifted copy:
+//
+//   - evaluation of a ClothoidList from concurrent threads, with the
+//     default segment lookup and with a caller-owned cursor
+//   - AABB tree build (`AABBtree::set_build_threads`)
+//   - dual tree traversal (`AABBtree::intersect_parallel`)
+//   - intersection of two clothoid lists (`threadsIntersectAABBtree`)
+//
+// Usage: benchThreads [max threads] (default: all the cores)
+//
+
+// keeps the evaluations from being optimized away
+static volatile real_type sink = 0;
+
+// best of `nrep` runs of `fun`, in ms
+template <typename FUN>
+static
+real_type
+best_time( int_type nrep, FUN const & fun ) {
+  real_type best = numeric_limits<real_type>::infinity();
+  for ( int_type r = 0; r < nrep; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, chrono::duration<real_type,milli>(t1-t0).count() );
+  }
+  return best;
+}
+
+// run `fun(t)` on `nt` threads
+template <typename FUN>
+static
+void
+on_threads( int_type nt, FUN const & fun ) {
+  vector<thread> pool;
+  for ( int_type t = 1; t < nt; ++t ) pool.emplace_back( fun, t );
+  fun( 0 );
+  for ( thread & th : pool ) th.join();
+}
+
+static
+void
+row( char const * what, int_type nt, real_type ms, real_type ms1 ) {
+  cout
+    << setw(28) << left << what << right
+    << " threads = " << setw(3) << nt
+    << setw(12) << fixed << setprecision(3) << ms << " ms"
+    << "  speedup " << setprecision(2) << ms1/ms << '\n';
+}
+
+int
+main( int argc, char const * argv[] ) {
+
+  int_type max_threads = argc > 1 ? int_type(atoi(argv[1])) : int_type(thread::hardware_concurrency());
+  if ( max_threads < 1 ) max_threads = 1;
+  vector<int_type> threads;
+  for ( int_type nt = 1; nt < max_threads; nt *= 2 ) threads.push_back( nt );
+  threads.push_back( max_threads );
+
+  G2lib::ClothoidList track;
+  track.init();
+  track.push_back( 0, 0, 0, 0, 0, 1 );
+  mt19937 gen(1);
+  uniform_real_distribution<real_type> U(0,1);
+  for ( int i = 0; i < 4000; ++i ) {
+    if ( i % 3 == 0 ) track.push_back( 0, 0, 200+800*U(gen) );   // straight
+    else              track.push_back( (U(gen)-0.5)*0.4, 0, 5+20*U(gen) ); // hairpin
+  }
+  G2lib::ClothoidList lane(track);
+  lane.translate( 3, -2 );
+
+  // concurrent evaluation: every thread evaluates the same number of random points
+  {
+    int_type const    npts = 200000;
+    vector<real_type> s(npts);
+    for ( real_type & si : s ) si = track.length()*U(gen);
+    real_type ms1 = 0, msc1 = 0;
+    for ( int_type nt : threads ) {
+      real_type ms = best_time( 3, [&]() {
+        on_threads( nt, [&]( int_type ) {
+          real_type x, y, sx = 0;
+          for ( real_type si : s ) { track.eval( si, x, y ); sx += x; }
+          sink = sx;
+        } );
+      } );
+      real_type msc = best_time( 3, [&]() {
+        on_threads( nt, [&]( int_type ) {
+          G2lib::SegmentCursor cursor;
+          real_type x, y, sx = 0;
+          for ( real_type si : s ) { track.eval( si, cursor, x, y ); sx += x; }
+          sink = sx;
+        } );
+      } );
+      if ( nt == 1 ) { ms1 = ms; msc1 = msc; }
+      // equal work per thread: the ideal time is constant, the speedup is nt*ms1/ms
+      row( "eval", nt, ms, nt*ms1 );
+      row( "eval with cursor", nt, msc, nt*msc1 );
+    }
+  }
+
+  // triangles of the track and of the lane
+  vector<G2lib::Triangle2D> tri, tri2;
+  track.bbTriangles_ISO( 0, tri, G2lib::Utils::m_pi/18, 1e100 );
+  lane.bbTriangles_ISO( 1.75, tri2, G2lib::Utils::m_pi/18, 1e100 );
+  vector<G2lib::BBox::PtrBBox> boxes, boxes2;
+  for ( size_t i = 0; i < tri.size(); ++i ) {
+    real_type xmin, ymin, xmax, ymax;
+    tri[i].bbox( xmin, ymin, xmax, ymax );
+    boxes.push_back( make_shared<G2lib::BBox const>( xmin, ymin, xmax, ymax, 0, int_type(i) ) );
+  }
+  for ( size_t i = 0; i < tri2.size(); ++i ) {
+    real_type xmin, ymin, xmax, ymax;
+    tri2[i].bbox( xmin, ymin, xmax, ymax );
+    boxes2.push_back( make_shared<G2lib::BBox const>( xmin, ymin, xmax, ymax, 0, int_type(i) ) );
+  }
+  cout << "\ntriangles = " << tri.size() << " and " << tri2.size() << '\n';
+
+  // tree build (same tree for all the numbers of threads)
+  {
+    real_type ms1 = 0;
+    for ( int_type nt : threads ) {
+      G2lib::AABBtree T;
+      T.set_build( G2lib::G2LIB_AABB_BINNED_SAH, 4 );
+      T.set_build_threads( nt );
+      real_type ms = best_time( 5, [&]() { T.build( boxes ); } );
+      if ( nt == 1 ) ms1 = ms;
+      row( "AABBtree::build", nt, ms, ms1 );
+    }
+  }
+
+  // dual tree traversal
+  {
+    G2lib::AABBtree T1, T2;
+    T1.set_build( G2lib::G2LIB_AABB_BINNED_SAH, 4 );
+    T2.set_build( G2lib::G2LIB_AABB_BINNED_SAH, 4 );
+    T1.build( boxes );
+    T2.build( boxes2 );
+    real_type ms1 = 0;
+    for ( int_type nt : threads ) {
+      real_type ms = best_time( 5, [&]() {
+        G2lib::AABBtree::VecPairPtrBBox ilist;
+        T1.intersect_parallel( T2, nt, ilist );
+      } );
+      if ( nt == 1 ) ms1 = ms;
+      row( "AABBtree::intersect_parallel", nt, ms, ms1 );
+    }
+  }
+
+  // intersection of two lists (the triangle covers are built once, before the runs)
+  {
+    G2lib::IntersectList ilist;
+    track.intersect_ISO( 0.5, lane, -0.5, ilist, false );
+    cout << "\nintersections = " << ilist.size() << '\n';
+    real_type ms1 = 0;
+    for ( int_type nt : threads ) {
+      G2lib::threadsIntersectAABBtree( nt );
+      real_type ms = best_time( 5, [&]() {
+        G2lib::IntersectList I;
+        track.intersect_ISO( 0.5, lane, -0.5, I, false );
+      } );
+      if ( nt == 1 ) ms1 = ms;
+      row( "ClothoidList::intersect_ISO", nt, ms, ms1 );
+    }
+    G2lib::threadsIntersectAABBtree( 1 );
+  }
+
+  cout << "\n\nALL DONE FOLKS!!!\n";
+
+  return 0;
+}
@@ -0,0 +1,395 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <sstream>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+static int_type failures = 0;
+
+static
+void
+check( char const * what, bool ok ) {
+  cout << what << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+//
+// Results of the queries of a tree: the pairs of overlapping boxes (by
+// position) and the distances of the 4 nearest boxes of every point.
+//
+
+struct Result {
+  set<pair<int_type,int_type>> pairs;
+  vector<real_type>            dist;
+  bool operator == ( Result const & R ) const { return pairs == R.pairs && dist == R.dist; }
+};
+
+//
+// Compare the AABB tree builders on the triangles covering an unevenly
+// tessellated track: long straights (few large triangles) and hairpins
+// (many small ones).
+//
+
+static
+void
+run(
+  char const *                           name,
+  G2lib::AABBbuildType                   type,
+  int_type                               leaf,
+  vector<G2lib::BBox::PtrBBox> const &   boxes,
+  vector<G2lib::BBox::PtrBBox> const &   boxes2,
+  vector<pair<real_type,real_type>> const & pnts,
+  Result &                               res,
+  bool                                   wide = false
+) {
+  G2lib::AABBtree T1, T2;
+  T1.set_build( type, leaf );
+  T2.set_build( type, leaf );
+  T1.set_wide( wide );
+  T2.set_wide( wide );
+
+  auto t0 = chrono::steady_clock::now();
+  T1.build( boxes );
+  T2.build( boxes2 );
+  auto t1 = chrono::steady_clock::now();
+
+  size_t ncand = 0;
+  res.dist.clear();
+  for ( auto const & P : pnts ) {
+    G2lib::AABBtree::VecDistPtrBBox nearList;
+    T1.knn( P.first, P.second, 4, nearList );
+    ncand += nearList.size();
+    for ( auto const & D : nearList ) res.dist.push_back( D.first );
+  }
+  auto t2 = chrono::steady_clock::now();
+
+  G2lib::AABBtree::VecPairPtrBBox intersectionList;
+  T1.intersect( T2, intersectionList );
+  auto t3 = chrono::steady_clock::now();
+
+  res.pairs.clear();
+  for ( auto const & P : intersectionList ) res.pairs.emplace( P.first->Ipos(), P.second->Ipos() );
+
+  G2lib::AABBtree::Stats S;
+  T1.stats( S );
+
+  auto ms = []( chrono::steady_clock::time_point a, chrono::steady_clock::time_point b ) {
+    return chrono::duration<double,milli>(b-a).count();
+  };
+
+  cout
+    << name << " (leaf " << leaf << ( wide ? ", wide" : "" ) << ")\n"
+    << "  nodes = " << S.num_nodes
+    << " leaves = " << S.num_leaves
+    << " max depth = " << S.max_depth
+    << " avg depth = " << S.avg_leaf_depth
+    << " avg leaf = " << S.avg_leaf_size << '\n'
+    << "  SAH cost = " << S.sah_cost
+    << " sibling overlap = " << S.overlap << '\n'
+    << "  build " << ms(t0,t1) << " ms"
+    << ", " << pnts.size() << " knn " << ms(t1,t2) << " ms (" << ncand << " found)"
+    << ", intersect " << ms(t2,t3) << " ms (" << intersectionList.size() << " pairs)\n\n";
+}
+
+//
+// Random insert/update/remove on a DynamicAABBtree: after every batch of
+// operations the pairs found against a static tree must be the pairs of
+// colliding boxes found by brute force.
+//
+
+static
+void
+test_dynamic( mt19937 & gen ) {
+  uniform_real_distribution<real_type> U(0,1);
+  auto random_box = [&]( int_type ipos ) {
+    real_type x = 100*U(gen), y = 100*U(gen);
+    return make_shared<G2lib::BBox const>( x, y, x+0.5+3*U(gen), y+0.5+3*U(gen), 1, ipos );
+  };
+
+  vector<G2lib::BBox::PtrBBox> fixed;
+  for ( int_type i = 0; i < 500; ++i ) fixed.push_back( random_box(i) );
+  G2lib::AABBtree S;
+  S.build( fixed );
+
+  G2lib::DynamicAABBtree D( 0.5 );
+  vector<pair<int_type,G2lib::BBox::PtrBBox>> live; // handle, box
+  int_type next = 0;
+  bool     ok   = true;
+  for ( int batch = 0; batch < 40 && ok; ++batch ) {
+    for ( int op = 0; op < 50; ++op ) {
+      real_type r = U(gen);
+      if ( live.empty() || r < 0.4 ) {
+        G2lib::BBox::PtrBBox B = random_box( next++ );
+        live.emplace_back( D.insert( B ), B );
+      } else if ( r < 0.8 ) {
+        // small moves stay in the enlarged leaf, the large ones do not
+        auto &               E  = live[size_t(U(gen)*live.size())];
+        real_type            d  = U(gen) < 0.5 ? 0.2 : 10;
+        real_type            dx = d*(U(gen)-0.5), dy = d*(U(gen)-0.5);
+        G2lib::BBox const &  B  = *E.second;
+        G2lib::BBox::PtrBBox M  = make_shared<G2lib::BBox const>(
+          B.x_min()+dx, B.y_min()+dy, B.x_max()+dx, B.y_max()+dy, 1, B.Ipos()
+        );
+        D.update( E.first, M );
+        E.second = M;
+      } else {
+        size_t k = size_t(U(gen)*live.size());
+        D.remove( live[k].first );
+        live[k] = live.back();
+        live.pop_back();
+      }
+    }
+    set<pair<int_type,int_type>> found, expected;
+    G2lib::AABBtree::VecPairPtrBBox ilist;
+    D.intersect( S, ilist );
+    for ( auto const & P : ilist ) found.emplace( P.first->Ipos(), P.second->Ipos() );
+    for ( auto const & E : live )
+      for ( auto const & F : fixed )
+        if ( E.second->collision( *F ) )
+          expected.emplace( E.second->Ipos(), F->Ipos() );
+    ok = found == expected && ilist.size() == expected.size() && D.size() == int_type(live.size());
+  }
+  check( "dynamic tree insert/update/remove against brute force", ok );
+}
+
+//
+// Save and load of the triangle covers of a ClothoidList, rejection of the
+// covers of another geometry and of truncated or corrupted data.
+//
+
+static
+void
+test_save_load( G2lib::ClothoidList const & track ) {
+  G2lib::ClothoidList A;
+  A.init();
+  for ( int_type i = 0; i < 300; ++i ) A.push_back( track.get( i ) );
+
+  real_type qx = A.x_begin()+10, qy = A.y_begin()-5;
+  real_type x, y, s, t, d0, d1;
+  A.closest_point_ISO( qx, qy, 0, x, y, s, t, d0 );
+  A.closest_point_ISO( qx, qy, 1.5, x, y, s, t, d0 );
+
+  ostringstream out;
+  A.save_aabb( out );
+  string const data = out.str();
+
+  // round trip: the loaded covers serve the queries, nothing is rebuilt
+  G2lib::ClothoidList B(A);
+  istringstream in( data );
+  bool loaded = B.load_aabb( in );
+  B.aabb_reset_counters();
+  B.closest_point_ISO( qx, qy, 1.5, x, y, s, t, d1 );
+  check(
+    "save_aabb/load_aabb round trip",
+    loaded && B.aabb_cache().size() == 2 && B.aabb_cache().misses() == 0 && d0 == d1
+  );
+
+  // a moved curve has another geometry hash
+  G2lib::ClothoidList C(A);
+  C.translate( 1, 0 );
+  check(
+    "load_aabb after translate rejected",
+    C.geometry_hash() != A.geometry_hash() &&
+    !C.load_aabb( data.data(), data.size() ) && C.aabb_cache().size() == 0
+  );
+
+  // truncated and corrupted images of the covers
+  std::uint64_t key = A.geometry_hash();
+  vector<shared_ptr<G2lib::TriangleCover const>> covers;
+  bool ok = true;
+  for ( size_t n : { size_t(0), size_t(8), data.size()/2, data.size()-1 } )
+    ok = ok && !G2lib::TriangleCover::load( data.data(), n, key, covers ) && covers.empty();
+  string bad( data );
+  bad[bad.size()/2] ^= 0x10;
+  ok = ok && !G2lib::TriangleCover::load( bad.data(), bad.size(), key, covers ) && covers.empty();
+  string garbage( data.size(), char(0xAB) );
+  ok = ok && !G2lib::TriangleCover::load( garbage.data(), garbage.size(), key, covers ) && covers.empty();
+  check( "TriangleCover::load of truncated and garbage data rejected", ok );
+
+  // truncated and garbage images of a tree
+  G2lib::PtrTriangleCover TC = A.build_AABBtree_ISO( 0 );
+  vector<char> buffer;
+  TC->tree.pack( buffer );
+  G2lib::AABBtree T;
+  char const * p = buffer.data();
+  ok = T.unpack( p, buffer.data()+buffer.size() ) && p == buffer.data()+buffer.size();
+  for ( size_t n : { size_t(0), size_t(12), buffer.size()/2, buffer.size()-1 } ) {
+    p  = buffer.data();
+    ok = ok && !T.unpack( p, buffer.data()+n ) && T.empty();
+  }
+  vector<char> junk( buffer.size(), char(0xAB) );
+  p  = junk.data();
+  ok = ok && !T.unpack( p, junk.data()+junk.size() ) && T.empty();
+  check( "AABBtree::unpack of truncated and garbage data rejected", ok );
+}
+
+//
+// The cache of the covers holds at most `capacity` covers: an evicted one
+// is freed unless a reader still holds it.
+//
+
+static
+void
+test_cache( G2lib::ClothoidList const & track ) {
+  G2lib::ClothoidList A;
+  A.init();
+  for ( int_type i = 0; i < 100; ++i ) A.push_back( track.get( i ) );
+  A.aabb_set_capacity( 2 );
+
+  weak_ptr<G2lib::TriangleCover const> first = A.build_AABBtree_ISO( 0 );
+  G2lib::PtrTriangleCover              held  = A.build_AABBtree_ISO( 0.5 );
+  real_type x, y, s, t, d;
+  for ( int_type k = 1; k <= 20; ++k )
+    A.closest_point_ISO( A.x_begin(), A.y_begin(), 0.1*k+1, x, y, s, t, d );
+  check(
+    "cache bounded by capacity, evicted covers freed",
+    A.aabb_cache().size() == 2 && A.aabb_cache().capacity() == 2 && first.expired() &&
+    held.use_count() == 1 && !held->tri.empty() && A.aabb_cache().misses() == 22
+  );
+}
+
+int
+main() {
+
+  G2lib::ClothoidList track;
+  track.init();
+  track.push_back( 0, 0, 0, 0, 0, 1 );
+  mt19937 gen(1);
+  uniform_real_distribution<real_type> U(0,1);
+  for ( int i = 0; i < 4000; ++i ) {
+    if ( i % 3 == 0 ) track.push_back( 0, 0, 200+800*U(gen) );   // straight
+    else              track.push_back( (U(gen)-0.5)*0.4, 0, 5+20*U(gen) ); // hairpin
+  }
+
+  vector<G2lib::Triangle2D> tri;
+  track.bbTriangles_ISO( 0, tri, G2lib::Utils::m_pi/18, 1e100 );
+
+  G2lib::ClothoidList lane(track);
+  lane.translate( 3, -2 );
+  vector<G2lib::Triangle2D> tri2;
+  lane.bbTriangles_ISO( 1.75, tri2, G2lib::Utils::m_pi/18, 1e100 );
+
+  vector<G2lib::BBox::PtrBBox> boxes, boxes2;
+  for ( size_t i = 0; i < tri.size(); ++i ) {
+    real_type xmin, ymin, xmax, ymax;
+    tri[i].bbox( xmin, ymin, xmax, ymax );
+    boxes.push_back( make_shared<G2lib::BBox const>( xmin, ymin, xmax, ymax, 0, int_type(i) ) );
+  }
+  for ( size_t i = 0; i < tri2.size(); ++i ) {
+    real_type xmin, ymin, xmax, ymax;
+    tri2[i].bbox( xmin, ymin, xmax, ymax );
+    boxes2.push_back( make_shared<G2lib::BBox const>( xmin, ymin, xmax, ymax, 0, int_type(i) ) );
+  }
+
+  // query points close to the track
+  vector<pair<real_type,real_type>> pnts;
+  for ( int i = 0; i < 20000; ++i ) {
+    real_type s = track.length()*U(gen);
+    real_type x, y;
+    track.eval_ISO( s, 20*(U(gen)-0.5), x, y );
+    pnts.push_back( pair<real_type,real_type>(x,y) );
+  }
+
+  cout << "triangles = " << tri.size() << '\n';
+  Result R0, R;
+  run( "MIDPOINT",    G2lib::G2LIB_AABB_MIDPOINT,    1, boxes, boxes2, pnts, R0 );
+  bool same = true;
+  run( "MIDPOINT",    G2lib::G2LIB_AABB_MIDPOINT,    4, boxes, boxes2, pnts, R ); same = same && R == R0;
+  run( "BINNED_SAH",  G2lib::G2LIB_AABB_BINNED_SAH,  1, boxes, boxes2, pnts, R ); same = same && R == R0;
+  run( "BINNED_SAH",  G2lib::G2LIB_AABB_BINNED_SAH,  4, boxes, boxes2, pnts, R ); same = same && R == R0;
+  run( "BINNED_SAH",  G2lib::G2LIB_AABB_BINNED_SAH,  8, boxes, boxes2, pnts, R ); same = same && R == R0;
+  run( "BINNED_SAH",  G2lib::G2LIB_AABB_BINNED_SAH,  1, boxes, boxes2, pnts, R, true ); same = same && R == R0;
+  run( "BINNED_SAH",  G2lib::G2LIB_AABB_BINNED_SAH,  4, boxes, boxes2, pnts, R, true ); same = same && R == R0;
+  check( "builders and wide nodes give the same pairs and nearest boxes", same );
+
+  // the reference tree against brute force on the first points
+  {
+    bool ok = true;
+    for ( size_t i = 0; i < 200 && ok; ++i ) {
+      vector<real_type> d;
+      for ( auto const & B : boxes ) d.push_back( B->distance( pnts[i].first, pnts[i].second ) );
+      partial_sort( d.begin(), d.begin()+4, d.end() );
+      for ( size_t k = 0; k < 4; ++k )
+        ok = ok && abs( d[k]-R0.dist[4*i+k] ) <= 1e-12*(1+d[k]);
+    }
+    // the pairs of the first 2000 boxes
+    set<pair<int_type,int_type>> expected, found;
+    for ( size_t i = 0; i < 2000; ++i )
+      for ( auto const & B2 : boxes2 )
+        if ( boxes[i]->collision( *B2 ) )
+          expected.emplace( boxes[i]->Ipos(), B2->Ipos() );
+    for ( auto const & P : R0.pairs ) if ( P.first < 2000 ) found.insert( P );
+    check( "knn and intersect against brute force", ok && expected == found );
+  }
+
+  // the parallel builder and the parallel dual traversal give the serial results
+  // (their scaling with the number of threads is measured by `benchThreads`)
+  {
+    G2lib::AABBtree T1, T2;
+    T1.set_build( G2lib::G2LIB_AABB_BINNED_SAH, 4 );
+    T2.set_build( G2lib::G2LIB_AABB_BINNED_SAH, 4 );
+    T1.build( boxes );
+    T2.build( boxes2 );
+    G2lib::AABBtree::VecPairPtrBBox I1;
+    T1.intersect( T2, I1 );
+    bool ok = !I1.empty();
+    for ( int_type nt : { 1, 2, 3, 8 } ) {
+      G2lib::AABBtree P;
+      P.set_build( G2lib::G2LIB_AABB_BINNED_SAH, 4 );
+      P.set_build_threads( nt );
+      P.build( boxes );
+      G2lib::AABBtree::VecPairPtrBBox I, IP;
+      P.intersect( T2, I );
+      T1.intersect_parallel( T2, nt, IP );
+      ok = ok && I == I1 && IP == I1;
+    }
+    check( "parallel build and intersect_parallel against serial", ok );
+  }
+
+  // refinements of the curve intersection with and without clipped triangles
+  bool same_pairs = true;
+  for ( int clip = 0; clip < 2; ++clip ) {
+    G2lib::clipAABBtriangles( clip != 0 );
+    G2lib::ClothoidList A(track), B(lane);
+    G2lib::IntersectList ilist;
+    A.intersect_ISO( 0.5, B, -0.5, ilist, false );
+    // the pairs of triangles of the covers used by `intersect_ISO`
+    G2lib::PtrTriangleCover      TC1 = A.build_AABBtree_ISO( 0.5 );
+    G2lib::PtrTriangleCover      TC2 = B.build_AABBtree_ISO( -0.5 );
+    G2lib::AABBintersectCounters counters;
+    TC1->intersect_visit(
+      *TC2,
+      []( G2lib::Triangle2D const &, G2lib::Triangle2D const & ) {},
+      &counters
+    );
+    cout
+      << "clip = " << clip
+      << " tested " << counters.tested
+      << " refined " << counters.refined
+      << " (" << ilist.size() << " intersections)\n";
+    // the same pairs found by the split traversal on any number of threads
+    vector<pair<G2lib::Triangle2D const *, G2lib::Triangle2D const *>> P1, P4;
+    G2lib::AABBintersectCounters                                         C1, C4;
+    TC1->intersect_pairs( *TC2, 1, P1, &C1 );
+    TC1->intersect_pairs( *TC2, 4, P4, &C4 );
+    same_pairs = same_pairs && P1 == P4 && P1.size() == counters.refined &&
+                 C1.tested == counters.tested && C4.refined == counters.refined;
+  }
+  G2lib::clipAABBtriangles( false );
+  check( "TriangleCover::intersect_pairs on 1 and 4 threads", same_pairs );
+
+  test_dynamic( gen );
+  test_save_load( track );
+  test_cache( track );
+
+  cout << "\n\nALL DONE FOLKS!!!\n";
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+//
+// The batched eval, eval_ISO and evaluate of the curves against `n` calls
+// of the scalar versions. Lines, circle arcs, biarc lists and polylines
+// give the same values; clothoids and clothoid lists go through the
+// batched Fresnel kernels, which agree up to rounding: positions within
+// `1e-12*(1+|s|)`, angles and curvatures within `1e-12`.
+//
+
+static int_type failures = 0;
+
+static
+void
+check( char const * what, real_type err, real_type tol ) {
+  bool ok = err <= tol;
+  cout << what << " max err = " << err << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+// max difference batch vs scalar at the abscissas `s` (any order)
+static
+real_type
+batch_error( G2lib::BaseCurve const & C, vector<real_type> const & s, real_type offs ) {
+  int_type const    n = int_type(s.size());
+  vector<real_type> x(n), y(n), xo(n), yo(n), th(n), kk(n), xe(n), ye(n);
+  C.eval( n, s.data(), x.data(), y.data() );
+  C.eval_ISO( n, s.data(), offs, xo.data(), yo.data() );
+  C.evaluate( n, s.data(), th.data(), kk.data(), xe.data(), ye.data() );
+  real_type err = 0;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type x1, y1, xo1, yo1, th1, kk1, xe1, ye1;
+    C.eval( s[i], x1, y1 );
+    C.eval_ISO( s[i], offs, xo1, yo1 );
+    C.evaluate( s[i], th1, kk1, xe1, ye1 );
+    real_type scale = 1+abs(s[i]);
+    err = max( err, max( abs(x1-x[i]), abs(y1-y[i]) )/scale );
+    err = max( err, max( abs(xo1-xo[i]), abs(yo1-yo[i]) )/scale );
+    err = max( err, max( abs(xe1-xe[i]), abs(ye1-ye[i]) )/scale );
+    err = max( err, max( abs(th1-th[i]), abs(kk1-kk[i]) ) );
+  }
+  return err;
+}
+
+// abscissas on the curve: sorted, then the same shuffled
+static
+vector<real_type>
+abscissas( G2lib::BaseCurve const & C, mt19937 & gen ) {
+  int_type const    n = 1001;
+  vector<real_type> s(2*n);
+  for ( int_type i = 0; i < n; ++i ) s[i] = C.length()*i/(n-1);
+  copy( s.begin(), s.begin()+n, s.begin()+n );
+  shuffle( s.begin()+n, s.end(), gen );
+  return s;
+}
+
+int
+main() {
+
+  mt19937 gen(1);
+  uniform_real_distribution<real_type> U(-1,1);
+
+  real_type const offs = 0.7;
+
+  G2lib::LineSegment L( 1, 2, 0.3, 50 );
+  check( "LineSegment    batch vs scalar", batch_error( L, abscissas( L, gen ), offs ), 0 );
+
+  G2lib::CircleArc A( 1, 2, 0.3, 0.05, 50 );
+  check( "CircleArc      batch vs scalar", batch_error( A, abscissas( A, gen ), offs ), 0 );
+
+  G2lib::ClothoidCurve C( 1, 2, 0.3, 0.05, -0.004, 50 );
+  check( "ClothoidCurve  batch vs scalar", batch_error( C, abscissas( C, gen ), offs ), 1e-12 );
+
+  G2lib::ClothoidList CL;
+  CL.push_back( 0, 0, 0.3, 0, 0, 10 );
+  for ( int_type i = 0; i < 100; ++i )
+    CL.push_back( 0.2*U(gen), 0.01*U(gen), 5+4*U(gen) );
+  check( "ClothoidList   batch vs scalar", batch_error( CL, abscissas( CL, gen ), offs ), 1e-12 );
+
+  vector<real_type> xx, yy;
+  for ( int_type i = 0; i < 50; ++i ) {
+    xx.push_back( 10*i+U(gen) );
+    yy.push_back( 5*sin(0.3*i)+U(gen) );
+  }
+  G2lib::BiarcList BL;
+  BL.build_G1( int_type(xx.size()), xx.data(), yy.data() );
+  check( "BiarcList      batch vs scalar", batch_error( BL, abscissas( BL, gen ), offs ), 0 );
+
+  G2lib::PolyLine PL;
+  PL.init( xx[0], yy[0] );
+  for ( size_t i = 1; i < xx.size(); ++i ) PL.push_back( xx[i], yy[i] );
+  check( "PolyLine       batch vs scalar", batch_error( PL, abscissas( PL, gen ), offs ), 0 );
+
+  cout << "\n\nALL DONE FOLKS!!!\n";
+
+  return failures == 0 ? 0 : 1;
+}
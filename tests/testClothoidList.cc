@@ -0,0 +1,166 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+//
+// The accessors of the segments of a ClothoidList and its transformations,
+// which update the stored parameters in place, against the same
+// transformations applied to the clothoids one by one.
+//
+
+static int_type failures = 0;
+
+static
+void
+check( char const * what, bool ok ) {
+  cout << what << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+// max distance of the parameters of the segments of two lists
+static
+real_type
+distance( G2lib::ClothoidList const & A, G2lib::ClothoidList const & B ) {
+  if ( A.num_segments() != B.num_segments() ) return numeric_limits<real_type>::infinity();
+  real_type err = 0;
+  for ( int_type i = 0; i < A.num_segments(); ++i ) {
+    G2lib::ClothoidCurve const & a = A.get( i );
+    G2lib::ClothoidCurve const & b = B.get( i );
+    err = max( err, abs( a.x_begin()-b.x_begin() ) );
+    err = max( err, abs( a.y_begin()-b.y_begin() ) );
+    err = max( err, abs( remainder( a.theta_begin()-b.theta_begin(), G2lib::Utils::m_2pi ) ) );
+    err = max( err, abs( a.kappa_begin()-b.kappa_begin() ) );
+    err = max( err, abs( a.dkappa()-b.dkappa() ) );
+    err = max( err, abs( a.length()-b.length() ) );
+  }
+  return max( err, abs( A.length()-B.length() ) );
+}
+
+// the list rebuilt from its segments transformed by `fun`, chained as `ClothoidList` does
+template <typename FUN>
+static
+G2lib::ClothoidList
+by_curves( G2lib::ClothoidList const & L, bool chain, FUN const & fun ) {
+  G2lib::ClothoidList R;
+  real_type x0 = 0, y0 = 0;
+  for ( int_type i = 0; i < L.num_segments(); ++i ) {
+    G2lib::ClothoidCurve C = L.segment( i );
+    fun( C );
+    if ( chain && i > 0 ) C.change_origin( x0, y0 );
+    x0 = C.x_end();
+    y0 = C.y_end();
+    R.push_back( C );
+  }
+  return R;
+}
+
+int
+main() {
+
+  mt19937 gen(1);
+  uniform_real_distribution<real_type> U(-1,1);
+
+  G2lib::ClothoidList L;
+  L.push_back( 0, 0, 0.3, 0, 0, 10 );
+  for ( int_type i = 0; i < 200; ++i )
+    L.push_back( 0.2*U(gen), 0.01*U(gen), 5+4*U(gen) );
+
+  // accessors: a reference stable until the list changes and the same segment by value
+  {
+    G2lib::ClothoidCurve const & r = L.get( 7 );
+    real_type                    s = 0.5;
+    for ( int_type i = 0; i < 7; ++i ) s += L.segment_length( i );
+    bool ok = &r == &L.get( 7 ) && &L.getAtS( s ) == &r;
+    G2lib::ClothoidCurve c = L.segment( 7 );
+    G2lib::ClothoidCurve d = L.segmentAtS( s );
+    ok = ok && c.x_begin() == r.x_begin() && c.theta_begin() == r.theta_begin() && c.length() == r.length();
+    ok = ok && d.x_begin() == r.x_begin() && d.kappa_begin() == r.kappa_begin();
+    check( "get/getAtS references and segment/segmentAtS values", ok );
+  }
+
+  real_type const tol = 1e-9;
+
+  {
+    G2lib::ClothoidList A(L);
+    A.translate( 3, -2 );
+    G2lib::ClothoidList B = by_curves( L, false, []( G2lib::ClothoidCurve & C ) { C.translate( 3, -2 ); } );
+    check( "translate", distance( A, B ) <= tol );
+  }
+  {
+    G2lib::ClothoidList A(L);
+    A.rotate( 0.7, 1, 2 );
+    G2lib::ClothoidList B = by_curves( L, false, []( G2lib::ClothoidCurve & C ) { C.rotate( 0.7, 1, 2 ); } );
+    check( "rotate", distance( A, B ) <= tol );
+  }
+  {
+    G2lib::ClothoidList A(L);
+    A.scale( 1.7 );
+    G2lib::ClothoidList B = by_curves( L, true, []( G2lib::ClothoidCurve & C ) { C.scale( 1.7 ); } );
+    check( "scale", distance( A, B ) <= tol );
+  }
+  {
+    G2lib::ClothoidList A(L);
+    A.change_origin( -4, 5 );
+    G2lib::ClothoidList C;
+    real_type x0 = -4, y0 = 5;
+    for ( int_type i = 0; i < L.num_segments(); ++i ) {
+      G2lib::ClothoidCurve S = L.segment( i );
+      S.change_origin( x0, y0 );
+      x0 = S.x_end();
+      y0 = S.y_end();
+      C.push_back( S );
+    }
+    check( "change_origin", distance( A, C ) <= tol );
+  }
+  {
+    G2lib::ClothoidList A(L);
+    A.reverse();
+    G2lib::ClothoidList R;
+    for ( int_type i = L.num_segments()-1; i >= 0; --i ) R.push_back( L.segment( i ) );
+    G2lib::ClothoidList B = by_curves( R, true, []( G2lib::ClothoidCurve & C ) { C.reverse(); } );
+    bool ok = distance( A, B ) <= tol;
+    A.reverse();
+    ok = ok && distance( A, L ) <= tol;
+    check( "reverse, twice gives back the list", ok );
+  }
+
+  // a reference is not affected by a later copy being transformed
+  {
+    G2lib::ClothoidList A(L);
+    real_type xb = A.get( 3 ).x_begin();
+    A.translate( 1, 1 );
+    check( "get after translate", abs( A.get( 3 ).x_begin()-(xb+1) ) <= tol );
+  }
+
+  // the intersections of two lists do not depend on the number of threads
+  {
+    G2lib::ClothoidList A(L), B(L);
+    B.rotate( 0.05, 0, 0 );
+    B.translate( 2, 1 );
+    G2lib::IntersectList I1;
+    G2lib::threadsIntersectAABBtree( 1 );
+    A.intersect_ISO( 0.5, B, -0.5, I1, false );
+    bool ok = !I1.empty() && is_sorted( I1.begin(), I1.end() );
+    for ( G2lib::int_type nt : { 2, 3, 8, 0 } ) {
+      G2lib::IntersectList I;
+      G2lib::threadsIntersectAABBtree( nt );
+      A.intersect_ISO( 0.5, B, -0.5, I, false );
+      ok = ok && I == I1;
+    }
+    G2lib::threadsIntersectAABBtree( 1 );
+    cout << I1.size() << " intersections\n";
+    check( "intersect_ISO same result with 1, 2, 3, 8 and all threads", ok );
+  }
+
+  cout << "\n\nALL DONE FOLKS!!!\n";
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <sstream>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+//
+// The float cores of the clothoid curve and list against the double
+// wrappers. The evaluations agree within `1e-4` relative to 1+s, the
+// intersections are the same with the curvilinear abscissas within `1e-2`.
+// The double cores give the results of the wrappers up to rounding (the
+// batch evaluations take sin/cos from their own kernel).
+//
+
+static int_type failures = 0;
+
+static
+void
+check( char const * what, bool ok ) {
+  cout << what << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+static
+void
+check( char const * what, real_type err, real_type tol ) {
+  bool ok = err <= tol;
+  cout << what << " max err = " << err << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+// a wavy list of clothoids through the points (x,sin(x))
+static
+G2lib::ClothoidList
+wave( real_type y0, real_type amp ) {
+  G2lib::ClothoidList L;
+  L.init();
+  L.push_back_G1( 0, y0, 0.8, 1, y0+amp*sin(1.0), 0 );
+  for ( int_type i = 2; i <= 20; ++i )
+    L.push_back_G1( i, y0+amp*sin(real_type(i)), real_type(i%3)*0.3-0.3 );
+  return L;
+}
+
+template <typename T, typename CURVE, typename REF>
+static
+real_type
+eval_error( CURVE const & C, REF const & R, real_type L ) {
+  int_type const N = 301;
+  vector<T>      s(N), th(N), kk(N), x(N), y(N), xo(N), yo(N);
+  for ( int_type i = 0; i < N; ++i ) s[i] = T(L*i/(N-1));
+  C.evaluate( N, s.data(), th.data(), kk.data(), x.data(), y.data() );
+  C.eval_ISO( N, s.data(), T(0.3), xo.data(), yo.data() );
+  real_type err = 0;
+  for ( int_type i = 0; i < N; ++i ) {
+    real_type si = real_type(s[i]), th1, kk1, x1, y1, xo1, yo1;
+    T         xs, ys;
+    R.evaluate( si, th1, kk1, x1, y1 );
+    R.eval_ISO( si, 0.3, xo1, yo1 );
+    C.eval( s[i], xs, ys );
+    real_type e = max( abs(th1-th[i]), abs(kk1-kk[i]) );
+    e   = max( e, max( abs(x1-x[i]), abs(y1-y[i]) ) );
+    e   = max( e, max( abs(xo1-xo[i]), abs(yo1-yo[i]) ) );
+    e   = max( e, max( abs(x1-xs), abs(y1-ys) ) );
+    err = max( err, e/(1+si) );
+  }
+  return err;
+}
+
+template <typename LIST>
+static
+real_type
+intersect_error( LIST const & A, LIST const & B, G2lib::IntersectList const & ref, bool & same ) {
+  typename LIST::IntersectList ilist;
+  A.intersect_ISO( 0, B, 0, ilist );
+  same = ilist.size() == ref.size();
+  real_type err = 0;
+  for ( size_t k = 0; same && k < ilist.size(); ++k )
+    err = max( err, max( abs(ilist[k].first-ref[k].first), abs(ilist[k].second-ref[k].second) ) );
+  return err;
+}
+
+int
+main() {
+
+  G2lib::ClothoidList A = wave( 0, 1 );
+  G2lib::ClothoidList B = wave( 0.3, -1 );
+  G2lib::ClothoidList C = wave( 5, 1 );
+
+  // a single curve
+  {
+    G2lib::ClothoidCurve             R( 1, 2, 0.3, 0.1, -0.02, 15 );
+    G2lib::ClothoidCurveT<float>     F( R );
+    G2lib::ClothoidCurveT<real_type> D( R );
+    check( "ClothoidCurveT<float> vs ClothoidCurve ", eval_error<float>( F, R, R.length() ), 1e-4 );
+    check( "ClothoidCurveT<double> vs ClothoidCurve", eval_error<real_type>( D, R, R.length() ), 1e-12 );
+  }
+
+  // a list, the evaluations cross the joints of the segments
+  {
+    G2lib::ClothoidListT<float>     F( A );
+    G2lib::ClothoidListT<real_type> D( A );
+    check( "ClothoidListT<float> vs ClothoidList ", eval_error<float>( F, A, A.length() ), 1e-4 );
+    check( "ClothoidListT<double> vs ClothoidList", eval_error<real_type>( D, A, A.length() ), 1e-12 );
+    G2lib::ClothoidListT<float> P;
+    for ( int_type i = 0; i < A.num_segments(); ++i ) P.push_back( F.segment( i ) );
+    check( "ClothoidListT::push_back", P.num_segments() == F.num_segments() && P.length() == F.length() );
+  }
+
+  // intersection and collision of two lists
+  {
+    G2lib::IntersectList ref;
+    A.intersect_ISO( 0, B, 0, ref, false );
+    sort( ref.begin(), ref.end() );
+    bool      same;
+    real_type errD = intersect_error(
+      G2lib::ClothoidListT<real_type>( A ), G2lib::ClothoidListT<real_type>( B ), ref, same
+    );
+    check( "ClothoidListT<double>::intersect_ISO count", same && !ref.empty() );
+    check( "ClothoidListT<double>::intersect_ISO", errD, 1e-12 );
+    real_type errF = intersect_error( G2lib::ClothoidListT<float>( A ), G2lib::ClothoidListT<float>( B ), ref, same );
+    check( "ClothoidListT<float>::intersect_ISO count", same );
+    check( "ClothoidListT<float>::intersect_ISO", errF, 1e-2 );
+
+    G2lib::ClothoidListT<float> FA( A ), FB( B ), FC( C );
+    check(
+      "ClothoidListT<float>::collision_ISO",
+      FA.collision_ISO( 0, FB, 0 ) == A.collision_ISO( 0, B, 0 ) &&
+      FA.collision_ISO( 0, FC, 0 ) == A.collision_ISO( 0, C, 0 ) &&
+      FA.collision_ISO( 0, FC, 0 ) == false
+    );
+  }
+
+  // intersection of two curves
+  {
+    G2lib::ClothoidCurve R1( 0, 0, 0, 0.1, 0, 20 );
+    G2lib::ClothoidCurve R2( 5, -5, 1.5, 0.02, -0.001, 25 );
+    G2lib::IntersectList ref;
+    R1.intersect_ISO( 0, R2, 0, ref, false );
+    G2lib::ClothoidCurveT<float>::IntersectList ilist;
+    G2lib::ClothoidCurveT<float>( R1 ).intersect_ISO( 0, G2lib::ClothoidCurveT<float>( R2 ), 0, ilist );
+    bool      ok  = ilist.size() == ref.size() && !ref.empty();
+    real_type err = 0;
+    for ( size_t k = 0; ok && k < ilist.size(); ++k )
+      err = max( err, max( abs(ilist[k].first-ref[k].first), abs(ilist[k].second-ref[k].second) ) );
+    check( "ClothoidCurveT<float>::intersect_ISO count", ok );
+    check( "ClothoidCurveT<float>::intersect_ISO", err, 1e-2 );
+  }
+
+  // a float dynamic tree against a float static tree
+  {
+    using BBoxF = G2lib::BBoxT<float>;
+    mt19937 gen(1);
+    uniform_real_distribution<float> U(0,1);
+    auto random_box = [&]( int_type ipos ) {
+      float x = 100*U(gen), y = 100*U(gen);
+      return make_shared<BBoxF const>( x, y, x+0.5f+3*U(gen), y+0.5f+3*U(gen), 1, ipos );
+    };
+    vector<BBoxF::PtrBBox> fixed, moving;
+    for ( int_type i = 0; i < 300; ++i ) fixed.push_back( random_box(i) );
+    for ( int_type i = 0; i < 300; ++i ) moving.push_back( random_box(i) );
+    G2lib::AABBtreeT<float> S;
+    S.build( fixed );
+    G2lib::DynamicAABBtreeT<float> D( 0.5f );
+    for ( auto const & B : moving ) D.insert( B );
+    G2lib::AABBtreeT<float>::VecPairPtrBBox ilist;
+    D.intersect( S, ilist );
+    set<pair<int_type,int_type>> found, expected;
+    for ( auto const & P : ilist ) found.emplace( P.first->Ipos(), P.second->Ipos() );
+    for ( auto const & M : moving )
+      for ( auto const & F : fixed )
+        if ( M->collision( *F ) )
+          expected.emplace( M->Ipos(), F->Ipos() );
+    check( "DynamicAABBtreeT<float>::intersect against brute force", found == expected && !found.empty() );
+  }
+
+  // save and load of float covers, rejected as double covers
+  {
+    G2lib::ClothoidListT<float> F( A );
+    vector<G2lib::ClothoidListT<float>::PtrCover> covers{ F.build_AABBtree_ISO( 0 ), F.build_AABBtree_ISO( 0.5f ) };
+    ostringstream out;
+    G2lib::TriangleCoverT<float>::save( out, covers, 42 );
+    string const data = out.str();
+    vector<G2lib::ClothoidListT<float>::PtrCover> loaded;
+    bool ok = G2lib::TriangleCoverT<float>::load( data.data(), data.size(), 42, loaded ) && loaded.size() == 2;
+    for ( size_t k = 0; ok && k < 2; ++k )
+      ok = loaded[k]->tri.size() == covers[k]->tri.size() && loaded[k]->offs == covers[k]->offs;
+    vector<G2lib::PtrTriangleCover> dcovers;
+    ok = ok && !G2lib::TriangleCover::load( data.data(), data.size(), 42, dcovers ) && dcovers.empty();
+    check( "TriangleCoverT<float> save/load round trip", ok );
+  }
+
+  cout << "\n\nALL DONE FOLKS!!!\n";
+
+  return failures == 0 ? 0 : 1;
+}
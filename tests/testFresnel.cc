@@ -0,0 +1,132 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+//
+// The batched Fresnel kernels against the scalar ones. The batch takes
+// sin/cos from its own vectorized kernel, not from libm, so the results
+// agree up to rounding: within `1e-12` in double and `1e-5` in float
+// (absolute, the integrals are at most 1) where the scalar evaluation is
+// well conditioned, |b| <= 10.
+//
+
+static int_type failures = 0;
+
+static
+void
+check( char const * what, bool ok ) {
+  cout << what << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+static
+void
+check( char const * what, real_type err, real_type tol ) {
+  bool ok = err <= tol;
+  cout << what << " max err = " << err << ( ok ? " OK\n" : " NO OK\n" );
+  if ( !ok ) ++failures;
+}
+
+template <typename T>
+static
+real_type
+generalized( mt19937 & gen, real_type amax ) {
+  uniform_real_distribution<real_type> U(-1,1);
+  int_type const N = 4000;
+  vector<T> a(N), b(N), c(N), C(N), S(N);
+  for ( int_type i = 0; i < N; ++i ) {
+    a[i] = T(amax*U(gen));
+    b[i] = T(10*U(gen));
+    c[i] = T(4*U(gen));
+  }
+  G2lib::GeneralizedFresnelCS( N, a.data(), b.data(), c.data(), C.data(), S.data() );
+  real_type err = 0;
+  for ( int_type i = 0; i < N; ++i ) {
+    T C1, S1;
+    G2lib::GeneralizedFresnelCS( a[i], b[i], c[i], C1, S1 );
+    err = max( err, real_type(max( abs(C1-C[i]), abs(S1-S[i]) )) );
+  }
+  return err;
+}
+
+int
+main() {
+
+  mt19937 gen(1);
+
+  // the regimes of the kernel: small |a| (Lommel series), moderate and large |a|
+  for ( real_type amax : { 0.004, 0.5, 20.0, 200.0 } ) {
+    check( "GeneralizedFresnelCS batch vs scalar (double)", generalized<double>( gen, amax ), 1e-12 );
+    check( "GeneralizedFresnelCS batch vs scalar (float) ", generalized<float>( gen, amax ), 1e-5 );
+  }
+
+  // the batched evaluations of a clothoid, positions relative to 1+s
+  uniform_real_distribution<real_type> U(-1,1);
+  real_type errF = 0, errE = 0, errI = 0;
+  for ( int_type k = 0; k < 50; ++k ) {
+    G2lib::ClothoidData CD;
+    CD.x0     = 10*U(gen);
+    CD.y0     = 10*U(gen);
+    CD.theta0 = 3*U(gen);
+    CD.kappa0 = 0.5*U(gen);
+    CD.dk     = 0.05*U(gen);
+    real_type L = 20;
+
+    int_type const    N = 257;
+    vector<real_type> s(N), C(N), S(N), th(N), kk(N), x(N), y(N), xo(N), yo(N);
+    for ( int_type i = 0; i < N; ++i ) s[i] = L*i/(N-1);
+    CD.fresnelCS( N, s.data(), C.data(), S.data() );
+    CD.evaluate( N, s.data(), th.data(), kk.data(), x.data(), y.data() );
+    CD.eval_ISO( N, s.data(), 0.7, xo.data(), yo.data() );
+    for ( int_type i = 0; i < N; ++i ) {
+      real_type C1, S1, th1, kk1, x1, y1, xo1, yo1;
+      CD.fresnelCS( s[i], C1, S1 );
+      CD.evaluate( s[i], th1, kk1, x1, y1 );
+      CD.eval_ISO( s[i], 0.7, xo1, yo1 );
+      errF = max( errF, max( abs(C1-C[i]), abs(S1-S[i]) ) );
+      errE = max( errE, max( abs(th1-th[i]), abs(kk1-kk[i]) ) );
+      errE = max( errE, max( abs(x1-x[i]), abs(y1-y[i]) )/(1+s[i]) );
+      errI = max( errI, max( abs(xo1-xo[i]), abs(yo1-yo[i]) )/(1+s[i]) );
+    }
+  }
+  check( "ClothoidData::fresnelCS batch vs scalar", errF, 1e-12 );
+  check( "ClothoidData::evaluate batch vs scalar ", errE, 1e-12 );
+  check( "ClothoidData::eval_ISO batch vs scalar ", errI, 1e-12 );
+
+  // approximate kernel: the bound is met, or reported as not met
+  {
+    bool met = G2lib::fresnel_approx_tolerance( 1e-9 );
+    G2lib::FresnelApproxReport R = G2lib::fresnel_approx_report();
+    check( "approximate kernel 1e-9 met", met && R.tolerance_met );
+    check( "approximate kernel 1e-9", max( R.max_error_CS, R.max_error_GCS ), 1e-9 );
+    met = G2lib::fresnel_approx_tolerance( 1e-20 );
+    R   = G2lib::fresnel_approx_report();
+    check( "approximate kernel 1e-20 reported as not met", !met && !R.tolerance_met );
+    G2lib::fresnel_approx_tolerance( 1e-9 );
+  }
+
+  // the kernel of a list is one for all its segments
+  {
+    G2lib::ClothoidList L;
+    G2lib::ClothoidCurve C( 0, 0, 0, 0.1, 0.01, 10 );
+    C.fresnel_mode( G2lib::G2LIB_FRESNEL_EXACT );
+    L.fresnel_mode( G2lib::G2LIB_FRESNEL_APPROX );
+    L.push_back( C );
+    L.push_back_G1( 20, 5, 0.3 );
+    bool ok = L.fresnel_mode() == G2lib::G2LIB_FRESNEL_APPROX;
+    for ( int_type i = 0; i < L.num_segments(); ++i )
+      ok = ok && L.get( i ).fresnel_mode() == G2lib::G2LIB_FRESNEL_APPROX;
+    check( "ClothoidList::fresnel_mode of the segments", ok );
+  }
+
+  cout << "\n\nALL DONE FOLKS!!!\n";
+
+  return failures == 0 ? 0 : 1;
+}